@@ -0,0 +1,271 @@
+/*! \file
+ * \brief The implementation part of threadscript/code_cache.hpp
+ */
+
+#include "threadscript/code_cache.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+
+namespace threadscript {
+
+namespace {
+
+//! A reader of the binary form of a script
+/*! All functions return \c false or \c std::nullopt if the data are
+ * exhausted or malformed. */
+class reader {
+public:
+    //! Creates the reader.
+    /*! \param[in] data the binary form of a script */
+    explicit reader(std::string_view data): data(data) {}
+    //! Reads an unsigned integer.
+    /*! \return the value */
+    std::optional<uint64_t> get_uint() {
+        uint64_t v = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (data.empty())
+                return std::nullopt;
+            auto b = static_cast<unsigned char>(data.front());
+            data.remove_prefix(1);
+            v |= uint64_t(b & 0x7fU) << shift;
+            if (!(b & 0x80U))
+                return v;
+        }
+        return std::nullopt;
+    }
+    //! Reads a string.
+    /*! \return a view into the data */
+    std::optional<std::string_view> get_string() {
+        auto sz = get_uint();
+        if (!sz || *sz > data.size())
+            return std::nullopt;
+        auto result = data.substr(0, *sz);
+        data.remove_prefix(*sz);
+        return result;
+    }
+    //! Reads a single byte.
+    /*! \return the value */
+    std::optional<unsigned char> get_byte() {
+        if (data.empty())
+            return std::nullopt;
+        auto result = static_cast<unsigned char>(data.front());
+        data.remove_prefix(1);
+        return result;
+    }
+    //! Tests if all data have been read.
+    /*! \return whether the data are exhausted */
+    [[nodiscard]] bool empty() const noexcept {
+        return data.empty();
+    }
+    //! Reads a node and its descendants and adds them to a script.
+    /*! \param[in] builder the builder of the script
+     * \param[in] parent the parent node, node_handle{} for the root
+     * \return whether successful */
+    bool node(script_builder& builder,
+              const script_builder::node_handle& parent);
+private:
+    //! The remaining unread data
+    std::string_view data;
+};
+
+bool reader::node(script_builder& builder,
+                  const script_builder::node_handle& parent)
+{
+    using tag = code_cache::value_tag;
+    auto line = get_uint();
+    auto column = get_uint();
+    auto name = get_string();
+    auto t = get_byte();
+    if (!line || !column || !name || !t ||
+        *line > std::numeric_limits<unsigned>::max() ||
+        *column > std::numeric_limits<unsigned>::max())
+    {
+        return false;
+    }
+    script_builder::value_handle value{};
+    switch (tag(*t)) {
+    case tag::none:
+        break;
+    case tag::null:
+        value = script_builder::create_value_null();
+        break;
+    case tag::false_:
+    case tag::true_:
+        value = builder.create_value_bool(tag(*t) == tag::true_);
+        break;
+    case tag::int_:
+        if (auto v = get_uint()) {
+            // zigzag decoding
+            value = builder.create_value_int(
+                config::value_int_type(int64_t(*v >> 1) ^ -int64_t(*v & 1)));
+            break;
+        } else
+            return false;
+    case tag::unsigned_:
+        if (auto v = get_uint()) {
+            value = builder.create_value_unsigned(*v);
+            break;
+        } else
+            return false;
+    case tag::string:
+        if (auto v = get_string()) {
+            value = builder.create_value_string(*v);
+            break;
+        } else
+            return false;
+    default:
+        return false;
+    }
+    auto n = builder.add_node(parent, file_location(unsigned(*line),
+                                                    unsigned(*column)),
+                              *name, value);
+    auto children = get_uint();
+    if (!children)
+        return false;
+    for (uint64_t i = 0; i < *children; ++i)
+        if (!node(builder, n))
+            return false;
+    return true;
+}
+
+//! Updates a FNV-1a hash.
+/*! \param[in] h the current hash value
+ * \param[in] data the hashed data
+ * \return the updated hash value */
+code_cache::key_t fnv1a(code_cache::key_t h, std::string_view data)
+{
+    for (unsigned char c: data) {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+} // namespace
+
+/*** code_cache **************************************************************/
+
+code_cache::key_t code_cache::key(std::string_view src,
+                                  std::string_view syntax)
+{
+    std::string params;
+    put_uint(params, format_version);
+    put_string(params, version);
+    put_uint(params, sizeof(config::value_int_type));
+    put_uint(params, sizeof(config::value_unsigned_type));
+    put_string(params, syntax);
+    return fnv1a(fnv1a(0xcbf29ce484222325ULL, params), src);
+}
+
+bool code_cache::load(script_builder& builder, std::string_view data,
+                      key_t key, std::string_view file)
+{
+    if (!data.starts_with(magic))
+        return false;
+    reader r{data.substr(magic.size())};
+    if (r.get_uint() != format_version || r.get_uint() != key)
+        return false;
+    auto roots = r.get_uint();
+    if (!roots || *roots > 1)
+        return false;
+    builder.create_script(file);
+    if (*roots == 1 && !r.node(builder, {}))
+        return false;
+    return r.empty();
+}
+
+std::string code_cache::path(std::string_view dir, key_t key)
+{
+    std::ostringstream name;
+    name << std::hex;
+    name.width(2 * sizeof(key));
+    name.fill('0');
+    name << key << file_suffix;
+    return (std::filesystem::path(dir) / name.str()).string();
+}
+
+void code_cache::put_header(std::string& out, key_t key)
+{
+    out.append(magic);
+    put_uint(out, format_version);
+    put_uint(out, key);
+}
+
+void code_cache::put_int(std::string& out, int64_t v)
+{
+    // zigzag encoding, small negative numbers are stored in a few bytes
+    put_uint(out, (uint64_t(v) << 1) ^ uint64_t(v >> 63));
+}
+
+void code_cache::put_string(std::string& out, std::string_view v)
+{
+    put_uint(out, v.size());
+    out.append(v);
+}
+
+void code_cache::put_uint(std::string& out, uint64_t v)
+{
+    for (; v >= 0x80U; v >>= 7)
+        out.push_back(char((v & 0x7fU) | 0x80U));
+    out.push_back(char(v));
+}
+
+std::optional<std::string> code_cache::read_cache(std::string_view file)
+    noexcept
+{
+    try {
+        std::ifstream is{std::string{file}, std::ios::binary};
+        if (!is)
+            return std::nullopt;
+        std::string data;
+        is.seekg(0, std::ios::end);
+        auto sz = is.tellg();
+        if (sz < 0)
+            return std::nullopt;
+        data.resize(size_t(sz));
+        is.seekg(0);
+        if (!is.read(data.data(), sz))
+            return std::nullopt;
+        return data;
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
+bool code_cache::write_cache(std::string_view file, std::string_view data)
+    noexcept
+{
+    try {
+        std::filesystem::path path{file};
+        std::error_code ec;
+        if (path.has_parent_path())
+            std::filesystem::create_directories(path.parent_path(), ec);
+        // A unique temporary name, concurrent writers do not interfere
+        auto tmp = path;
+        tmp += ".tmp" + std::to_string(std::random_device{}());
+        {
+            std::ofstream os{tmp, std::ios::binary | std::ios::trunc};
+            if (!os.write(data.data(), std::streamsize(data.size())) ||
+                !os.flush())
+            {
+                os.close();
+                std::filesystem::remove(tmp, ec);
+                return false;
+            }
+        }
+        std::filesystem::rename(tmp, path, ec);
+        if (ec) {
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+} // namespace threadscript
@@ -0,0 +1,142 @@
+/*! \file
+ * \brief The implementation part of green.hpp
+ */
+
+#include "threadscript/green.hpp"
+
+#include <boost/context/protected_fixedsize_stack.hpp>
+
+#include <algorithm>
+#include <functional>
+
+namespace threadscript::impl {
+
+/*** green_thread ************************************************************/
+
+class green_thread::stack_allocator {
+public:
+    stack_allocator(size_t stack_size, const char*& limit):
+        stack(stack_size), limit(limit) {}
+    boost::context::stack_context allocate() {
+        auto sctx = stack.allocate();
+        // The stack grows down from sctx.sp
+        auto bottom = static_cast<const char*>(sctx.sp) - sctx.size;
+        limit = bottom + std::min(stack_reserve, sctx.size / 2);
+        return sctx;
+    }
+    void deallocate(boost::context::stack_context& sctx) noexcept {
+        stack.deallocate(sctx);
+    }
+private:
+    boost::context::protected_fixedsize_stack stack;
+    const char*& limit;
+};
+
+thread_local green_thread* green_thread::_current = nullptr;
+
+green_thread::green_thread(size_t stack_size):
+    fib(std::allocator_arg, stack_allocator(stack_size, stack_limit),
+        [this](boost::context::fiber&& s) {
+            sched = std::move(s);
+            body();
+            return std::move(sched);
+        })
+{
+}
+
+bool green_thread::park(std::shared_ptr<green_thread> self)
+{
+    assert(self.get() == this);
+    this->self = std::move(self);
+    auto s = state_t::running;
+    if (state.compare_exchange_strong(s, state_t::parked))
+        return true;
+    // wake() has been called, it is runnable again
+    assert(s == state_t::woken);
+    state = state_t::running;
+    this->self.reset();
+    return false;
+}
+
+bool green_thread::resume()
+{
+    assert(fib);
+    assert(!_current);
+    _current = this;
+    fib = std::move(fib).resume();
+    _current = nullptr;
+    return !fib;
+}
+
+bool green_thread::stack_exhausted() noexcept
+{
+    auto here = static_cast<const char*>(__builtin_frame_address(0));
+    return _current && std::less<const char*>{}(here, _current->stack_limit);
+}
+
+void green_thread::suspend(const std::optional<clock::time_point>& deadline)
+{
+    assert(_current == this);
+    _deadline = deadline;
+    ++_suspends;
+    sched = std::move(sched).resume();
+}
+
+void green_thread::wake()
+{
+    if (state.exchange(state_t::woken) == state_t::parked) {
+        state = state_t::running;
+        schedule(std::move(self));
+    }
+}
+
+/*** green_cond **************************************************************/
+
+void green_cond::notify_all()
+{
+    cond.notify_all();
+    std::lock_guard lck{mtx};
+    for (auto g: waiters)
+        g->wake();
+    waiters.clear();
+}
+
+void green_cond::notify_one()
+{
+    cond.notify_one();
+    std::lock_guard lck{mtx};
+    if (!waiters.empty()) {
+        waiters.front()->wake();
+        waiters.erase(waiters.begin());
+    }
+}
+
+void green_cond::suspend(green_thread& g, std::unique_lock<std::mutex>& lck,
+                         const std::optional<clock::time_point>& deadline)
+{
+    {
+        std::lock_guard l{mtx};
+        waiters.push_back(&g);
+    }
+    // A notification after unlocking and before suspending is not lost,
+    // because then g.suspend() returns immediately
+    lck.unlock();
+    g.suspend(deadline);
+    {
+        std::lock_guard l{mtx};
+        if (auto it = std::ranges::find(waiters, &g); it != waiters.end())
+            waiters.erase(it);
+    }
+    lck.lock();
+}
+
+void green_cond::wait_for(std::unique_lock<std::mutex>& lck,
+                          clock::duration timeout)
+{
+    if (auto g = green_thread::current())
+        suspend(*g, lck, clock::now() + timeout);
+    else
+        cond.wait_for(lck, timeout);
+}
+
+} // namespace threadscript::impl
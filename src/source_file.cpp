@@ -0,0 +1,83 @@
+/*! \file
+ * \brief The implementation part of threadscript/source_file.hpp
+ */
+
+#include "threadscript/source_file.hpp"
+
+#include <fstream>
+#include <sstream>
+
+#if __has_include(<sys/mman.h>)
+//! Whether source files can be mapped into memory
+#define THREADSCRIPT_SOURCE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+//! Whether source files can be mapped into memory
+#define THREADSCRIPT_SOURCE_MMAP 0
+#endif
+
+namespace threadscript {
+
+/*** source_file *************************************************************/
+
+source_file::source_file(std::string_view file)
+{
+#if THREADSCRIPT_SOURCE_MMAP
+    // Any failure falls back to reading, which reports errors
+    if (int fd = ::open(std::string{file}.c_str(), O_RDONLY | O_CLOEXEC);
+        fd >= 0)
+    {
+        struct stat st{};
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            auto size = size_t(st.st_size);
+            void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                // A parser reads the source sequentially
+                madvise(p, size, MADV_SEQUENTIAL);
+                _map = p;
+                _view = {static_cast<const char*>(p), size};
+            }
+        }
+        close(fd);
+        if (_map)
+            return;
+    }
+#endif
+    std::ifstream is{std::string{file}, std::ios::binary};
+    _data = read(is);
+    _view = _data;
+}
+
+source_file::~source_file()
+{
+#if THREADSCRIPT_SOURCE_MMAP
+    if (_map)
+        munmap(_map, _view.size());
+#endif
+}
+
+std::string source_file::read(std::istream& is)
+{
+    is.exceptions(std::ifstream::failbit); // throw if open failed
+    is.exceptions(std::ifstream::goodbit); // do not throw on empty file
+    if (auto begin = is.tellg(); begin != std::istream::pos_type(-1)) {
+        is.seekg(0, std::ios::end);
+        auto end = is.tellg();
+        is.seekg(begin);
+        if (is && end >= begin) {
+            std::string data(size_t(end - begin), '\0');
+            is.read(data.data(), std::streamsize(data.size()));
+            data.resize(size_t(is.gcount()));
+            return data;
+        }
+        is.clear();
+    }
+    std::stringbuf sb;
+    is >> &sb; // read file, C++ streams cannot report errors here
+    return std::move(sb).str();
+}
+
+} // namespace threadscript
@@ -4,10 +4,9 @@
 
 #include "threadscript/syntax.hpp"
 #include "threadscript/code_builder.hpp"
+#include "threadscript/source_file.hpp"
 #include "threadscript/syntax_canon.hpp"
 
-#include <fstream>
-
 namespace threadscript {
 
 /*** syntax_base *************************************************************/
@@ -25,19 +24,15 @@ void syntax_base::parse_stream(script_builder& builder, std::istream& is,
                                std::string_view file,
                                parser::context::trace_t trace)
 {
-    is.exceptions(std::ifstream::failbit); // throw if open failed
-    is.exceptions(std::ifstream::goodbit); // do not throw on empty file
-    std::stringbuf sb;
-    is >> &sb; // read file, C++ streams cannot report errors here
-    std::string src = std::move(sb).str();
+    std::string src = source_file::read(is);
     parse(builder, src, file, std::move(trace));
 }
 
 void syntax_base::parse_file(script_builder& builder, std::string_view file,
                              parser::context::trace_t trace)
 {
-    std::ifstream is{std::string{file}};
-    parse_stream(builder, is, file, std::move(trace));
+    source_file src{file};
+    parse(builder, src.view(), file, std::move(trace));
 }
 
 /*** syntax_factory **********************************************************/
@@ -329,9 +329,356 @@ void canon::rules::hnd_unsigned(parser::context&, tmp_ctx& self, tmp_ctx*,
     throw parser::error<iterator_type>(begin, "Invalid number");
 }
 
+/*** canon::fast_parser *****************************************************/
+
+namespace {
+
+//! A script builder that discards everything
+/*! It is used when the input is parsed again only in order to get an error
+ * message. */
+class null_builder final: public script_builder {
+public:
+    void create_script(std::string_view) override {}
+    node_handle add_node(const node_handle&, const file_location&,
+                         std::string_view, const value_handle&) override
+    {
+        return {};
+    }
+    value_handle create_value_bool(bool) override {
+        return {};
+    }
+    value_handle create_value_int(config::value_int_type) override {
+        return {};
+    }
+    value_handle create_value_unsigned(config::value_unsigned_type) override {
+        return {};
+    }
+    value_handle create_value_string(std::string_view) override {
+        return {};
+    }
+};
+
+//! Tests if a character is a decimal digit.
+/*! \param[in] c a character
+ * \return whether \a c is a decimal digit */
+bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+//! Tests if a character is a hexadecimal digit.
+/*! \copydetails is_digit()
+ * \return whether \a c is a hexadecimal digit */
+bool is_hex(char c)
+{
+    return is_digit(c) || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f');
+}
+
+//! Tests if a character can start an identifier.
+/*! \copydetails is_digit()
+ * \return whether \a c is a letter or an underscore */
+bool is_id_begin(char c)
+{
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_';
+}
+
+//! Tests if a character is a printable ASCII character.
+/*! \copydetails is_digit()
+ * \return whether \a c has code between 32 and 126, inclusive */
+bool is_print(char c)
+{
+    return c >= 32 && c <= 126;
+}
+
+} // namespace
+
+//! A hand-written recursive descent parser of the canonical syntax
+/*! It accepts exactly the language defined by canon::rules and it calls the
+ * script builder in the same way as handlers of the rules. It does not report
+ * details of syntax errors, it only stops at the first error. The input is
+ * then parsed again by the rules in order to get the error message. */
+class canon::fast_parser {
+public:
+    //! Creates the parser.
+    /*! \param[in] builder the script builder
+     * \param[in] src the source code */
+    fast_parser(script_builder& builder, std::string_view src):
+        builder(builder), src(src), p(src.begin()), line_begin(src.begin()) {}
+    //! Parses the whole input.
+    /*! \return \c true if successful, \c false if a syntax error has been
+     * found */
+    bool script() {
+        spaces();
+        if (!node({}))
+            return false;
+        spaces();
+        return p == src.end();
+    }
+    //! Gets the position of the parser.
+    /*! \return the current position, used in an error message */
+    [[nodiscard]] iterator_type pos() const {
+        return iterator_type(p, line, column());
+    }
+private:
+    //! Gets the current column number.
+    /*! \return the column number of the current position */
+    [[nodiscard]] size_t column() const {
+        return size_t(p - line_begin) + 1;
+    }
+    //! Gets the current location.
+    /*! \return the location of the current position */
+    [[nodiscard]] file_location location() const {
+        return file_location(unsigned(line), unsigned(column()));
+    }
+    //! Tests if the current character is \a c.
+    /*! \param[in] c a character
+     * \return whether the input continues with \a c */
+    [[nodiscard]] bool next_is(char c) const {
+        return p != src.end() && *p == c;
+    }
+    //! Skips whitespace and comments (rule \c space).
+    void spaces();
+    //! Parses a node and adds it to the script (rule \c node).
+    /*! \param[in] parent the parent node
+     * \return whether successful */
+    bool node(const script_builder::node_handle& parent);
+    //! Parses an unsigned number (rule \c val_unsigned).
+    /*! \copydetails node() */
+    bool val_unsigned(const script_builder::node_handle& parent);
+    //! Parses a signed number (rule \c val_int).
+    /*! \copydetails node() */
+    bool val_int(const script_builder::node_handle& parent);
+    //! Parses a string (rule \c val_string).
+    /*! \copydetails node() */
+    bool val_string(const script_builder::node_handle& parent);
+    //! Parses a function call (rule \c node_fun).
+    /*! \copydetails node() */
+    bool node_fun(const script_builder::node_handle& parent);
+    //! Parses a sequence of decimal digits.
+    /*! \param[out] val the parsed value
+     * \return whether at least one digit was found and the value did not
+     * overflow */
+    bool digits(uintmax_t& val);
+    script_builder& builder; //!< The script builder
+    std::string_view src; //!< The source code
+    std::string_view::iterator p; //!< The current position
+    std::string_view::iterator line_begin; //!< The beginning of the line
+    size_t line = 1; //!< The current line number
+    //! A buffer for strings containing escape sequences
+    std::string str;
+};
+
+bool canon::fast_parser::digits(uintmax_t& val)
+{
+    auto begin = p;
+    val = 0;
+    bool ok = true;
+    for (; p != src.end() && is_digit(*p); ++p) {
+        uintmax_t d = *p - '0';
+        if (val > (std::numeric_limits<uintmax_t>::max() - d) / 10)
+            ok = false;
+        val = 10 * val + d;
+    }
+    return ok && p != begin;
+}
+
+bool canon::fast_parser::node(const script_builder::node_handle& parent)
+{
+    if (p == src.end())
+        return false;
+    auto rest = std::string_view(p, src.end());
+    if (rest.starts_with("null"sv)) {
+        builder.add_node(parent, location(), ""sv,
+                         script_builder::create_value_null());
+        p += 4;
+        return true;
+    }
+    if (rest.starts_with("false"sv)) {
+        builder.add_node(parent, location(), ""sv,
+                         builder.create_value_bool(false));
+        p += 5;
+        return true;
+    }
+    if (rest.starts_with("true"sv)) {
+        builder.add_node(parent, location(), ""sv,
+                         builder.create_value_bool(true));
+        p += 4;
+        return true;
+    }
+    if (is_digit(*p))
+        return val_unsigned(parent);
+    if (*p == '+' || *p == '-')
+        return val_int(parent);
+    if (*p == '"')
+        return val_string(parent);
+    if (is_id_begin(*p))
+        return node_fun(parent);
+    return false;
+}
+
+bool canon::fast_parser::node_fun(const script_builder::node_handle& parent)
+{
+    auto loc = location();
+    auto begin = p;
+    for (++p; p != src.end() && (is_id_begin(*p) || is_digit(*p)); ++p)
+        ;
+    auto name = std::string_view(begin, p);
+    spaces();
+    if (!next_is('('))
+        return false;
+    ++p;
+    auto n = builder.add_node(parent, loc, name);
+    spaces();
+    if (next_is(')')) {
+        ++p;
+        return true;
+    }
+    for (;;) {
+        if (!node(n))
+            return false;
+        spaces();
+        if (next_is(')')) {
+            ++p;
+            return true;
+        }
+        if (!next_is(','))
+            return false;
+        ++p;
+        spaces();
+    }
+}
+
+void canon::fast_parser::spaces()
+{
+    while (p != src.end()) {
+        switch (*p) {
+        case '\n':
+            line_begin = ++p;
+            ++line;
+            break;
+        case ' ':
+        case '\t':
+            ++p;
+            break;
+        case '#': {
+            auto e = p + 1;
+            while (e != src.end() && is_print(*e))
+                ++e;
+            if (e == src.end())
+                p = e;
+            else if (*e == '\n') {
+                line_begin = p = e + 1;
+                ++line;
+            } else
+                return; // invalid comment, reported by the rules
+            break;
+        }
+        default:
+            return;
+        }
+    }
+}
+
+bool canon::fast_parser::val_int(const script_builder::node_handle& parent)
+{
+    using limits = std::numeric_limits<config::value_int_type>;
+    auto loc = location();
+    bool neg = *p++ == '-';
+    uintmax_t val = 0;
+    if (!digits(val))
+        return false;
+    if (neg) {
+        if (val > uintmax_t(limits::max()) + 1)
+            return false;
+        builder.add_node(parent, loc, ""sv, builder.create_value_int(
+            val == 0 ? 0 : -config::value_int_type(val - 1) - 1));
+    } else {
+        if (val > uintmax_t(limits::max()))
+            return false;
+        builder.add_node(parent, loc, ""sv,
+                         builder.create_value_int(config::value_int_type(val)));
+    }
+    return true;
+}
+
+bool canon::fast_parser::val_string(const script_builder::node_handle& parent)
+{
+    ++p;
+    auto loc = location();
+    auto begin = p;
+    // A string without escape sequences is passed without copying
+    while (p != src.end() && rules::is_lit_char(*p))
+        ++p;
+    if (next_is('"')) {
+        builder.add_node(parent, loc, ""sv,
+            builder.create_value_string(std::string_view(begin, p)));
+        ++p;
+        return true;
+    }
+    str.assign(begin, p);
+    while (p != src.end()) {
+        char c = *p++;
+        if (rules::is_lit_char(c)) {
+            str.push_back(c);
+            continue;
+        }
+        if (c == '"') {
+            builder.add_node(parent, loc, ""sv,
+                             builder.create_value_string(str));
+            return true;
+        }
+        if (c != '\\' || p == src.end())
+            return false;
+        switch (c = *p++) {
+        case '0':
+            str.push_back('\0');
+            break;
+        case 't':
+            str.push_back('\t');
+            break;
+        case 'n':
+            str.push_back('\n');
+            break;
+        case 'r':
+            str.push_back('\r');
+            break;
+        case '"':
+        case '\\':
+            str.push_back(c);
+            break;
+        case 'x':
+        case 'X':
+            if (src.end() - p < 2 || !is_hex(p[0]) ||
+                !is_hex(p[1]))
+            {
+                return false;
+            }
+            str.push_back(char(16 * parser_ascii::hex_to_int(p[0]) +
+                               parser_ascii::hex_to_int(p[1])));
+            p += 2;
+            break;
+        default:
+            return false;
+        }
+    }
+    return false;
+}
+
+bool canon::fast_parser::val_unsigned(const script_builder::node_handle& parent)
+{
+    using limits = std::numeric_limits<config::value_unsigned_type>;
+    auto loc = location();
+    uintmax_t val = 0;
+    if (!digits(val) || val > limits::max())
+        return false;
+    builder.add_node(parent, loc, ""sv, builder.create_value_unsigned(
+                                            config::value_unsigned_type(val)));
+    return true;
+}
+
 /*** canon *******************************************************************/
 
-canon::canon(): _rules(std::make_unique<rules>())
+canon::canon(bool fast): fast(fast)
 {
 }
 
@@ -340,6 +687,24 @@ canon::~canon() = default;
 void canon::run_parser(script_builder& builder, std::string_view src,
                        parser::context::trace_t trace)
 {
+    if (!fast || trace) {
+        run_rules(builder, src, std::move(trace));
+        return;
+    }
+    fast_parser fp(builder, src);
+    if (fp.script())
+        return;
+    // The rules report the same error as if they were used from the start
+    null_builder nb;
+    run_rules(nb, src, {});
+    throw parser::error(fp.pos());
+}
+
+void canon::run_rules(script_builder& builder, std::string_view src,
+                      parser::context::trace_t trace)
+{
+    if (!_rules)
+        _rules = std::make_unique<rules>();
     rules::tmp_ctx root_ctx(builder);
     parser::context ctx;
     ctx.trace = std::move(trace);
@@ -3,13 +3,25 @@
  */
 
 #include "threadscript/threadscript.hpp"
+#include "threadscript/atomic_impl.hpp"
+#include "threadscript/bytes_impl.hpp"
 #include "threadscript/channel_impl.hpp"
+#include "threadscript/code_cache_impl.hpp"
 #include "threadscript/code_impl.hpp"
 #include "threadscript/code_parser_impl.hpp"
+#include "threadscript/future_impl.hpp"
+#include "threadscript/host_view_impl.hpp"
+#include "threadscript/module_impl.hpp"
+#include "threadscript/parse_files_impl.hpp"
 #include "threadscript/predef_impl.hpp"
+#include "threadscript/reload_impl.hpp"
 #include "threadscript/shared_hash_impl.hpp"
 #include "threadscript/shared_vector_impl.hpp"
+#include "threadscript/state_pool_impl.hpp"
+#include "threadscript/string_builder_impl.hpp"
 #include "threadscript/symbol_table_impl.hpp"
+#include "threadscript/sync_impl.hpp"
+#include "threadscript/task_pool_impl.hpp"
 #include "threadscript/virtual_machine_impl.hpp"
 #include "threadscript/vm_data_impl.hpp"
 
@@ -20,6 +32,18 @@ namespace threadscript {
 // primary templates and keep groups lexicographically ordered by file name.
 // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 
+/*** threadscript/atomic.hpp *************************************************/
+
+template class basic_value_object<basic_atomic<allocator_any>,
+    threadscript::impl::name_atomic, allocator_any>;
+template class basic_atomic<allocator_any>;
+
+/*** threadscript/bytes.hpp **************************************************/
+
+template class basic_value_object<basic_bytes<allocator_any>,
+    threadscript::impl::name_bytes, allocator_any>;
+template class basic_bytes<allocator_any>;
+
 /*** threadscript/channel.hpp ************************************************/
 
 template class basic_value_object<basic_channel<allocator_any>,
@@ -57,6 +81,22 @@ template class basic_value_script<allocator_any>;
 
 template class basic_script_builder_impl<allocator_any>;
 
+/*** threadscript/code_cache.hpp *********************************************/
+
+template class impl::script_writer<allocator_any>;
+
+template script::script_ptr
+deserialize_script<allocator_any>(const allocator_any& alloc,
+                                  std::string_view data, code_cache::key_t key,
+                                  std::string_view file);
+
+template script::script_ptr
+parse_code_file_cached<allocator_any>(const allocator_any& alloc,
+                                      std::string_view file,
+                                      std::string_view cache_dir,
+                                      std::string_view syntax,
+                                      parser::context::trace_t trace);
+
 /*** threadscript/code_parser_impl.hpp ***************************************/
 
 template script::script_ptr
@@ -74,6 +114,34 @@ parse_code_file<allocator_any>(const allocator_any& alloc,
                                std::string_view file, std::string_view syntax,
                                parser::context::trace_t trace);
 
+/*** threadscript/future.hpp *************************************************/
+
+template class basic_value_object<basic_future<allocator_any>,
+    threadscript::impl::name_future, allocator_any>;
+template class basic_future<allocator_any>;
+
+/*** threadscript/host_view.hpp **********************************************/
+
+template class basic_value_object<basic_host_view<allocator_any>,
+    threadscript::impl::name_host_view, allocator_any>;
+template class basic_host_view<allocator_any>;
+
+/*** threadscript/module.hpp *************************************************/
+
+template class basic_module_registry<allocator_any>;
+
+/*** threadscript/native_binding.hpp *****************************************/
+
+template class basic_lazy_arg<allocator_any>;
+
+/*** threadscript/parse_files.hpp ********************************************/
+
+template std::vector<parsed_file>
+parse_code_files<allocator_any>(basic_virtual_machine<allocator_any>& vm,
+                                std::span<const std::string> files,
+                                std::string_view syntax,
+                                std::string_view cache_dir);
+
 /*** threadscript/predef.hpp *************************************************/
 
 template std::shared_ptr<basic_symbol_table<allocator_any>>
@@ -98,21 +166,28 @@ template class f_at<allocator_any>;
 template class f_bool<allocator_any>;
 template class f_clone<allocator_any>;
 template class f_contains<allocator_any>;
+template class f_count<allocator_any>;
 template class f_div<allocator_any>;
+template class f_dot<allocator_any>;
 template class f_eq<allocator_any>;
 template class f_erase<allocator_any>;
+template class f_find<allocator_any>;
 template class f_fun<allocator_any>;
 template class f_ge<allocator_any>;
 template class f_gt<allocator_any>;
 template class f_gvar<allocator_any>;
 template class f_hash<allocator_any>;
 template class f_if<allocator_any>;
+template class f_import<allocator_any>;
 template class f_int<allocator_any>;
+template class f_int_vector<allocator_any>;
 template class f_is_mt_safe<allocator_any>;
 template class f_is_null<allocator_any>;
 template class f_keys<allocator_any>;
 template class f_le<allocator_any>;
 template class f_lt<allocator_any>;
+template class f_max<allocator_any>;
+template class f_min<allocator_any>;
 template class f_mod<allocator_any>;
 template class f_mt_safe<allocator_any>;
 template class f_mul<allocator_any>;
@@ -120,22 +195,34 @@ template class f_ne<allocator_any>;
 template class f_not<allocator_any>;
 template class f_or<allocator_any>;
 template class f_or_r<allocator_any>;
+template class f_par_for<allocator_any>;
+template class f_par_map<allocator_any>;
+template class f_par_reduce<allocator_any>;
 template class f_print<allocator_any>;
 template class f_is_same<allocator_any>;
+template class f_select<allocator_any>;
 template class f_seq<allocator_any>;
 template class f_size<allocator_any>;
+template class f_spawn<allocator_any>;
 template class f_sub<allocator_any>;
 template class f_substr<allocator_any>;
+template class f_sum<allocator_any>;
 template class f_throw<allocator_any>;
 template class f_try<allocator_any>;
 template class f_type<allocator_any>;
 template class f_unsigned<allocator_any>;
+template class f_unsigned_vector<allocator_any>;
+template class f_update_sh_vars<allocator_any>;
 template class f_var<allocator_any>;
 template class f_vector<allocator_any>;
 template class f_while<allocator_any>;
 
 } // namespace predef
 
+/*** threadscript/reload.hpp *************************************************/
+
+template class basic_reloader<allocator_any>;
+
 /*** threadscript/shared_hash.hpp ******************************************/
 
 template class basic_value_object<basic_shared_hash<allocator_any>,
@@ -148,10 +235,39 @@ template class basic_value_object<basic_shared_vector<allocator_any>,
     threadscript::impl::name_shared_vector, allocator_any>;
 template class basic_shared_vector<allocator_any>;
 
+/*** threadscript/state_pool.hpp *********************************************/
+
+template class basic_state_pool<allocator_any>;
+
+/*** threadscript/string_builder.hpp *****************************************/
+
+template class basic_value_object<basic_string_builder<allocator_any>,
+    threadscript::impl::name_string_builder, allocator_any>;
+template class basic_string_builder<allocator_any>;
+
 /*** threadscript/symbol_table.hpp *******************************************/
 
 template class basic_symbol_table<allocator_any>;
 
+/*** threadscript/sync.hpp ***************************************************/
+
+template class basic_value_object<basic_barrier<allocator_any>,
+    threadscript::impl::name_barrier, allocator_any>;
+template class basic_barrier<allocator_any>;
+template class basic_value_object<basic_latch<allocator_any>,
+    threadscript::impl::name_latch, allocator_any>;
+template class basic_latch<allocator_any>;
+template class basic_value_object<basic_mutex<allocator_any>,
+    threadscript::impl::name_mutex, allocator_any>;
+template class basic_mutex<allocator_any>;
+template class basic_value_object<basic_semaphore<allocator_any>,
+    threadscript::impl::name_semaphore, allocator_any>;
+template class basic_semaphore<allocator_any>;
+
+/*** threadscript/task_pool.hpp **********************************************/
+
+template class basic_task_pool<allocator_any>;
+
 /*** threadscript/virtual_machine.hpp ****************************************/
 
 template class basic_virtual_machine<allocator_any>;
@@ -189,4 +305,14 @@ template class basic_typed_value<value_hash,
     threadscript::impl::name_value_hash, allocator_any>;
 template class basic_value_hash<allocator_any>;
 
+template class basic_typed_value<value_int_vector,
+    a_basic_vector<config::value_int_type, allocator_any>,
+    threadscript::impl::name_value_int_vector, allocator_any>;
+template class basic_value_int_vector<allocator_any>;
+
+template class basic_typed_value<value_unsigned_vector,
+    a_basic_vector<config::value_unsigned_type, allocator_any>,
+    threadscript::impl::name_value_unsigned_vector, allocator_any>;
+template class basic_value_unsigned_vector<allocator_any>;
+
 } // namespace threadscript
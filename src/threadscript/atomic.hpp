@@ -0,0 +1,208 @@
+#pragma once
+
+/*! \file
+ * \brief An atomic integer for sharing counters and flags among threads.
+ */
+
+#include "threadscript/vm_data.hpp"
+
+#include <atomic>
+
+namespace threadscript {
+
+template <impl::allocator A> class basic_atomic;
+
+namespace impl {
+//! The name of atomic
+inline constexpr char name_atomic[] = "atomic";
+//! The base class of basic_atomic
+/*! \tparam A an allocator type */
+template <allocator A> using basic_atomic_base =
+    basic_value_object<basic_atomic<A>, name_atomic, A>;
+} // namespace impl
+
+//! A thread-safe atomic integer class
+/*! An object of this class holds a single integer value of type \c int or \c
+ * unsigned, selected by the type of the initial value passed to the
+ * constructor. The value can be read and modified by multiple threads
+ * simultaneously. Unlike basic_shared_vector and basic_shared_hash, this class
+ * does not use a mutex. All operations are implemented by \c std::atomic, and
+ * they are lock-free if \c std::atomic is lock-free for the value type.
+ *
+ * All methods taking a value argument require the argument to have the same
+ * type as the stored value, otherwise exception::value_type is thrown.
+ * Arithmetic follows the rules of predef::f_add and predef::f_sub, that is,
+ * modulo arithmetic is used for \c unsigned and overflow is checked for \c
+ * int. If an \c int operation overflows, the stored value is not changed.
+ *
+ * Methods:
+ * \snippet atomic_impl.hpp methods
+ * \tparam A an allocator type
+ * \threadsafe{safe,safe}
+ * \test in file test_atomic.cpp */
+template <impl::allocator A>
+class basic_atomic final: public impl::basic_atomic_base<A> {
+public:
+    //! Creates the atomic object.
+    /*! It marks the object mt-safe.
+     * \param[in] t an ignored parameter that prevents using this
+     * \param[in] methods the mapping from method names to implementations
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with constructor arguments:
+     *     \arg \c value the initial value, of type \c int or \c unsigned; it
+     *     also selects the type of the stored value
+     * \throw exception::op_narg if the number of arguments is not 1
+     * \throw exception::value_null if \a value is \c null
+     * \throw exception::value_type if \a value does not have type \c int or
+     * \c unsigned */
+    basic_atomic(typename basic_atomic::tag t,
+        std::shared_ptr<const typename basic_atomic::method_table> methods,
+        typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node);
+    //! \copydoc basic_value_object::init_methods()
+    [[nodiscard]] static
+    typename basic_atomic::method_table init_methods();
+private:
+    //! Atomically adds a value.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c value the value to be added
+     * \return the old value
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 2
+     * \throw exception::value_null if \a value is \c null
+     * \throw exception::value_type if \a value has a different type than the
+     * stored value
+     * \throw exception::op_overflow if the stored value has type \c int and
+     * overflow occurs */
+    typename basic_atomic::value_ptr
+    add(typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node);
+    //! Atomically compares and sets the value.
+    /*! If the stored value is equal to \a expected, it is replaced by \a
+     * desired.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c expected the expected stored value
+     *     \arg \c desired the new value
+     * \return \c true if the value has been replaced, \c false otherwise
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 3
+     * \throw exception::value_null if \a expected or \a desired is \c null
+     * \throw exception::value_type if \a expected or \a desired has
+     * a different type than the stored value */
+    typename basic_atomic::value_ptr
+    cas(typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node);
+    //! Atomically replaces the value.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c value the new value
+     * \return the old value
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 2
+     * \throw exception::value_null if \a value is \c null
+     * \throw exception::value_type if \a value has a different type than the
+     * stored value */
+    typename basic_atomic::value_ptr
+    exchange(typename threadscript::basic_state<A>& thread,
+             typename threadscript::basic_symbol_table<A>& l_vars,
+             const typename threadscript::basic_code_node<A>& node);
+    //! Atomically reads the value.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     * \return the stored value
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 1 */
+    typename basic_atomic::value_ptr
+    load(typename threadscript::basic_state<A>& thread,
+         typename threadscript::basic_symbol_table<A>& l_vars,
+         const typename threadscript::basic_code_node<A>& node);
+    //! Atomically writes the value.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c value the new value
+     * \return \c null
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 2
+     * \throw exception::value_null if \a value is \c null
+     * \throw exception::value_type if \a value has a different type than the
+     * stored value */
+    typename basic_atomic::value_ptr
+    store(typename threadscript::basic_state<A>& thread,
+          typename threadscript::basic_symbol_table<A>& l_vars,
+          const typename threadscript::basic_code_node<A>& node);
+    //! Atomically subtracts a value.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c value the value to be subtracted
+     * \return the old value
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 2
+     * \throw exception::value_null if \a value is \c null
+     * \throw exception::value_type if \a value has a different type than the
+     * stored value
+     * \throw exception::op_overflow if the stored value has type \c int and
+     * overflow occurs */
+    typename basic_atomic::value_ptr
+    sub(typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node);
+    //! Evaluates an argument and calls a function with the stored value.
+    /*! It selects either \ref value_int or \ref value_unsigned, according to
+     * the type of the stored value, and checks that the argument has the same
+     * type.
+     * \tparam F a function type
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments
+     * \param[in] idx the (zero-based) index of the argument
+     * \param[in] f a function called with two arguments: a reference to the
+     * selected \c std::atomic and the argument value converted to the
+     * corresponding C++ type
+     * \return the value returned by \a f
+     * \throw exception::value_null if the argument is \c null
+     * \throw exception::value_type if the argument has a different type than
+     * the stored value */
+    template <class F> typename basic_atomic::value_ptr
+    visit_arg(typename threadscript::basic_state<A>& thread,
+              typename threadscript::basic_symbol_table<A>& l_vars,
+              const typename threadscript::basic_code_node<A>& node,
+              size_t idx, F&& f);
+    //! Creates a script value from a C++ value.
+    /*! \param[in] thread the current thread
+     * \param[in] v a value
+     * \return a value of type \c int or \c unsigned, according to the type of
+     * \a v */
+    static typename basic_atomic::value_ptr
+    make_value(typename threadscript::basic_state<A>& thread,
+               config::value_int_type v);
+    //! \copydoc make_value(basic_state<A>&, config::value_int_type)
+    static typename basic_atomic::value_ptr
+    make_value(typename threadscript::basic_state<A>& thread,
+               config::value_unsigned_type v);
+    //! The stored value, used if the stored value has type \c int
+    std::atomic<config::value_int_type> value_int{0};
+    //! The stored value, used if the stored value has type \c unsigned
+    std::atomic<config::value_unsigned_type> value_unsigned{0};
+    //! Whether the type of the stored value is \c int or \c unsigned
+    bool is_int = false;
+};
+
+} // namespace threadscript
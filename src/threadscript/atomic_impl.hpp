@@ -0,0 +1,191 @@
+#pragma once
+
+/*! \file
+ * \brief The implementation part of atomic.hpp
+ */
+
+#include "threadscript/atomic.hpp"
+#include "threadscript/predef.hpp"
+
+#include <type_traits>
+
+namespace threadscript {
+
+template <impl::allocator A>
+basic_atomic<A>::basic_atomic(
+        typename basic_atomic<A>::tag,
+        std::shared_ptr<const typename basic_atomic<A>::method_table>
+            methods,
+        typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node):
+    impl::basic_atomic_base<A>(typename basic_atomic::tag_args{}, methods,
+                               thread, l_vars, node)
+{
+    size_t narg = this->narg(node);
+    if (narg != 1)
+        throw exception::op_narg();
+    auto v = this->arg(thread, l_vars, node, 0);
+    if (!v)
+        throw exception::value_null();
+    if (auto pi = dynamic_cast<basic_value_int<A>*>(v.get())) {
+        value_int = pi->cvalue();
+        is_int = true;
+    } else if (auto pu = dynamic_cast<basic_value_unsigned<A>*>(v.get()))
+        value_unsigned = pu->cvalue();
+    else
+        throw exception::value_type();
+    this->set_mt_safe();
+}
+
+template <impl::allocator A> basic_atomic<A>::value_ptr
+basic_atomic<A>::add(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 2)
+        throw exception::op_narg();
+    return visit_arg(thread, l_vars, node, 1, [&thread](auto& a, auto d) {
+        auto old = a.load();
+        if constexpr (std::is_unsigned_v<decltype(d)>)
+            old = a.fetch_add(d);
+        else
+            while (!a.compare_exchange_weak(old, predef::f_add<A>::add(old, d)))
+                ;
+        return make_value(thread, old);
+    });
+}
+
+template <impl::allocator A> basic_atomic<A>::value_ptr
+basic_atomic<A>::cas(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 3)
+        throw exception::op_narg();
+    auto result = basic_value_bool<A>::create(thread.get_allocator());
+    visit_arg(thread, l_vars, node, 1, [&](auto&, auto expected) {
+        return visit_arg(thread, l_vars, node, 2,
+            [&result, e = expected](auto& a, auto desired) mutable {
+                // Both arguments always have the same type at runtime, but
+                // all combinations of types are instantiated.
+                if constexpr (std::is_same_v<decltype(e), decltype(desired)>)
+                    result->value() = a.compare_exchange_strong(e, desired);
+                return nullptr;
+            });
+    });
+    return result;
+}
+
+template <impl::allocator A> basic_atomic<A>::value_ptr
+basic_atomic<A>::exchange(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 2)
+        throw exception::op_narg();
+    return visit_arg(thread, l_vars, node, 1, [&thread](auto& a, auto v) {
+        return make_value(thread, a.exchange(v));
+    });
+}
+
+template <impl::allocator A> basic_atomic<A>::method_table
+basic_atomic<A>::init_methods()
+{
+    return {
+        //! [methods]
+        {"add", &basic_atomic::add},
+        {"cas", &basic_atomic::cas},
+        {"exchange", &basic_atomic::exchange},
+        {"load", &basic_atomic::load},
+        {"store", &basic_atomic::store},
+        {"sub", &basic_atomic::sub},
+        //! [methods]
+    };
+}
+
+template <impl::allocator A> basic_atomic<A>::value_ptr
+basic_atomic<A>::load(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>&,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 1)
+        throw exception::op_narg();
+    if (is_int)
+        return make_value(thread, value_int.load());
+    else
+        return make_value(thread, value_unsigned.load());
+}
+
+template <impl::allocator A> basic_atomic<A>::value_ptr
+basic_atomic<A>::make_value(typename threadscript::basic_state<A>& thread,
+                            config::value_int_type v)
+{
+    auto result = basic_value_int<A>::create(thread.get_allocator());
+    result->value() = v;
+    return result;
+}
+
+template <impl::allocator A> basic_atomic<A>::value_ptr
+basic_atomic<A>::make_value(typename threadscript::basic_state<A>& thread,
+                            config::value_unsigned_type v)
+{
+    auto result = basic_value_unsigned<A>::create(thread.get_allocator());
+    result->value() = v;
+    return result;
+}
+
+template <impl::allocator A> basic_atomic<A>::value_ptr
+basic_atomic<A>::store(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 2)
+        throw exception::op_narg();
+    return visit_arg(thread, l_vars, node, 1, [](auto& a, auto v) {
+        a.store(v);
+        return nullptr;
+    });
+}
+
+template <impl::allocator A> basic_atomic<A>::value_ptr
+basic_atomic<A>::sub(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 2)
+        throw exception::op_narg();
+    return visit_arg(thread, l_vars, node, 1, [&thread](auto& a, auto d) {
+        auto old = a.load();
+        if constexpr (std::is_unsigned_v<decltype(d)>)
+            old = a.fetch_sub(d);
+        else
+            while (!a.compare_exchange_weak(old, predef::f_sub<A>::sub(old, d)))
+                ;
+        return make_value(thread, old);
+    });
+}
+
+template <impl::allocator A> template <class F>
+basic_atomic<A>::value_ptr
+basic_atomic<A>::visit_arg(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node, size_t idx, F&& f)
+{
+    auto v = this->arg(thread, l_vars, node, idx);
+    if (!v)
+        throw exception::value_null();
+    if (is_int) {
+        auto pi = dynamic_cast<basic_value_int<A>*>(v.get());
+        if (!pi)
+            throw exception::value_type();
+        return f(value_int, pi->cvalue());
+    } else {
+        auto pu = dynamic_cast<basic_value_unsigned<A>*>(v.get());
+        if (!pu)
+            throw exception::value_type();
+        return f(value_unsigned, pu->cvalue());
+    }
+}
+
+} // namespace threadscript
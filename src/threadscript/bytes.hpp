@@ -0,0 +1,380 @@
+#pragma once
+
+/*! \file
+ * \brief A byte buffer for binary data, with slices sharing storage.
+ */
+
+#include "threadscript/vm_data.hpp"
+
+#include <span>
+#include <tuple>
+#include <utility>
+
+namespace threadscript {
+
+template <impl::allocator A> class basic_bytes;
+
+namespace impl {
+//! The name of bytes
+inline constexpr char name_bytes[] = "bytes";
+//! The base class of basic_bytes
+/*! \tparam A an allocator type */
+template <allocator A> using basic_bytes_base =
+    basic_value_object<basic_bytes<A>, name_bytes, A>;
+} // namespace impl
+
+//! A byte buffer class
+/*! An object of this class is a view of a contiguous range of bytes stored in
+ * a reference-counted buffer. Method slice() creates a new object sharing the
+ * buffer with the original object, so that no bytes are copied. A change of a
+ * byte is visible in all objects that share the byte.
+ *
+ * Methods append() and concat() grow the storage with amortized constant
+ * complexity per byte. If the object does not end at the end of its buffer,
+ * method append() first copies the object to a new buffer, in order not to
+ * overwrite bytes visible via other objects sharing the buffer.
+ *
+ * Integers are read and written by read_int(), read_unsigned(), and write(),
+ * using 1 to \c sizeof(config::value_unsigned_type) bytes in either big or
+ * little endian byte order. The byte order is selected by an optional
+ * argument \c endian, which can be \c "big" (the default) or \c "little".
+ *
+ * An object is thread-local by default. Marking it thread-safe by
+ * set_mt_safe() makes the whole buffer read-only, including other objects
+ * sharing the buffer. Then the object (and any slices created from it) can be
+ * shared among threads without copying the buffer.
+ *
+ * Methods:
+ * \snippet bytes_impl.hpp methods
+ * \tparam A an allocator type
+ * \threadsafe{safe,unsafe} if not marked thread-safe; \threadsafe{safe,safe}
+ * if marked thread-safe (then all methods modifying the object throw
+ * exception::value_read_only)
+ * \test in file test_bytes.cpp */
+template <impl::allocator A>
+class basic_bytes final: public impl::basic_bytes_base<A> {
+    //! The type of the shared storage
+    struct buffer {
+        //! Creates an empty buffer.
+        /*! \param[in] alloc the allocator used by \ref data */
+        explicit buffer(const A& alloc): data(alloc) {}
+        //! The stored bytes
+        a_basic_vector<unsigned char, A> data;
+        //! Whether \ref data must not be modified
+        /*! It is set by basic_bytes::set_mt_safe(). After that, it is only
+         * read, therefore it need not be atomic. */
+        bool read_only = false;
+    };
+public:
+    //! Creates the byte buffer.
+    /*! \param[in] t an ignored parameter that prevents using this
+     * \param[in] methods the mapping from method names to implementations
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with constructor arguments:
+     *     \arg \c init (optional) the initial contents; either a \c string,
+     *     whose characters are copied as bytes, or an \c int or \c unsigned
+     *     size of a buffer filled by zeros; if missing, the buffer is empty
+     * \throw exception::op_narg if the number of arguments is not 0 or 1
+     * \throw exception::value_null if \a init is \c null
+     * \throw exception::value_type if \a init does not have type \c string,
+     * \c int, or \c unsigned
+     * \throw exception::value_out_of_range if \a init is a negative number or
+     * greater than the maximum size of the buffer */
+    basic_bytes(typename basic_bytes::tag t,
+        std::shared_ptr<const typename basic_bytes::method_table> methods,
+        typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node);
+    //! Creates an object sharing a buffer.
+    /*! It is used by methods that create a new object, e.g., slice().
+     * \param[in] t an ignored parameter that prevents using this
+     * \param[in] methods the mapping from method names to implementations
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node of the method call that creates the
+     * object
+     * \param[in] storage the buffer; a new empty buffer is created if \c
+     * nullptr
+     * \param[in] first the index of the first byte of \a storage in this
+     * object
+     * \param[in] size the number of bytes of \a storage in this object */
+    basic_bytes(typename basic_bytes::tag t,
+        std::shared_ptr<const typename basic_bytes::method_table> methods,
+        typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node,
+        std::shared_ptr<buffer> storage, size_t first, size_t size);
+    //! \copydoc basic_value_object::init_methods()
+    [[nodiscard]] static
+    typename basic_bytes::method_table init_methods();
+    //! Marks the object thread-safe.
+    /*! It also makes the whole buffer read-only, including objects sharing the
+     * buffer. */
+    void set_mt_safe() override;
+private:
+    //! Appends data at the end.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c data the appended data, of type \c bytes or \c string
+     * \return \c null
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 2
+     * \throw exception::value_null if \a data is \c null
+     * \throw exception::value_type if \a data does not have type \c bytes or
+     * \c string
+     * \throw exception::value_out_of_range if the resulting size would be
+     * greater than the maximum size of the buffer
+     * \throw exception::value_read_only if the object is read-only */
+    typename basic_bytes::value_ptr
+    append(typename threadscript::basic_state<A>& thread,
+           typename threadscript::basic_symbol_table<A>& l_vars,
+           const typename threadscript::basic_code_node<A>& node);
+    //! Creates a concatenation of this object and other data.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c data the appended data, of type \c bytes or \c string
+     * \return a new \c bytes object with a new buffer, containing bytes of
+     * this object followed by bytes of \a data
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 2
+     * \throw exception::value_null if \a data is \c null
+     * \throw exception::value_type if \a data does not have type \c bytes or
+     * \c string
+     * \throw exception::value_out_of_range if the resulting size would be
+     * greater than the maximum size of the buffer */
+    typename basic_bytes::value_ptr
+    concat(typename threadscript::basic_state<A>& thread,
+           typename threadscript::basic_symbol_table<A>& l_vars,
+           const typename threadscript::basic_code_node<A>& node);
+    //! Reads a signed integer.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c offset the index of the first byte of the integer
+     *     \arg \c size the number of bytes of the integer
+     *     \arg \c endian (optional) the byte order
+     * \return the integer, of type \c int, sign-extended from \a size bytes
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 3 or 4
+     * \throw exception::value_null if any argument is \c null
+     * \throw exception::value_type if \a offset or \a size is not \c int or
+     * \c unsigned, or if \a endian is not \c string
+     * \throw exception::value_out_of_range if \a offset or \a size is
+     * negative, if \a size is 0 or greater than the size of \c int, if bytes
+     * from \a offset to <tt>offset + size</tt> are not in the object, or if
+     * \a endian is neither \c "big" nor \c "little" */
+    typename basic_bytes::value_ptr
+    read_int(typename threadscript::basic_state<A>& thread,
+             typename threadscript::basic_symbol_table<A>& l_vars,
+             const typename threadscript::basic_code_node<A>& node);
+    //! Reads an unsigned integer.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c offset the index of the first byte of the integer
+     *     \arg \c size the number of bytes of the integer
+     *     \arg \c endian (optional) the byte order
+     * \return the integer, of type \c unsigned
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 3 or 4
+     * \throw exception::value_null if any argument is \c null
+     * \throw exception::value_type if \a offset or \a size is not \c int or
+     * \c unsigned, or if \a endian is not \c string
+     * \throw exception::value_out_of_range if \a offset or \a size is
+     * negative, if \a size is 0 or greater than the size of \c unsigned, if
+     * bytes from \a offset to <tt>offset + size</tt> are not in the object,
+     * or if \a endian is neither \c "big" nor \c "little" */
+    typename basic_bytes::value_ptr
+    read_unsigned(typename threadscript::basic_state<A>& thread,
+                  typename threadscript::basic_symbol_table<A>& l_vars,
+                  const typename threadscript::basic_code_node<A>& node);
+    //! Gets the number of bytes.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     * \return the number of bytes, of type \c unsigned
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 1 */
+    typename basic_bytes::value_ptr
+    size(typename threadscript::basic_state<A>& thread,
+         typename threadscript::basic_symbol_table<A>& l_vars,
+         const typename threadscript::basic_code_node<A>& node);
+    //! Creates a slice sharing the buffer with this object.
+    /*! The range is clipped to the existing bytes, as in
+     * basic_shared_vector::slice(). The new object is thread-safe (and
+     * read-only) if this object is thread-safe.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c from the index of the first byte of the slice
+     *     \arg \c to (optional) the index after the last byte of the slice; if
+     *     missing, the slice ends at the end of this object
+     * \return a new \c bytes object
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 2 or 3
+     * \throw exception::value_null if \a from or \a to is \c null
+     * \throw exception::value_type if \a from or \a to is not \c int or \c
+     * unsigned
+     * \throw exception::value_out_of_range if \a from or \a to is negative */
+    typename basic_bytes::value_ptr
+    slice(typename threadscript::basic_state<A>& thread,
+          typename threadscript::basic_symbol_table<A>& l_vars,
+          const typename threadscript::basic_code_node<A>& node);
+    //! Copies the bytes to a string.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     * \return a new \c string containing the bytes of this object
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 1 */
+    typename basic_bytes::value_ptr
+    str(typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node);
+    //! Writes an integer.
+    /*! Only the lowest \a size bytes of \a value are written, that is, \a
+     * value is truncated modulo 2<sup>8*size</sup>.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c offset the index of the first byte of the integer
+     *     \arg \c size the number of bytes of the integer
+     *     \arg \c value the written value, of type \c int or \c unsigned
+     *     \arg \c endian (optional) the byte order
+     * \return \c null
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 4 or 5
+     * \throw exception::value_null if any argument is \c null
+     * \throw exception::value_type if \a offset, \a size, or \a value is not
+     * \c int or \c unsigned, or if \a endian is not \c string
+     * \throw exception::value_out_of_range if \a offset or \a size is
+     * negative, if \a size is 0 or greater than the size of \c unsigned, if
+     * bytes from \a offset to <tt>offset + size</tt> are not in the object,
+     * or if \a endian is neither \c "big" nor \c "little"
+     * \throw exception::value_read_only if the object is read-only */
+    typename basic_bytes::value_ptr
+    write(typename threadscript::basic_state<A>& thread,
+          typename threadscript::basic_symbol_table<A>& l_vars,
+          const typename threadscript::basic_code_node<A>& node);
+    //! Gets the bytes of data passed as a method argument.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments
+     * \param[in] idx the (zero-based) index of the argument
+     * \return the argument value, which must be kept while the bytes are
+     * used, and the bytes of the argument of type \c bytes or \c string
+     * \throw exception::value_null if the argument is \c null
+     * \throw exception::value_type if the argument does not have type \c
+     * bytes or \c string */
+    std::pair<typename basic_bytes::value_ptr, std::span<const unsigned char>>
+    arg_data(typename threadscript::basic_state<A>& thread,
+             typename threadscript::basic_symbol_table<A>& l_vars,
+             const typename threadscript::basic_code_node<A>& node,
+             size_t idx);
+    //! Evaluates arguments that select an integer stored in the object.
+    /*! It is used by read_int() and read_unsigned(). All arguments are
+     * evaluated before the integer is located by int_data(), because
+     * evaluation of an argument can modify the object.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments
+     * \param[in] endian_idx the (zero-based) index of the optional \c endian
+     * argument
+     * \param[in] max_size the maximum allowed number of bytes
+     * \return a pointer to the first byte of the integer, the number of bytes,
+     * and whether the byte order is big endian
+     * \throw exception::value_null if any argument is \c null
+     * \throw exception::value_type if \c offset or \c size is not \c int or
+     * \c unsigned, or if \c endian is not \c string
+     * \throw exception::value_out_of_range if the integer is not in the
+     * object, or if \c endian is neither \c "big" nor \c "little" */
+    std::tuple<unsigned char*, size_t, bool>
+    arg_int(typename threadscript::basic_state<A>& thread,
+            typename threadscript::basic_symbol_table<A>& l_vars,
+            const typename threadscript::basic_code_node<A>& node,
+            size_t endian_idx, size_t max_size);
+    //! Evaluates the optional argument selecting the byte order.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments
+     * \param[in] idx the (zero-based) index of the optional \c endian
+     * argument
+     * \return whether the byte order is big endian, \c true if the argument
+     * is missing
+     * \throw exception::value_null if the argument is \c null
+     * \throw exception::value_type if the argument is not \c string
+     * \throw exception::value_out_of_range if the argument is neither \c
+     * "big" nor \c "little" */
+    bool arg_endian(typename threadscript::basic_state<A>& thread,
+                    typename threadscript::basic_symbol_table<A>& l_vars,
+                    const typename threadscript::basic_code_node<A>& node,
+                    size_t idx);
+    //! Locates an integer stored in the object.
+    /*! The returned pointer is valid until the buffer is modified, therefore
+     * it must be obtained after all method arguments are evaluated.
+     * \param[in] offset the index of the first byte of the integer
+     * \param[in] size the number of bytes of the integer
+     * \param[in] max_size the maximum allowed number of bytes
+     * \return a pointer to the first byte of the integer
+     * \throw exception::value_out_of_range if the integer is not in the
+     * object or \a size is not in the range 1 to \a max_size */
+    unsigned char* int_data(size_t offset, size_t size, size_t max_size);
+    //! Reads an integer stored in the object.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments
+     * \param[in] max_size the maximum allowed number of bytes
+     * \return the integer zero-extended to config::value_unsigned_type, and
+     * the number of bytes
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 3 or 4
+     * \throw exception::value_null if any argument is \c null
+     * \throw exception::value_type if \c offset or \c size is not \c int or
+     * \c unsigned, or if \c endian is not \c string
+     * \throw exception::value_out_of_range if the integer is not in the
+     * object, or if \c endian is neither \c "big" nor \c "little" */
+    std::pair<config::value_unsigned_type, size_t>
+    read(typename threadscript::basic_state<A>& thread,
+         typename threadscript::basic_symbol_table<A>& l_vars,
+         const typename threadscript::basic_code_node<A>& node,
+         size_t max_size);
+    //! Creates a new object.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node of the method call that creates the
+     * object
+     * \param[in] storage the buffer; a new empty buffer is created if \c
+     * nullptr
+     * \param[in] first the index of the first byte of \a storage in the new
+     * object
+     * \param[in] size the number of bytes of \a storage in the new object
+     * \return the new object */
+    std::shared_ptr<basic_bytes>
+    make_bytes(typename threadscript::basic_state<A>& thread,
+               typename threadscript::basic_symbol_table<A>& l_vars,
+               const typename threadscript::basic_code_node<A>& node,
+               std::shared_ptr<buffer> storage, size_t first, size_t size);
+    //! Throws if the object cannot be modified.
+    /*! \throw exception::value_read_only if the object or its buffer is
+     * read-only */
+    void check_writable() const;
+    //! The shared storage of bytes
+    std::shared_ptr<buffer> buf;
+    //! The index of the first byte of this object in \ref buf
+    size_t begin = 0;
+    //! The number of bytes of this object
+    size_t len = 0;
+};
+
+} // namespace threadscript
@@ -0,0 +1,334 @@
+#pragma once
+
+/*! \file
+ * \brief The implementation part of bytes.hpp
+ */
+
+#include "threadscript/bytes.hpp"
+
+#include <algorithm>
+
+namespace threadscript {
+
+template <impl::allocator A>
+basic_bytes<A>::basic_bytes(
+        typename basic_bytes<A>::tag,
+        std::shared_ptr<const typename basic_bytes<A>::method_table>
+            methods,
+        typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node):
+    impl::basic_bytes_base<A>(typename basic_bytes::tag_args{}, methods,
+                              thread, l_vars, node),
+    buf(std::allocate_shared<buffer>(thread.get_allocator(),
+                                     thread.get_allocator()))
+{
+    size_t narg = this->narg(node);
+    if (narg > 1)
+        throw exception::op_narg();
+    if (narg == 1) {
+        auto v = this->arg(thread, l_vars, node, 0);
+        if (!v)
+            throw exception::value_null();
+        if (auto ps = dynamic_cast<basic_value_string<A>*>(v.get()))
+            buf->data.assign(ps->cvalue().begin(), ps->cvalue().end());
+        else {
+            size_t sz = basic_value<A>::to_index(v);
+            if (sz > buf->data.max_size())
+                throw exception::value_out_of_range();
+            buf->data.resize(sz);
+        }
+        len = buf->data.size();
+    }
+}
+
+template <impl::allocator A>
+basic_bytes<A>::basic_bytes(
+        typename basic_bytes<A>::tag,
+        std::shared_ptr<const typename basic_bytes<A>::method_table>
+            methods,
+        typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node,
+        std::shared_ptr<buffer> storage, size_t first, size_t size):
+    impl::basic_bytes_base<A>(typename basic_bytes::tag_args{}, methods,
+                              thread, l_vars, node),
+    buf(storage ? std::move(storage) :
+        std::allocate_shared<buffer>(thread.get_allocator(),
+                                     thread.get_allocator())),
+    begin(first), len(size)
+{
+    assert(begin + len <= buf->data.size());
+}
+
+template <impl::allocator A> basic_bytes<A>::value_ptr
+basic_bytes<A>::append(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 2)
+        throw exception::op_narg();
+    check_writable();
+    auto [arg, data] = arg_data(thread, l_vars, node, 1);
+    if (data.size() > buf->data.max_size() - len)
+        throw exception::value_out_of_range();
+    if (begin + len != buf->data.size()) {
+        // Do not overwrite bytes following this object, which may be visible
+        // via other objects sharing the buffer
+        auto b = std::allocate_shared<buffer>(thread.get_allocator(),
+                                              thread.get_allocator());
+        b->data.reserve(len + data.size());
+        b->data.assign(buf->data.begin() + ptrdiff_t(begin),
+                       buf->data.begin() + ptrdiff_t(begin + len));
+        b->data.insert(b->data.end(), data.begin(), data.end());
+        buf = std::move(b);
+        begin = 0;
+    } else if (!data.empty() && data.data() >= buf->data.data() &&
+               data.data() < buf->data.data() + buf->data.size())
+    {
+        // Appending a part of the own buffer, which can be reallocated
+        a_basic_vector<unsigned char, A> tmp(data.begin(), data.end(),
+                                             thread.get_allocator());
+        buf->data.insert(buf->data.end(), tmp.begin(), tmp.end());
+    } else
+        buf->data.insert(buf->data.end(), data.begin(), data.end());
+    len += data.size();
+    return nullptr;
+}
+
+template <impl::allocator A>
+std::pair<typename basic_bytes<A>::value_ptr, std::span<const unsigned char>>
+basic_bytes<A>::arg_data(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node, size_t idx)
+{
+    auto v = this->arg(thread, l_vars, node, idx);
+    if (!v)
+        throw exception::value_null();
+    std::span<const unsigned char> data;
+    if (auto pb = dynamic_cast<basic_bytes*>(v.get()))
+        data = {pb->buf->data.data() + pb->begin, pb->len};
+    else if (auto ps = dynamic_cast<basic_value_string<A>*>(v.get()))
+        data = {reinterpret_cast<const unsigned char*>(ps->cvalue().data()),
+            ps->cvalue().size()};
+    else
+        throw exception::value_type();
+    return {std::move(v), data};
+}
+
+template <impl::allocator A> std::tuple<unsigned char*, size_t, bool>
+basic_bytes<A>::arg_int(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node,
+    size_t endian_idx, size_t max_size)
+{
+    size_t offset = this->arg_index(thread, l_vars, node, 1);
+    size_t size = this->arg_index(thread, l_vars, node, 2);
+    bool big = arg_endian(thread, l_vars, node, endian_idx);
+    return {int_data(offset, size, max_size), size, big};
+}
+
+template <impl::allocator A>
+bool basic_bytes<A>::arg_endian(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node, size_t idx)
+{
+    if (this->narg(node) <= idx)
+        return true;
+    auto v = this->arg(thread, l_vars, node, idx);
+    if (!v)
+        throw exception::value_null();
+    auto ps = dynamic_cast<basic_value_string<A>*>(v.get());
+    if (!ps)
+        throw exception::value_type();
+    if (ps->cvalue() == "little")
+        return false;
+    else if (ps->cvalue() != "big")
+        throw exception::value_out_of_range();
+    return true;
+}
+
+template <impl::allocator A> unsigned char*
+basic_bytes<A>::int_data(size_t offset, size_t size, size_t max_size)
+{
+    if (size == 0 || size > max_size || offset > len || size > len - offset)
+        throw exception::value_out_of_range();
+    return buf->data.data() + begin + offset;
+}
+
+template <impl::allocator A> void basic_bytes<A>::check_writable() const
+{
+    if (this->mt_safe() || buf->read_only)
+        throw exception::value_read_only();
+}
+
+template <impl::allocator A> basic_bytes<A>::value_ptr
+basic_bytes<A>::concat(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 2)
+        throw exception::op_narg();
+    auto [arg, data] = arg_data(thread, l_vars, node, 1);
+    if (data.size() > buf->data.max_size() - len)
+        throw exception::value_out_of_range();
+    auto b = std::allocate_shared<buffer>(thread.get_allocator(),
+                                          thread.get_allocator());
+    b->data.reserve(len + data.size());
+    b->data.assign(buf->data.begin() + ptrdiff_t(begin),
+                   buf->data.begin() + ptrdiff_t(begin + len));
+    b->data.insert(b->data.end(), data.begin(), data.end());
+    size_t sz = b->data.size();
+    return make_bytes(thread, l_vars, node, std::move(b), 0, sz);
+}
+
+template <impl::allocator A> basic_bytes<A>::method_table
+basic_bytes<A>::init_methods()
+{
+    return {
+        //! [methods]
+        {"append", &basic_bytes::append},
+        {"concat", &basic_bytes::concat},
+        {"read_int", &basic_bytes::read_int},
+        {"read_unsigned", &basic_bytes::read_unsigned},
+        {"size", &basic_bytes::size},
+        {"slice", &basic_bytes::slice},
+        {"str", &basic_bytes::str},
+        {"write", &basic_bytes::write},
+        //! [methods]
+    };
+}
+
+template <impl::allocator A> std::shared_ptr<basic_bytes<A>>
+basic_bytes<A>::make_bytes(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node,
+    std::shared_ptr<buffer> storage, size_t first, size_t size)
+{
+    return std::allocate_shared<basic_bytes>(thread.get_allocator(),
+                                             typename basic_bytes::tag{},
+                                             this->get_methods(), thread,
+                                             l_vars, node, std::move(storage),
+                                             first, size);
+}
+
+template <impl::allocator A> std::pair<config::value_unsigned_type, size_t>
+basic_bytes<A>::read(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node, size_t max_size)
+{
+    if (size_t narg = this->narg(node); narg != 3 && narg != 4)
+        throw exception::op_narg();
+    auto [p, size, big] = arg_int(thread, l_vars, node, 3, max_size);
+    config::value_unsigned_type result = 0;
+    for (size_t i = 0; i < size; ++i)
+        result = result << 8 | p[big ? i : size - 1 - i];
+    return {result, size};
+}
+
+template <impl::allocator A> basic_bytes<A>::value_ptr
+basic_bytes<A>::read_int(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    auto [u, size] =
+        read(thread, l_vars, node, sizeof(config::value_int_type));
+    // Sign extension, the result of conversion to a signed type is defined
+    // since C++20
+    constexpr size_t bits = 8 * sizeof(config::value_unsigned_type);
+    auto shift = bits - 8 * size;
+    auto result = basic_value_int<A>::create(thread.get_allocator());
+    result->value() = config::value_int_type(u << shift) >> shift;
+    return result;
+}
+
+template <impl::allocator A> basic_bytes<A>::value_ptr
+basic_bytes<A>::read_unsigned(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    auto result = basic_value_unsigned<A>::create(thread.get_allocator());
+    result->value() =
+        read(thread, l_vars, node, sizeof(config::value_unsigned_type)).first;
+    return result;
+}
+
+template <impl::allocator A> void basic_bytes<A>::set_mt_safe()
+{
+    buf->read_only = true;
+    impl::basic_bytes_base<A>::set_mt_safe();
+}
+
+template <impl::allocator A> basic_bytes<A>::value_ptr
+basic_bytes<A>::size(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>&,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 1)
+        throw exception::op_narg();
+    auto result = basic_value_unsigned<A>::create(thread.get_allocator());
+    result->value() = len;
+    return result;
+}
+
+template <impl::allocator A> basic_bytes<A>::value_ptr
+basic_bytes<A>::slice(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    size_t narg = this->narg(node);
+    if (narg != 2 && narg != 3)
+        throw exception::op_narg();
+    size_t from = this->arg_index(thread, l_vars, node, 1);
+    size_t to = narg == 3 ? this->arg_index(thread, l_vars, node, 2) : len;
+    to = std::min(to, len);
+    from = std::min(from, to);
+    auto result =
+        make_bytes(thread, l_vars, node, buf, begin + from, to - from);
+    if (this->mt_safe())
+        result->set_mt_safe();
+    return result;
+}
+
+template <impl::allocator A> basic_bytes<A>::value_ptr
+basic_bytes<A>::str(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>&,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 1)
+        throw exception::op_narg();
+    auto result = basic_value_string<A>::create(thread.get_allocator());
+    result->value().assign(
+        reinterpret_cast<const char*>(buf->data.data() + begin), len);
+    return result;
+}
+
+template <impl::allocator A> basic_bytes<A>::value_ptr
+basic_bytes<A>::write(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (size_t narg = this->narg(node); narg != 4 && narg != 5)
+        throw exception::op_narg();
+    // Evaluation of any argument can reallocate the buffer
+    size_t offset = this->arg_index(thread, l_vars, node, 1);
+    size_t size = this->arg_index(thread, l_vars, node, 2);
+    auto v = this->arg(thread, l_vars, node, 3);
+    if (!v)
+        throw exception::value_null();
+    config::value_unsigned_type u = 0;
+    if (auto pi = dynamic_cast<basic_value_int<A>*>(v.get()))
+        u = pi->cvalue();
+    else if (auto pu = dynamic_cast<basic_value_unsigned<A>*>(v.get()))
+        u = pu->cvalue();
+    else
+        throw exception::value_type();
+    bool big = arg_endian(thread, l_vars, node, 4);
+    auto p = int_data(offset, size, sizeof(config::value_unsigned_type));
+    check_writable();
+    for (size_t i = 0; i < size; ++i, u >>= 8)
+        p[big ? size - 1 - i : i] = static_cast<unsigned char>(u);
+    return nullptr;
+}
+
+} // namespace threadscript
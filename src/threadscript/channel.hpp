@@ -4,9 +4,15 @@
  * \brief A channel for communicating among threads.
  */
 
+#include "threadscript/green.hpp"
 #include "threadscript/vm_data.hpp"
 
-#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
 
 namespace threadscript {
 
@@ -19,6 +25,46 @@ inline constexpr char name_channel[] = "channel";
 /*! \tparam A an allocator type */
 template <allocator A> using basic_channel_base =
     basic_value_object<basic_channel<A>, name_channel, A>;
+
+//! A thread waiting for any of several channels
+/*! It is used by basic_channel::select(). A waiter is registered in all
+ * channels involved in a select operation. A channel notifies all its
+ * registered waiters whenever it may become ready for an operation. */
+class channel_waiter {
+public:
+    //! The clock used for timeouts
+    using clock = green_cond::clock;
+    //! Wakes up the waiting thread.
+    void notify() {
+        {
+            std::lock_guard lck{mtx};
+            ready = true;
+        }
+        cond.notify_one();
+    }
+    //! Waits for notify().
+    /*! It returns immediately if notify() has been called since the previous
+     * return from this function.
+     * \param[in] deadline the time of a timeout; no timeout if empty
+     * \return \c true if notified, \c false if the timeout expired */
+    bool wait(const std::optional<clock::time_point>& deadline) {
+        std::unique_lock lck{mtx};
+        if (deadline) {
+            if (!cond.wait_until(lck, *deadline, [this]() { return ready; }))
+                return false;
+        } else
+            cond.wait(lck, [this]() { return ready; });
+        ready = false;
+        return true;
+    }
+private:
+    //! The mutex protecting \ref ready
+    std::mutex mtx;
+    //! Used for waiting
+    green_cond cond;
+    //! Set by notify(), reset by wait()
+    bool ready = false;
+};
 } // namespace impl
 
 //! A thread-safe communication channel class
@@ -38,6 +84,31 @@ template <allocator A> using basic_channel_base =
  * succeeds only if there is send() waiting. A pair of try_send() and
  * try_recv() never succeeds for a zero capacity channel.
  *
+ * If the capacity is nonzero, messages are stored in a lock-free ring buffer.
+ * A mutex and condition variables are used only if a thread must wait in
+ * send() for a free slot or in recv() for a message. Threads that do not wait
+ * are notified only if some other thread is waiting.
+ *
+ * Methods send_many(), recv_many(), try_send_many(), and try_recv_many()
+ * transfer a batch of messages by a single method call. For a nonzero
+ * capacity, they also notify waiting threads once per batch instead of once
+ * per message.
+ *
+ * Methods send_for() and recv_for() wait at most for a specified time. If
+ * the operation cannot be performed before the timeout expires, they throw
+ * exception::op_would_block.
+ *
+ * A channel can be created with a nonzero spin count. Then a blocking
+ * operation repeatedly retries, yielding the CPU between attempts, before the
+ * thread is suspended on a condition variable. If the peer thread usually
+ * responds quickly, for example, in a request/response pattern or with
+ * a zero capacity channel, spinning reduces the handoff latency and the
+ * number of thread wakeups.
+ *
+ * Function \c select (implemented by predef::f_select) waits until any of
+ * several send and receive operations on one or more channels can be
+ * performed, and then performs it. It uses select().
+ *
  * Methods:
  * \snippet channel_impl.hpp methods
  * \tparam A an allocator type
@@ -54,11 +125,15 @@ public:
      * \param[in] l_vars the symbol table of the current stack frame
      * \param[in] node the code node, with constructor arguments:
      *     \arg \c capacity the channel capacity, of type \c int or \c unsigned
-     * \throw exception::op_narg if the number of arguments is not 1
-     * \throw exception::value_null if \a capacity is \c null
-     * \throw exception::value_type if \a capacity does not have type \c int or
-     * \c c unsigned
-     * \throw exception::value_out_of_range if \a capacity is negative */
+     *     \arg \c spin (optional) the number of retries of a blocking
+     *     operation before suspending the thread, of type \c int or \c
+     *     unsigned; 0 (no spinning) if missing
+     * \throw exception::op_narg if the number of arguments is not 1 or 2
+     * \throw exception::value_null if \a capacity or \a spin is \c null
+     * \throw exception::value_type if \a capacity or \a spin does not have
+     * type \c int or \c unsigned
+     * \throw exception::value_out_of_range if \a capacity or \a spin is
+     * negative */
     basic_channel(typename basic_channel::tag t,
         std::shared_ptr<const typename basic_channel::method_table> methods,
         typename threadscript::basic_state<A>& thread,
@@ -67,7 +142,56 @@ public:
     //! \copydoc basic_value_object::init_methods()
     [[nodiscard]] static
     typename basic_channel::method_table init_methods();
+    //! The clock used for timeouts
+    using clock = impl::channel_waiter::clock;
+    //! A single operation of select()
+    struct select_op {
+        //! The channel
+        std::shared_ptr<basic_channel> channel;
+        //! Whether to send (\c true) or receive (\c false)
+        bool send = false;
+        //! The sent value, or the received value after a successful receive
+        typename basic_channel::value_ptr val;
+    };
+    //! Waits until any of a set of operations can be performed.
+    /*! Then it performs exactly one of the operations. If more operations can
+     * be performed, one of them is selected pseudorandomly, so that no
+     * operation is starved. The calling thread does not spin while waiting,
+     * but it registers a single impl::channel_waiter in all channels of \a
+     * ops.
+     *
+     * For a zero capacity channel, a send operation is performed only if
+     * there is a thread blocked in recv() or recv_many(), and a receive
+     * operation only if there is a thread blocked in send() or send_many().
+     * Therefore, two threads calling select() with opposite operations on the
+     * same zero capacity channel do not communicate with each other.
+     * \param[in, out] ops the operations; if a receive operation is selected,
+     * the received value is stored in its \ref select_op::val
+     * \param[in] deadline the time of a timeout; no timeout if empty
+     * \return the index of the performed operation in \a ops; empty if the
+     * timeout expired
+     * \threadsafe{safe,safe} */
+    static std::optional<size_t>
+    select(std::span<select_op> ops,
+           const std::optional<clock::time_point>& deadline);
 private:
+    //! An element of the message queue
+    /*! Each slot has a sequence number, which tells, relative to the
+     * positions \ref pos_push and \ref pos_pop, whether the slot is ready for
+     * a push or for a pop. A thread claims a slot by incrementing a position
+     * and then it publishes the modified slot by storing a new sequence
+     * number. This is a variant of the bounded MPMC queue algorithm by Dmitry
+     * Vyukov, which works also for capacity 1. */
+    struct slot {
+        //! The sequence number of the slot
+        /*! Position \c p uses the slot at index <tt>p % capacity()</tt> of
+         * \ref slots in turn <tt>t = p / capacity()</tt>. The slot is ready for
+         * a push if <tt>seq == 2 * t</tt> and for a pop if <tt>seq == 2 * t +
+         * 1</tt>. */
+        std::atomic<size_t> seq{0};
+        //! The stored message
+        typename basic_channel::value_ptr val;
+    };
     //! Sends a message to the channel in the blocking mode.
     /*! A message can be any thread-safe value or \c null. If the channel is
      * not full, the message is appended at the end of the message queue.
@@ -104,6 +228,77 @@ private:
     try_send(typename threadscript::basic_state<A>& thread,
              typename threadscript::basic_symbol_table<A>& l_vars,
              const typename threadscript::basic_code_node<A>& node);
+    //! Sends a message to the channel, waiting at most for a timeout.
+    /*! It is similar to send(), but it throws exception::op_would_block if
+     * the message cannot be sent before the timeout expires. For a zero
+     * capacity channel, the message is sent even after the timeout if
+     * a receiver has already committed to receiving it.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c value the value sent to the channel
+     *     \arg \c timeout the maximum waiting time in milliseconds, of type \c
+     *     int or \c unsigned
+     * \return \c null
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 3
+     * \throw exception::value_mt_unsafe if \a value is not mt-safe
+     * \throw exception::value_null if \a timeout is \c null
+     * \throw exception::value_type if \a timeout is not \c int or \c
+     * unsigned
+     * \throw exception::value_out_of_range if \a timeout is negative
+     * \throw exception::op_would_block if the timeout expired */
+    typename basic_channel::value_ptr
+    send_for(typename threadscript::basic_state<A>& thread,
+             typename threadscript::basic_symbol_table<A>& l_vars,
+             const typename threadscript::basic_code_node<A>& node);
+    //! Sends a batch of messages to the channel in the blocking mode.
+    /*! It is equivalent to calling send() for each element of a vector, but
+     * with lower overhead. Waiting receivers are notified once per batch,
+     * unless the channel becomes full during the batch. All elements are
+     * checked before the first one is sent, so that either all or none of
+     * them are sent.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c values a \c vector of values sent to the channel, in the
+     *     order of elements
+     * \return \c null
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 2
+     * \throw exception::value_null if \a values is \c null
+     * \throw exception::value_type if \a values is not a \c vector
+     * \throw exception::value_mt_unsafe if any element of \a values is not
+     * mt-safe */
+    typename basic_channel::value_ptr
+    send_many(typename threadscript::basic_state<A>& thread,
+              typename threadscript::basic_symbol_table<A>& l_vars,
+              const typename threadscript::basic_code_node<A>& node);
+    //! Sends a batch of messages to the channel in the nonblocking mode.
+    /*! It sends elements of a vector in order, while it is possible without
+     * blocking.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c values a \c vector of values sent to the channel, in the
+     *     order of elements
+     * \return the number of sent values (a prefix of \a values), of type \c
+     * unsigned
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 2
+     * \throw exception::value_null if \a values is \c null
+     * \throw exception::value_type if \a values is not a \c vector
+     * \throw exception::value_mt_unsafe if any element of \a values is not
+     * mt-safe
+     * \throw exception::op_would_block if \a values is not empty and no value
+     * can be sent without blocking */
+    typename basic_channel::value_ptr
+    try_send_many(typename threadscript::basic_state<A>& thread,
+                  typename threadscript::basic_symbol_table<A>& l_vars,
+                  const typename threadscript::basic_code_node<A>& node);
     //! Receives a message from the channel in the blocking mode.
     /*! If the channel is not empty, the first message in the message queue is
      * removed and returned. Otherwise, the operation blocks until a message
@@ -136,6 +331,73 @@ private:
     try_recv(typename threadscript::basic_state<A>& thread,
              typename threadscript::basic_symbol_table<A>& l_vars,
              const typename threadscript::basic_code_node<A>& node);
+    //! Receives a message from the channel, waiting at most for a timeout.
+    /*! It is similar to recv(), but it throws exception::op_would_block if
+     * no message is available before the timeout expires. For a zero capacity
+     * channel, a message is received even after the timeout if a sender has
+     * already committed to sending it.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c timeout the maximum waiting time in milliseconds, of type \c
+     *     int or \c unsigned
+     * \return the received value (can be \c null)
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 2
+     * \throw exception::value_null if \a timeout is \c null
+     * \throw exception::value_type if \a timeout is not \c int or \c
+     * unsigned
+     * \throw exception::value_out_of_range if \a timeout is negative
+     * \throw exception::op_would_block if the timeout expired */
+    typename basic_channel::value_ptr
+    recv_for(typename threadscript::basic_state<A>& thread,
+             typename threadscript::basic_symbol_table<A>& l_vars,
+             const typename threadscript::basic_code_node<A>& node);
+    //! Receives a batch of messages from the channel in the blocking mode.
+    /*! It blocks until at least one message is available, like recv(). Then
+     * it removes and returns messages from the front of the message queue,
+     * while they are available without blocking, up to a maximum number.
+     * Waiting senders are notified once per batch.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c max the maximum number of received values, of type \c int
+     *     or \c unsigned
+     * \return a new \c vector of 1 to \a max received values, in the order
+     * of receiving
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 2
+     * \throw exception::value_null if \a max is \c null
+     * \throw exception::value_type if \a max is not \c int or \c unsigned
+     * \throw exception::value_out_of_range if \a max is not positive */
+    typename basic_channel::value_ptr
+    recv_many(typename threadscript::basic_state<A>& thread,
+              typename threadscript::basic_symbol_table<A>& l_vars,
+              const typename threadscript::basic_code_node<A>& node);
+    //! Receives a batch of messages from the channel in the nonblocking mode.
+    /*! It removes and returns messages from the front of the message queue,
+     * while they are available without blocking, up to a maximum number.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c max the maximum number of received values, of type \c int
+     *     or \c unsigned
+     * \return a new \c vector of 1 to \a max received values, in the order
+     * of receiving
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 2
+     * \throw exception::value_null if \a max is \c null
+     * \throw exception::value_type if \a max is not \c int or \c unsigned
+     * \throw exception::value_out_of_range if \a max is not positive
+     * \throw exception::op_would_block if a recv_many() called instead of this
+     * method would block */
+    typename basic_channel::value_ptr
+    try_recv_many(typename threadscript::basic_state<A>& thread,
+                  typename threadscript::basic_symbol_table<A>& l_vars,
+                  const typename threadscript::basic_code_node<A>& node);
     //! Gets the number of waiting senders/receivers.
     /*! \param[in] thread the current thread
      * \param[in] l_vars the symbol table of the current stack frame
@@ -149,47 +411,222 @@ private:
     balance(typename threadscript::basic_state<A>& thread,
             typename threadscript::basic_symbol_table<A>& l_vars,
             const typename threadscript::basic_code_node<A>& node);
-    //! Checks if the queue has space for at least one value.
-    /*! \return \c true if \ref data is not full, \c false if it is full */
-    bool has_space() {
-        return it_push != it_pop;
-    }
-    //! Checks if the queue is nonempty.
-    /*! \return \c if \ref data is not empty, \c false if it is empty */
-    bool has_data() {
-        return it_pop != data.end();
-    }
-    //! Pushes a value to the end of the queue.
-    /*! It assumes the queue is not full.
-     * \param[in] val the value to be pushed */
-    void push(typename basic_channel::value_ptr&& val);
-    //! Pops a value from the front of the queue.
-    /*! It assumes the queue is not empty.
-     * \return val the popped value */
-    typename basic_channel::value_ptr pop();
+    //! Creates the message queue.
+    /*! It is used by the constructor to initialize \ref slots.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with constructor arguments
+     * \return the queue with the requested capacity
+     * \throw as the constructor */
+    a_basic_vector<slot, A>
+    init_slots(typename threadscript::basic_state<A>& thread,
+               typename threadscript::basic_symbol_table<A>& l_vars,
+               const typename threadscript::basic_code_node<A>& node);
+    //! Pushes a value to the end of the queue if it is not full.
+    /*! It does not lock \ref mtx.
+     * \param[in, out] val the value to be pushed; it is moved from only if
+     * pushed successfully
+     * \return \c true if \a val has been pushed, \c false if the queue is
+     * full */
+    bool try_push(typename basic_channel::value_ptr& val);
+    //! Pops a value from the front of the queue if it is not empty.
+    /*! It does not lock \ref mtx.
+     * \param[out] val the popped value; unchanged if the queue is empty
+     * \return \c true if a value has been popped, \c false if the queue is
+     * empty */
+    bool try_pop(typename basic_channel::value_ptr& val);
+    //! Pushes a value to the end of the queue, waiting while it is full.
+    /*! It does not call notify_recv(). It spins according to \ref spin
+     * before waiting on \ref cond_send.
+     * \param[in, out] val the value to be pushed; it is moved from only if
+     * pushed successfully
+     * \param[in] deadline the time of a timeout; no timeout if empty
+     * \return \c true if \a val has been pushed, \c false if the timeout
+     * expired */
+    bool push_wait(typename basic_channel::value_ptr& val,
+                   const std::optional<clock::time_point>& deadline =
+                       std::nullopt);
+    //! Pops a value from the front of the queue, waiting while it is empty.
+    /*! It does not call notify_send(). It spins according to \ref spin
+     * before waiting on \ref cond_recv.
+     * \param[out] val the popped value; unchanged if the timeout expired
+     * \param[in] deadline the time of a timeout; no timeout if empty
+     * \return \c true if a value has been popped, \c false if the timeout
+     * expired */
+    bool pop_wait(typename basic_channel::value_ptr& val,
+                  const std::optional<clock::time_point>& deadline =
+                      std::nullopt);
+    //! Passes a value to a receiver in a zero capacity channel.
+    /*! It waits until the value is taken by a receiver. After the timeout, it
+     * still passes the value if a receiver has already been matched with
+     * this sender.
+     * \param[in, out] val the value to be sent; it is moved from only if
+     * sent successfully
+     * \param[in] deadline the time of a timeout; no timeout if empty
+     * \return \c true if \a val has been sent, \c false if the timeout
+     * expired */
+    bool send_sync(typename basic_channel::value_ptr& val,
+                   const std::optional<clock::time_point>& deadline =
+                       std::nullopt);
+    //! Gets a value from a sender in a zero capacity channel.
+    /*! It waits until a value is passed by a sender. After the timeout, it
+     * still waits for the value if a sender has already been matched with
+     * this receiver.
+     * \param[out] val the received value; unchanged if the timeout expired
+     * \param[in] deadline the time of a timeout; no timeout if empty
+     * \return \c true if a value has been received, \c false if the timeout
+     * expired */
+    bool recv_sync(typename basic_channel::value_ptr& val,
+                   const std::optional<clock::time_point>& deadline =
+                       std::nullopt);
+    //! Waits on a condition variable, spinning first.
+    /*! It checks \a pred up to \ref spin times, unlocking \a lck and
+     * yielding the CPU between the checks, before it blocks on \a cond.
+     * \tparam P the type of the wait condition
+     * \param[in] lck a lock of \ref mtx
+     * \param[in] cond the condition variable
+     * \param[in] deadline the time of a timeout; no timeout if empty
+     * \param[in] pred the wait condition
+     * \return the result of \a pred; it is \c false only if the timeout
+     * expired */
+    template <class P>
+    bool wait_cond(std::unique_lock<std::mutex>& lck,
+                   impl::green_cond& cond,
+                   const std::optional<clock::time_point>& deadline, P pred);
+    //! Gets a deadline from a timeout passed as a method argument.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments
+     * \param[in] idx the index of the timeout argument
+     * \return the current time plus the timeout in milliseconds, see
+     * impl::deadline_after()
+     * \throw exception::value_null if the argument is \c null
+     * \throw exception::value_type if the argument is not \c int or \c
+     * unsigned
+     * \throw exception::value_out_of_range if the argument is negative */
+    clock::time_point
+    arg_deadline(typename threadscript::basic_state<A>& thread,
+                 typename threadscript::basic_symbol_table<A>& l_vars,
+                 const typename threadscript::basic_code_node<A>& node,
+                 size_t idx);
+    //! Passes a value to a waiting receiver in a zero capacity channel.
+    /*! \param[in, out] val the value to be sent; it is moved from only if
+     * sent successfully
+     * \return \c true if \a val has been sent, \c false if there is no
+     * receiver waiting */
+    bool try_send_sync(typename basic_channel::value_ptr& val);
+    //! Gets a value from a waiting sender in a zero capacity channel.
+    /*! \param[out] val the received value; unchanged if there is no sender
+     * waiting
+     * \return \c true if a value has been received, \c false if there is no
+     * sender waiting */
+    bool try_recv_sync(typename basic_channel::value_ptr& val);
+    //! Tries to perform an operation for select() without blocking.
+    /*! \param[in, out] op the operation
+     * \return whether the operation has been performed */
+    bool try_select_op(select_op& op);
+    //! Registers a waiter of select().
+    /*! \param[in] w the waiter
+     * \param[in] send whether \a w waits for sending (\c true) or receiving
+     * (\c false) */
+    void add_waiter(impl::channel_waiter& w, bool send);
+    //! Unregisters a waiter registered by add_waiter().
+    /*! \param[in] w the waiter
+     * \param[in] send the same value as passed to add_waiter() */
+    void remove_waiter(impl::channel_waiter& w, bool send);
+    //! Notifies all registered waiters of select().
+    /*! It must be called with \ref mtx locked.
+     * \param[in] send whether to notify waiters for sending (\c true) or
+     * receiving (\c false) */
+    void notify_waiters(bool send);
+    //! Gets a vector of messages passed as a method argument.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments
+     * \return the argument value, guaranteed to have type \c vector
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 2
+     * \throw exception::value_null if the argument is \c null
+     * \throw exception::value_type if the argument is not a \c vector
+     * \throw exception::value_mt_unsafe if any element of the vector is not
+     * mt-safe */
+    std::shared_ptr<basic_value_vector<A>>
+    arg_messages(typename threadscript::basic_state<A>& thread,
+                 typename threadscript::basic_symbol_table<A>& l_vars,
+                 const typename threadscript::basic_code_node<A>& node);
+    //! Gets the maximum number of messages passed as a method argument.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments
+     * \return the argument value
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 2
+     * \throw exception::value_null if the argument is \c null
+     * \throw exception::value_type if the argument is not \c int or \c
+     * unsigned
+     * \throw exception::value_out_of_range if the argument is not positive */
+    size_t arg_max(typename threadscript::basic_state<A>& thread,
+                   typename threadscript::basic_symbol_table<A>& l_vars,
+                   const typename threadscript::basic_code_node<A>& node);
+    //! Wakes up a thread waiting for a value in a queue.
+    /*! It is called after a successful try_push(). */
+    void notify_recv();
+    //! Wakes up a thread waiting for space in a queue.
+    /*! It is called after a successful try_pop(). */
+    void notify_send();
     //! Gets the capacity of the queue.
     /*! \return the capacity, as initialized by the constructor */
     size_t capacity() {
-        return data.size();
+        return slots.size();
     }
+    //! A polling period used by send_sync() and recv_sync() after a timeout
+    /*! If the timeout expires while a peer is matched to the waiting thread,
+     * the thread waits for the peer to finish. This is rare and short, so it
+     * is done by polling instead of adding notifications to the common
+     * paths. */
+    static constexpr std::chrono::milliseconds late_poll{1};
+    //! The size of a cache line, used to avoid false sharing
+    static constexpr size_t cache_line = 64;
     //! The message queue (for nonzero \ref capacity)
-    a_basic_vector<typename basic_channel::value_ptr, A> data;
-    //! The position for push() (for nonzero \ref capacity)
-    decltype(data)::iterator it_push{};
-    //! The position for pop() (for nonzero \ref capacity)
-    decltype(data)::iterator it_pop{};
+    /*! Values are pushed and popped without locking \ref mtx. The mutex is
+     * only used by threads waiting in send() for a free slot and in recv()
+     * for a message. */
+    a_basic_vector<slot, A> slots;
+    //! The number of retries of a blocking operation before waiting
+    size_t spin = 0;
+    //! The position of the next try_push() (for nonzero \ref capacity)
+    alignas(cache_line) std::atomic<size_t> pos_push{0};
+    //! The position of the next try_pop() (for nonzero \ref capacity)
+    alignas(cache_line) std::atomic<size_t> pos_pop{0};
     //! A value storage (for zero \ref capacity)
     std::optional<typename basic_channel::value_ptr> value;
     //! The mutex for synchronizing access from threads
-    std::mutex mtx;
+    /*! For nonzero \ref capacity, it is used only for waiting. */
+    alignas(cache_line) std::mutex mtx;
     //! Used to wait in send()
-    std::condition_variable cond_send;
+    impl::green_cond cond_send;
     //! Used to wait in recv()
-    std::condition_variable cond_recv;
+    impl::green_cond cond_recv;
     //! Tracks waiting senders
-    intmax_t senders = 0;
+    /*! It is modified only with \ref mtx locked. It is atomic, because for
+     * nonzero \ref capacity, it is read without locking in notify_send(). */
+    std::atomic<intmax_t> senders = 0;
     //! Tracks waiting receivers
-    intmax_t receivers = 0;
+    /*! It is modified only with \ref mtx locked. It is atomic, because for
+     * nonzero \ref capacity, it is read without locking in notify_recv(). */
+    std::atomic<intmax_t> receivers = 0;
+    //! Waiters of select() waiting for sending, protected by \ref mtx
+    a_basic_vector<impl::channel_waiter*, A> send_waiters;
+    //! Waiters of select() waiting for receiving, protected by \ref mtx
+    a_basic_vector<impl::channel_waiter*, A> recv_waiters;
+    //! The size of \ref send_waiters
+    /*! It is modified only with \ref mtx locked. It is atomic, because for
+     * nonzero \ref capacity, it is read without locking in notify_send(). */
+    std::atomic<size_t> n_send_waiters = 0;
+    //! The size of \ref recv_waiters
+    /*! It is modified only with \ref mtx locked. It is atomic, because for
+     * nonzero \ref capacity, it is read without locking in notify_recv(). */
+    std::atomic<size_t> n_recv_waiters = 0;
 };
 
 } // namespace threadscript
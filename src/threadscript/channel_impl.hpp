@@ -5,6 +5,11 @@
  */
 
 #include "threadscript/channel.hpp"
+#include "threadscript/finally.hpp"
+
+#include <algorithm>
+#include <random>
+#include <type_traits>
 
 namespace threadscript {
 
@@ -17,20 +22,69 @@ basic_channel<A>::basic_channel(
         typename threadscript::basic_symbol_table<A>& l_vars,
         const typename threadscript::basic_code_node<A>& node):
     impl::basic_channel_base<A>(typename basic_channel::tag_args{}, methods,
-                                thread, l_vars, node)
+                                thread, l_vars, node),
+    slots(init_slots(thread, l_vars, node)),
+    send_waiters(thread.get_allocator()), recv_waiters(thread.get_allocator())
 {
-    size_t narg = this->narg(node);
-    if (narg != 1)
-        throw exception::op_narg();
-    auto c = this->arg_index(thread, l_vars, node, 0);
-    if (c != 0) {
-        data.resize(c);
-        it_push = data.begin();
-        it_pop = data.end();
-    }
+    if (this->narg(node) == 2)
+        spin = this->arg_index(thread, l_vars, node, 1);
     this->set_mt_safe();
 }
 
+template <impl::allocator A>
+void basic_channel<A>::add_waiter(impl::channel_waiter& w, bool send)
+{
+    std::lock_guard lck{mtx};
+    if (send) {
+        send_waiters.push_back(&w);
+        ++n_send_waiters;
+    } else {
+        recv_waiters.push_back(&w);
+        ++n_recv_waiters;
+    }
+}
+
+template <impl::allocator A>
+std::shared_ptr<basic_value_vector<A>>
+basic_channel<A>::arg_messages(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 2)
+        throw exception::op_narg();
+    auto v = this->arg(thread, l_vars, node, 1);
+    if (!v)
+        throw exception::value_null();
+    auto pv = std::dynamic_pointer_cast<basic_value_vector<A>>(v);
+    if (!pv)
+        throw exception::value_type();
+    for (auto&& e: pv->cvalue())
+        if (e && !e->mt_safe())
+            throw exception::value_mt_unsafe();
+    return pv;
+}
+
+template <impl::allocator A> typename basic_channel<A>::clock::time_point
+basic_channel<A>::arg_deadline(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node, size_t idx)
+{
+    return impl::deadline_after(this->arg_index(thread, l_vars, node, idx));
+}
+
+template <impl::allocator A>
+size_t basic_channel<A>::arg_max(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 2)
+        throw exception::op_narg();
+    size_t result = this->arg_index(thread, l_vars, node, 1);
+    if (result == 0)
+        throw exception::value_out_of_range();
+    return result;
+}
+
 template <impl::allocator A> basic_channel<A>::value_ptr
 basic_channel<A>::balance(
     typename threadscript::basic_state<A>& thread,
@@ -53,32 +107,115 @@ basic_channel<A>::init_methods()
         //! [methods]
         {"balance", &basic_channel::balance},
         {"recv", &basic_channel::recv},
+        {"recv_for", &basic_channel::recv_for},
+        {"recv_many", &basic_channel::recv_many},
         {"send", &basic_channel::send},
+        {"send_for", &basic_channel::send_for},
+        {"send_many", &basic_channel::send_many},
         {"try_recv", &basic_channel::try_recv},
+        {"try_recv_many", &basic_channel::try_recv_many},
         {"try_send", &basic_channel::try_send},
+        {"try_send_many", &basic_channel::try_send_many},
         //! [methods]
     };
 }
 
-template <impl::allocator A> typename basic_channel<A>::value_ptr
-basic_channel<A>::pop()
+template <impl::allocator A>
+a_basic_vector<typename basic_channel<A>::slot, A>
+basic_channel<A>::init_slots(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
 {
-    auto result = std::move(*it_pop++);
-    if (it_pop == data.end())
-        it_pop = data.begin();
-    if (it_pop == it_push)
-        it_pop = data.end();
-    return result;
+    size_t narg = this->narg(node);
+    if (narg != 1 && narg != 2)
+        throw exception::op_narg();
+    auto c = this->arg_index(thread, l_vars, node, 0);
+    return a_basic_vector<slot, A>(c, thread.get_allocator());
+}
+
+template <impl::allocator A> void basic_channel<A>::notify_recv()
+{
+    // Pairs with the fence in pop_wait(), so that either pop_wait() sees the
+    // pushed value, or this function sees the waiting receiver
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (receivers.load(std::memory_order_relaxed) > 0 ||
+        n_recv_waiters.load(std::memory_order_relaxed) > 0)
+    {
+        // Locking prevents notifying between checking the wait condition and
+        // blocking in pop_wait(). All receivers are notified, because a
+        // single one could find the queue still empty if a push to an earlier
+        // slot has not finished yet, and then this notification would be
+        // lost.
+        std::lock_guard lck{mtx};
+        cond_recv.notify_all();
+        notify_waiters(false);
+    }
+}
+
+template <impl::allocator A> void basic_channel<A>::notify_send()
+{
+    // Pairs with the fence in push_wait(), see notify_recv()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (senders.load(std::memory_order_relaxed) > 0 ||
+        n_send_waiters.load(std::memory_order_relaxed) > 0)
+    {
+        std::lock_guard lck{mtx};
+        cond_send.notify_all();
+        notify_waiters(true);
+    }
+}
+
+template <impl::allocator A> void basic_channel<A>::notify_waiters(bool send)
+{
+    for (auto w: send ? send_waiters : recv_waiters)
+        w->notify();
 }
 
-template <impl::allocator A> void
-basic_channel<A>::push(typename basic_channel::value_ptr&& val)
+template <impl::allocator A>
+bool basic_channel<A>::pop_wait(typename basic_channel::value_ptr& val,
+    const std::optional<clock::time_point>& deadline)
 {
-    if (it_pop == data.end())
-        it_pop = it_push;
-    *it_push++ = std::move(val);
-    if (it_push == data.end())
-        it_push = data.begin();
+    // Spinning does not need the mutex
+    for (size_t i = 0; !try_pop(val); ++i) {
+        if (i >= spin) {
+            std::unique_lock lck{mtx};
+            ++receivers;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto ready = [&]() { return try_pop(val); };
+            bool result = true;
+            if (deadline)
+                result = cond_recv.wait_until(lck, *deadline, ready);
+            else
+                cond_recv.wait(lck, ready);
+            --receivers;
+            return result;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+template <impl::allocator A>
+bool basic_channel<A>::push_wait(typename basic_channel::value_ptr& val,
+    const std::optional<clock::time_point>& deadline)
+{
+    for (size_t i = 0; !try_push(val); ++i) {
+        if (i >= spin) {
+            std::unique_lock lck{mtx};
+            ++senders;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto ready = [&]() { return try_push(val); };
+            bool result = true;
+            if (deadline)
+                result = cond_send.wait_until(lck, *deadline, ready);
+            else
+                cond_send.wait(lck, ready);
+            --senders;
+            return result;
+        }
+        std::this_thread::yield();
+    }
+    return true;
 }
 
 template <impl::allocator A> basic_channel<A>::value_ptr
@@ -90,25 +227,136 @@ basic_channel<A>::recv(
     size_t narg = this->narg(node);
     if (narg != 1)
         throw exception::op_narg();
-    std::unique_lock lck{mtx};
+    typename basic_channel::value_ptr result;
+    if (capacity() == 0)
+        recv_sync(result);
+    else {
+        pop_wait(result);
+        notify_send();
+    }
+    return result;
+}
+
+template <impl::allocator A> basic_channel<A>::value_ptr
+basic_channel<A>::recv_for(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    size_t narg = this->narg(node);
+    if (narg != 2)
+        throw exception::op_narg();
+    auto deadline = arg_deadline(thread, l_vars, node, 1);
+    typename basic_channel::value_ptr result;
     if (capacity() == 0) {
-        ++receivers;
-        cond_send.notify_one();
-        cond_recv.wait(lck, [&]() { return senders > 0 && value; });
-        auto result = std::move(*value);
-        value.reset();
-        --senders;
-        lck.unlock();
-        cond_send.notify_one();
-        return result;
+        if (!recv_sync(result, deadline))
+            throw exception::op_would_block();
     } else {
-        ++receivers;
-        cond_recv.wait(lck, [&]() { return has_data(); });
-        --receivers;
-        auto result = pop();
-        lck.unlock();
-        cond_send.notify_one();
-        return result;
+        if (!pop_wait(result, deadline))
+            throw exception::op_would_block();
+        notify_send();
+    }
+    return result;
+}
+
+template <impl::allocator A> basic_channel<A>::value_ptr
+basic_channel<A>::recv_many(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    size_t max = arg_max(thread, l_vars, node);
+    auto result = basic_value_vector<A>::create(thread.get_allocator());
+    auto& data = result->value();
+    typename basic_channel::value_ptr v;
+    if (capacity() == 0) {
+        recv_sync(v);
+        data.push_back(std::move(v));
+        while (data.size() < max && try_recv_sync(v))
+            data.push_back(std::move(v));
+    } else {
+        pop_wait(v);
+        data.push_back(std::move(v));
+        while (data.size() < max && try_pop(v))
+            data.push_back(std::move(v));
+        notify_send();
+    }
+    return result;
+}
+
+template <impl::allocator A>
+bool basic_channel<A>::recv_sync(typename basic_channel::value_ptr& val,
+    const std::optional<clock::time_point>& deadline)
+{
+    std::unique_lock lck{mtx};
+    ++receivers;
+    cond_send.notify_one();
+    notify_waiters(true);
+    auto ready = [&]() { return senders > 0 && value; };
+    if (!wait_cond(lck, cond_recv, deadline, ready)) {
+        // A sender may have been already matched with this receiver
+        while (!ready()) {
+            if (senders == 0) {
+                --receivers;
+                return false;
+            }
+            cond_recv.wait_for(lck, late_poll);
+        }
+    }
+    val = std::move(*value);
+    value.reset();
+    --senders;
+    lck.unlock();
+    cond_send.notify_one();
+    return true;
+}
+
+template <impl::allocator A>
+void basic_channel<A>::remove_waiter(impl::channel_waiter& w, bool send)
+{
+    std::lock_guard lck{mtx};
+    auto& waiters = send ? send_waiters : recv_waiters;
+    if (auto it = std::find(waiters.begin(), waiters.end(), &w);
+        it != waiters.end())
+    {
+        waiters.erase(it);
+        --(send ? n_send_waiters : n_recv_waiters);
+    }
+}
+
+template <impl::allocator A> std::optional<size_t>
+basic_channel<A>::select(std::span<select_op> ops,
+    const std::optional<impl::channel_waiter::clock::time_point>& deadline)
+{
+    thread_local std::minstd_rand random{std::random_device{}()};
+    impl::channel_waiter waiter;
+    bool registered = false;
+    finally unregister{[&]() noexcept {
+        if (registered)
+            for (auto&& op: ops)
+                op.channel->remove_waiter(waiter, op.send);
+    }};
+    for (;;) {
+        // Start at a random operation, so that all ready operations have
+        // the same chance to be selected
+        size_t start = ops.empty() ? 0 : random() % ops.size();
+        for (size_t i = 0; i < ops.size(); ++i) {
+            size_t idx = (start + i) % ops.size();
+            if (ops[idx].channel->try_select_op(ops[idx]))
+                return idx;
+        }
+        if (registered) {
+            if (!waiter.wait(deadline))
+                return std::nullopt;
+        } else {
+            // Register and try again before the first wait, because an
+            // operation may have become ready before registration. The fence
+            // pairs with the fences in notify_recv() and notify_send().
+            for (auto&& op: ops)
+                op.channel->add_waiter(waiter, op.send);
+            registered = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
     }
 }
 
@@ -124,26 +372,139 @@ basic_channel<A>::send(
     auto v = this->arg(thread, l_vars, node, 1);
     if (v && !v->mt_safe())
         throw exception::value_mt_unsafe();
-    std::unique_lock lck{mtx};
+    if (capacity() == 0)
+        send_sync(v);
+    else {
+        push_wait(v);
+        notify_recv();
+    }
+    return nullptr;
+}
+
+template <impl::allocator A> basic_channel<A>::value_ptr
+basic_channel<A>::send_for(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    size_t narg = this->narg(node);
+    if (narg != 3)
+        throw exception::op_narg();
+    auto v = this->arg(thread, l_vars, node, 1);
+    if (v && !v->mt_safe())
+        throw exception::value_mt_unsafe();
+    auto deadline = arg_deadline(thread, l_vars, node, 2);
     if (capacity() == 0) {
-        ++senders;
-        cond_recv.notify_one();
-        cond_send.wait(lck, [&]() { return receivers > 0 && !value; });
-        value = std::move(v);
-        --receivers;
-        lck.unlock();
-        cond_recv.notify_one();
+        if (!send_sync(v, deadline))
+            throw exception::op_would_block();
     } else {
-        ++senders;
-        cond_send.wait(lck, [&]() { return has_space(); });
-        --senders;
-        push(std::move(v));
-        lck.unlock();
-        cond_recv.notify_one();
+        if (!push_wait(v, deadline))
+            throw exception::op_would_block();
+        notify_recv();
     }
     return nullptr;
 }
 
+template <impl::allocator A> basic_channel<A>::value_ptr
+basic_channel<A>::send_many(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    auto values = arg_messages(thread, l_vars, node);
+    if (capacity() == 0) {
+        for (auto&& e: values->cvalue()) {
+            typename basic_channel::value_ptr v = e;
+            send_sync(v);
+        }
+    } else {
+        for (auto&& e: values->cvalue()) {
+            typename basic_channel::value_ptr v = e;
+            if (!try_push(v)) {
+                // Let receivers empty the full queue before waiting
+                notify_recv();
+                push_wait(v);
+            }
+        }
+        notify_recv();
+    }
+    return nullptr;
+}
+
+template <impl::allocator A>
+bool basic_channel<A>::send_sync(typename basic_channel::value_ptr& val,
+    const std::optional<clock::time_point>& deadline)
+{
+    std::unique_lock lck{mtx};
+    ++senders;
+    cond_recv.notify_one();
+    notify_waiters(false);
+    auto ready = [&]() { return receivers > 0 && !value; };
+    if (!wait_cond(lck, cond_send, deadline, ready)) {
+        // A receiver may have been already matched with this sender
+        while (!ready()) {
+            if (receivers == 0) {
+                --senders;
+                return false;
+            }
+            cond_send.wait_for(lck, late_poll);
+        }
+    }
+    value = std::move(val);
+    --receivers;
+    lck.unlock();
+    cond_recv.notify_one();
+    return true;
+}
+
+template <impl::allocator A>
+bool basic_channel<A>::try_pop(typename basic_channel::value_ptr& val)
+{
+    size_t pos = pos_pop.load(std::memory_order_relaxed);
+    for (;;) {
+        slot& s = slots[pos % capacity()];
+        size_t turn = 2 * (pos / capacity());
+        size_t seq = s.seq.load(std::memory_order_acquire);
+        auto diff = std::make_signed_t<size_t>(seq - (turn + 1));
+        if (diff == 0) {
+            if (pos_pop.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed))
+            {
+                val = std::move(s.val);
+                s.seq.store(turn + 2, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0)
+            return false; // the slot has not been pushed yet
+        else
+            pos = pos_pop.load(std::memory_order_relaxed);
+    }
+}
+
+template <impl::allocator A>
+bool basic_channel<A>::try_push(typename basic_channel::value_ptr& val)
+{
+    size_t pos = pos_push.load(std::memory_order_relaxed);
+    for (;;) {
+        slot& s = slots[pos % capacity()];
+        size_t turn = 2 * (pos / capacity());
+        size_t seq = s.seq.load(std::memory_order_acquire);
+        auto diff = std::make_signed_t<size_t>(seq - turn);
+        if (diff == 0) {
+            if (pos_push.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed))
+            {
+                s.val = std::move(val);
+                s.seq.store(turn + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0)
+            return false; // the slot has not been popped yet
+        else
+            pos = pos_push.load(std::memory_order_relaxed);
+    }
+}
+
 template <impl::allocator A> basic_channel<A>::value_ptr
 basic_channel<A>::try_recv(
     typename threadscript::basic_state<A>&,
@@ -153,27 +514,81 @@ basic_channel<A>::try_recv(
     size_t narg = this->narg(node);
     if (narg != 1)
         throw exception::op_narg();
-    std::unique_lock lck{mtx};
+    typename basic_channel::value_ptr result;
     if (capacity() == 0) {
-        if (senders == 0)
+        if (!try_recv_sync(result))
             throw exception::op_would_block();
-        ++receivers;
-        --senders;
-        cond_send.notify_one();
-        cond_recv.wait(lck, [&]() { return bool(value); });
-        auto result = std::move(*value);
-        value.reset();
-        lck.unlock();
-        cond_send.notify_one();
-        return result;
     } else {
-        if (!has_data())
+        if (!try_pop(result))
             throw exception::op_would_block();
-        auto result = pop();
-        lck.unlock();
-        cond_send.notify_one();
-        return result;
+        notify_send();
+    }
+    return result;
+}
+
+template <impl::allocator A> basic_channel<A>::value_ptr
+basic_channel<A>::try_recv_many(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    size_t max = arg_max(thread, l_vars, node);
+    auto result = basic_value_vector<A>::create(thread.get_allocator());
+    auto& data = result->value();
+    typename basic_channel::value_ptr v;
+    if (capacity() == 0) {
+        while (data.size() < max && try_recv_sync(v))
+            data.push_back(std::move(v));
+    } else {
+        while (data.size() < max && try_pop(v))
+            data.push_back(std::move(v));
+        if (!data.empty())
+            notify_send();
+    }
+    if (data.empty())
+        throw exception::op_would_block();
+    return result;
+}
+
+template <impl::allocator A>
+bool basic_channel<A>::try_recv_sync(typename basic_channel::value_ptr& val)
+{
+    std::unique_lock lck{mtx};
+    if (senders == 0)
+        return false;
+    ++receivers;
+    --senders;
+    cond_send.notify_one();
+    cond_recv.wait(lck, [&]() { return bool(value); });
+    val = std::move(*value);
+    value.reset();
+    lck.unlock();
+    cond_send.notify_one();
+    return true;
+}
+
+template <impl::allocator A>
+bool basic_channel<A>::try_select_op(select_op& op)
+{
+    if (op.send) {
+        if (capacity() == 0)
+            return try_send_sync(op.val);
+        if (!try_push(op.val))
+            return false;
+        notify_recv();
+    } else {
+        typename basic_channel::value_ptr v;
+        if (capacity() == 0) {
+            if (!try_recv_sync(v))
+                return false;
+        } else {
+            if (!try_pop(v))
+                return false;
+            notify_send();
+        }
+        op.val = std::move(v);
     }
+    return true;
 }
 
 template <impl::allocator A> basic_channel<A>::value_ptr
@@ -188,25 +603,70 @@ basic_channel<A>::try_send(
     auto v = this->arg(thread, l_vars, node, 1);
     if (v && !v->mt_safe())
         throw exception::value_mt_unsafe();
-    std::unique_lock lck{mtx};
     if (capacity() == 0) {
-        if (receivers == 0)
+        if (!try_send_sync(v))
             throw exception::op_would_block();
-        ++senders;
-        --receivers;
-        cond_recv.notify_one();
-        cond_send.wait(lck, [&]() { return !value; });
-        value = std::move(v);
-        lck.unlock();
-        cond_recv.notify_one();
     } else {
-        if (!has_space())
+        if (!try_push(v))
             throw exception::op_would_block();
-        push(std::move(v));
-        lck.unlock();
-        cond_recv.notify_one();
+        notify_recv();
     }
     return nullptr;
 }
 
+template <impl::allocator A> basic_channel<A>::value_ptr
+basic_channel<A>::try_send_many(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    auto values = arg_messages(thread, l_vars, node);
+    auto& data = values->cvalue();
+    size_t n = 0;
+    for (; n < data.size(); ++n) {
+        typename basic_channel::value_ptr v = data[n];
+        if (!(capacity() == 0 ? try_send_sync(v) : try_push(v)))
+            break;
+    }
+    if (capacity() != 0 && n > 0)
+        notify_recv();
+    if (n == 0 && !data.empty())
+        throw exception::op_would_block();
+    auto result = basic_value_unsigned<A>::create(thread.get_allocator());
+    result->value() = n;
+    return result;
+}
+
+template <impl::allocator A>
+bool basic_channel<A>::try_send_sync(typename basic_channel::value_ptr& val)
+{
+    std::unique_lock lck{mtx};
+    if (receivers == 0)
+        return false;
+    ++senders;
+    --receivers;
+    cond_recv.notify_one();
+    cond_send.wait(lck, [&]() { return !value; });
+    value = std::move(val);
+    lck.unlock();
+    cond_recv.notify_one();
+    return true;
+}
+
+template <impl::allocator A> template <class P>
+bool basic_channel<A>::wait_cond(std::unique_lock<std::mutex>& lck,
+    impl::green_cond& cond,
+    const std::optional<clock::time_point>& deadline, P pred)
+{
+    for (size_t i = 0; i < spin && !pred(); ++i) {
+        lck.unlock();
+        std::this_thread::yield();
+        lck.lock();
+    }
+    if (deadline)
+        return cond.wait_until(lck, *deadline, pred);
+    cond.wait(lck, pred);
+    return true;
+}
+
 } // namespace threadscript
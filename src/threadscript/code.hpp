@@ -11,11 +11,16 @@
 
 namespace threadscript {
 
+template <impl::allocator A> class basic_module_registry;
 template <impl::allocator A> class basic_script;
 template <impl::allocator A> class basic_value_script;
 template <impl::allocator A> class basic_value_function;
 template <class Derived, impl::allocator A> class basic_value_native_fun;
 
+namespace impl {
+template <allocator A> class script_writer;
+} // namespace impl
+
 //! A single node in a tree representing a parsed script
 /*! \tparam A the allocator type
  * \threadsafe{safe, unsafe}
@@ -148,6 +153,10 @@ private:
     friend class basic_value_function<A>;
     //! basic_value needs access to _children
     template <impl::allocator Alloc> friend class basic_value;
+    //! Serialization needs access to node internals
+    friend class impl::script_writer<A>;
+    //! Looking for imported modules needs access to node internals
+    friend class basic_module_registry<A>;
 };
 
 //! Writes a textual description of the node to a stream
@@ -276,6 +285,10 @@ private:
     friend std::ostream& operator<< <A>(std::ostream&, const basic_script<A>&);
     //! basic_value_script needs access to _root
     friend class basic_value_script<A>;
+    //! Serialization needs access to _root
+    friend class impl::script_writer<A>;
+    //! Looking for imported modules needs access to _root
+    friend class basic_module_registry<A>;
 };
 
 namespace impl {
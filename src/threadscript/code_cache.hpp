@@ -0,0 +1,207 @@
+#pragma once
+
+/*! \file
+ * \brief A binary representation of parsed scripts and a cache of parsed
+ * script files
+ *
+ * A script file is usually parsed every time it is loaded. Parsing of a large
+ * script can be avoided by storing its parsed representation (a tree of
+ * basic_code_node objects) in a binary form in a cache directory. The binary
+ * form is identified by a key computed from the script source, the syntax
+ * variant, and the ThreadScript version. Hence a cache entry is automatically
+ * ignored if the script or the parser changes.
+ *
+ * The binary format of a script consists of:
+ * \arg the magic string code_cache::magic
+ * \arg the format version code_cache::format_version
+ * \arg the key returned by code_cache::key()
+ * \arg the number of root nodes (0 or 1)
+ * \arg nodes in preorder, each containing a line, a column, a name, a value,
+ * and the number of child nodes
+ *
+ * All integers are stored as variable-length unsigned numbers (7 bits per
+ * byte, least significant first), signed integers are zigzag encoded. A string
+ * is stored as its length followed by its characters. A value is stored as a
+ * code_cache::value_tag, followed by the value for an integer or a string.
+ *
+ * \test in file test_code_cache.cpp
+ */
+
+#include "threadscript/code.hpp"
+#include "threadscript/code_builder.hpp"
+#include "threadscript/syntax.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace threadscript {
+
+//! Functions for storing parsed scripts in a binary form
+/*! It contains the parts of the implementation that do not depend on an
+ * allocator. Public interface is provided by function templates
+ * serialize_script(), deserialize_script(), and parse_code_file_cached(). */
+class code_cache {
+public:
+    //! The type of a key of a stored script
+    using key_t = uint64_t;
+    //! The first bytes of any stored script
+    static constexpr std::string_view magic{"TSCC"};
+    //! The version of the binary format
+    /*! It must be incremented by any incompatible change of the format. */
+    static constexpr unsigned format_version = 1;
+    //! The suffix of file names in a cache directory
+    static constexpr std::string_view file_suffix{".tsc"};
+    //! Types of node values stored in the binary form
+    enum class value_tag: unsigned char {
+        none = 0, //!< \c std::nullopt
+        null = 1, //!< \c nullptr
+        false_ = 2, //!< basic_value_bool containing \c false
+        true_ = 3, //!< basic_value_bool containing \c true
+        int_ = 4, //!< basic_value_int
+        unsigned_ = 5, //!< basic_value_unsigned
+        string = 6, //!< basic_value_string
+    };
+    //! Computes a key of a script.
+    /*! The key is a 64-bit FNV-1a hash of format_version,
+     * threadscript::version, the sizes of script integer types, \a syntax,
+     * and \a src.
+     * \param[in] src the source code of a script
+     * \param[in] syntax the syntax variant of the script
+     * \return the key */
+    [[nodiscard]] static key_t key(std::string_view src,
+                                   std::string_view syntax);
+    //! Gets the name of a cache file.
+    /*! \param[in] dir a cache directory
+     * \param[in] key a key of a script
+     * \return the name of a file in \a dir that stores the script identified
+     * by \a key */
+    [[nodiscard]] static std::string path(std::string_view dir, key_t key);
+    //! Rebuilds a script from its binary form.
+    /*! It calls script_builder::create_script() and then it adds all nodes to
+     * the created script. String values reference \a data directly, without
+     * intermediate copies.
+     * \param[in,out] builder a builder object used to create the script; if
+     * this function returns \c false, the builder should be discarded
+     * \param[in] data the binary form of a script
+     * \param[in] key the expected key of the script
+     * \param[in] file the file name stored in the created script
+     * \return \c true if successful, \c false if \a data is not a valid
+     * binary form of a script or the stored key is not equal to \a key */
+    static bool load(script_builder& builder, std::string_view data,
+                     key_t key, std::string_view file);
+    //! Reads a whole cache file.
+    /*! \param[in] file a file name
+     * \return the file content; \c std::nullopt if the file cannot be read */
+    [[nodiscard]] static std::optional<std::string>
+    read_cache(std::string_view file) noexcept;
+    //! Writes a cache file.
+    /*! The content is written to a temporary file, which is then renamed to \a
+     * file. Therefore, a concurrent reader of the same file sees either the
+     * old or the new content. The directory of \a file is created if it does
+     * not exist.
+     * \param[in] file a file name
+     * \param[in] data the data to be written
+     * \return \c true if successful, \c false if writing failed */
+    static bool write_cache(std::string_view file,
+                            std::string_view data) noexcept;
+    //! Appends an encoded unsigned integer.
+    /*! \param[in,out] out the output buffer
+     * \param[in] v the value to be stored */
+    static void put_uint(std::string& out, uint64_t v);
+    //! Appends an encoded signed integer.
+    /*! \param[in,out] out the output buffer
+     * \param[in] v the value to be stored */
+    static void put_int(std::string& out, int64_t v);
+    //! Appends an encoded string.
+    /*! \param[in,out] out the output buffer
+     * \param[in] v the value to be stored */
+    static void put_string(std::string& out, std::string_view v);
+    //! Appends the header of a stored script.
+    /*! \param[in,out] out the output buffer
+     * \param[in] key the key of the script */
+    static void put_header(std::string& out, key_t key);
+};
+
+namespace impl {
+
+//! Converts scripts to the binary form
+/*! It is a separate class, so that it can be declared as a friend of
+ * basic_code_node and basic_script.
+ * \tparam A an allocator type */
+template <allocator A> class script_writer {
+public:
+    //! Converts a script to the binary form.
+    /*! \param[in] script a script
+     * \param[in] key the key of the script
+     * \return the binary form of \a script
+     * \throw exception::value_type if the script contains a node without a
+     * name, with a value not created by a parser */
+    static std::string write(const basic_script<A>& script,
+                             code_cache::key_t key);
+private:
+    //! Converts a node and its descendants.
+    /*! \param[in,out] out the output buffer
+     * \param[in] node the node */
+    static void write_node(std::string& out, const basic_code_node<A>& node);
+};
+
+} // namespace impl
+
+//! Converts a script to the binary form.
+/*! Values of nodes with nonempty names are not stored, because they are
+ * results of basic_script::resolve(). Hence, a resolved script is stored as if
+ * it were unresolved.
+ * \tparam A the allocator type
+ * \param[in] script a script
+ * \param[in] key the key of the script, usually computed by code_cache::key()
+ * from the script source
+ * \return the binary form of \a script
+ * \throw exception::value_type if the script contains a node without a name,
+ * with a value that is not \c null, \c bool, \c int, \c unsigned, or \c string
+ */
+template <impl::allocator A>
+std::string serialize_script(const basic_script<A>& script,
+                             code_cache::key_t key)
+{
+    return impl::script_writer<A>::write(script, key);
+}
+
+//! Rebuilds a script from the binary form.
+/*! \tparam A the allocator type
+ * \param[in] alloc the allocator used to allocate the returned script
+ * \param[in] data the binary form of a script created by serialize_script()
+ * \param[in] key the expected key of the script
+ * \param[in] file a file name, which will be stored in the internal
+ * representation of the script
+ * \return the internal representation of the script; \c nullptr if \a data is
+ * not a valid binary form or the stored key is not \a key */
+template <impl::allocator A> basic_script<A>::script_ptr
+deserialize_script(const A& alloc, std::string_view data,
+                   code_cache::key_t key, std::string_view file);
+
+//! Parses a script file, using a cache of parsed scripts
+/*! If the cache contains the script, it is loaded from the cache and not
+ * parsed. Otherwise, the script is parsed and stored into the cache. Any
+ * errors of accessing the cache are ignored, that is, the script is parsed if
+ * it cannot be read from the cache, and it is not stored if it cannot be
+ * written to the cache.
+ * \tparam A the allocator type
+ * \param[in] alloc the allocator used to allocate the returned parsed script
+ * \param[in] file the file name
+ * \param[in] cache_dir the cache directory; it is created if it does not
+ * exist
+ * \param[in] syntax the syntax variant of the script
+ * \param[in] trace an optional tracing function, used only if the script is
+ * parsed
+ * \return the internal representation of the parsed script; never \c nullptr
+ * \throw exception::parse_error if parsing fails
+ * \throw std::ios_base::failure if reading of \a file fails */
+template <impl::allocator A> basic_script<A>::script_ptr
+parse_code_file_cached(const A& alloc, std::string_view file,
+                       std::string_view cache_dir,
+                       std::string_view syntax = syntax_factory::syntax_canon,
+                       parser::context::trace_t trace = {});
+
+} // namespace threadscript
@@ -0,0 +1,95 @@
+#pragma once
+
+/*! \file
+ * \brief The implementation part of threadscript/code_cache.hpp
+ */
+
+#include "threadscript/code_cache.hpp"
+#include "threadscript/code_parser_impl.hpp"
+#include "threadscript/source_file.hpp"
+
+namespace threadscript {
+
+/*** impl::script_writer *****************************************************/
+
+namespace impl {
+
+template <allocator A>
+std::string script_writer<A>::write(const basic_script<A>& script,
+                                    code_cache::key_t key)
+{
+    std::string out;
+    code_cache::put_header(out, key);
+    code_cache::put_uint(out, script._root ? 1 : 0);
+    if (script._root)
+        write_node(out, *script._root);
+    return out;
+}
+
+template <allocator A>
+void script_writer<A>::write_node(std::string& out,
+                                  const basic_code_node<A>& node)
+{
+    using tag = code_cache::value_tag;
+    code_cache::put_uint(out, node.location.line);
+    code_cache::put_uint(out, node.location.column);
+    code_cache::put_string(out, node.name);
+    // A value of a named node is the result of name resolution
+    if (!node.value || !node.name.empty())
+        out.push_back(char(tag::none));
+    else if (!*node.value)
+        out.push_back(char(tag::null));
+    else if (auto pb = dynamic_cast<basic_value_bool<A>*>(node.value->get()))
+        out.push_back(char(pb->cvalue() ? tag::true_ : tag::false_));
+    else if (auto pi = dynamic_cast<basic_value_int<A>*>(node.value->get())) {
+        out.push_back(char(tag::int_));
+        code_cache::put_int(out, pi->cvalue());
+    } else if (auto pu =
+               dynamic_cast<basic_value_unsigned<A>*>(node.value->get()))
+    {
+        out.push_back(char(tag::unsigned_));
+        code_cache::put_uint(out, pu->cvalue());
+    } else if (auto ps =
+               dynamic_cast<basic_value_string<A>*>(node.value->get()))
+    {
+        out.push_back(char(tag::string));
+        code_cache::put_string(out, ps->cvalue());
+    } else
+        throw exception::value_type();
+    code_cache::put_uint(out, node._children.size());
+    for (auto&& c: node._children)
+        write_node(out, *c);
+}
+
+} // namespace impl
+
+/*** functions ***************************************************************/
+
+template <impl::allocator A> basic_script<A>::script_ptr
+deserialize_script(const A& alloc, std::string_view data,
+                   code_cache::key_t key, std::string_view file)
+{
+    basic_script_builder_impl<A> builder(alloc);
+    if (!code_cache::load(builder, data, key, file))
+        return nullptr;
+    return builder.get_script();
+}
+
+template <impl::allocator A> basic_script<A>::script_ptr
+parse_code_file_cached(const A& alloc, std::string_view file,
+                       std::string_view cache_dir, std::string_view syntax,
+                       parser::context::trace_t trace)
+{
+    source_file src{file};
+    auto key = code_cache::key(src.view(), syntax);
+    auto path = code_cache::path(cache_dir, key);
+    if (auto data = code_cache::read_cache(path))
+        if (auto script = deserialize_script(alloc, *data, key, file))
+            return script;
+    auto script = parse_code(alloc, src.view(), file, syntax,
+                             std::move(trace));
+    code_cache::write_cache(path, serialize_script(*script, key));
+    return script;
+}
+
+} // namespace threadscript
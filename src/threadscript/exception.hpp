@@ -615,6 +615,33 @@ public:
     }
 };
 
+//! A module imports itself, directly or indirectly.
+/*! It is thrown by basic_module_registry::import() if a module is imported
+ * while it is being loaded. */
+class op_import_cycle: public operation {
+public:
+    //! Stores an error message.
+    /*! \param[in] trace a stack trace */
+    explicit op_import_cycle(stack_trace trace = {}):
+        operation("Import cycle", std::move(trace)) {}
+    [[nodiscard]] std::string_view type() const noexcept override {
+        return "op_import_cycle";
+    }
+};
+
+//! A module file does not exist in the module search path.
+/*! It is thrown by basic_module_registry::import(). */
+class op_import_not_found: public operation {
+public:
+    //! Stores an error message.
+    /*! \param[in] trace a stack trace */
+    explicit op_import_not_found(stack_trace trace = {}):
+        operation("Module not found", std::move(trace)) {}
+    [[nodiscard]] std::string_view type() const noexcept override {
+        return "op_import_not_found";
+    }
+};
+
 //! A failed call to an OS or library function.
 /*! It is used if there is no more specific exception class. */
 class op_library: public operation {
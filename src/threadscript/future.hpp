@@ -0,0 +1,177 @@
+#pragma once
+
+/*! \file
+ * \brief A result of a task executed by a task pool
+ */
+
+#include "threadscript/code.hpp"
+#include "threadscript/task_pool.hpp"
+#include "threadscript/vm_data.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <mutex>
+
+namespace threadscript {
+
+template <impl::allocator A> class basic_future;
+
+namespace impl {
+//! The name of future
+inline constexpr char name_future[] = "future";
+//! The base class of basic_future
+/*! \tparam A an allocator type */
+template <allocator A> using basic_future_base =
+    basic_value_object<basic_future<A>, name_future, A>;
+} // namespace impl
+
+//! A result of a function executed asynchronously by a task pool
+/*! An object of this class is created by function \c spawn (implemented by
+ * predef::f_spawn), which calls a script function in a thread of the
+ * basic_task_pool of the virtual machine. The object is mt-safe, so that it
+ * can be passed to other threads. Any thread can wait for the result of the
+ * function and get it by method get(). The function result is made mt-safe,
+ * as if by function \c mt_safe. If the function throws an exception, method
+ * get() rethrows it.
+ *
+ * The function runs in a green thread of the task pool. If it blocks, e.g.,
+ * in get() of another future or in a channel operation, the green thread is
+ * suspended and the pool thread executes other tasks in the meantime.
+ * Therefore, tasks can spawn and wait for subtasks, or communicate via
+ * channels, without blocking all pool threads. If get() is called by a task
+ * not running in a green thread, it executes other pending tasks while
+ * waiting.
+ *
+ * Objects of this class cannot be created by a constructor called from
+ * a script.
+ *
+ * Methods:
+ * \snippet future_impl.hpp methods
+ * \tparam A an allocator type
+ * \threadsafe{safe,safe}
+ * \test in file test_future.cpp */
+template <impl::allocator A>
+class basic_future final: public impl::basic_future_base<A>,
+    public basic_task_pool<A>::task
+{
+public:
+    //! Creates the future object.
+    /*! It marks the object mt-safe. The task is not submitted to the pool
+     * by the constructor, but by spawn().
+     * \param[in] t an ignored parameter that prevents using this
+     * \param[in] methods the mapping from method names to implementations
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with arguments:
+     *     \arg \c fun the name of the called function, of type \c string
+     *     \arg \c args (0 or more) arguments passed to the function; they
+     *     must be mt-safe
+     * \throw exception::op_narg if the number of arguments is 0
+     * \throw exception::value_null if \a fun is \c null
+     * \throw exception::value_type if \a fun is not a \c string, or if it is
+     * not a name of a function
+     * \throw exception::unknown_symbol if function \a fun does not exist
+     * \throw exception::value_mt_unsafe if any of \a args is not mt-safe */
+    basic_future(typename basic_future::tag t,
+        std::shared_ptr<const typename basic_future::method_table> methods,
+        typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node);
+    //! \copydoc basic_value_object::init_methods()
+    [[nodiscard]] static
+    typename basic_future::method_table init_methods();
+    //! Creates a future object and submits it to the task pool.
+    /*! It is used by predef::f_spawn.
+     * \param[in] methods the mapping from method names to implementations
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with arguments as in the constructor
+     * \return the created object
+     * \throw as the constructor */
+    static std::shared_ptr<basic_future>
+    spawn(std::shared_ptr<const typename basic_future::method_table> methods,
+          typename threadscript::basic_state<A>& thread,
+          typename threadscript::basic_symbol_table<A>& l_vars,
+          const typename threadscript::basic_code_node<A>& node);
+    //! Executes the function and stores its result.
+    /*! The function runs with basic_state::max_stack of the thread that
+     * created this future.
+     * \param[in] thread the state of the pool thread executing the task */
+    void run(basic_state<A>& thread) noexcept override;
+    //! The function is executed in a green thread.
+    /*! \return \c true */
+    bool green() const noexcept override {
+        return true;
+    }
+private:
+    //! Waits for and gets the result in the blocking mode.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     * \return the result of the function
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 1
+     * \throw any exception thrown by the function */
+    typename basic_future::value_ptr
+    get(typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node);
+    //! Checks if the result is available.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     * \return a \c bool value, \c true if get() would not block
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 1 */
+    typename basic_future::value_ptr
+    ready(typename threadscript::basic_state<A>& thread,
+          typename threadscript::basic_symbol_table<A>& l_vars,
+          const typename threadscript::basic_code_node<A>& node);
+    //! Gets the result in the nonblocking mode.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     * \return the result of the function
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 1
+     * \throw exception::op_would_block if the result is not available yet
+     * \throw any exception thrown by the function */
+    typename basic_future::value_ptr
+    try_get(typename threadscript::basic_state<A>& thread,
+            typename threadscript::basic_symbol_table<A>& l_vars,
+            const typename threadscript::basic_code_node<A>& node);
+    //! Gets the stored result or rethrows the stored exception.
+    /*! It must be called only if \ref done is \c true.
+     * \return \ref result */
+    typename basic_future::value_ptr result_or_throw() const;
+    //! A polling period of get() waiting in a pool thread
+    /*! It limits the time for noticing a task submitted while waiting for
+     * \ref cond. */
+    static constexpr std::chrono::milliseconds help_poll{1};
+    //! The called function, released after the call
+    std::shared_ptr<basic_value_function<A>> fun;
+    //! The name used for calling \ref fun
+    a_basic_string<A> fun_name;
+    //! Arguments of \ref fun, released after the call
+    std::shared_ptr<basic_value_vector<A>> args;
+    //! basic_state::max_stack used for calling \ref fun
+    size_t max_stack;
+    //! The task pool executing the function
+    basic_task_pool<A>* pool = nullptr;
+    //! The result of the function
+    typename basic_future::value_ptr result;
+    //! The exception thrown by the function
+    std::exception_ptr exc;
+    //! Whether \ref result or \ref exc is set
+    std::atomic<bool> done = false;
+    //! The mutex used for waiting for \ref done
+    std::mutex mtx;
+    //! Used to wait for \ref done
+    impl::green_cond cond;
+};
+
+} // namespace threadscript
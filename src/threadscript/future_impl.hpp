@@ -0,0 +1,178 @@
+#pragma once
+
+/*! \file
+ * \brief The implementation part of future.hpp
+ */
+
+#include "threadscript/future.hpp"
+#include "threadscript/task_pool_impl.hpp"
+
+namespace threadscript {
+
+template <impl::allocator A>
+basic_future<A>::basic_future(
+        typename basic_future<A>::tag,
+        std::shared_ptr<const typename basic_future<A>::method_table>
+            methods,
+        typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node):
+    impl::basic_future_base<A>(typename basic_future::tag_args{}, methods,
+                               thread, l_vars, node),
+    fun_name(thread.get_allocator()), max_stack(thread.max_stack)
+{
+    size_t narg = this->narg(node);
+    if (narg < 1)
+        throw exception::op_narg();
+    auto a0 = this->arg(thread, l_vars, node, 0);
+    if (!a0)
+        throw exception::value_null();
+    auto name = dynamic_cast<basic_value_string<A>*>(a0.get());
+    if (!name)
+        throw exception::value_type();
+    auto f = l_vars.lookup(name->cvalue());
+    if (!f)
+        throw exception::unknown_symbol(name->cvalue());
+    fun = std::dynamic_pointer_cast<basic_value_function<A>>(*f);
+    if (!fun)
+        throw exception::value_type();
+    fun_name = name->cvalue();
+    args = basic_value_vector<A>::create(thread.get_allocator());
+    args->value().reserve(narg - 1);
+    for (size_t i = 1; i < narg; ++i) {
+        auto v = this->arg(thread, l_vars, node, i);
+        if (v && !v->mt_safe())
+            throw exception::value_mt_unsafe();
+        args->value().push_back(std::move(v));
+    }
+    this->set_mt_safe();
+}
+
+template <impl::allocator A> basic_future<A>::value_ptr
+basic_future<A>::get(
+    typename threadscript::basic_state<A>&,
+    typename threadscript::basic_symbol_table<A>&,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 1)
+        throw exception::op_narg();
+    if (impl::green_thread::current()) {
+        // A green thread is suspended without blocking the pool thread
+        std::unique_lock lck{mtx};
+        cond.wait(lck, [this]() {
+            return done.load(std::memory_order_acquire);
+        });
+    } else if (pool->in_pool()) {
+        // Help executing tasks, because all pool threads may be waiting
+        while (!done.load(std::memory_order_acquire))
+            if (!pool->run_one()) {
+                std::unique_lock lck{mtx};
+                cond.wait_until(lck, impl::green_cond::clock::now() +
+                                help_poll, [this]() {
+                    return done.load(std::memory_order_acquire);
+                });
+            }
+    } else if (!done.load(std::memory_order_acquire)) {
+        std::unique_lock lck{mtx};
+        cond.wait(lck, [this]() {
+            return done.load(std::memory_order_acquire);
+        });
+    }
+    return result_or_throw();
+}
+
+template <impl::allocator A>
+auto basic_future<A>::init_methods() -> typename basic_future::method_table
+{
+    return {
+        //! [methods]
+        {"get", &basic_future::get},
+        {"ready", &basic_future::ready},
+        {"try_get", &basic_future::try_get},
+        //! [methods]
+    };
+}
+
+template <impl::allocator A> basic_future<A>::value_ptr
+basic_future<A>::ready(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>&,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 1)
+        throw exception::op_narg();
+    auto result = basic_value_bool<A>::create(thread.get_allocator());
+    result->value() = done.load(std::memory_order_acquire);
+    return result;
+}
+
+template <impl::allocator A>
+auto basic_future<A>::result_or_throw() const ->
+    typename basic_future::value_ptr
+{
+    assert(done);
+    if (exc)
+        std::rethrow_exception(exc);
+    return result;
+}
+
+template <impl::allocator A>
+void basic_future<A>::run(basic_state<A>& thread) noexcept
+{
+    size_t saved = thread.max_stack;
+    thread.max_stack = max_stack;
+    try {
+        auto r = fun->call(thread, fun_name, std::move(args));
+        if (r)
+            try {
+                r->set_mt_safe();
+            } catch (exception::value_mt_unsafe&) {
+                // The stack trace must not be empty, otherwise it would be
+                // set by each thread rethrowing the exception from get()
+                throw exception::value_mt_unsafe(
+                                        stack_trace{frame_location(fun_name)});
+            }
+        result = std::move(r);
+    } catch (...) {
+        exc = std::current_exception();
+    }
+    thread.max_stack = saved;
+    fun.reset();
+    args.reset();
+    {
+        std::lock_guard lck{mtx};
+        done.store(true, std::memory_order_release);
+    }
+    cond.notify_all();
+}
+
+template <impl::allocator A> std::shared_ptr<basic_future<A>>
+basic_future<A>::spawn(
+    std::shared_ptr<const typename basic_future::method_table> methods,
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    auto f = std::allocate_shared<basic_future>(thread.get_allocator(),
+                                                typename basic_future::tag{},
+                                                std::move(methods), thread,
+                                                l_vars, node);
+    f->pool = &basic_task_pool<A>::get(thread.vm);
+    f->pool->submit(f);
+    return f;
+}
+
+template <impl::allocator A> basic_future<A>::value_ptr
+basic_future<A>::try_get(
+    typename threadscript::basic_state<A>&,
+    typename threadscript::basic_symbol_table<A>&,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 1)
+        throw exception::op_narg();
+    if (!done.load(std::memory_order_acquire))
+        throw exception::op_would_block();
+    return result_or_throw();
+}
+
+} // namespace threadscript
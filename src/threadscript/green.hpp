@@ -0,0 +1,232 @@
+#pragma once
+
+/*! \file
+ * \brief Green threads (fibers) and a condition variable usable by both OS
+ * threads and green threads
+ */
+
+#include <boost/context/fiber.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace threadscript::impl {
+
+//! A green thread, that is, a fiber with its own stack
+/*! A green thread is executed by a scheduler running in an OS thread, see
+ * basic_task_pool. It runs until it finishes or suspends itself by suspend().
+ * A suspended green thread does not block the OS thread, which can run other
+ * green threads in the meantime. A suspended green thread is made runnable
+ * again by wake(), which calls schedule(). A green thread must be always
+ * resumed by the same OS thread, because code running in it may use
+ * thread-local variables.
+ * \threadsafe{safe,unsafe}; only wake() may be called by any thread */
+class green_thread {
+public:
+    //! The clock used for timeouts
+    using clock = std::chrono::steady_clock;
+    //! Creates a green thread, which does not start running.
+    /*! \param[in] stack_size the size of the stack of the green thread */
+    explicit green_thread(size_t stack_size);
+    //! No copying
+    green_thread(const green_thread&) = delete;
+    //! No moving
+    green_thread(green_thread&&) = delete;
+    //! Virtual destructor, because objects are deleted via this class
+    virtual ~green_thread() = default;
+    //! No copying
+    green_thread& operator=(const green_thread&) = delete;
+    //! No moving
+    green_thread& operator=(green_thread&&) = delete;
+    //! Gets the green thread running in the current OS thread.
+    /*! \return the current green thread, \c nullptr if not called from a
+     * green thread */
+    [[nodiscard]] static green_thread* current() noexcept {
+        return _current;
+    }
+    //! Runs the green thread until it suspends itself or finishes.
+    /*! It is called by the scheduler. If the green thread has been suspended,
+     * the scheduler must call park() after this function returns.
+     * \return \c true if the green thread has finished, \c false if it has
+     * suspended itself */
+    bool resume();
+    //! Parks a suspended green thread.
+    /*! It is called by the scheduler after resume() returns \c false.
+     * \param[in] self a shared pointer to this object, kept until wake()
+     * \return \c true if the green thread has been parked; \c false if wake()
+     * has been called since the last resume(), hence the green thread should
+     * be resumed again without parking */
+    bool park(std::shared_ptr<green_thread> self);
+    //! Suspends the current green thread.
+    /*! It must be called from the green thread. It returns after wake() is
+     * called, but it may also return spuriously, so the caller must check the
+     * condition it waits for.
+     * \param[in] deadline a time when the scheduler calls wake(); no timeout
+     * if empty */
+    void suspend(const std::optional<clock::time_point>& deadline);
+    //! Makes a suspended green thread runnable.
+    /*! It may be called by any thread. If the green thread is parked, it calls
+     * schedule(). If it is running or runnable, the next suspend() returns
+     * immediately. */
+    void wake();
+    //! Checks if the stack of the current green thread is nearly exhausted.
+    /*! It is used to stop deep recursion in a green thread before it
+     * overflows the stack, which has a fixed size.
+     * \return \c true if called from a green thread with less than \ref
+     * stack_reserve bytes (or half of the stack, if it is smaller) of unused
+     * stack; \c false otherwise */
+    [[nodiscard]] static bool stack_exhausted() noexcept;
+    //! The minimum unused stack space required by stack_exhausted()
+    static constexpr size_t stack_reserve = 64 * 1024;
+    //! Gets the deadline requested by the last suspend().
+    /*! \return the deadline */
+    [[nodiscard]] const std::optional<clock::time_point>& deadline() const {
+        return _deadline;
+    }
+    //! Gets the number of calls of suspend().
+    /*! It identifies the last suspend(), e.g., for detecting that a timeout
+     * requested by an earlier suspend() is no longer needed.
+     * \return the number of calls of suspend() */
+    [[nodiscard]] uint64_t suspends() const noexcept {
+        return _suspends;
+    }
+protected:
+    //! The code executed by the green thread
+    /*! It must not throw exceptions. */
+    virtual void body() noexcept = 0;
+    //! Schedules a parked green thread for resuming.
+    /*! It is called by wake() and it must arrange that resume() will be
+     * called by the OS thread that executed this green thread before.
+     * \param[in] self a shared pointer to this object */
+    virtual void schedule(std::shared_ptr<green_thread> self) = 0;
+private:
+    //! States of a green thread, stored in \ref state
+    enum class state_t {
+        running, //!< Running or runnable, no pending wake()
+        woken, //!< Running or runnable, wake() has been called
+        parked, //!< Suspended, waiting for wake()
+    };
+    //! A stack allocator that records the stack limit of a green thread
+    class stack_allocator;
+    //! The lowest stack address accepted by stack_exhausted()
+    /*! It is set when \ref fib allocates its stack, therefore it must be
+     * declared before \ref fib. */
+    const char* stack_limit;
+    //! The green thread if not running, empty if it has finished
+    boost::context::fiber fib;
+    //! The scheduler while this green thread is running
+    boost::context::fiber sched;
+    //! The current state of this green thread
+    std::atomic<state_t> state = state_t::running;
+    //! Keeps this object alive while parked.
+    std::shared_ptr<green_thread> self;
+    //! The deadline passed to the last suspend()
+    std::optional<clock::time_point> _deadline;
+    //! The number of calls of suspend()
+    uint64_t _suspends = 0;
+    //! The green thread running in the current OS thread
+    static thread_local green_thread* _current;
+};
+
+//! Computes the deadline of a timeout starting now.
+/*! \param[in] timeout the timeout in milliseconds
+ * \return the current time plus \a timeout; \c time_point::max() if the
+ * result is not representable, which means waiting without a timeout */
+inline green_thread::clock::time_point deadline_after(uint64_t timeout)
+{
+    using clock = green_thread::clock;
+    auto now = clock::now();
+    auto max_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                            clock::time_point::max() - now);
+    if (max_ms.count() < 0 || timeout >= uint64_t(max_ms.count()))
+        return clock::time_point::max();
+    return now + std::chrono::milliseconds(timeout);
+}
+
+//! A condition variable that can be used by OS threads and green threads
+/*! It has a subset of the interface of \c std::condition_variable. If called
+ * from an OS thread, it blocks the OS thread using \c
+ * std::condition_variable. If called from a green_thread, it suspends the
+ * green thread without blocking the OS thread.
+ * \threadsafe{safe,safe} */
+class green_cond {
+public:
+    //! The clock used for timeouts
+    using clock = green_thread::clock;
+    //! Wakes up one waiting OS thread and one waiting green thread.
+    void notify_one();
+    //! Wakes up all waiting threads.
+    void notify_all();
+    //! Waits until a condition is satisfied.
+    /*! \tparam P the type of the condition
+     * \param[in] lck a locked lock, which is released while waiting
+     * \param[in] pred the condition */
+    template <class P> void wait(std::unique_lock<std::mutex>& lck, P pred) {
+        wait_impl(lck, std::nullopt, pred);
+    }
+    //! Waits until a condition is satisfied or a timeout expires.
+    /*! \tparam P the type of the condition
+     * \param[in] lck a locked lock, which is released while waiting
+     * \param[in] deadline the time of the timeout
+     * \param[in] pred the condition
+     * \return the value of \a pred after waiting */
+    template <class P> bool wait_until(std::unique_lock<std::mutex>& lck,
+                                       const clock::time_point& deadline,
+                                       P pred)
+    {
+        return wait_impl(lck, deadline, pred);
+    }
+    //! Waits for a notification or until a timeout expires.
+    /*! It may return spuriously.
+     * \param[in] lck a locked lock, which is released while waiting
+     * \param[in] timeout the maximum waiting time */
+    void wait_for(std::unique_lock<std::mutex>& lck, clock::duration timeout);
+private:
+    //! Waits in an OS thread or in a green thread.
+    /*! \tparam P the type of the condition
+     * \param[in] lck a locked lock, which is released while waiting
+     * \param[in] deadline the time of a timeout; no timeout if empty
+     * \param[in] pred the condition
+     * \return the value of \a pred after waiting */
+    template <class P> bool wait_impl(std::unique_lock<std::mutex>& lck,
+        const std::optional<clock::time_point>& deadline, P pred);
+    //! Suspends the current green thread until notified.
+    /*! \param[in] g the current green thread
+     * \param[in] lck a locked lock, which is released while waiting
+     * \param[in] deadline the time of a timeout; no timeout if empty */
+    void suspend(green_thread& g, std::unique_lock<std::mutex>& lck,
+                 const std::optional<clock::time_point>& deadline);
+    //! Used by waiting OS threads
+    std::condition_variable cond;
+    //! The mutex protecting \ref waiters
+    std::mutex mtx;
+    //! Waiting green threads
+    std::vector<green_thread*> waiters;
+};
+
+template <class P> bool green_cond::wait_impl(std::unique_lock<std::mutex>& lck,
+    const std::optional<clock::time_point>& deadline, P pred)
+{
+    auto g = green_thread::current();
+    if (!g) {
+        if (deadline)
+            return cond.wait_until(lck, *deadline, pred);
+        cond.wait(lck, pred);
+        return true;
+    }
+    while (!pred()) {
+        if (deadline && clock::now() >= *deadline)
+            return pred();
+        suspend(*g, lck, deadline);
+    }
+    return true;
+}
+
+} // namespace threadscript::impl
@@ -0,0 +1,261 @@
+#pragma once
+
+/*! \file
+ * \brief Read-only access of scripts to containers owned by the host program
+ */
+
+#include "threadscript/vm_data.hpp"
+
+#include <concepts>
+#include <iterator>
+#include <optional>
+#include <string_view>
+
+namespace threadscript {
+
+template <impl::allocator A> class basic_host_view;
+
+namespace impl {
+//! The name of host_view
+inline constexpr char name_host_view[] = "host_view";
+//! The base class of basic_host_view
+/*! \tparam A an allocator type */
+template <allocator A> using basic_host_view_base =
+    basic_value_object<basic_host_view<A>, name_host_view, A>;
+} // namespace impl
+
+//! A read-only view of a container owned by the host program
+/*! It gives scripts access to a C++ container without copying it into
+ * basic_value_vector or basic_value_hash. The container is accessed by an
+ * adapter, which creates a script value for an element only when the element
+ * is accessed by a script. A view is created by the host program by create()
+ * and it is usually stored in a shared symbol table. All objects of this class
+ * are marked thread-safe.
+ *
+ * Adapters for common containers are provided by sequence_adapter and
+ * map_adapter. Other containers, or containers with element types without
+ * a predefined conversion, can be exposed by a class derived from \ref
+ * adapter.
+ *
+ * A script can create only an empty view by calling \c host_view(), but the
+ * constructor is not registered by add_predef_objects().
+ *
+ * Methods:
+ * \snippet host_view_impl.hpp methods
+ * \tparam A an allocator type
+ * \threadsafe{safe,safe}
+ * \test in file test_host_view.cpp */
+template <impl::allocator A>
+class basic_host_view final: public impl::basic_host_view_base<A> {
+public:
+    //! The type of a script value
+    using value_ptr = typename basic_host_view::value_ptr;
+    //! The interface used to access a host container
+    /*! Member functions may be called by multiple threads concurrently.
+     * Therefore the container must not be modified while it is accessible via
+     * a view, unless the adapter implements appropriate synchronization. */
+    class adapter {
+    public:
+        //! Default constructor
+        adapter() = default;
+        //! No copying
+        adapter(const adapter&) = delete;
+        //! No moving
+        adapter(adapter&&) = delete;
+        //! Virtual destructor, because objects are deleted via the base class
+        virtual ~adapter() = default;
+        //! No copying
+        adapter& operator=(const adapter&) = delete;
+        //! No moving
+        adapter& operator=(adapter&&) = delete;
+        //! Gets the number of elements.
+        /*! \return the number of elements in the container */
+        [[nodiscard]] virtual size_t size() const = 0;
+        //! Gets an element by its index.
+        /*! The default implementation throws exception::value_type, which is
+         * suitable for containers without indexed access.
+         * \param[in] alloc an allocator for the created value
+         * \param[in] idx the index of an element
+         * \return the element converted to a script value, \c std::nullopt if
+         * \a idx is greater than the greatest existing index
+         * \throw exception::value_type if the container is not indexed by
+         * integers */
+        virtual std::optional<value_ptr> at(const A& alloc, size_t idx) const;
+        //! Gets an element by its key.
+        /*! The default implementation throws exception::value_type, which is
+         * suitable for containers without lookup by key.
+         * \param[in] alloc an allocator for the created value
+         * \param[in] key the key of an element
+         * \return the element converted to a script value, \c std::nullopt if
+         * there is no element with \a key
+         * \throw exception::value_type if the container is not indexed by
+         * strings */
+        virtual std::optional<value_ptr> find(const A& alloc,
+                                              std::string_view key) const;
+    };
+    //! An adapter for a random access container
+    /*! \tparam C a container type; its elements must be convertible by
+     * impl::to_value() */
+    template <class C> class sequence_adapter final: public adapter {
+    public:
+        //! Stores the container.
+        /*! \param[in] c the container, shared with the host program */
+        explicit sequence_adapter(std::shared_ptr<const C> c):
+            c(std::move(c)) {}
+        [[nodiscard]] size_t size() const override {
+            return c->size();
+        }
+        std::optional<value_ptr> at(const A& alloc,
+                                    size_t idx) const override
+        {
+            if (idx >= c->size())
+                return std::nullopt;
+            return impl::to_value(alloc, (*c)[idx]);
+        }
+    private:
+        std::shared_ptr<const C> c; //!< The container
+    };
+    //! An adapter for an associative container with string keys
+    /*! \tparam C a container type; its mapped values must be convertible by
+     * impl::to_value() */
+    template <class C> class map_adapter final: public adapter {
+    public:
+        //! Stores the container.
+        /*! \param[in] c the container, shared with the host program */
+        explicit map_adapter(std::shared_ptr<const C> c): c(std::move(c)) {}
+        [[nodiscard]] size_t size() const override {
+            return c->size();
+        }
+        std::optional<value_ptr> find(const A& alloc,
+                                      std::string_view key) const override
+        {
+            auto it = c->end();
+            // Use heterogeneous lookup if available to avoid a key copy
+            if constexpr (requires { c->find(key); })
+                it = c->find(key);
+            else
+                it = c->find(typename C::key_type(key));
+            if (it == c->end())
+                return std::nullopt;
+            return impl::to_value(alloc, it->second);
+        }
+    private:
+        std::shared_ptr<const C> c; //!< The container
+    };
+    //! Creates an empty view.
+    /*! It is used if a script calls the constructor of this class.
+     * \copydetails basic_value_object<A>::basic_value_object() */
+    basic_host_view(typename basic_host_view::tag t,
+        std::shared_ptr<const typename basic_host_view::method_table> methods,
+        typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node);
+    //! Creates a view using an adapter.
+    /*! It should not be called directly, use create() instead.
+     * \param[in] t an ignored parameter that prevents using this constructor
+     * directly
+     * \param[in] methods the mapping from method names to implementations
+     * \param[in] a the adapter */
+    basic_host_view(typename basic_host_view::tag t,
+        std::shared_ptr<const typename basic_host_view::method_table> methods,
+        std::shared_ptr<const adapter> a);
+    //! \copydoc basic_value_object::init_methods()
+    [[nodiscard]] static
+    typename basic_host_view::method_table init_methods();
+    //! Creates a view of a host container.
+    /*! \param[in] alloc an allocator used by the created object
+     * \param[in] a the adapter of the container
+     * \return the view */
+    static std::shared_ptr<basic_host_view>
+    create(const A& alloc, std::shared_ptr<const adapter> a);
+    //! Creates a view of a random access container.
+    /*! It uses sequence_adapter.
+     * \tparam C the container type
+     * \param[in] alloc an allocator used by the created object
+     * \param[in] c the container
+     * \return the view */
+    template <class C> requires std::random_access_iterator<
+        typename C::const_iterator>
+    static std::shared_ptr<basic_host_view>
+    create(const A& alloc, std::shared_ptr<const C> c) {
+        return create(alloc, std::allocate_shared<sequence_adapter<C>>(alloc,
+                                                                std::move(c)));
+    }
+    //! Creates a view of an associative container with string keys.
+    /*! It uses map_adapter.
+     * \tparam C the container type
+     * \param[in] alloc an allocator used by the created object
+     * \param[in] c the container
+     * \return the view */
+    template <class C> requires requires { typename C::mapped_type; }
+    static std::shared_ptr<basic_host_view>
+    create(const A& alloc, std::shared_ptr<const C> c) {
+        return create(alloc, std::allocate_shared<map_adapter<C>>(alloc,
+                                                                std::move(c)));
+    }
+private:
+    //! Gets an element.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c key -- an index of type \c int or \c unsigned, or a key of
+     *     type \c string
+     * \return the element converted to a script value
+     * \throw exception::op_narg if the number of arguments (incl. \a
+     * method_name) is not 2
+     * \throw exception::value_null if \a key is \c null
+     * \throw exception::value_type if \a key does not have type \c int, \c
+     * unsigned, or \c string, or if the container does not support access by
+     * the type of \a key
+     * \throw exception::value_out_of_range if \a key is a negative number or
+     * if there is no element with \a key */
+    typename basic_host_view::value_ptr
+    at(typename threadscript::basic_state<A>& thread,
+       typename threadscript::basic_symbol_table<A>& l_vars,
+       const typename threadscript::basic_code_node<A>& node);
+    //! Tests if an element exists.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c key -- an index of type \c int or \c unsigned, or a key of
+     *     type \c string
+     * \return \c true if the element exists, \c false otherwise
+     * \throw exception::op_narg if the number of arguments (incl. \a
+     * method_name) is not 2
+     * \throw exception::value_null if \a key is \c null
+     * \throw exception::value_type if \a key does not have type \c int, \c
+     * unsigned, or \c string, or if the container does not support access by
+     * the type of \a key
+     * \throw exception::value_out_of_range if \a key is a negative number */
+    typename basic_host_view::value_ptr
+    contains(typename threadscript::basic_state<A>& thread,
+             typename threadscript::basic_symbol_table<A>& l_vars,
+             const typename threadscript::basic_code_node<A>& node);
+    //! Gets the number of elements.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     * \return the number of elements in the container (an \c unsigned value)
+     * \throw exception::op_narg if the number of arguments (incl. \a
+     * method_name) is not 1 */
+    typename basic_host_view::value_ptr
+    size(typename threadscript::basic_state<A>& thread,
+         typename threadscript::basic_symbol_table<A>& l_vars,
+         const typename threadscript::basic_code_node<A>& node);
+    //! Gets an element by the key in the argument of at() or contains().
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node of at() or contains()
+     * \return the element, \c std::nullopt if it does not exist */
+    std::optional<value_ptr>
+    lookup(typename threadscript::basic_state<A>& thread,
+           typename threadscript::basic_symbol_table<A>& l_vars,
+           const typename threadscript::basic_code_node<A>& node);
+    //! The adapter of the container, \c nullptr for an empty view
+    std::shared_ptr<const adapter> _adapter;
+};
+
+} // namespace threadscript
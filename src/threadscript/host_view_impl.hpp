@@ -0,0 +1,132 @@
+#pragma once
+
+/*! \file
+ * \brief The implementation part of host_view.hpp
+ */
+
+#include "threadscript/host_view.hpp"
+
+namespace threadscript {
+
+/*** basic_host_view::adapter ************************************************/
+
+template <impl::allocator A>
+auto basic_host_view<A>::adapter::at(const A&, size_t) const
+    -> std::optional<value_ptr>
+{
+    throw exception::value_type();
+}
+
+template <impl::allocator A>
+auto basic_host_view<A>::adapter::find(const A&, std::string_view) const
+    -> std::optional<value_ptr>
+{
+    throw exception::value_type();
+}
+
+/*** basic_host_view *********************************************************/
+
+template <impl::allocator A>
+basic_host_view<A>::basic_host_view(typename basic_host_view<A>::tag,
+        std::shared_ptr<const typename basic_host_view<A>::method_table>
+            methods,
+        typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node):
+    impl::basic_host_view_base<A>(typename basic_host_view::tag_args{},
+                                  methods, thread, l_vars, node)
+{
+    if (this->narg(node) != 0)
+        throw exception::op_narg();
+    this->set_mt_safe();
+}
+
+template <impl::allocator A>
+basic_host_view<A>::basic_host_view(typename basic_host_view<A>::tag,
+        std::shared_ptr<const typename basic_host_view<A>::method_table>
+            methods,
+        std::shared_ptr<const adapter> a):
+    impl::basic_host_view_base<A>(typename basic_host_view::tag_args{},
+                                  methods),
+    _adapter(std::move(a))
+{
+    this->set_mt_safe();
+}
+
+template <impl::allocator A> basic_host_view<A>::value_ptr
+basic_host_view<A>::at(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 2)
+        throw exception::op_narg();
+    if (auto v = lookup(thread, l_vars, node))
+        return std::move(*v);
+    else
+        throw exception::value_out_of_range();
+}
+
+template <impl::allocator A> basic_host_view<A>::value_ptr
+basic_host_view<A>::contains(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 2)
+        throw exception::op_narg();
+    auto result = basic_value_bool<A>::create(thread.get_allocator());
+    result->value() = bool(lookup(thread, l_vars, node));
+    return result;
+}
+
+template <impl::allocator A>
+std::shared_ptr<basic_host_view<A>>
+basic_host_view<A>::create(const A& alloc, std::shared_ptr<const adapter> a)
+{
+    return std::allocate_shared<basic_host_view>(alloc,
+        typename basic_host_view::tag{},
+        std::allocate_shared<const typename basic_host_view::method_table>(
+            alloc, init_methods()),
+        std::move(a));
+}
+
+template <impl::allocator A> basic_host_view<A>::method_table
+basic_host_view<A>::init_methods()
+{
+    return {
+        //! [methods]
+        {"at", &basic_host_view::at},
+        {"contains", &basic_host_view::contains},
+        {"size", &basic_host_view::size},
+        //! [methods]
+    };
+}
+
+template <impl::allocator A> auto
+basic_host_view<A>::lookup(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+    -> std::optional<value_ptr>
+{
+    auto key = this->arg(thread, l_vars, node, 1);
+    if (!key)
+        throw exception::value_null();
+    if (auto ps = dynamic_cast<basic_value_string<A>*>(key.get()))
+        return _adapter ? _adapter->find(thread.get_allocator(), ps->cvalue()) :
+            std::nullopt;
+    size_t idx = this->to_index(key);
+    return _adapter ? _adapter->at(thread.get_allocator(), idx) : std::nullopt;
+}
+
+template <impl::allocator A> basic_host_view<A>::value_ptr
+basic_host_view<A>::size(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>&,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 1)
+        throw exception::op_narg();
+    auto result = basic_value_unsigned<A>::create(thread.get_allocator());
+    result->value() = _adapter ? _adapter->size() : 0;
+    return result;
+}
+
+} // namespace threadscript
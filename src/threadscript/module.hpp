@@ -0,0 +1,154 @@
+#pragma once
+
+/*! \file
+ * \brief Importing script files as modules shared by all threads of a virtual
+ * machine
+ *
+ * A script imports a module by function \c import (predef::f_import). The
+ * module is a script file found in the module search path. It is parsed and
+ * evaluated only once in a virtual machine, when it is imported for the first
+ * time. Its thread-safe definitions (functions and variables) are kept in the
+ * module registry of the virtual machine and each import copies them into the
+ * global symbol table of the importing thread.
+ *
+ * \test in file test_module.cpp
+ */
+
+#include "threadscript/code_parser.hpp"
+#include "threadscript/green.hpp"
+#include "threadscript/virtual_machine.hpp"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace threadscript {
+
+//! A registry of modules imported in a virtual machine
+/*! There is at most one module registry in a basic_virtual_machine. It is
+ * created on demand by get(), and it is destroyed by the destructor of the VM.
+ *
+ * A module is identified by the canonical name of its file, hence the same
+ * file imported by different names is loaded once. A module is loaded by
+ * parsing the file, evaluating it in a new basic_state, and collecting all
+ * thread-safe symbols from basic_state::t_vars of that state. These symbols
+ * are the exports of the module. The exports are never modified after the
+ * module is loaded, therefore they are shared by all threads without copying
+ * and without locking.
+ *
+ * Loading of modules is serialized. An import is nested if it is called by
+ * the basic_state that evaluates a module being loaded, i.e., by a module
+ * importing another module. Any other import that needs to load a module
+ * waits until all modules being loaded finish loading. It waits by
+ * impl::green_cond, hence a green thread waiting for a module does not block
+ * its pool thread. A nested import of a module that is being loaded, i.e., of
+ * the importing module itself or of a module that (indirectly) imports it,
+ * causes exception::op_import_cycle. A module should not wait during loading
+ * for another thread that imports a module, because that thread would wait
+ * for the module. If loading fails, the module is not registered and a later
+ * import tries to load it again.
+ * \tparam A an allocator type
+ * \threadsafe{safe,safe} */
+template <impl::allocator A>
+class basic_module_registry final: public impl::module_registry_base {
+public:
+    //! A shared pointer to the exports of a module
+    using exports_ptr = std::shared_ptr<const basic_symbol_table<A>>;
+    //! The name of the function that imports a module
+    static constexpr std::string_view import_fun = "import";
+    //! Creates an empty registry.
+    /*! \param[in] vm the virtual machine that evaluates loaded modules */
+    explicit basic_module_registry(basic_virtual_machine<A>& vm): vm(vm) {}
+    //! Gets the module registry of a virtual machine.
+    /*! The registry is created by the first call for \a vm.
+     * \param[in] vm a virtual machine
+     * \return the module registry of \a vm */
+    static basic_module_registry& get(basic_virtual_machine<A>& vm);
+    //! Gets the module search path.
+    /*! \return the directories searched for module files, in the order of
+     * searching */
+    [[nodiscard]] std::vector<std::string> search_path() const;
+    //! Sets the module search path.
+    /*! It affects modules imported later. Already loaded modules are kept.
+     * \param[in] dirs the directories searched for module files, in the order
+     * of searching; if empty, the current directory is searched */
+    void search_path(std::vector<std::string> dirs);
+    //! Gets the exports of a module, loading it if needed.
+    /*! If \a name is an absolute file name, it is used without searching.
+     * Otherwise, it is a file name relative to a directory in the search path
+     * and the first existing file is used. If resolve_modules is \c true, the
+     * imports of the module are resolved by resolve() before it is evaluated.
+     * \param[in] name the module name
+     * \param[in] importer the thread calling the import, used to detect nested
+     * imports; \c nullptr if called outside of a script
+     * \return the exports of the module
+     * \throw exception::op_import_not_found if the module file is not found
+     * \throw exception::op_import_cycle if the import is nested and the module
+     * is being loaded
+     * \throw exception::parse_error if parsing fails
+     * \throw std::ios_base::failure if reading of the module file fails
+     * \throw any exception thrown by the module script */
+    exports_ptr import(std::string_view name,
+                       const basic_state<A>* importer = nullptr);
+    //! Gets the number of loaded modules.
+    /*! \return the number of modules in the registry */
+    [[nodiscard]] size_t size() const;
+    //! Imports modules used by a script and binds their exports early.
+    /*! It finds all calls of function \ref import_fun in \a script, which have
+     * a single constant string argument. It imports each such module by
+     * import() and resolves names in \a script by basic_script::resolve() to
+     * the exports of the module, without replacing existing values. Hence a
+     * call of an imported function need not look up the function name in
+     * symbol tables when it is evaluated. All modules imported by \a script are
+     * loaded eagerly, even if the respective call of \ref import_fun would not
+     * be evaluated.
+     * \param[in] script a script
+     * \param[in] importer passed to import()
+     * \throw any exception thrown by import() */
+    void resolve(basic_script<A>& script,
+                 const basic_state<A>* importer = nullptr);
+    //! Whether import() resolves imports of a module before evaluating it.
+    std::atomic<bool> resolve_modules = false;
+private:
+    //! A module in the registry
+    struct entry {
+        //! The exports; \c nullptr while the module is being loaded
+        exports_ptr exports = nullptr;
+        //! The thread evaluating the module while it is being loaded
+        const basic_state<A>* loader = nullptr;
+    };
+    //! Finds a module file in the search path.
+    /*! \param[in] name the module name
+     * \return the canonical name of the module file
+     * \throw exception::op_import_not_found if the file is not found */
+    std::string find(std::string_view name) const;
+    //! Loads a module.
+    /*! The module must be already registered in \ref modules and counted in
+     * \ref loading. When loading finishes, it is removed from \ref loading
+     * and waiting imports are notified. If loading fails, the module is
+     * unregistered.
+     * \param[in] file the canonical name of the module file
+     * \return the exports of the module */
+    exports_ptr load(const std::string& file);
+    //! The virtual machine
+    basic_virtual_machine<A>& vm;
+    //! Protects \ref dirs, \ref modules, \ref names, and \ref loading
+    mutable std::mutex mtx;
+    //! Used to wait until \ref loading becomes 0
+    impl::green_cond cond;
+    //! The number of modules being loaded
+    size_t loading = 0;
+    //! The module search path
+    std::vector<std::string> dirs;
+    //! The loaded modules and modules being loaded, indexed by file names
+    std::map<std::string, entry, std::less<>> modules;
+    //! The exports of loaded modules, indexed by names passed to import()
+    /*! It allows to import a loaded module without searching for its file. It
+     * is cleared when the search path changes. */
+    std::map<std::string, exports_ptr, std::less<>> names;
+};
+
+} // namespace threadscript
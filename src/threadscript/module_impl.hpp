@@ -0,0 +1,180 @@
+#pragma once
+
+/*! \file
+ * \brief The implementation part of module.hpp
+ */
+
+#include "threadscript/module.hpp"
+#include "threadscript/finally.hpp"
+
+#include <algorithm>
+#include <filesystem>
+
+namespace threadscript {
+
+/*** basic_module_registry ***************************************************/
+
+template <impl::allocator A> basic_module_registry<A>&
+basic_module_registry<A>::get(basic_virtual_machine<A>& vm)
+{
+    std::lock_guard lck{vm.module_registry_mtx};
+    if (!vm.module_registry)
+        vm.module_registry = std::make_unique<basic_module_registry>(vm);
+    return static_cast<basic_module_registry&>(*vm.module_registry);
+}
+
+template <impl::allocator A>
+std::string basic_module_registry<A>::find(std::string_view name) const
+{
+    namespace fs = std::filesystem;
+    fs::path module{name};
+    std::vector<fs::path> candidates;
+    if (module.is_absolute())
+        candidates.push_back(module);
+    else {
+        std::lock_guard lck{mtx};
+        if (dirs.empty())
+            candidates.push_back(module);
+        for (auto&& d: dirs)
+            candidates.push_back(fs::path{d} / module);
+    }
+    for (auto&& f: candidates) {
+        std::error_code ec;
+        if (fs::is_regular_file(f, ec)) {
+            auto canonical = fs::weakly_canonical(f, ec);
+            return (ec ? f : canonical).string();
+        }
+    }
+    throw exception::op_import_not_found();
+}
+
+template <impl::allocator A> auto
+basic_module_registry<A>::import(std::string_view name,
+                                 const basic_state<A>* importer) -> exports_ptr
+{
+    {
+        std::lock_guard lck{mtx};
+        if (auto it = names.find(name); it != names.end())
+            return it->second;
+    }
+    auto file = find(name);
+    exports_ptr exports = nullptr;
+    {
+        std::unique_lock lck{mtx};
+        bool nested = importer &&
+            std::ranges::any_of(modules, [importer](auto&& m) {
+                return m.second.loader == importer;
+            });
+        // A nested import is a part of the loading in progress
+        if (!nested)
+            cond.wait(lck, [this]() { return loading == 0; });
+        auto [it, inserted] = modules.try_emplace(file);
+        if (!inserted) {
+            // Only modules imported by this import chain can be loading now
+            if (!it->second.exports)
+                throw exception::op_import_cycle();
+            exports = it->second.exports;
+        } else
+            ++loading;
+    }
+    if (!exports)
+        exports = load(file);
+    std::lock_guard lck{mtx};
+    names.insert_or_assign(std::string{name}, exports);
+    return exports;
+}
+
+template <impl::allocator A> auto
+basic_module_registry<A>::load(const std::string& file) -> exports_ptr
+{
+    bool loaded = false;
+    finally done{[this, &file, &loaded]() noexcept {
+        {
+            std::lock_guard lck{mtx};
+            if (!loaded)
+                modules.erase(file);
+            --loading;
+        }
+        cond.notify_all();
+    }};
+    auto alloc = vm.get_allocator();
+    auto script = parse_code_file(alloc, file);
+    auto exports =
+        std::allocate_shared<basic_symbol_table<A>>(alloc, alloc, nullptr);
+    {
+        basic_state<A> thread{vm};
+        entry* e = nullptr;
+        {
+            std::lock_guard lck{mtx};
+            e = &modules[file];
+            e->loader = &thread;
+        }
+        // Before destroying thread, so that its address is not reused
+        finally unregister{[this, e]() noexcept {
+            std::lock_guard lck{mtx};
+            e->loader = nullptr;
+        }};
+        if (resolve_modules)
+            resolve(*script, &thread);
+        script->eval(thread);
+        auto& t_vars = thread.t_vars.symbols();
+        for (auto it = t_vars.begin(); it != t_vars.end(); ++it)
+            if (it->second && it->second->mt_safe())
+                exports->insert(it->first, std::move(it->second));
+    }
+    std::lock_guard lck{mtx};
+    loaded = true;
+    return modules[file].exports = std::move(exports);
+}
+
+template <impl::allocator A>
+void basic_module_registry<A>::resolve(basic_script<A>& script,
+                                       const basic_state<A>* importer)
+{
+    if (!script._root)
+        return;
+    std::vector<std::string> imports;
+    auto find_imports = [&imports](auto&& self,
+                                   const basic_code_node<A>& node) -> void
+    {
+        if (node.name == import_fun && node._children.size() == 1) {
+            auto& arg = *node._children[0];
+            if (arg.name.empty() && arg.value)
+                if (auto s = dynamic_cast<const basic_value_string<A>*>(
+                                                            arg.value->get()))
+                {
+                    imports.emplace_back(std::string_view{s->cvalue()});
+                }
+        }
+        for (auto&& c: node._children)
+            self(self, *c);
+    };
+    find_imports(find_imports, *script._root);
+    for (auto&& name: imports)
+        script.resolve(*import(name, importer), false, false);
+}
+
+template <impl::allocator A>
+std::vector<std::string> basic_module_registry<A>::search_path() const
+{
+    std::lock_guard lck{mtx};
+    return dirs;
+}
+
+template <impl::allocator A>
+void basic_module_registry<A>::search_path(std::vector<std::string> dirs)
+{
+    std::lock_guard lck{mtx};
+    this->dirs = std::move(dirs);
+    names.clear();
+}
+
+template <impl::allocator A> size_t basic_module_registry<A>::size() const
+{
+    std::lock_guard lck{mtx};
+    return size_t(std::ranges::count_if(modules, [](auto&& m) {
+        return bool(m.second.exports);
+    }));
+}
+
+} // namespace threadscript
@@ -0,0 +1,334 @@
+#pragma once
+
+/*! \file
+ * \brief Native functions implemented by ordinary C++ callables
+ *
+ * Like basic_prepared_call, basic_native_binding is parametrized by a C++
+ * type, therefore it is defined completely in this header and it is not
+ * explicitly instantiated. For the same reason, this header includes the
+ * implementation of its base classes.
+ */
+
+#include "threadscript/code_impl.hpp"
+#include "threadscript/virtual_machine.hpp"
+#include "threadscript/vm_data_impl.hpp"
+
+#include <array>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace threadscript {
+
+//! A lazily evaluated argument of a basic_native_binding
+/*! If a parameter of a callable bound by basic_native_binding has this type,
+ * the corresponding argument is not evaluated before calling the callable.
+ * The callable may evaluate it any number of times, or not at all. It is
+ * intended for implementing control flow, like function \c if.
+ * An object of this class is valid only during the call of the callable.
+ * \tparam A an allocator type
+ * \threadsafe{safe,unsafe} */
+template <impl::allocator A> class basic_lazy_arg {
+public:
+    //! The type of a script value
+    using value_ptr = typename basic_value<A>::value_ptr;
+    //! The type of a function evaluating an argument
+    using eval_t = value_ptr (*)(basic_value<A>& fun, basic_state<A>& thread,
+                                 basic_symbol_table<A>& l_vars,
+                                 const basic_code_node<A>& node, size_t idx);
+    //! Stores the context of the argument, used by basic_native_binding.
+    /*! \param[in] eval a function that evaluates the argument
+     * \param[in] fun the called native function
+     * \param[in] thread the current thread
+     * \param[in] l_vars the local symbol table of the caller
+     * \param[in] node the code node of the function call
+     * \param[in] idx the index of the argument */
+    basic_lazy_arg(eval_t eval, basic_value<A>& fun, basic_state<A>& thread,
+                   basic_symbol_table<A>& l_vars,
+                   const basic_code_node<A>& node, size_t idx) noexcept:
+        _eval(eval), fun(fun), _thread(thread), l_vars(l_vars), node(node),
+        idx(idx)
+    {}
+    //! Evaluates the argument.
+    /*! \return the argument value
+     * \throw any exception thrown by evaluation */
+    value_ptr eval() const {
+        return _eval(fun, _thread, l_vars, node, idx);
+    }
+    //! Evaluates the argument.
+    /*! \return the argument value
+     * \throw any exception thrown by evaluation */
+    value_ptr operator()() const {
+        return eval();
+    }
+    //! Gets the current thread.
+    /*! \return the thread evaluating the function call */
+    [[nodiscard]] basic_state<A>& thread() const noexcept {
+        return _thread;
+    }
+private:
+    eval_t _eval; //!< Evaluates the argument
+    basic_value<A>& fun; //!< The called native function
+    basic_state<A>& _thread; //!< The current thread
+    basic_symbol_table<A>& l_vars; //!< The local symbol table of the caller
+    const basic_code_node<A>& node; //!< The code node of the function call
+    size_t idx; //!< The index of the argument
+};
+
+namespace impl {
+
+//! Gets the signature of a callable
+/*! The primary template handles class types with a non-overloaded and
+ * non-template \c operator(), e.g., non-generic lambdas.
+ * \tparam F a callable type */
+template <class F> struct callable_traits:
+    callable_traits<decltype(&F::operator())> {};
+
+//! Gets the signature of a function pointer
+/*! \tparam R the result type
+ * \tparam Args the parameter types */
+template <class R, class... Args> struct callable_traits<R(*)(Args...)> {
+    using result_type = R; //!< The result type
+    using args_type = std::tuple<Args...>; //!< The parameter types
+};
+
+//! Gets the signature of a \c noexcept function pointer
+/*! \tparam R the result type
+ * \tparam Args the parameter types */
+template <class R, class... Args>
+struct callable_traits<R(*)(Args...) noexcept>:
+    callable_traits<R(*)(Args...)> {};
+
+//! Gets the signature of a const member function
+/*! \tparam C the class type
+ * \tparam R the result type
+ * \tparam Args the parameter types */
+template <class C, class R, class... Args>
+struct callable_traits<R(C::*)(Args...) const>:
+    callable_traits<R(*)(Args...)> {};
+
+//! Gets the signature of a \c noexcept const member function
+/*! \tparam C the class type
+ * \tparam R the result type
+ * \tparam Args the parameter types */
+template <class C, class R, class... Args>
+struct callable_traits<R(C::*)(Args...) const noexcept>:
+    callable_traits<R(*)(Args...)> {};
+
+} // namespace impl
+
+//! A native function that calls a C++ callable
+/*! It evaluates arguments of a function call, converts them to the parameter
+ * types of the callable, calls it, and converts its result to a script value.
+ * The number and types of arguments are checked by code generated from the
+ * signature of the callable. The callable must be a function pointer or a
+ * class with a single non-template \c operator() declared \c const, e.g.,
+ * a non-generic lambda. Allowed parameter types are:
+ * \arg <tt>basic_state<A>&</tt>, only as the first parameter, which gets the
+ * current thread and does not consume a script argument
+ * \arg basic_lazy_arg, which gets an unevaluated argument
+ * \arg \c bool, signed and unsigned integer types, \c std::string, \c
+ * std::string_view, and basic_value::value_ptr, converted by
+ * impl::from_value(); a \c std::string_view is valid only during the call
+ *
+ * Allowed result types are \c void (the function returns \c null) and types
+ * convertible by impl::to_value(). A new script value is created for each
+ * result.
+ *
+ * The bound function is thread-safe (see basic_value::mt_safe()), therefore
+ * the callable must be safe to call from multiple threads concurrently.
+ * \tparam A an allocator type
+ * \tparam F a callable type
+ * \threadsafe{safe,safe}
+ * \test in file test_native_binding.cpp */
+template <impl::allocator A, class F> class basic_native_binding final:
+    public basic_value_native_fun<basic_native_binding<A, F>, A>
+{
+    //! The type of a script value
+    using value_ptr = typename basic_value<A>::value_ptr;
+    //! The result type of \a F
+    using result_type = typename impl::callable_traits<F>::result_type;
+    //! The parameter types of \a F
+    using args_type = typename impl::callable_traits<F>::args_type;
+    //! The number of parameters of \a F
+    static constexpr size_t nparam = std::tuple_size_v<args_type>;
+    //! The type of a parameter of \a F
+    /*! \tparam I a parameter index */
+    template <size_t I> using param_t =
+        std::remove_cvref_t<std::tuple_element_t<I, args_type>>;
+    //! Whether the first parameter of \a F gets the current thread
+    static constexpr bool use_thread = [] {
+        if constexpr (nparam > 0)
+            return std::is_same_v<std::tuple_element_t<0, args_type>,
+                                  basic_state<A>&>;
+        else
+            return false;
+    }();
+    //! The number of script arguments
+    static constexpr size_t nargs = nparam - (use_thread ? 1 : 0);
+    //! Tests if a parameter type is valid
+    /*! \tparam I a parameter index
+     * \return whether the parameter can be passed */
+    template <size_t I> static consteval bool valid_param() {
+        using p_t = param_t<I>;
+        if constexpr (I == 0 && use_thread)
+            return true;
+        else if constexpr (std::is_same_v<p_t, basic_lazy_arg<A>>)
+            return true;
+        else
+            return impl::cpp_value<A, p_t>::valid &&
+                !std::is_same_v<p_t, const char*>;
+    }
+    //! Tests if all parameter types are valid
+    /*! \tparam I parameter indices
+     * \return whether all parameters can be passed */
+    template <size_t... I>
+    static consteval bool valid_params(std::index_sequence<I...>) {
+        return (valid_param<I>() && ...);
+    }
+    static_assert(valid_params(std::make_index_sequence<nparam>{}),
+                  "Unsupported parameter type");
+    static_assert(std::is_void_v<result_type> ||
+                  impl::cpp_value<A, std::remove_cvref_t<result_type>>::valid,
+                  "Unsupported result type");
+public:
+    //! Creates the function object.
+    /*! It should not be called directly, use create() instead.
+     * \param[in] t an ignored parameter that prevents using this constructor
+     * directly
+     * \param[in] alloc an allocator to be used by this object
+     * \param[in] f the callable */
+    basic_native_binding(typename basic_native_binding::tag t, const A& alloc,
+                         F f):
+        basic_value_native_fun<basic_native_binding, A>(t, alloc),
+        f(std::move(f))
+    {}
+    //! Creates a native function calling a C++ callable.
+    /*! \param[in] alloc an allocator to be used by the created object
+     * \param[in] f the callable
+     * \return the created function */
+    static value_ptr create(const A& alloc, F f) {
+        return std::allocate_shared<basic_native_binding>(alloc,
+                            typename basic_native_binding::tag{}, alloc,
+                            std::move(f));
+    }
+protected:
+    //! Evaluates arguments and calls the callable.
+    /*! \copydetails basic_value::eval()
+     * \throw exception::op_narg if the number of arguments does not match the
+     * number of (script) parameters of the callable
+     * \throw exception::value_null if an argument is \c null, but the
+     * parameter type is not basic_value::value_ptr
+     * \throw exception::value_type if an argument cannot be converted to the
+     * parameter type
+     * \throw exception::value_out_of_range if an integer argument is not
+     * representable by the parameter type, or if the result is not
+     * representable by the script type */
+    value_ptr eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
+                   const basic_code_node<A>& node, std::string_view) override
+    {
+        if (this->narg(node) != nargs)
+            throw exception::op_narg();
+        // Evaluate non-lazy arguments in order, they are kept alive here
+        std::array<value_ptr, nargs> values;
+        eval_args(thread, l_vars, node, values,
+                  std::make_index_sequence<nparam>{});
+        auto call = [&]<size_t... I>(std::index_sequence<I...>) {
+            return std::invoke(f,
+                get_param<I>(thread, l_vars, node, values)...);
+        };
+        if constexpr (std::is_void_v<result_type>) {
+            call(std::make_index_sequence<nparam>{});
+            return nullptr;
+        } else
+            return impl::to_value<A>(this->alloc,
+                                     call(std::make_index_sequence<nparam>{}));
+    }
+private:
+    //! Gets the index of the script argument for a parameter.
+    /*! \tparam I a parameter index, not the one getting the thread
+     * \return the argument index */
+    template <size_t I> static constexpr size_t arg_idx() {
+        return use_thread ? I - 1 : I;
+    }
+    //! Evaluates non-lazy arguments.
+    /*! \tparam I parameter indices
+     * \param[in] thread the current thread
+     * \param[in] l_vars the local symbol table of the caller
+     * \param[in] node the code node of the function call
+     * \param[out] values the evaluated arguments */
+    template <size_t... I>
+    void eval_args(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
+                   const basic_code_node<A>& node,
+                   std::array<value_ptr, nargs>& values,
+                   std::index_sequence<I...>)
+    {
+        (eval_arg<I>(thread, l_vars, node, values), ...);
+    }
+    //! Evaluates an argument if it is not lazy.
+    /*! \tparam I a parameter index
+     * \param[in] thread the current thread
+     * \param[in] l_vars the local symbol table of the caller
+     * \param[in] node the code node of the function call
+     * \param[out] values the evaluated arguments */
+    template <size_t I>
+    void eval_arg(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
+                  const basic_code_node<A>& node,
+                  std::array<value_ptr, nargs>& values)
+    {
+        if constexpr (!(I == 0 && use_thread) &&
+                      !std::is_same_v<param_t<I>, basic_lazy_arg<A>>)
+        {
+            values[arg_idx<I>()] = this->arg(thread, l_vars, node,
+                                             arg_idx<I>());
+        }
+    }
+    //! Gets a parameter value.
+    /*! \tparam I a parameter index
+     * \param[in] thread the current thread
+     * \param[in] l_vars the local symbol table of the caller
+     * \param[in] node the code node of the function call
+     * \param[in] values the evaluated arguments
+     * \return the parameter value */
+    template <size_t I>
+    decltype(auto) get_param(basic_state<A>& thread,
+                             basic_symbol_table<A>& l_vars,
+                             const basic_code_node<A>& node,
+                             std::array<value_ptr, nargs>& values)
+    {
+        if constexpr (I == 0 && use_thread)
+            return static_cast<basic_state<A>&>(thread);
+        else if constexpr (std::is_same_v<param_t<I>, basic_lazy_arg<A>>)
+            return basic_lazy_arg<A>(eval_lazy, *this, thread, l_vars, node,
+                                     arg_idx<I>());
+        else
+            return impl::from_value<A, param_t<I>>(values[arg_idx<I>()]);
+    }
+    //! Evaluates a lazy argument.
+    /*! \copydetails basic_lazy_arg::eval_t */
+    static value_ptr eval_lazy(basic_value<A>& fun, basic_state<A>& thread,
+                               basic_symbol_table<A>& l_vars,
+                               const basic_code_node<A>& node, size_t idx)
+    {
+        return static_cast<basic_native_binding&>(fun).arg(thread, l_vars,
+                                                           node, idx);
+    }
+    //! The callable
+    F f;
+};
+
+//! Creates a native function calling a C++ callable.
+/*! It is a shortcut for basic_native_binding::create(), which deduces the
+ * template arguments.
+ * \tparam A an allocator type
+ * \tparam F a callable type
+ * \param[in] alloc an allocator to be used by the created object
+ * \param[in] f the callable
+ * \return the created function */
+template <impl::allocator A, class F>
+typename basic_value<A>::value_ptr make_native_fun(const A& alloc, F f)
+{
+    return basic_native_binding<A, F>::create(alloc, std::move(f));
+}
+
+} // namespace threadscript
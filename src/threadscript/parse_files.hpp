@@ -0,0 +1,61 @@
+#pragma once
+
+/*! \file
+ * \brief Parallel parsing of multiple script files
+ *
+ * Parsing of a script file does not depend on other files. Therefore, a
+ * program that loads many script files at startup can parse them
+ * concurrently by parse_code_files() and then evaluate the parsed scripts
+ * sequentially, in the order of the files.
+ *
+ * \test in file test_parse_files.cpp
+ */
+
+#include "threadscript/code_parser.hpp"
+#include "threadscript/virtual_machine.hpp"
+
+#include <exception>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace threadscript {
+
+//! The result of parsing of a single file by parse_code_files()
+/*! \tparam A an allocator type */
+template <impl::allocator A> struct basic_parsed_file {
+    //! The file name
+    std::string file;
+    //! The parsed script; \c nullptr if parsing failed
+    typename basic_script<A>::script_ptr script = nullptr;
+    //! The exception thrown while parsing; \c nullptr if parsing succeeded
+    std::exception_ptr error = nullptr;
+};
+
+//! Parses script files in parallel
+/*! The files are distributed among threads of the task pool of \a vm (see
+ * basic_task_pool::get()) and the calling thread. Each file is parsed
+ * independently into a separate basic_script, allocated by the allocator of
+ * \a vm. An error in a file does not stop parsing of other files.
+ *
+ * The scripts are only parsed, not evaluated. The returned results are in
+ * the order of \a files, which is the order, in which the scripts are
+ * expected to be evaluated.
+ * \tparam A the allocator type
+ * \param[in] vm the virtual machine, which provides the allocator and the
+ * task pool
+ * \param[in] files the file names
+ * \param[in] syntax the syntax variant of the scripts
+ * \param[in] cache_dir if not empty, a directory of cached parsed scripts
+ * used by parse_code_file_cached()
+ * \return the parsed scripts, each element corresponding to the element of \a
+ * files with the same index
+ * \throw std::bad_alloc if there is not enough memory for the result; errors
+ * of parsing individual files are stored in the result */
+template <impl::allocator A> std::vector<basic_parsed_file<A>>
+parse_code_files(basic_virtual_machine<A>& vm,
+                 std::span<const std::string> files,
+                 std::string_view syntax = syntax_factory::syntax_canon,
+                 std::string_view cache_dir = {});
+
+} // namespace threadscript
@@ -0,0 +1,43 @@
+#pragma once
+
+/*! \file
+ * \brief The implementation part of threadscript/parse_files.hpp
+ */
+
+#include "threadscript/parse_files.hpp"
+#include "threadscript/code_cache_impl.hpp"
+#include "threadscript/task_pool_impl.hpp"
+
+namespace threadscript {
+
+/*** functions ***************************************************************/
+
+template <impl::allocator A> std::vector<basic_parsed_file<A>>
+parse_code_files(basic_virtual_machine<A>& vm,
+                 std::span<const std::string> files,
+                 std::string_view syntax, std::string_view cache_dir)
+{
+    std::vector<basic_parsed_file<A>> result(files.size());
+    for (size_t i = 0; i < files.size(); ++i)
+        result[i].file = files[i];
+    basic_state<A> thread{vm};
+    basic_task_pool<A>::get(vm).parallel_for(thread, files.size(),
+        [&vm, &result, syntax, cache_dir](basic_state<A>&, size_t begin,
+                                          size_t end)
+        {
+            for (size_t i = begin; i < end; ++i) {
+                auto& r = result[i];
+                try {
+                    r.script = cache_dir.empty() ?
+                        parse_code_file(vm.get_allocator(), r.file, syntax) :
+                        parse_code_file_cached(vm.get_allocator(), r.file,
+                                               cache_dir, syntax);
+                } catch (...) {
+                    r.error = std::current_exception();
+                }
+            }
+        });
+    return result;
+}
+
+} // namespace threadscript
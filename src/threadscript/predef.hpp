@@ -4,6 +4,7 @@
  * \brief Implementation of predefined built-in symbols. 
  */
 
+#include "threadscript/future.hpp"
 #include "threadscript/symbol_table.hpp"
 #include "threadscript/vm_data.hpp"
 
@@ -33,20 +34,28 @@ namespace predef {
 
 //! Function \c add
 /*! Numeric addition and string concatenation. Unsigned addition is done using
- * modulo arithmetic, signed overflow causes exception::op_overflow.
+ * modulo arithmetic, signed overflow causes exception::op_overflow. If \a
+ * result is the same \c string object as \a val1, \a val2 is appended to it
+ * in place, therefore building a long string by repeated <tt>add(s, s, x)</tt>
+ * has amortized linear complexity.
  * \param result (optional) if it exists and has the same type as \a val1 and
  * \a val2, the result is stored into it; otherwise, a new value is allocated
  * for the result
- * \param val1 the first operand, it must be \c int, \c unsigned, or \c string
+ * \param val1 the first operand, it must be \c int, \c unsigned, \c string,
+ * \c int_vector, or \c unsigned_vector
  * \param val2 the second operand, it must have the same type as \a val1
  * \return \a val1 + \a val2 if they are \c int or \c unsigned; concatenation
- * of \a val1 and \a val2 if they are \c string
+ * of \a val1 and \a val2 if they are \c string; elementwise sum if they are
+ * \c int_vector or \c unsigned_vector
  * \throw exception::op_narg if the number of arguments is not 2 or 3
  * \throw exception::value_null if \a val1 or \a val2 is \c null
  * \throw exception::value_type if \a val1 and \a val2 do not have the same
- * type or if their type is not \c int, \c unsigned, or \c string
- * \throw exception::op_overflow if \a val1 and \a val2 have type \c int and
- * overflow occurs
+ * type or if their type is not \c int, \c unsigned, \c string, \c
+ * int_vector, or \c unsigned_vector
+ * \throw exception::value_out_of_range if \a val1 and \a val2 are vectors
+ * of different sizes
+ * \throw exception::op_overflow if \a val1 and \a val2 have type \c int or
+ * \c int_vector and overflow occurs
  * \note An alternative would be to allow more than two operands. String
  * concatenation could then first compute the final string length and use a
  * single allocation for the concatenated string. But it would need another
@@ -56,11 +65,46 @@ namespace predef {
 template <impl::allocator A>
 class f_add final: public basic_value_native_fun<f_add<A>, A> {
     using basic_value_native_fun<f_add<A>, A>::basic_value_native_fun;
+public:
+    //! Adds two signed integers.
+    /*! This is a helper function used by eval() and it should be used (for
+     * consistency) by any other addition of \c int values.
+     * \param[in] s1 the first operand
+     * \param[in] s2 the second operand
+     * \return \a s1 + \a s2
+     * \throw exception::op_overflow if overflow occurs */
+    static config::value_int_type add(config::value_int_type s1,
+                                      config::value_int_type s2);
+    //! Adds two unsigned integers.
+    /*! This is a helper function used by eval() and it should be used (for
+     * consistency) by any other addition of \c unsigned values. It uses modulo
+     * arithmetic.
+     * \param[in] u1 the first operand
+     * \param[in] u2 the second operand
+     * \return \a u1 + \a u2 */
+    static config::value_unsigned_type add(config::value_unsigned_type u1,
+                                           config::value_unsigned_type u2);
 protected:
     typename basic_value<A>::value_ptr eval(basic_state<A>& thread,
                                             basic_symbol_table<A>& l_vars,
                                             const basic_code_node<A>& node,
                                             std::string_view fun_name) override;
+private:
+    //! Adds two packed numeric vectors elementwise.
+    /*! The loop is written so that the compiler can vectorize it. For \c
+     * int_vector, overflow is accumulated in a flag and checked after the
+     * loop.
+     * \tparam V basic_value_int_vector or basic_value_unsigned_vector
+     * \param[in] v1 the first operand
+     * \param[in] v2 the second operand
+     * \param[in] alloc the allocator of the result
+     * \return the elementwise sum of \a v1 and \a v2
+     * \throw exception::value_out_of_range if \a v1 and \a v2 have
+     * different sizes
+     * \throw exception::op_overflow if overflow occurs in an \c int_vector */
+    template <class V> static typename V::value_type
+    add_vector(const typename V::value_type& v1,
+               const typename V::value_type& v2, const A& alloc);
 };
 
 //! Common functionality of classes f_and and f_and_r
@@ -128,17 +172,28 @@ protected:
  * specified when setting a vector element (calling with 3 arguments), the
  * vector is extended to <tt>idx+1</tt> arguments and elements between the
  * previous last element and \a idx are set to \c null.
- * \param container a value of type \c vector or \c hash
- * \param idx an index (of type \c int or \c unsigned for a \c vector), or a
- * key (of type \c string for a \c hash)
+ *
+ * Packed vectors \c int_vector and \c unsigned_vector are handled like \c
+ * vector, but elements are stored by value. Therefore, getting an element
+ * returns a new \c int or \c unsigned value, setting an element requires a
+ * (non-null) \a value of the element type, and a packed vector is extended by
+ * zeros instead of \c null.
+ * \param container a value of type \c vector, \c hash, \c int_vector, or \c
+ * unsigned_vector
+ * \param idx an index (of type \c int or \c unsigned for a \c vector or a
+ * packed vector), or a key (of type \c string for a \c hash)
  * \param value (optional) if used, it is set as the element at \a idx; if
- * missing, the element at \a idx is returned; it may be be \c null
+ * missing, the element at \a idx is returned; it may be be \c null, unless
+ * \a container is a packed vector
  * \return the existing (for get) or the new (for set) element at \a idx
  * \throw exception::op_narg if the number of arguments is not 2 or 3
- * \throw exception::value_null if the first or the second argument is \c null
- * \throw exception::value_type if \a container is not of type \c vector
- * or \c hash, or if \a idx is not of type \c int or \c unsigned (for \a
- * container of type \c vector) or \c string (for \a container of type \c hash)
+ * \throw exception::value_null if the first or the second argument is \c
+ * null, or if \a value is \c null for a packed vector
+ * \throw exception::value_type if \a container is not of type \c vector, \c
+ * hash, or a packed vector, or if \a idx is not of type \c int or \c
+ * unsigned (for \a container of type \c vector or a packed vector) or \c
+ * string (for \a container of type \c hash), or if \a value does not have
+ * the element type of a packed vector
  * \throw exception::value_out_of_range if a \c vector \a idx is negative or
  * greater or equal to \link a_basic_vector a_basic_vector::max_size()\endlink
  * or (only when \a value is not used) greater than the greatest existing
@@ -223,6 +278,28 @@ protected:
                                             std::string_view fun_name) override;
 };
 
+//! Function \c count
+/*! Counts elements of a packed numeric vector equal to a value.
+ * \param result (optional) if exists and has type \c unsigned, the result is
+ * stored into it; otherwise, a new value is allocated for the result
+ * \param vec a value of type \c int_vector or \c unsigned_vector
+ * \param val the searched value, of type \c int for an \c int_vector, or \c
+ * unsigned for an \c unsigned_vector
+ * \return the number of elements of \a vec equal to \a val
+ * \throw exception::op_narg if the number of arguments is not 2 or 3
+ * \throw exception::value_null if \a vec or \a val is \c null
+ * \throw exception::value_type if \a vec is not a packed vector or if \a val
+ * does not have the element type of \a vec */
+template <impl::allocator A>
+class f_count final: public basic_value_native_fun<f_count<A>, A> {
+    using basic_value_native_fun<f_count<A>, A>::basic_value_native_fun;
+protected:
+    typename basic_value<A>::value_ptr eval(basic_state<A>& thread,
+                                            basic_symbol_table<A>& l_vars,
+                                            const basic_code_node<A>& node,
+                                            std::string_view fun_name) override;
+};
+
 //! Common functionality of classes f_div and f_mod
 /*! \tparam A an allocator type */
 template <impl::allocator A>
@@ -273,6 +350,35 @@ protected:
                                             std::string_view fun_name) override;
 };
 
+//! Function \c dot
+/*! Computes the dot product of two packed numeric vectors. The computation
+ * uses the same rules as f_add and f_mul, that is, modulo arithmetic for \c
+ * unsigned_vector and overflow checking for \c int_vector.
+ * \param result (optional) if exists and has the element type of \a vec1 and
+ * \a vec2, the result is stored into it; otherwise, a new value is allocated
+ * for the result
+ * \param vec1 the first operand, of type \c int_vector or \c
+ * unsigned_vector
+ * \param vec2 the second operand, it must have the same type as \a vec1
+ * \return the sum of products of the corresponding elements of \a vec1 and
+ * \a vec2, of type \c int or \c unsigned; 0 for empty vectors
+ * \throw exception::op_narg if the number of arguments is not 2 or 3
+ * \throw exception::value_null if \a vec1 or \a vec2 is \c null
+ * \throw exception::value_type if \a vec1 is not a packed vector or if \a
+ * vec2 does not have the same type as \a vec1
+ * \throw exception::value_out_of_range if \a vec1 and \a vec2 have different
+ * sizes
+ * \throw exception::op_overflow if overflow occurs in an \c int_vector */
+template <impl::allocator A>
+class f_dot final: public basic_value_native_fun<f_dot<A>, A> {
+    using basic_value_native_fun<f_dot<A>, A>::basic_value_native_fun;
+protected:
+    typename basic_value<A>::value_ptr eval(basic_state<A>& thread,
+                                            basic_symbol_table<A>& l_vars,
+                                            const basic_code_node<A>& node,
+                                            std::string_view fun_name) override;
+};
+
 //! Function \c eq
 /*! Compares two values for equality. Unlike f_is_same, this function compares
  * the contents of values, not their location in memory. If both values are of
@@ -319,23 +425,26 @@ protected:
 /*! Removes elements from a value of type \c vector or \c hash. If called
  * without argument \a idx, all elements are removed.
  *
- * If \a container has type \c vector then elements from index \a idx to the
- * end of the vector are deleted and the vector is shrinked to the first \a idx
- * elements. If \a idx is greater or equal to the size of the vector then
- * nothing is deleted and the vector size remains unchanged.
+ * If \a container has type \c vector, \c int_vector, or \c unsigned_vector
+ * then elements from index \a idx to the end of the vector are deleted and the
+ * vector is shrinked to the first \a idx elements. If \a idx is greater or
+ * equal to the size of the vector then nothing is deleted and the vector size
+ * remains unchanged.
  *
  * If \a container has type \c hash then the element with key \a idx is
  * deleted. If \c hash does not contain an element with key \a idx then nothing
  * is deleted and the hash remains unchanged.
- * \param container a value of type \c vector or \c hash
+ * \param container a value of type \c vector, \c hash, \c int_vector, or \c
+ * unsigned_vector
  * \param idx (optional) an index (of type \c int or \c unsigned for a \c
- * vector), or a key (of type \c string for a \c hash)
+ * vector or a packed vector), or a key (of type \c string for a \c hash)
  * \return \c null
  * \throw exception::op_narg if the number of arguments is not 1 or 2
  * \throw exception::value_null if \a container or \a idx is \c null
- * \throw exception::value_type if \a container does not have type \c vector
- * or \c hash, or if \a idx does not have type \c int or \c unsigned for a \c
- * vector, or if \a idx does not have type \c string for a \c hash
+ * \throw exception::value_type if \a container does not have type \c vector,
+ * \c hash, \c int_vector, or \c unsigned_vector, or if \a idx does not have
+ * type \c int or \c unsigned for a vector, or if \a idx does not have type
+ * \c string for a \c hash
  * \throw exception::value_out_of_range if \a idx is negative
  * \throw exception::value_read_only if trying to remove an element from a
  * read-only \a container */
@@ -349,6 +458,27 @@ protected:
                                             std::string_view fun_name) override;
 };
 
+//! Function \c find
+/*! Finds the first element of a packed numeric vector equal to a value.
+ * \param vec a value of type \c int_vector or \c unsigned_vector
+ * \param val the searched value, of type \c int for an \c int_vector, or \c
+ * unsigned for an \c unsigned_vector
+ * \return the \c unsigned index of the first element of \a vec equal to \a
+ * val; \c null if not found
+ * \throw exception::op_narg if the number of arguments is not 2
+ * \throw exception::value_null if \a vec or \a val is \c null
+ * \throw exception::value_type if \a vec is not a packed vector or if \a val
+ * does not have the element type of \a vec */
+template <impl::allocator A>
+class f_find final: public basic_value_native_fun<f_find<A>, A> {
+    using basic_value_native_fun<f_find<A>, A>::basic_value_native_fun;
+protected:
+    typename basic_value<A>::value_ptr eval(basic_state<A>& thread,
+                                            basic_symbol_table<A>& l_vars,
+                                            const basic_code_node<A>& node,
+                                            std::string_view fun_name) override;
+};
+
 //! Command \c fun
 /*! Defines a function. The function is stored in the global symbol table of
  * the current thread (basic_state::t_vars). The function value in the symbol
@@ -485,6 +615,33 @@ protected:
                                             std::string_view fun_name) override;
 };
 
+//! Command \c import
+/*! It imports a module, which is a script file found in the module search path
+ * of basic_module_registry of the current virtual machine. The module is
+ * loaded by basic_module_registry::import(), therefore it is parsed and
+ * evaluated only once in the virtual machine. Then all thread-safe symbols
+ * defined by the module (functions and variables) are set as global
+ * variables of the current thread, that is, in basic_state::t_vars.
+ * \param name the module name
+ * \return \c null
+ * \throw exception::op_narg if the number of arguments is not 1
+ * \throw exception::value_null if \a name is \c null
+ * \throw exception::value_type if \a name is not of type \c string
+ * \throw exception::op_import_not_found if the module file is not found
+ * \throw exception::op_import_cycle if the module imports itself, directly
+ * or indirectly
+ * \throw exception::wrapped if the module cannot be read or parsed
+ * \throw any exception thrown by the module script */
+template <impl::allocator A>
+class f_import final: public basic_value_native_fun<f_import<A>, A> {
+    using basic_value_native_fun<f_import<A>, A>::basic_value_native_fun;
+protected:
+    typename basic_value<A>::value_ptr eval(basic_state<A>& thread,
+                                            basic_symbol_table<A>& l_vars,
+                                            const basic_code_node<A>& node,
+                                            std::string_view fun_name) override;
+};
+
 //! Function \c int
 /*! Converts a value to \c int. An \c int value is returned unchanged. An \c
  * uint value is converted using integral conversion rules of C++, that is,
@@ -523,6 +680,28 @@ protected:
                                             std::string_view fun_name) override;
 };
 
+//! Function \c int_vector
+/*! It creates a new value of type \c int_vector, a packed vector of \c int
+ * elements.
+ * \param size (optional) the number of elements, of type \c int or \c
+ * unsigned; all elements are initialized to 0; if missing, an empty vector is
+ * created
+ * \return the newly created \c int_vector
+ * \throw exception::op_narg if the number of arguments is not 0 or 1
+ * \throw exception::value_null if \a size is \c null
+ * \throw exception::value_type if \a size is not \c int or \c unsigned
+ * \throw exception::value_out_of_range if \a size is negative or greater than
+ * \link a_basic_vector a_basic_vector::max_size()\endlink */
+template <impl::allocator A>
+class f_int_vector final: public basic_value_native_fun<f_int_vector<A>, A> {
+    using basic_value_native_fun<f_int_vector<A>, A>::basic_value_native_fun;
+protected:
+    typename basic_value<A>::value_ptr eval(basic_state<A>& thread,
+                                            basic_symbol_table<A>& l_vars,
+                                            const basic_code_node<A>& node,
+                                            std::string_view fun_name) override;
+};
+
 //! Function \c is_mt_safe
 /*! Tests if a value is marked as thread-safe and may be shared among threads.
  * \param result (optional) if exists and has type \c bool, the result is
@@ -673,6 +852,69 @@ protected:
                                             std::string_view fun_name) override;
 };
 
+//! Common functionality of classes f_max and f_min
+/*! \tparam A an allocator type */
+template <impl::allocator A>
+class f_minmax_base: public basic_value_native_fun<f_minmax_base<A>, A> {
+    using basic_value_native_fun<f_minmax_base<A>, A>::basic_value_native_fun;
+protected:
+    //! Computes a result.
+    /*! This is the common part of evaluation used by both f_max::eval() and
+     * f_min::eval(). Arguments are the same as in eval():
+     * \param[in] thread
+     * \param[in] l_vars
+     * \param[in] node
+     * \param[in] min whether to compute the minimum (\c true) or the maximum
+     * (\c false)
+     * \return the result of evaluation */
+    typename basic_value<A>::value_ptr eval_impl(basic_state<A>& thread,
+                                            basic_symbol_table<A>& l_vars,
+                                            const basic_code_node<A>& node,
+                                            bool min);
+};
+
+//! Function \c max
+/*! Computes the maximum element of a packed numeric vector.
+ * \param result (optional) if exists and has the element type of \a vec, the
+ * result is stored into it; otherwise, a new value is allocated for the
+ * result
+ * \param vec a value of type \c int_vector or \c unsigned_vector
+ * \return the maximum element of \a vec, of type \c int or \c unsigned
+ * \throw exception::op_narg if the number of arguments is not 1 or 2
+ * \throw exception::value_null if \a vec is \c null
+ * \throw exception::value_type if \a vec is not a packed vector
+ * \throw exception::value_out_of_range if \a vec is empty */
+template <impl::allocator A>
+class f_max final: public f_minmax_base<A> {
+    using f_minmax_base<A>::f_minmax_base;
+protected:
+    typename basic_value<A>::value_ptr eval(basic_state<A>& thread,
+                                            basic_symbol_table<A>& l_vars,
+                                            const basic_code_node<A>& node,
+                                            std::string_view fun_name) override;
+};
+
+//! Function \c min
+/*! Computes the minimum element of a packed numeric vector.
+ * \param result (optional) if exists and has the element type of \a vec, the
+ * result is stored into it; otherwise, a new value is allocated for the
+ * result
+ * \param vec a value of type \c int_vector or \c unsigned_vector
+ * \return the minimum element of \a vec, of type \c int or \c unsigned
+ * \throw exception::op_narg if the number of arguments is not 1 or 2
+ * \throw exception::value_null if \a vec is \c null
+ * \throw exception::value_type if \a vec is not a packed vector
+ * \throw exception::value_out_of_range if \a vec is empty */
+template <impl::allocator A>
+class f_min final: public f_minmax_base<A> {
+    using f_minmax_base<A>::f_minmax_base;
+protected:
+    typename basic_value<A>::value_ptr eval(basic_state<A>& thread,
+                                            basic_symbol_table<A>& l_vars,
+                                            const basic_code_node<A>& node,
+                                            std::string_view fun_name) override;
+};
+
 //! Function \c mod
 /*! Numeric remainder (modulo) of division. It follows the C++ rules, therefore
  * it throws exceptions under the same conditions as f_div: Unsigned division
@@ -731,30 +973,70 @@ protected:
  * If both arguments \a val1 and \a val2 are \c int or \c unsigned, then they
  * are multiplied. If one them is \c string, the other must be \c unsigned or a
  * nonnegative \c int and the string argument is repeated as many times as is
- * the value of the numeric argument.
+ * the value of the numeric argument. If both arguments are \c int_vector or
+ * both are \c unsigned_vector, then they are multiplied elementwise.
  * \param result (optional) if it exists and has the same type as \a val1 and
  * \a val2, the result is stored into it; otherwise, a new value is allocated
  * for the result
  * \param val1 the first operand
  * \param val2 the second operand
- * \return \a val1 * \a val2 if they are \c int or \c unsigned; repeated of
- * the string argument otherwise
+ * \return \a val1 * \a val2 if they are \c int or \c unsigned; elementwise
+ * product if they are packed vectors; repeated of the string argument
+ * otherwise
  * \throw exception::op_narg if the number of arguments is not 2 or 3
  * \throw exception::value_null if \a val1 or \a val2 is \c null
  * \throw exception::value_type if \a val1 and \a val2 do not have an allowed
- * combination of types: either both \c int, both \c unsigned, or one \c string
- * and the other \c int or \c unsigned
- * \throw exception::op_overflow if \a val1 and \a val2 have type \c int and
- * overflow occurs; or if one argument is \c string and the other is a negative
- * \c int */
+ * combination of types: either both \c int, both \c unsigned, both \c
+ * int_vector, both \c unsigned_vector, or one \c string and the other \c int
+ * or \c unsigned
+ * \throw exception::value_out_of_range if \a val1 and \a val2 are vectors
+ * of different sizes
+ * \throw exception::op_overflow if \a val1 and \a val2 have type \c int or
+ * \c int_vector and overflow occurs; or if one argument is \c string and the
+ * other is a negative \c int */
 template <impl::allocator A>
 class f_mul final: public basic_value_native_fun<f_mul<A>, A> {
     using basic_value_native_fun<f_mul<A>, A>::basic_value_native_fun;
+public:
+    //! Multiplies two signed integers.
+    /*! This is a helper function used by eval() and it should be used (for
+     * consistency) by any other multiplication of \c int values.
+     * \param[in] s1 the first operand
+     * \param[in] s2 the second operand
+     * \return \a s1 * \a s2
+     * \throw exception::op_overflow if overflow occurs */
+    static config::value_int_type mul(config::value_int_type s1,
+                                      config::value_int_type s2);
+    //! Multiplies two unsigned integers.
+    /*! This is a helper function used by eval() and it should be used (for
+     * consistency) by any other multiplication of \c unsigned values. It uses
+     * modulo arithmetic.
+     * \param[in] u1 the first operand
+     * \param[in] u2 the second operand
+     * \return \a u1 * \a u2 */
+    static config::value_unsigned_type mul(config::value_unsigned_type u1,
+                                           config::value_unsigned_type u2);
 protected:
     typename basic_value<A>::value_ptr eval(basic_state<A>& thread,
                                             basic_symbol_table<A>& l_vars,
                                             const basic_code_node<A>& node,
                                             std::string_view fun_name) override;
+private:
+    //! Multiplies two packed numeric vectors elementwise.
+    /*! The loop for \c unsigned_vector is written so that the compiler can
+     * vectorize it. Elements of \c int_vector are multiplied by mul(), which
+     * checks overflow.
+     * \tparam V basic_value_int_vector or basic_value_unsigned_vector
+     * \param[in] v1 the first operand
+     * \param[in] v2 the second operand
+     * \param[in] alloc the allocator of the result
+     * \return the elementwise product of \a v1 and \a v2
+     * \throw exception::value_out_of_range if \a v1 and \a v2 have
+     * different sizes
+     * \throw exception::op_overflow if overflow occurs in an \c int_vector */
+    template <class V> static typename V::value_type
+    mul_vector(const typename V::value_type& v1,
+               const typename V::value_type& v2, const A& alloc);
 };
 
 //! Function \c ne
@@ -866,6 +1148,158 @@ protected:
                                             std::string_view fun_name) override;
 };
 
+//! Common functionality of classes f_par_for, f_par_map, and f_par_reduce
+/*! These functions call a script function for elements of a \c vector in
+ * parallel, using the task pool (basic_task_pool) of the virtual machine.
+ * The function is called in the current thread and in pool threads, hence any
+ * functions called by it must be accessible via shared variables. Each thread
+ * uses its own basic_state with basic_state::max_stack of the current thread.
+ * The state of a pool thread is reset after each call of a parallel function,
+ * so global variables set by the function are not visible to later tasks.
+ * Results of the function passed between threads are made thread-safe as if by
+ * function \c mt_safe. All threads allocate memory by the allocator of the
+ * virtual machine, so that allocator limits apply to all of them.
+ * \tparam A an allocator type */
+template <impl::allocator A>
+class f_par_base: public basic_value_native_fun<f_par_base<A>, A> {
+    using basic_value_native_fun<f_par_base<A>, A>::basic_value_native_fun;
+protected:
+    //! Arguments common to all parallel functions
+    struct par_args {
+        //! The input vector
+        std::shared_ptr<basic_value_vector<A>> vec;
+        //! The name of the called function
+        std::shared_ptr<basic_value_string<A>> name;
+        //! The called function
+        std::shared_ptr<basic_value_function<A>> fun;
+    };
+    //! Evaluates the input vector and the called function.
+    /*! Arguments are the same as in eval():
+     * \param[in] thread
+     * \param[in] l_vars
+     * \param[in] node
+     * \param[in] narg_max the maximum number of arguments
+     * \return the evaluated arguments
+     * \throw exception::op_narg if the number of arguments is less than 2 or
+     * greater than \a narg_max
+     * \throw exception::value_null if the vector or the function name is \c
+     * null
+     * \throw exception::value_type if the vector is not a \c vector, if the
+     * function name is not a \c string, or if it is not a name of a function
+     * \throw exception::value_mt_unsafe if the vector is not thread-safe
+     * \throw exception::unknown_symbol if the function does not exist */
+    par_args eval_args(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
+                       const basic_code_node<A>& node, size_t narg_max = 2);
+    //! Calls the function with two arguments.
+    /*! \param[in] thread the current thread
+     * \param[in] args the evaluated arguments of the parallel function
+     * \param[in] a1 the first argument passed to the called function
+     * \param[in] a2 the second argument passed to the called function
+     * \return the result of the function */
+    typename basic_value<A>::value_ptr
+    call(basic_state<A>& thread, const par_args& args,
+         typename basic_value<A>::value_ptr a1,
+         typename basic_value<A>::value_ptr a2);
+    //! Makes a result of the called function thread-safe.
+    /*! \param[in] v a result
+     * \return \a v
+     * \throw exception::value_mt_unsafe if \a v cannot be made thread-safe */
+    static typename basic_value<A>::value_ptr
+    mt_safe_result(typename basic_value<A>::value_ptr v);
+    //! Creates an index value passed to the called function.
+    /*! \param[in] thread the current thread
+     * \param[in] i an index
+     * \return an \c unsigned value \a i */
+    typename basic_value<A>::value_ptr index(basic_state<A>& thread, size_t i);
+};
+
+//! Function \c par_for
+/*! It calls a function for each element of a \c vector in parallel, in an
+ * unspecified order. See f_par_base for details.
+ * \param vec a thread-safe \c vector
+ * \param fun the name of the called function, of type \c string; it is
+ * called with two arguments: an element of \a vec and its \c unsigned index
+ * \return \c null
+ * \throw exception::op_narg if the number of arguments is not 2
+ * \throw exception::value_null if \a vec or \a fun is \c null
+ * \throw exception::value_type if \a vec is not a \c vector, or if \a fun is
+ * not a \c string or if it is not a name of a function
+ * \throw exception::value_mt_unsafe if \a vec is not thread-safe
+ * \throw exception::unknown_symbol if function \a fun does not exist
+ * \throw any exception thrown by \a fun; if multiple calls throw, one of the
+ * exceptions is propagated */
+template <impl::allocator A>
+class f_par_for final: public f_par_base<A> {
+    using f_par_base<A>::f_par_base;
+protected:
+    typename basic_value<A>::value_ptr eval(basic_state<A>& thread,
+                                            basic_symbol_table<A>& l_vars,
+                                            const basic_code_node<A>& node,
+                                            std::string_view fun_name) override;
+};
+
+//! Function \c par_map
+/*! It calls a function for each element of a \c vector in parallel and
+ * collects the results. See f_par_base for details.
+ * \param vec a thread-safe \c vector
+ * \param fun the name of the called function, of type \c string; it is
+ * called with two arguments: an element of \a vec and its \c unsigned index
+ * \return a new \c vector of the same size as \a vec, containing the
+ * result of \a fun for each element of \a vec at the index of the element
+ * \throw exception::op_narg if the number of arguments is not 2
+ * \throw exception::value_null if \a vec or \a fun is \c null
+ * \throw exception::value_type if \a vec is not a \c vector, or if \a fun is
+ * not a \c string or if it is not a name of a function
+ * \throw exception::value_mt_unsafe if \a vec is not thread-safe
+ * \throw exception::unknown_symbol if function \a fun does not exist
+ * \throw exception::value_mt_unsafe if a result of \a fun cannot be made
+ * thread-safe
+ * \throw any exception thrown by \a fun; if multiple calls throw, one of the
+ * exceptions is propagated */
+template <impl::allocator A>
+class f_par_map final: public f_par_base<A> {
+    using f_par_base<A>::f_par_base;
+protected:
+    typename basic_value<A>::value_ptr eval(basic_state<A>& thread,
+                                            basic_symbol_table<A>& l_vars,
+                                            const basic_code_node<A>& node,
+                                            std::string_view fun_name) override;
+};
+
+//! Function \c par_reduce
+/*! It combines all elements of a \c vector by a binary function. Consecutive
+ * elements are combined in parallel chunks, and then the partial results are
+ * combined in order. The result is the same as of sequential evaluation
+ * <tt>fun(...fun(fun(init, vec[0]), vec[1])..., vec[n - 1])</tt> only if
+ * \a fun is associative. See f_par_base for details.
+ * \param vec a thread-safe \c vector
+ * \param fun the name of the called function, of type \c string; it is
+ * called with two arguments: an accumulated value and an element of \a vec
+ * or a partial result
+ * \param init (optional) the initial value
+ * \return the combined value; \a init if \a vec is empty (\c null if \a
+ * init is missing); the only element if \a vec has one element and \a init
+ * is missing
+ * \throw exception::op_narg if the number of arguments is not 2 or 3
+ * \throw exception::value_null if \a vec or \a fun is \c null
+ * \throw exception::value_type if \a vec is not a \c vector, or if \a fun is
+ * not a \c string or if it is not a name of a function
+ * \throw exception::value_mt_unsafe if \a vec is not thread-safe
+ * \throw exception::unknown_symbol if function \a fun does not exist
+ * \throw exception::value_mt_unsafe if a result of \a fun cannot be made
+ * thread-safe
+ * \throw any exception thrown by \a fun; if multiple calls throw, one of the
+ * exceptions is propagated */
+template <impl::allocator A>
+class f_par_reduce final: public f_par_base<A> {
+    using f_par_base<A>::f_par_base;
+protected:
+    typename basic_value<A>::value_ptr eval(basic_state<A>& thread,
+                                            basic_symbol_table<A>& l_vars,
+                                            const basic_code_node<A>& node,
+                                            std::string_view fun_name) override;
+};
+
 //! Function \c print
 /*! It writes all its arguments atomically to the standard output, which can be
  * redirected to any \c std::ostream by basic_state::std_out or
@@ -885,6 +1319,38 @@ protected:
                                             std::string_view fun_name) override;
 };
 
+//! Function \c select
+/*! It waits until at least one of several channel operations can be
+ * performed, then it performs exactly one of them. If more operations are
+ * ready, one of them is chosen pseudorandomly, so that no channel is starved.
+ * The function blocks without busy waiting. See basic_channel::select() for
+ * details, especially about channels with zero capacity.
+ * \param ops a \c vector of operations; each element is either a \c channel
+ * (receiving a value from the channel), or a \c vector containing
+ * a \c channel and a thread-safe value (sending the value to the channel)
+ * \param timeout (optional) the maximum time to wait in milliseconds, of type
+ * \c int or \c unsigned; if missing, the function waits indefinitely
+ * \return a new \c vector containing the \c unsigned index of the performed
+ * operation in \a ops and the received value (\c null for a send
+ * operation); \c null if no operation was performed before \a timeout
+ * expired
+ * \throw exception::op_narg if the number of arguments is not 1 or 2
+ * \throw exception::value_null if \a ops, any of its elements, or \a timeout
+ * is \c null
+ * \throw exception::value_type if \a ops or any of its elements has a bad type
+ * \throw exception::value_mt_unsafe if a value to be sent is not thread-safe
+ * \throw exception::value_out_of_range if \a timeout is negative, or if \a ops
+ * is empty and \a timeout is missing */
+template <impl::allocator A>
+class f_select final: public basic_value_native_fun<f_select<A>, A> {
+    using basic_value_native_fun<f_select<A>, A>::basic_value_native_fun;
+protected:
+    typename basic_value<A>::value_ptr eval(basic_state<A>& thread,
+                                            basic_symbol_table<A>& l_vars,
+                                            const basic_code_node<A>& node,
+                                            std::string_view fun_name) override;
+};
+
 //! Command \c seq
 /*! It evaluates all its arguments sequentially. This is essentially equivalent
  * to a block of commands in other programming languages.
@@ -906,9 +1372,9 @@ protected:
  * \param result (optional) if it exists and has type \c unsigned, the result
  * is stored into it; otherwise, a new value is allocated for the result
  * \param val a value
- * \return an \c unsigned value: the number of elements of a \c vector or \c
- * hash, the number of characters in a \c string, 1 otherwise (for scalar
- * types)
+ * \return an \c unsigned value: the number of elements of a \c vector, \c
+ * hash, \c int_vector, or \c unsigned_vector, the number of characters in a
+ * \c string, 1 otherwise (for scalar types)
  * \throw exception::op_narg if the number of arguments is not 1 or 2
  * \throw exception::value_null if \a val is \c null */
 template <impl::allocator A>
@@ -921,6 +1387,45 @@ protected:
                                             std::string_view fun_name) override;
 };
 
+//! Function \c spawn
+/*! It calls a function asynchronously in a thread of the task pool
+ * (basic_task_pool) of the virtual machine. The function is looked up in the
+ * current thread, but it is executed by a pool thread, hence any functions
+ * called by it must be accessible via shared variables. The result of the
+ * called function is made thread-safe as if by function \c mt_safe. The
+ * function runs in a green thread, which is suspended without blocking the
+ * pool thread while the function waits, e.g., in a channel operation. It uses
+ * basic_state::max_stack of the current thread, and a call that would
+ * overflow the stack of the green thread throws exception::op_recursion.
+ * \param fun the name of the called function, of type \c string
+ * \param args (0 or more) arguments passed to the function; they must be
+ * thread-safe
+ * \return a new \c future object (basic_future), which can be used to get the
+ * result of the function or the exception thrown by it
+ * \throw exception::op_narg if the number of arguments is 0
+ * \throw exception::value_null if \a fun is \c null
+ * \throw exception::value_type if \a fun is not a \c string or if it is not
+ * a name of a function
+ * \throw exception::unknown_symbol if function \a fun does not exist
+ * \throw exception::value_mt_unsafe if any of \a args is not thread-safe */
+template <impl::allocator A>
+class f_spawn final: public basic_value_native_fun<f_spawn<A>, A> {
+public:
+    //! Creates the function object.
+    /*! \param[in] t an ignored parameter that prevents using this constructor
+     * directly
+     * \param[in] alloc an allocator used to create \ref methods */
+    f_spawn(typename f_spawn::tag t, const A& alloc);
+protected:
+    typename basic_value<A>::value_ptr eval(basic_state<A>& thread,
+                                            basic_symbol_table<A>& l_vars,
+                                            const basic_code_node<A>& node,
+                                            std::string_view fun_name) override;
+private:
+    //! The table of methods of created \c future objects
+    std::shared_ptr<const typename basic_future<A>::method_table> methods;
+};
+
 //! Function \c sub
 /*! Numeric subtraction. Unsigned subtraction is done using modulo arithmetic,
  * signed overflow causes exception::op_overflow.
@@ -939,6 +1444,25 @@ protected:
 template <impl::allocator A>
 class f_sub final: public basic_value_native_fun<f_sub<A>, A> {
     using basic_value_native_fun<f_sub<A>, A>::basic_value_native_fun;
+public:
+    //! Subtracts two signed integers.
+    /*! This is a helper function used by eval() and it should be used (for
+     * consistency) by any other subtraction of \c int values.
+     * \param[in] s1 the first operand
+     * \param[in] s2 the second operand
+     * \return \a s1 - \a s2
+     * \throw exception::op_overflow if overflow occurs */
+    static config::value_int_type sub(config::value_int_type s1,
+                                      config::value_int_type s2);
+    //! Subtracts two unsigned integers.
+    /*! This is a helper function used by eval() and it should be used (for
+     * consistency) by any other subtraction of \c unsigned values. It uses
+     * modulo arithmetic.
+     * \param[in] u1 the first operand
+     * \param[in] u2 the second operand
+     * \return \a u1 - \a u2 */
+    static config::value_unsigned_type sub(config::value_unsigned_type u1,
+                                           config::value_unsigned_type u2);
 protected:
     typename basic_value<A>::value_ptr eval(basic_state<A>& thread,
                                             basic_symbol_table<A>& l_vars,
@@ -970,6 +1494,30 @@ protected:
                                             std::string_view fun_name) override;
 };
 
+//! Function \c sum
+/*! Computes the sum of elements of a packed numeric vector. The computation
+ * uses the same rules as f_add, that is, modulo arithmetic for \c
+ * unsigned_vector and overflow checking for \c int_vector.
+ * \param result (optional) if exists and has the element type of \a vec, the
+ * result is stored into it; otherwise, a new value is allocated for the
+ * result
+ * \param vec a value of type \c int_vector or \c unsigned_vector
+ * \return the sum of elements of \a vec, of type \c int or \c unsigned; 0
+ * for an empty vector
+ * \throw exception::op_narg if the number of arguments is not 1 or 2
+ * \throw exception::value_null if \a vec is \c null
+ * \throw exception::value_type if \a vec is not a packed vector
+ * \throw exception::op_overflow if overflow occurs in an \c int_vector */
+template <impl::allocator A>
+class f_sum final: public basic_value_native_fun<f_sum<A>, A> {
+    using basic_value_native_fun<f_sum<A>, A>::basic_value_native_fun;
+protected:
+    typename basic_value<A>::value_ptr eval(basic_state<A>& thread,
+                                            basic_symbol_table<A>& l_vars,
+                                            const basic_code_node<A>& node,
+                                            std::string_view fun_name) override;
+};
+
 //! Command \c throw
 /*! Throws an exception of type exception::script_throw. This command never
  * returns.
@@ -1080,6 +1628,53 @@ protected:
                                             std::string_view fun_name) override;
 };
 
+//! Function \c unsigned_vector
+/*! It creates a new value of type \c unsigned_vector, a packed vector of \c
+ * unsigned elements.
+ * \param size (optional) the number of elements, of type \c int or \c
+ * unsigned; all elements are initialized to 0; if missing, an empty vector is
+ * created
+ * \return the newly created \c unsigned_vector
+ * \throw exception::op_narg if the number of arguments is not 0 or 1
+ * \throw exception::value_null if \a size is \c null
+ * \throw exception::value_type if \a size is not \c int or \c unsigned
+ * \throw exception::value_out_of_range if \a size is negative or greater than
+ * \link a_basic_vector a_basic_vector::max_size()\endlink */
+template <impl::allocator A>
+class f_unsigned_vector final:
+    public basic_value_native_fun<f_unsigned_vector<A>, A>
+{
+    using basic_value_native_fun<f_unsigned_vector<A>, A>::
+        basic_value_native_fun;
+protected:
+    typename basic_value<A>::value_ptr eval(basic_state<A>& thread,
+                                            basic_symbol_table<A>& l_vars,
+                                            const basic_code_node<A>& node,
+                                            std::string_view fun_name) override;
+};
+
+//! Function \c update_sh_vars
+/*! It switches the current thread to the current global variables shared by
+ * all threads of the virtual machine (basic_virtual_machine::sh_vars) by
+ * calling basic_state::update_sh_vars(). It is a safe point for a thread
+ * running in a loop, where it starts using functions and variables published
+ * by basic_reloader. It is cheap if the shared variables have not changed.
+ * \return \c true if the thread has switched to new shared variables, \c
+ * false if the shared variables have not changed
+ * \throw exception::op_narg if the number of arguments is not 0 */
+template <impl::allocator A>
+class f_update_sh_vars final:
+    public basic_value_native_fun<f_update_sh_vars<A>, A>
+{
+    using basic_value_native_fun<f_update_sh_vars<A>, A>::
+        basic_value_native_fun;
+protected:
+    typename basic_value<A>::value_ptr eval(basic_state<A>& thread,
+                                            basic_symbol_table<A>& l_vars,
+                                            const basic_code_node<A>& node,
+                                            std::string_view fun_name) override;
+};
+
 //! Command \c var
 /*! It gets or sets a \a value of variable \a name. It assings a reference to
  * the \a value instead of copying it. Hence, the same value may be accessible
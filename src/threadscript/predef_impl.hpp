@@ -5,19 +5,123 @@
  */
 
 #include "threadscript/predef.hpp"
+#include "threadscript/atomic.hpp"
+#include "threadscript/bytes.hpp"
 #include "threadscript/channel.hpp"
+#include "threadscript/future_impl.hpp"
+#include "threadscript/module_impl.hpp"
 #include "threadscript/shared_hash.hpp"
 #include "threadscript/shared_vector.hpp"
+#include "threadscript/string_builder.hpp"
+#include "threadscript/sync.hpp"
 
+#include <algorithm>
 #include <limits>
+#include <mutex>
 #include <syncstream>
+#include <type_traits>
+#include <utility>
 
 namespace threadscript {
 
+namespace impl {
+
+//! Calls a function for a packed numeric vector.
+/*! \tparam A an allocator type
+ * \tparam F a function type
+ * \param[in] val a value
+ * \param[in] f a function called with a reference to \a val converted to
+ * basic_value_int_vector or basic_value_unsigned_vector
+ * \return the value returned by \a f
+ * \throw exception::value_null if \a val is \c null
+ * \throw exception::value_type if \a val is not a packed numeric vector */
+template <allocator A, class F>
+auto visit_num_vector(const typename basic_value<A>::value_ptr& val, F&& f)
+{
+    if (!val)
+        throw exception::value_null();
+    if (auto pi = dynamic_cast<basic_value_int_vector<A>*>(val.get()))
+        return f(*pi);
+    else if (auto pu = dynamic_cast<basic_value_unsigned_vector<A>*>(val.get()))
+        return f(*pu);
+    else
+        throw exception::value_type();
+}
+
+//! Gets a value of an element type of a packed numeric vector.
+/*! \tparam V basic_value_int_vector or basic_value_unsigned_vector
+ * \tparam A an allocator type
+ * \param[in] val a value
+ * \return the value stored in \a val
+ * \throw exception::value_null if \a val is \c null
+ * \throw exception::value_type if \a val does not have type
+ * <tt>V::element_value</tt> */
+template <class V, allocator A> typename V::element_value::value_type
+num_vector_element(const std::shared_ptr<basic_value<A>>& val)
+{
+    if (!val)
+        throw exception::value_null();
+    if (auto pe = dynamic_cast<typename V::element_value*>(val.get()))
+        return pe->cvalue();
+    else
+        throw exception::value_type();
+}
+
+} // namespace impl
+
 namespace predef {
 
 /*** f_add *******************************************************************/
 
+template <impl::allocator A> config::value_int_type
+f_add<A>::add(config::value_int_type s1, config::value_int_type s2)
+{
+    // Here, and in other arithmetic operations, we must make sure that if
+    // config::value_unsigned_type is smaller than int, we do not perform
+    // signed instead of unsigned computation due to integral promotion
+    config::value_int_type result = uintmax_t(s1) + uintmax_t(s2);
+    if ((s1 > 0 && s2 > 0 && (result < s1 || result < s2)) ||
+        (s1 < 0 && s2 < 0 && (result > s1 || result > s2)))
+    {
+        throw exception::op_overflow();
+    }
+    return result;
+}
+
+template <impl::allocator A> config::value_unsigned_type
+f_add<A>::add(config::value_unsigned_type u1, config::value_unsigned_type u2)
+{
+    return uintmax_t(u1) + uintmax_t(u2);
+}
+
+template <impl::allocator A> template <class V> typename V::value_type
+f_add<A>::add_vector(const typename V::value_type& v1,
+                     const typename V::value_type& v2, const A& alloc)
+{
+    if (v1.size() != v2.size())
+        throw exception::value_out_of_range();
+    typename V::value_type result(v1.size(), alloc);
+    if constexpr (std::is_same_v<typename V::value_type::value_type,
+                                 config::value_int_type>)
+    {
+        // Overflow is detected by sign bits and accumulated without
+        // branching, so that the loop can be vectorized
+        config::value_int_type overflow = 0;
+        for (size_t i = 0; i < v1.size(); ++i) {
+            config::value_int_type s1 = v1[i];
+            config::value_int_type s2 = v2[i];
+            config::value_int_type r = uintmax_t(s1) + uintmax_t(s2);
+            overflow |= (s1 ^ r) & (s2 ^ r);
+            result[i] = r;
+        }
+        if (overflow < 0)
+            throw exception::op_overflow();
+    } else
+        for (size_t i = 0; i < v1.size(); ++i)
+            result[i] = add(v1[i], v2[i]);
+    return result;
+}
+
 template <impl::allocator A> typename basic_value<A>::value_ptr
 f_add<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
               const basic_code_node<A>& node, std::string_view)
@@ -33,36 +137,45 @@ f_add<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
         auto v2 = dynamic_cast<basic_value_int<A>*>(a2.get());
         if (!v2)
             throw exception::value_type();
-        // Here, and in other arithmetic operations, we must make sure that if
-        // config::value_unsigned_type is smaller than int, we do not perform
-        // signed instead of unsigned computation due to integral promotion
-        auto s1 = v1->cvalue();
-        auto s2 = v2->cvalue();
-        config::value_int_type result = uintmax_t(s1) + uintmax_t(s2);
-        if ((s1 > 0 && s2 > 0 && (result < s1 || result < s2)) ||
-            (s1 < 0 && s2 < 0 && (result > s1 || result > s2)))
-        {
-            throw exception::op_overflow();
-        }
+        auto result = add(v1->cvalue(), v2->cvalue());
         return this->template make_result<basic_value_int<A>>(thread, l_vars,
                                             node, std::move(result), narg == 3);
     } else if (auto v1 = dynamic_cast<basic_value_unsigned<A>*>(a1.get())) {
         auto v2 = dynamic_cast<basic_value_unsigned<A>*>(a2.get());
         if (!v2)
             throw exception::value_type();
-        config::value_unsigned_type result =
-            uintmax_t(v1->cvalue()) + uintmax_t(v2->cvalue());
+        auto result = add(v1->cvalue(), v2->cvalue());
         return this->template make_result<basic_value_unsigned<A>>(thread,
                                     l_vars, node, std::move(result), narg == 3);
     } else if (auto v1 = dynamic_cast<basic_value_string<A>*>(a1.get())) {
         auto v2 = dynamic_cast<basic_value_string<A>*>(a2.get());
         if (!v2)
             throw exception::value_type();
+        if (narg == 3) {
+            auto a0 = this->arg(thread, l_vars, node, 0);
+            if (auto pr = dynamic_cast<basic_value_string<A>*>(a0.get())) {
+                // Appending in place does not copy the whole result
+                if (pr == v1)
+                    pr->value().append(v2->cvalue());
+                else
+                    pr->value() = v1->cvalue() + v2->cvalue();
+                return a0;
+            }
+        }
         auto result = v1->cvalue() + v2->cvalue();
         return this->template make_result<basic_value_string<A>>(thread, l_vars,
-                                            node, std::move(result), narg == 3);
+                                            node, std::move(result), false);
     } else
-        throw exception::value_type();
+        return impl::visit_num_vector<A>(a1, [&](auto& v1) {
+            using V = std::remove_cvref_t<decltype(v1)>;
+            auto v2 = dynamic_cast<V*>(a2.get());
+            if (!v2)
+                throw exception::value_type();
+            auto result = add_vector<V>(v1.cvalue(), v2->cvalue(),
+                                        thread.get_allocator());
+            return this->template make_result<V>(thread, l_vars, node,
+                                                 std::move(result), narg == 3);
+        });
 }
 
 /*** f_and_base **************************************************************/
@@ -128,6 +241,32 @@ f_at<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
                 pv->value().resize(i + 1);
             return pv->value()[i] = this->arg(thread, l_vars, node, 2);
         }
+    } else if (dynamic_cast<basic_value_int_vector<A>*>(container.get()) ||
+               dynamic_cast<basic_value_unsigned_vector<A>*>(container.get()))
+    {
+        return impl::visit_num_vector<A>(container,
+            [&](auto& v) -> typename basic_value<A>::value_ptr {
+                using V = std::remove_cvref_t<decltype(v)>;
+                size_t i = this->arg_index(thread, l_vars, node, 1);
+                if (narg == 2) {
+                    if (i >= v.cvalue().size())
+                        throw exception::value_out_of_range();
+                    auto result =
+                        V::element_value::create(thread.get_allocator());
+                    result->value() = v.cvalue()[i];
+                    return result;
+                } else {
+                    assert(narg == 3);
+                    if (i >= v.cvalue().max_size())
+                        throw exception::value_out_of_range();
+                    auto val = this->arg(thread, l_vars, node, 2);
+                    auto e = impl::num_vector_element<V>(val);
+                    if (i >= v.cvalue().size())
+                        v.value().resize(i + 1);
+                    v.value()[i] = e;
+                    return val;
+                }
+            });
     } else if (auto ph = dynamic_cast<basic_value_hash<A>*>(container.get())) {
         auto idx = this->arg(thread, l_vars, node, 1);
         if (!container || !idx)
@@ -215,6 +354,27 @@ f_contains<A>::eval(basic_state<A>& thread, basic_symbol_table<A>&l_vars,
                                                std::move(result), narg == 3);
 }
 
+/*** f_count *****************************************************************/
+
+template <impl::allocator A> typename basic_value<A>::value_ptr
+f_count<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
+                 const basic_code_node<A>& node, std::string_view)
+{
+    size_t narg = this->narg(node);
+    if (narg != 2 && narg != 3)
+        throw exception::op_narg();
+    auto vec = this->arg(thread, l_vars, node, narg - 2);
+    auto val = this->arg(thread, l_vars, node, narg - 1);
+    config::value_unsigned_type result = impl::visit_num_vector<A>(vec,
+        [&val](auto& v) -> config::value_unsigned_type {
+            using V = std::remove_cvref_t<decltype(v)>;
+            auto e = impl::num_vector_element<V>(val);
+            return std::ranges::count(v.cvalue(), e);
+        });
+    return this->template make_result<basic_value_unsigned<A>>(thread, l_vars,
+                                            node, std::move(result), narg == 3);
+}
+
 /*** f_div_base **************************************************************/
 
 template <impl::allocator A> typename basic_value<A>::value_ptr
@@ -266,6 +426,42 @@ f_div<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
     return f_div_base<A>::eval_impl(thread, l_vars, node, true);
 }
 
+/*** f_dot *******************************************************************/
+
+template <impl::allocator A> typename basic_value<A>::value_ptr
+f_dot<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
+               const basic_code_node<A>& node, std::string_view)
+{
+    size_t narg = this->narg(node);
+    if (narg != 2 && narg != 3)
+        throw exception::op_narg();
+    auto a1 = this->arg(thread, l_vars, node, narg - 2);
+    auto a2 = this->arg(thread, l_vars, node, narg - 1);
+    if (!a1 || !a2)
+        throw exception::value_null();
+    return impl::visit_num_vector<A>(a1, [&](auto& v1) {
+        using V = std::remove_cvref_t<decltype(v1)>;
+        using E = typename V::element_value;
+        auto v2 = dynamic_cast<V*>(a2.get());
+        if (!v2)
+            throw exception::value_type();
+        auto& d1 = v1.cvalue();
+        auto& d2 = v2->cvalue();
+        if (d1.size() != d2.size())
+            throw exception::value_out_of_range();
+        typename E::value_type result = 0;
+        if constexpr (std::is_same_v<E, basic_value_int<A>>)
+            for (size_t i = 0; i < d1.size(); ++i)
+                result = f_add<A>::add(result, f_mul<A>::mul(d1[i], d2[i]));
+        else
+            // Plain modulo arithmetic allows vectorization
+            for (size_t i = 0; i < d1.size(); ++i)
+                result += uintmax_t(d1[i]) * uintmax_t(d2[i]);
+        return this->template make_result<E>(thread, l_vars, node,
+                                             std::move(result), narg == 3);
+    });
+}
+
 /*** f_eq ********************************************************************/
 
 template <impl::allocator A>
@@ -334,12 +530,25 @@ f_erase<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
         else if (auto ph = dynamic_cast<basic_value_hash<A>*>(container.get()))
             ph->value().clear();
         else
-            throw exception::value_type();
+            impl::visit_num_vector<A>(container, [](auto& v) {
+                v.value().clear();
+                return nullptr;
+            });
     } else {
         if (auto pv = dynamic_cast<basic_value_vector<A>*>(container.get())) {
             size_t i = this->arg_index(thread, l_vars, node, 1);
             if (i < pv->cvalue().size())
                 pv->value().resize(i);
+        } else if (dynamic_cast<basic_value_int_vector<A>*>(container.get()) ||
+                   dynamic_cast<basic_value_unsigned_vector<A>*>(
+                                                            container.get()))
+        {
+            size_t i = this->arg_index(thread, l_vars, node, 1);
+            impl::visit_num_vector<A>(container, [i](auto& v) {
+                if (i < v.cvalue().size())
+                    v.value().resize(i);
+                return nullptr;
+            });
         } else
             if (auto ph = dynamic_cast<basic_value_hash<A>*>(container.get())) {
                 auto idx = this->arg(thread, l_vars, node, 1);
@@ -355,6 +564,31 @@ f_erase<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
     return nullptr;
 }
 
+/*** f_find ******************************************************************/
+
+template <impl::allocator A> typename basic_value<A>::value_ptr
+f_find<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
+                const basic_code_node<A>& node, std::string_view)
+{
+    if (this->narg(node) != 2)
+        throw exception::op_narg();
+    auto vec = this->arg(thread, l_vars, node, 0);
+    auto val = this->arg(thread, l_vars, node, 1);
+    return impl::visit_num_vector<A>(vec,
+        [&](auto& v) -> typename basic_value<A>::value_ptr {
+            using V = std::remove_cvref_t<decltype(v)>;
+            auto e = impl::num_vector_element<V>(val);
+            auto& d = v.cvalue();
+            if (auto it = std::ranges::find(d, e); it != d.end()) {
+                auto result =
+                    basic_value_unsigned<A>::create(thread.get_allocator());
+                result->value() = it - d.begin();
+                return result;
+            } else
+                return nullptr;
+        });
+}
+
 /*** f_fun *******************************************************************/
 
 template <impl::allocator A> typename basic_value<A>::value_ptr
@@ -458,6 +692,29 @@ f_if<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
             return nullptr;
 }
 
+/*** f_import ****************************************************************/
+
+template <impl::allocator A> typename basic_value<A>::value_ptr
+f_import<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
+                  const basic_code_node<A>& node, std::string_view)
+{
+    size_t narg = this->narg(node);
+    if (narg != 1)
+        throw exception::op_narg();
+    auto arg_name = this->arg(thread, l_vars, node, 0);
+    if (!arg_name)
+        throw exception::value_null();
+    auto name = dynamic_cast<basic_value_string<A>*>(arg_name.get());
+    if (!name)
+        throw exception::value_type();
+    auto exports =
+        basic_module_registry<A>::get(thread.vm).import(name->cvalue(),
+                                                        &thread);
+    for (auto&& [k, v]: exports->csymbols())
+        thread.t_vars.insert(k, v);
+    return nullptr;
+}
+
 /*** f_int *******************************************************************/
 
 template <impl::allocator A> typename basic_value<A>::value_ptr
@@ -540,6 +797,25 @@ f_int<A>::from_string(const a_basic_string<A>& str, bool sign)
             throw exception::value_out_of_range();
 }
 
+/*** f_int_vector ************************************************************/
+
+template <impl::allocator A> typename basic_value<A>::value_ptr
+f_int_vector<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
+                      const basic_code_node<A>& node, std::string_view)
+{
+    size_t narg = this->narg(node);
+    if (narg != 0 && narg != 1)
+        throw exception::op_narg();
+    auto pr = basic_value_int_vector<A>::create(thread.get_allocator());
+    if (narg == 1) {
+        size_t size = this->arg_index(thread, l_vars, node, 0);
+        if (size > pr->cvalue().max_size())
+            throw exception::value_out_of_range();
+        pr->value().resize(size);
+    }
+    return pr;
+}
+
 /*** f_is_mt_safe ************************************************************/
 
 template <impl::allocator A> typename basic_value<A>::value_ptr
@@ -684,6 +960,53 @@ f_lt<A>::eval(basic_state<A>& thread, basic_symbol_table<A>&l_vars,
                                                std::move(result), narg == 3);
 }
 
+/*** f_minmax_base *********************************************************/
+
+template <impl::allocator A> typename basic_value<A>::value_ptr
+f_minmax_base<A>::eval_impl(basic_state<A>& thread,
+                            basic_symbol_table<A>& l_vars,
+                            const basic_code_node<A>& node, bool min)
+{
+    size_t narg = this->narg(node);
+    if (narg != 1 && narg != 2)
+        throw exception::op_narg();
+    auto vec = this->arg(thread, l_vars, node, narg - 1);
+    return impl::visit_num_vector<A>(vec, [&](auto& v) {
+        using E = typename std::remove_cvref_t<decltype(v)>::element_value;
+        auto& d = v.cvalue();
+        if (d.empty())
+            throw exception::value_out_of_range();
+        // Separate simple loops allow vectorization
+        typename E::value_type result = d.front();
+        if (min)
+            for (auto e: d)
+                result = std::min(result, e);
+        else
+            for (auto e: d)
+                result = std::max(result, e);
+        return this->template make_result<E>(thread, l_vars, node,
+                                             std::move(result), narg == 2);
+    });
+}
+
+/*** f_max *******************************************************************/
+
+template <impl::allocator A> typename basic_value<A>::value_ptr
+f_max<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
+               const basic_code_node<A>& node, std::string_view)
+{
+    return this->eval_impl(thread, l_vars, node, false);
+}
+
+/*** f_min *******************************************************************/
+
+template <impl::allocator A> typename basic_value<A>::value_ptr
+f_min<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
+               const basic_code_node<A>& node, std::string_view)
+{
+    return this->eval_impl(thread, l_vars, node, true);
+}
+
 /*** f_mod *******************************************************************/
 
 template <impl::allocator A> typename basic_value<A>::value_ptr
@@ -715,6 +1038,53 @@ f_mt_safe<A>::eval(basic_state<A>& thread, basic_symbol_table<A>&l_vars,
 
 /*** f_mul *******************************************************************/
 
+template <impl::allocator A> config::value_int_type
+f_mul<A>::mul(config::value_int_type s1, config::value_int_type s2)
+{
+    constexpr auto min = std::numeric_limits<config::value_int_type>::min();
+    constexpr auto max = std::numeric_limits<config::value_int_type>::max();
+    if (s1 != 0 && s2 != 0) {
+        if (s1 > 0) {
+            if (s2 > 0) {
+                if (s2 > max / s1)
+                    throw exception::op_overflow();
+            } else { // s2 < 0
+                if (s2 < min / s1)
+                    throw exception::op_overflow();
+            }
+        } else { // s1 < 0
+            if (s2 > 0) {
+                if (s1 < min / s2)
+                    throw exception::op_overflow();
+            } else { // s2 < 0
+                // -min is undefined in two's complement representation
+                // (which is required since C++20)
+                if (s1 == min || s2 == min || -s2 > max / -s1)
+                    throw exception::op_overflow();
+            }
+        }
+    }
+    return s1 * s2;
+}
+
+template <impl::allocator A> config::value_unsigned_type
+f_mul<A>::mul(config::value_unsigned_type u1, config::value_unsigned_type u2)
+{
+    return uintmax_t(u1) * uintmax_t(u2);
+}
+
+template <impl::allocator A> template <class V> typename V::value_type
+f_mul<A>::mul_vector(const typename V::value_type& v1,
+                     const typename V::value_type& v2, const A& alloc)
+{
+    if (v1.size() != v2.size())
+        throw exception::value_out_of_range();
+    typename V::value_type result(v1.size(), alloc);
+    for (size_t i = 0; i < v1.size(); ++i)
+        result[i] = mul(v1[i], v2[i]);
+    return result;
+}
+
 template <impl::allocator A> typename basic_value<A>::value_ptr
 f_mul<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
               const basic_code_node<A>& node, std::string_view)
@@ -750,44 +1120,27 @@ f_mul<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
         auto v2 = dynamic_cast<basic_value_int<A>*>(a2.get());
         if (!v2)
             throw exception::value_type();
-        auto s1 = v1->cvalue();
-        auto s2 = v2->cvalue();
-        constexpr auto min = std::numeric_limits<config::value_int_type>::min();
-        constexpr auto max = std::numeric_limits<config::value_int_type>::max();
-        if (s1 != 0 && s2 != 0) {
-            if (s1 > 0) {
-                if (s2 > 0) {
-                    if (s2 > max / s1)
-                        throw exception::op_overflow();
-                } else { // s2 < 0
-                    if (s2 < min / s1)
-                        throw exception::op_overflow();
-                }
-            } else { // s1 < 0
-                if (s2 > 0) {
-                    if (s1 < min / s2)
-                        throw exception::op_overflow();
-                } else { // s2 < 0
-                    // -min is undefined in two's complement representation
-                    // (which is required since C++20)
-                    if (s1 == min || s2 == min || -s2 > max / -s1)
-                        throw exception::op_overflow();
-                }
-            }
-        }
-        config::value_int_type result = s1 * s2;
+        auto result = mul(v1->cvalue(), v2->cvalue());
         return this->template make_result<basic_value_int<A>>(thread, l_vars,
                                             node, std::move(result), narg == 3);
     } else if (auto v1 = dynamic_cast<basic_value_unsigned<A>*>(a1.get())) {
         auto v2 = dynamic_cast<basic_value_unsigned<A>*>(a2.get());
         if (!v2)
             throw exception::value_type();
-        config::value_unsigned_type result =
-            uintmax_t(v1->cvalue()) * uintmax_t(v2->cvalue());
+        auto result = mul(v1->cvalue(), v2->cvalue());
         return this->template make_result<basic_value_unsigned<A>>(thread,
                                     l_vars, node, std::move(result), narg == 3);
     } else
-        throw exception::value_type();
+        return impl::visit_num_vector<A>(a1, [&](auto& v1) {
+            using V = std::remove_cvref_t<decltype(v1)>;
+            auto v2 = dynamic_cast<V*>(a2.get());
+            if (!v2)
+                throw exception::value_type();
+            auto result = mul_vector<V>(v1.cvalue(), v2->cvalue(),
+                                        thread.get_allocator());
+            return this->template make_result<V>(thread, l_vars, node,
+                                                 std::move(result), narg == 3);
+        });
 }
 
 /*** f_ne ********************************************************************/
@@ -857,6 +1210,141 @@ f_or_r<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
                                                        std::move(result), true);
 }
 
+/*** f_par_base ************************************************************/
+
+template <impl::allocator A> typename basic_value<A>::value_ptr
+f_par_base<A>::call(basic_state<A>& thread, const par_args& args,
+                    typename basic_value<A>::value_ptr a1,
+                    typename basic_value<A>::value_ptr a2)
+{
+    auto fun_args = basic_value_vector<A>::create(thread.get_allocator());
+    fun_args->value().reserve(2);
+    fun_args->value().push_back(std::move(a1));
+    fun_args->value().push_back(std::move(a2));
+    return args.fun->call(thread, args.name->cvalue(), std::move(fun_args));
+}
+
+template <impl::allocator A> auto
+f_par_base<A>::eval_args(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
+                         const basic_code_node<A>& node, size_t narg_max)
+    -> par_args
+{
+    if (size_t narg = this->narg(node); narg < 2 || narg > narg_max)
+        throw exception::op_narg();
+    par_args result;
+    auto vec = this->arg(thread, l_vars, node, 0);
+    if (!vec)
+        throw exception::value_null();
+    result.vec = std::dynamic_pointer_cast<basic_value_vector<A>>(vec);
+    if (!result.vec)
+        throw exception::value_type();
+    if (!result.vec->mt_safe())
+        throw exception::value_mt_unsafe();
+    auto name = this->arg(thread, l_vars, node, 1);
+    if (!name)
+        throw exception::value_null();
+    result.name = std::dynamic_pointer_cast<basic_value_string<A>>(name);
+    if (!result.name)
+        throw exception::value_type();
+    auto fun = l_vars.lookup(result.name->cvalue());
+    if (!fun)
+        throw exception::unknown_symbol(result.name->cvalue());
+    result.fun = std::dynamic_pointer_cast<basic_value_function<A>>(*fun);
+    if (!result.fun)
+        throw exception::value_type();
+    return result;
+}
+
+template <impl::allocator A> typename basic_value<A>::value_ptr
+f_par_base<A>::mt_safe_result(typename basic_value<A>::value_ptr v)
+{
+    if (v)
+        v->set_mt_safe();
+    return v;
+}
+
+template <impl::allocator A> typename basic_value<A>::value_ptr
+f_par_base<A>::index(basic_state<A>& thread, size_t i)
+{
+    auto result = basic_value_unsigned<A>::create(thread.get_allocator());
+    result->value() = i;
+    return result;
+}
+
+/*** f_par_for ***************************************************************/
+
+template <impl::allocator A> typename basic_value<A>::value_ptr
+f_par_for<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
+                   const basic_code_node<A>& node, std::string_view)
+{
+    auto args = this->eval_args(thread, l_vars, node);
+    auto& vec = args.vec->cvalue();
+    basic_task_pool<A>::get(thread.vm).parallel_for(thread, vec.size(),
+        [this, &args, &vec](basic_state<A>& t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                this->call(t, args, vec[i], this->index(t, i));
+        });
+    return nullptr;
+}
+
+/*** f_par_map ***************************************************************/
+
+template <impl::allocator A> typename basic_value<A>::value_ptr
+f_par_map<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
+                   const basic_code_node<A>& node, std::string_view)
+{
+    auto args = this->eval_args(thread, l_vars, node);
+    auto& vec = args.vec->cvalue();
+    auto result = basic_value_vector<A>::create(thread.get_allocator());
+    auto& res = result->value();
+    res.resize(vec.size());
+    // Each chunk writes different elements of res, no locking needed
+    basic_task_pool<A>::get(thread.vm).parallel_for(thread, vec.size(),
+        [this, &args, &vec, &res](basic_state<A>& t, size_t begin,
+                                  size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                res[i] = this->mt_safe_result(this->call(t, args, vec[i],
+                                                         this->index(t, i)));
+        });
+    return result;
+}
+
+/*** f_par_reduce ************************************************************/
+
+template <impl::allocator A> typename basic_value<A>::value_ptr
+f_par_reduce<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
+                      const basic_code_node<A>& node, std::string_view)
+{
+    auto args = this->eval_args(thread, l_vars, node, 3);
+    bool use_init = this->narg(node) == 3;
+    auto result = use_init ? this->arg(thread, l_vars, node, 2) : nullptr;
+    auto& vec = args.vec->cvalue();
+    // Results of chunks, indexed by the first element of each chunk
+    using partial_t = std::pair<size_t, typename basic_value<A>::value_ptr>;
+    a_basic_vector<partial_t, A> partials(thread.get_allocator());
+    std::mutex mtx;
+    basic_task_pool<A>::get(thread.vm).parallel_for(thread, vec.size(),
+        [this, &args, &vec, &partials, &mtx](basic_state<A>& t, size_t begin,
+                                             size_t end) {
+            auto acc = vec[begin];
+            for (size_t i = begin + 1; i < end; ++i)
+                acc = this->call(t, args, std::move(acc), vec[i]);
+            acc = this->mt_safe_result(std::move(acc));
+            std::lock_guard lck{mtx};
+            partials.emplace_back(begin, std::move(acc));
+        });
+    std::ranges::sort(partials, {}, &partial_t::first);
+    for (auto&& p: partials)
+        if (use_init)
+            result = this->call(thread, args, std::move(result),
+                                std::move(p.second));
+        else {
+            result = std::move(p.second);
+            use_init = true;
+        }
+    return result;
+}
+
 /*** f_print *****************************************************************/
 
 template <impl::allocator A> typename basic_value<A>::value_ptr
@@ -874,6 +1362,63 @@ f_print<A>::eval(basic_state<A>& thread, basic_symbol_table<A>&l_vars,
     return nullptr;
 }
 
+/*** f_select ****************************************************************/
+
+template <impl::allocator A> typename basic_value<A>::value_ptr
+f_select<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
+                  const basic_code_node<A>& node, std::string_view)
+{
+    size_t narg = this->narg(node);
+    if (narg != 1 && narg != 2)
+        throw exception::op_narg();
+    auto arg_ops = this->arg(thread, l_vars, node, 0);
+    if (!arg_ops)
+        throw exception::value_null();
+    auto pv = dynamic_cast<basic_value_vector<A>*>(arg_ops.get());
+    if (!pv)
+        throw exception::value_type();
+    auto channel = [](const typename basic_value<A>::value_ptr& v) {
+        if (!v)
+            throw exception::value_null();
+        auto ch = std::dynamic_pointer_cast<basic_channel<A>>(v);
+        if (!ch)
+            throw exception::value_type();
+        return ch;
+    };
+    using op_t = typename basic_channel<A>::select_op;
+    a_basic_vector<op_t, A> ops(thread.get_allocator());
+    ops.reserve(pv->cvalue().size());
+    for (auto&& e: pv->cvalue()) {
+        if (!e)
+            throw exception::value_null();
+        if (auto ps = dynamic_cast<basic_value_vector<A>*>(e.get())) {
+            if (ps->cvalue().size() != 2)
+                throw exception::value_type();
+            auto& val = ps->cvalue()[1];
+            if (val && !val->mt_safe())
+                throw exception::value_mt_unsafe();
+            ops.push_back({channel(ps->cvalue()[0]), true, val});
+        } else
+            ops.push_back({channel(e), false, nullptr});
+    }
+    std::optional<impl::channel_waiter::clock::time_point> deadline;
+    if (narg == 2)
+        deadline =
+            impl::deadline_after(this->arg_index(thread, l_vars, node, 1));
+    else if (ops.empty())
+        throw exception::value_out_of_range();
+    auto idx = basic_channel<A>::select(ops, deadline);
+    if (!idx)
+        return nullptr;
+    auto result = basic_value_vector<A>::create(thread.get_allocator());
+    auto i = basic_value_unsigned<A>::create(thread.get_allocator());
+    i->value() = *idx;
+    result->value().push_back(std::move(i));
+    result->value().push_back(ops[*idx].send ? nullptr :
+                              std::move(ops[*idx].val));
+    return result;
+}
+
 /*** f_seq *******************************************************************/
 
 template <impl::allocator A> typename basic_value<A>::value_ptr
@@ -905,12 +1450,51 @@ f_size<A>::eval(basic_state<A>& thread, basic_symbol_table<A>&l_vars,
         result = v->cvalue().size();
     else if (auto v = dynamic_cast<basic_value_hash<A>*>(val.get()))
         result = v->cvalue().size();
+    else if (auto v = dynamic_cast<basic_value_int_vector<A>*>(val.get()))
+        result = v->cvalue().size();
+    else if (auto v = dynamic_cast<basic_value_unsigned_vector<A>*>(val.get()))
+        result = v->cvalue().size();
     return this->template make_result<basic_value_unsigned<A>>(thread, l_vars,
                                             node, std::move(result), narg == 2);
 }
 
+/*** f_spawn *****************************************************************/
+
+template <impl::allocator A>
+f_spawn<A>::f_spawn(typename f_spawn::tag t, const A& alloc):
+    basic_value_native_fun<f_spawn<A>, A>(t, alloc),
+    methods(std::allocate_shared<const typename basic_future<A>::method_table>(
+                                        alloc, basic_future<A>::init_methods()))
+{
+}
+
+template <impl::allocator A> typename basic_value<A>::value_ptr
+f_spawn<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
+                 const basic_code_node<A>& node, std::string_view)
+{
+    return basic_future<A>::spawn(methods, thread, l_vars, node);
+}
+
 /*** f_sub *******************************************************************/
 
+template <impl::allocator A> config::value_int_type
+f_sub<A>::sub(config::value_int_type s1, config::value_int_type s2)
+{
+    config::value_int_type result = uintmax_t(s1) - uintmax_t(s2);
+    if ((s1 >= 0 && s2 < 0 && result < s1) ||
+        (s1 < 0 && s2 >= 0 && result > s1))
+    {
+        throw exception::op_overflow();
+    }
+    return result;
+}
+
+template <impl::allocator A> config::value_unsigned_type
+f_sub<A>::sub(config::value_unsigned_type u1, config::value_unsigned_type u2)
+{
+    return uintmax_t(u1) - uintmax_t(u2);
+}
+
 template <impl::allocator A> typename basic_value<A>::value_ptr
 f_sub<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
               const basic_code_node<A>& node, std::string_view)
@@ -926,22 +1510,14 @@ f_sub<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
         auto v2 = dynamic_cast<basic_value_int<A>*>(a2.get());
         if (!v2)
             throw exception::value_type();
-        auto s1 = v1->cvalue();
-        auto s2 = v2->cvalue();
-        config::value_int_type result = uintmax_t(s1) - uintmax_t(s2);
-        if ((s1 >= 0 && s2 < 0 && result < s1) ||
-            (s1 < 0 && s2 >= 0 && result > s1))
-        {
-            throw exception::op_overflow();
-        }
+        auto result = sub(v1->cvalue(), v2->cvalue());
         return this->template make_result<basic_value_int<A>>(thread, l_vars,
                                             node, std::move(result), narg == 3);
     } else if (auto v1 = dynamic_cast<basic_value_unsigned<A>*>(a1.get())) {
         auto v2 = dynamic_cast<basic_value_unsigned<A>*>(a2.get());
         if (!v2)
             throw exception::value_type();
-        config::value_unsigned_type result =
-            uintmax_t(v1->cvalue()) - uintmax_t(v2->cvalue());
+        auto result = sub(v1->cvalue(), v2->cvalue());
         return this->template make_result<basic_value_unsigned<A>>(thread,
                                     l_vars, node, std::move(result), narg == 3);
     } else
@@ -973,6 +1549,31 @@ f_substr<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
     return pr;
 }
 
+/*** f_sum *******************************************************************/
+
+template <impl::allocator A> typename basic_value<A>::value_ptr
+f_sum<A>::eval(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
+               const basic_code_node<A>& node, std::string_view)
+{
+    size_t narg = this->narg(node);
+    if (narg != 1 && narg != 2)
+        throw exception::op_narg();
+    auto vec = this->arg(thread, l_vars, node, narg - 1);
+    return impl::visit_num_vector<A>(vec, [&](auto& v) {
+        using E = typename std::remove_cvref_t<decltype(v)>::element_value;
+        typename E::value_type result = 0;
+        if constexpr (std::is_same_v<E, basic_value_int<A>>)
+            for (auto e: v.cvalue())
+                result = f_add<A>::add(result, e);
+        else
+            // Plain modulo arithmetic allows vectorization
+            for (auto e: v.cvalue())
+                result += e;
+        return this->template make_result<E>(thread, l_vars, node,
+                                             std::move(result), narg == 2);
+    });
+}
+
 /*** f_throw *****************************************************************/
 
 template <impl::allocator A> typename basic_value<A>::value_ptr
@@ -1074,6 +1675,39 @@ f_unsigned<A>::eval(basic_state<A>& thread, basic_symbol_table<A>&l_vars,
                                            node, std::move(result), narg == 2);
 }
 
+/*** f_unsigned_vector *******************************************************/
+
+template <impl::allocator A> typename basic_value<A>::value_ptr
+f_unsigned_vector<A>::eval(basic_state<A>& thread,
+                           basic_symbol_table<A>& l_vars,
+                           const basic_code_node<A>& node, std::string_view)
+{
+    size_t narg = this->narg(node);
+    if (narg != 0 && narg != 1)
+        throw exception::op_narg();
+    auto pr = basic_value_unsigned_vector<A>::create(thread.get_allocator());
+    if (narg == 1) {
+        size_t size = this->arg_index(thread, l_vars, node, 0);
+        if (size > pr->cvalue().max_size())
+            throw exception::value_out_of_range();
+        pr->value().resize(size);
+    }
+    return pr;
+}
+
+/*** f_update_sh_vars ********************************************************/
+
+template <impl::allocator A> typename basic_value<A>::value_ptr
+f_update_sh_vars<A>::eval(basic_state<A>& thread, basic_symbol_table<A>&,
+                          const basic_code_node<A>& node, std::string_view)
+{
+    if (this->narg(node) != 0)
+        throw exception::op_narg();
+    auto result = basic_value_bool<A>::create(thread.get_allocator());
+    result->value() = thread.update_sh_vars();
+    return result;
+}
+
 /*** f_var *******************************************************************/
 
 template <impl::allocator A> typename basic_value<A>::value_ptr
@@ -1152,22 +1786,29 @@ add_predef_symbols(std::shared_ptr<basic_symbol_table<A>> sym, bool replace)
         { "bool", predef::f_bool<A>::create },
         { "clone", predef::f_clone<A>::create },
         { "contains", predef::f_contains<A>::create },
+        { "count", predef::f_count<A>::create },
         { "div", predef::f_div<A>::template create<predef::f_div<A>> },
+        { "dot", predef::f_dot<A>::create },
         { "eq", predef::f_eq<A>::create },
         { "erase", predef::f_erase<A>::create },
+        { "find", predef::f_find<A>::create },
         { "fun", predef::f_fun<A>::create },
         { "ge", predef::f_ge<A>::create },
         { "gt", predef::f_gt<A>::create },
         { "gvar", predef::f_gvar<A>::create },
         { "hash", predef::f_hash<A>::create },
         { "if", predef::f_if<A>::create },
+        { "import", predef::f_import<A>::create },
         { "int", predef::f_int<A>::create },
+        { "int_vector", predef::f_int_vector<A>::create },
         { "is_mt_safe", predef::f_is_mt_safe<A>::create },
         { "is_null", predef::f_is_null<A>::create },
         { "is_same", predef::f_is_same<A>::create },
         { "keys", predef::f_keys<A>::create },
         { "le", predef::f_le<A>::create },
         { "lt", predef::f_lt<A>::create },
+        { "max", predef::f_max<A>::template create<predef::f_max<A>> },
+        { "min", predef::f_min<A>::template create<predef::f_min<A>> },
         { "mod", predef::f_mod<A>::template create<predef::f_mod<A>> },
         { "mt_safe", predef::f_mt_safe<A>::create },
         { "mul", predef::f_mul<A>::create },
@@ -1175,15 +1816,26 @@ add_predef_symbols(std::shared_ptr<basic_symbol_table<A>> sym, bool replace)
         { "not", predef::f_not<A>::create },
         { "or", predef::f_or<A>::template create<predef::f_or<A>> },
         { "or_r", predef::f_or<A>::template create<predef::f_or_r<A>> },
+        { "par_for",
+            predef::f_par_for<A>::template create<predef::f_par_for<A>> },
+        { "par_map",
+            predef::f_par_map<A>::template create<predef::f_par_map<A>> },
+        { "par_reduce",
+            predef::f_par_reduce<A>::template create<predef::f_par_reduce<A>> },
         { "print", predef::f_print<A>::create },
+        { "select", predef::f_select<A>::create },
         { "seq", predef::f_seq<A>::create },
         { "size", predef::f_size<A>::create },
+        { "spawn", predef::f_spawn<A>::create },
         { "sub", predef::f_sub<A>::create },
         { "substr", predef::f_substr<A>::create },
+        { "sum", predef::f_sum<A>::create },
         { "throw", predef::f_throw<A>::create },
         { "try", predef::f_try<A>::create },
         { "type", predef::f_type<A>::create },
         { "unsigned", predef::f_unsigned<A>::create },
+        { "unsigned_vector", predef::f_unsigned_vector<A>::create },
+        { "update_sh_vars", predef::f_update_sh_vars<A>::create },
         { "var", predef::f_var<A>::create },
         { "vector", predef::f_vector<A>::create },
         { "while", predef::f_while<A>::create },
@@ -1201,9 +1853,16 @@ template <impl::allocator A> std::shared_ptr<basic_symbol_table<A>>
 add_predef_objects(std::shared_ptr<basic_symbol_table<A>> sym, bool replace)
 {
     //! [register_constructor]
+    atomic::register_constructor(*sym, replace);
+    barrier::register_constructor(*sym, replace);
+    bytes::register_constructor(*sym, replace);
     channel::register_constructor(*sym, replace);
+    latch::register_constructor(*sym, replace);
+    mutex::register_constructor(*sym, replace);
+    semaphore::register_constructor(*sym, replace);
     shared_hash::register_constructor(*sym, replace);
     shared_vector::register_constructor(*sym, replace);
+    string_builder::register_constructor(*sym, replace);
     //! [register_constructor]
     return sym;
 }
@@ -0,0 +1,164 @@
+#pragma once
+
+/*! \file
+ * \brief Typed handles for calling script functions from C++
+ *
+ * Unlike most other class templates of ThreadScript, basic_prepared_call is
+ * parametrized by a function signature, therefore it is defined completely in
+ * this header and it is not explicitly instantiated.
+ */
+
+#include "threadscript/code.hpp"
+#include "threadscript/virtual_machine.hpp"
+
+#include <array>
+#include <utility>
+
+namespace threadscript {
+
+//! The primary template, only the specialization for a function type is used
+/*! \tparam A an allocator type
+ * \tparam Sig a function signature */
+template <impl::allocator A, class Sig> class basic_prepared_call;
+
+//! A typed handle for calling a script function from C++
+/*! It finds a script function once by its name and then it can call the
+ * function repeatedly with arguments and a result converted between C++ types
+ * and script values. Allowed types of arguments and of the result are:
+ * \arg \c bool, converted to and from basic_value_bool
+ * \arg signed integer types, converted to and from basic_value_int
+ * \arg unsigned integer types (except \c bool), converted to and from
+ * basic_value_unsigned
+ * \arg \c std::string, \c std::string_view, and <tt>const char*</tt> (only
+ * as arguments), converted to and from basic_value_string
+ * \arg basic_value::value_ptr, passed without conversion
+ * \arg \c void (only as the result), the function result is ignored
+ *
+ * The vector of arguments and the values of arguments are allocated by the
+ * first call and reused by subsequent calls. A new value is allocated only if
+ * the called function has kept a reference to the previous argument value or
+ * has replaced it in its argument vector.
+ *
+ * The function is found in basic_state::t_vars of the thread, including its
+ * parent symbol table of shared variables. It is found again if the thread
+ * has switched to a new version of shared variables by
+ * basic_state::update_sh_vars(), which is checked by comparing
+ * basic_state::sh_vars_generation() before each call.
+ * \tparam A an allocator type
+ * \tparam R the result type
+ * \tparam Args the argument types
+ * \threadsafe{safe,unsafe}
+ * \test in file test_prepared_call.cpp */
+template <impl::allocator A, class R, class... Args>
+class basic_prepared_call<A, R(Args...)> {
+    static_assert((impl::cpp_value<A, Args>::valid && ...),
+                  "Unsupported argument type");
+    static_assert(std::is_void_v<R> || (impl::cpp_value<A, R>::valid &&
+                                        !std::same_as<R, std::string_view> &&
+                                        !std::same_as<R, const char*>),
+                  "Unsupported result type");
+public:
+    //! Finds a script function.
+    /*! \param[in] thread the thread used for calling the function
+     * \param[in] name the name of the function
+     * \throw exception::unknown_symbol if the function does not exist
+     * \throw exception::value_type if \a name is not a function */
+    basic_prepared_call(basic_state<A>& thread, std::string_view name):
+        thread(thread), name(name, thread.get_allocator())
+    {
+        prepare();
+    }
+    //! Calls the function.
+    /*! \param[in] args the function arguments
+     * \return the function result
+     * \throw exception::unknown_symbol if the function does not exist after
+     * switching to a new version of shared variables
+     * \throw exception::value_null if \a R is not basic_value::value_ptr and
+     * the function returns \c null
+     * \throw exception::value_type if the function result cannot be
+     * converted to \a R
+     * \throw exception::value_out_of_range if an integer argument or result is
+     * not representable by the target type
+     * \throw any exception thrown by the called function */
+    R operator()(Args... args) {
+        if (thread.sh_vars_generation() != generation)
+            prepare();
+        set_args(std::index_sequence_for<Args...>{}, args...);
+        auto result = fun->call(thread, name, this->args);
+        if constexpr (!std::is_void_v<R>)
+            return get_result(result);
+    }
+    //! Gets the called function.
+    /*! \return the function found by the last preparation */
+    [[nodiscard]] const basic_value_function<A>& function() const noexcept {
+        return *fun;
+    }
+private:
+    //! The type of a script value
+    using value_ptr = typename basic_value<A>::value_ptr;
+    //! Finds the function and stores the current generation of shared vars.
+    void prepare() {
+        auto f = thread.t_vars.lookup(name);
+        if (!f)
+            throw exception::unknown_symbol(name, thread.current_stack());
+        if (!*f || (*f)->type_name() !=
+            basic_value_function<A>::static_type_name())
+        {
+            throw exception::value_type(thread.current_stack());
+        }
+        fun = std::static_pointer_cast<basic_value_function<A>>(std::move(*f));
+        generation = thread.sh_vars_generation();
+    }
+    //! Stores all arguments to \ref args.
+    /*! \tparam I indices of arguments
+     * \param[in] a the arguments */
+    template <size_t... I> void set_args(std::index_sequence<I...>,
+                                         const Args&... a)
+    {
+        if (!args || args.use_count() != 1 || args->mt_safe())
+            args = basic_value_vector<A>::create(thread.get_allocator());
+        auto& vec = args->value();
+        vec.resize(sizeof...(Args));
+        (set_arg<I>(vec[I], a), ...);
+    }
+    //! Stores a single argument.
+    /*! \tparam I the argument index
+     * \tparam T the argument type
+     * \param[out] v the element of \ref args
+     * \param[in] a the argument */
+    template <size_t I, class T> void set_arg(value_ptr& v, const T& a) {
+        using value_t = typename impl::cpp_value<A, T>::value_type;
+        if constexpr (std::is_void_v<value_t>)
+            v = a;
+        else {
+            // The box is reused if it is referenced only by args and boxes
+            auto& box = boxes[I];
+            if (!box || v != box || box.use_count() != 2 || box->mt_safe()) {
+                box = value_t::create(thread.get_allocator());
+                v = box;
+            }
+            impl::assign_value(static_cast<value_t&>(*box), a);
+        }
+    }
+    //! Converts the function result.
+    /*! \param[in] v the result of the called function
+     * \return the converted result */
+    R get_result(const value_ptr& v) const {
+        return impl::from_value<A, R>(v);
+    }
+    //! The thread used to call the function
+    basic_state<A>& thread;
+    //! The function name
+    a_basic_string<A> name;
+    //! The function
+    std::shared_ptr<basic_value_function<A>> fun;
+    //! The generation of shared variables used to find \ref fun
+    typename impl::published_ptr<const basic_symbol_table<A>>::generation_t
+        generation = 0;
+    //! The reused vector of arguments
+    std::shared_ptr<basic_value_vector<A>> args;
+    //! The reused values of arguments, \c nullptr for basic_value::value_ptr
+    std::array<value_ptr, sizeof...(Args)> boxes;
+};
+
+} // namespace threadscript
@@ -0,0 +1,127 @@
+#pragma once
+
+/*! \file
+ * \brief Replacing the script running in a virtual machine without stopping
+ * its threads
+ */
+
+#include "threadscript/code_parser.hpp"
+#include "threadscript/virtual_machine.hpp"
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace threadscript {
+
+//! Loads a script file repeatedly and publishes its definitions
+/*! Each call of reload() parses the script file, runs the parsed script in
+ * a new basic_state (the \e definition phase), and publishes a new shared
+ * symbol table in basic_virtual_machine::sh_vars. The new symbol table is
+ * created by a user-supplied function and it receives all thread-safe
+ * symbols (functions and variables) from the global symbol table of the
+ * thread that has run the script. If the script cannot be parsed or it
+ * throws an exception, the currently published symbol table is kept.
+ *
+ * Running threads are not stopped. A thread switches to the new symbol table
+ * at a safe point, when it calls basic_state::update_sh_vars(). It is done
+ * by each task of basic_task_pool and it can be done by a script calling
+ * function \c update_sh_vars (predef::f_update_sh_vars).
+ *
+ * The parsed scripts are owned by functions defined by them, therefore an
+ * old script is destroyed when no longer referenced. If names in the scripts
+ * are resolved (see basic_script::resolve()), the reloader breaks the
+ * resulting reference cycles by calling basic_script::unresolve() on an old
+ * script when its symbol table is not used by any basic_state. This is
+ * checked by collect(), which is called by each reload(). A thread that calls
+ * basic_state::update_sh_vars() while running a script keeps the symbol
+ * table used when its outermost stack frame was entered until its stack
+ * becomes empty, hence a script is not unresolved while its code can still be
+ * executed by returning from function \c update_sh_vars. Symbol tables of
+ * scripts loaded while the thread is running are not kept, so a thread
+ * looping forever in a single call does not keep all old scripts. With
+ * resolution enabled, values of an old script must not be executed after
+ * being passed outside of its symbol table and the stack frames entered with
+ * it, e.g., a function stored in a variable of a new script.
+ * \tparam A an allocator type
+ * \threadsafe{safe,safe}
+ * \test in file test_reload.cpp */
+template <impl::allocator A> class basic_reloader {
+public:
+    //! The type of a function creating a new symbol table for a script
+    /*! It must return a non-null symbol table, typically containing
+     * predefined symbols. */
+    using make_sh_vars_t =
+        std::function<std::shared_ptr<basic_symbol_table<A>>()>;
+    //! Creates the reloader, but does not load the script.
+    /*! \param[in] vm the virtual machine, whose basic_virtual_machine::sh_vars
+     * will be replaced
+     * \param[in] file the script file name
+     * \param[in] syntax the syntax variant of the script
+     * \param[in] make_sh_vars a function creating a new symbol table for each
+     * loaded script; if empty, predefined symbols and classes are added to an
+     * empty table by add_predef_symbols() and add_predef_objects()
+     * \param[in] resolve whether to resolve names in the loaded script using
+     * its published symbol table */
+    basic_reloader(basic_virtual_machine<A>& vm, std::string_view file,
+                   std::string_view syntax = syntax_factory::syntax_canon,
+                   make_sh_vars_t make_sh_vars = {}, bool resolve = false);
+    //! No copying
+    basic_reloader(const basic_reloader&) = delete;
+    //! No moving
+    basic_reloader(basic_reloader&&) = delete;
+    //! Unresolves all resolved scripts, including the current one.
+    /*! It must not be called while any thread can still run code of a script
+     * loaded by this reloader. */
+    ~basic_reloader();
+    //! No copying
+    basic_reloader& operator=(const basic_reloader&) = delete;
+    //! No moving
+    basic_reloader& operator=(basic_reloader&&) = delete;
+    //! Loads the script file and publishes its definitions.
+    /*! Concurrent calls are serialized.
+     * \return the loaded script
+     * \throw exception::parse_error if parsing fails
+     * \throw std::ios_base::failure if reading of the script file fails
+     * \throw any exception thrown by the script */
+    typename basic_script<A>::script_ptr reload();
+    //! Unresolves old scripts not used by any thread.
+    /*! An old script is unresolved and forgotten by the reloader when its
+     * symbol table has been replaced in all basic_state objects and it is not
+     * kept by a nonempty stack of any basic_state, see
+     * basic_state::update_sh_vars().
+     * \return the number of old scripts that are still in use */
+    size_t collect();
+    //! Gets the script loaded by the last successful reload().
+    /*! \return the current script, \c nullptr if no script has been loaded */
+    [[nodiscard]] typename basic_script<A>::script_ptr script() const;
+private:
+    //! A loaded script
+    struct loaded {
+        //! The script
+        typename basic_script<A>::script_ptr script;
+        //! The symbol table published for \ref script
+        std::weak_ptr<const basic_symbol_table<A>> sh_vars;
+    };
+    //! Unresolves old scripts, with \ref mtx locked.
+    /*! \return the number of old scripts that are still in use */
+    size_t collect_locked();
+    //! The virtual machine
+    basic_virtual_machine<A>& vm;
+    //! The script file name
+    std::string file;
+    //! The syntax variant of the script
+    std::string syntax;
+    //! The function creating symbol tables
+    make_sh_vars_t make_sh_vars;
+    //! Whether to resolve names in loaded scripts
+    bool resolve;
+    //! Serializes reload() and collect()
+    mutable std::mutex mtx;
+    //! The current script
+    loaded current;
+    //! Resolved old scripts waiting for unresolve()
+    std::vector<loaded> old;
+};
+
+} // namespace threadscript
@@ -0,0 +1,91 @@
+#pragma once
+
+/*! \file
+ * \brief The implementation part of reload.hpp
+ */
+
+#include "threadscript/reload.hpp"
+#include "threadscript/predef.hpp"
+
+namespace threadscript {
+
+/*** basic_reloader **********************************************************/
+
+template <impl::allocator A>
+basic_reloader<A>::basic_reloader(basic_virtual_machine<A>& vm,
+                                  std::string_view file,
+                                  std::string_view syntax,
+                                  make_sh_vars_t make_sh_vars, bool resolve):
+    vm(vm), file(file), syntax(syntax), make_sh_vars(std::move(make_sh_vars)),
+    resolve(resolve)
+{
+}
+
+template <impl::allocator A> basic_reloader<A>::~basic_reloader()
+{
+    if (!resolve)
+        return;
+    for (auto&& s: old)
+        s.script->unresolve();
+    if (current.script)
+        current.script->unresolve();
+}
+
+template <impl::allocator A> size_t basic_reloader<A>::collect()
+{
+    std::lock_guard lck{mtx};
+    return collect_locked();
+}
+
+template <impl::allocator A> size_t basic_reloader<A>::collect_locked()
+{
+    std::erase_if(old, [](auto&& s) {
+        if (!s.sh_vars.expired())
+            return false;
+        s.script->unresolve();
+        return true;
+    });
+    return old.size();
+}
+
+template <impl::allocator A>
+typename basic_script<A>::script_ptr basic_reloader<A>::reload()
+{
+    std::lock_guard lck{mtx};
+    auto alloc = vm.get_allocator();
+    auto parsed = parse_code_file(alloc, file, syntax);
+    std::shared_ptr<basic_symbol_table<A>> sh_vars;
+    if (make_sh_vars)
+        sh_vars = make_sh_vars();
+    else
+        sh_vars = add_predef_objects(predef_symbols(alloc), true);
+    assert(sh_vars);
+    // Run the definition phase
+    {
+        basic_state<A> thread{vm, sh_vars};
+        parsed->eval(thread);
+        auto& t_vars = thread.t_vars.symbols();
+        for (auto it = t_vars.begin(); it != t_vars.end(); ++it)
+            if (it->second && it->second->mt_safe())
+                sh_vars->insert(it->first, std::move(it->second));
+    }
+    if (resolve)
+        parsed->resolve(*sh_vars, true, true);
+    // Publish the new symbol table
+    loaded prev = std::move(current);
+    current = {parsed, sh_vars};
+    vm.sh_vars = std::move(sh_vars);
+    if (resolve && prev.script)
+        old.push_back(std::move(prev));
+    collect_locked();
+    return parsed;
+}
+
+template <impl::allocator A>
+typename basic_script<A>::script_ptr basic_reloader<A>::script() const
+{
+    std::lock_guard lck{mtx};
+    return current.script;
+}
+
+} // namespace threadscript
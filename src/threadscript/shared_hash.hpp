@@ -26,6 +26,13 @@ template <allocator A> using basic_shared_hash_base =
  * managed automatically using the same algorithm as for basic_value_hash, as
  * described in basic_value_hash::value().
  *
+ * Methods cas(), fetch_add(), get_or_insert(), and update() perform
+ * a read-modify-write operation on a single element atomically. Except for
+ * update(), they do it in a single critical section.
+ *
+ * Methods erase_many(), get_many(), and set_many() process several elements
+ * while locking the internal mutex only once.
+ *
  * Methods:
  * \snippet shared_hash_impl.hpp methods
  * \tparam A an allocator type
@@ -45,6 +52,33 @@ public:
     [[nodiscard]] static
     typename basic_shared_hash::method_table init_methods();
 private:
+    //! Evaluates an argument as a hash key.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node
+     * \param[in] idx the (zero-based) index of the argument
+     * \return the key
+     * \throw exception::value_null if the argument is \c null
+     * \throw exception::value_type if the argument is not of type \c string */
+    typename basic_value_string<A>::typed_value_ptr
+    arg_key(typename threadscript::basic_state<A>& thread,
+            typename threadscript::basic_symbol_table<A>& l_vars,
+            const typename threadscript::basic_code_node<A>& node, size_t idx);
+    //! Evaluates an argument as a vector of keys.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments
+     * \param[in] idx the (zero-based) index of the argument
+     * \return the argument value
+     * \throw exception::value_null if the argument or any of its elements is
+     * \c null
+     * \throw exception::value_type if the argument is not of type \c vector
+     * or any of its elements is not of type \c string */
+    typename basic_value_vector<A>::typed_value_ptr
+    arg_keys(typename threadscript::basic_state<A>& thread,
+             typename threadscript::basic_symbol_table<A>& l_vars,
+             const typename threadscript::basic_code_node<A>& node,
+             size_t idx);
     //! Gets or sets a hash element.
     /*! \param[in] thread the current thread
      * \param[in] l_vars the symbol table of the current stack frame
@@ -66,6 +100,33 @@ private:
     at(typename threadscript::basic_state<A>& thread,
        typename threadscript::basic_symbol_table<A>& l_vars,
        const typename threadscript::basic_code_node<A>& node);
+    //! Atomically compares and sets a hash element.
+    /*! If the element with \a key is equal to \a expected, it is replaced by
+     * \a value. Otherwise, the hash remains unchanged. Elements are compared
+     * by predef::f_eq::compare(), except that a missing element is equal to
+     * \c null and two references to the same value are always equal. The
+     * comparison and the replacement are done while holding the internal
+     * mutex, hence no other thread can modify the element in between.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c key -- a key of an element; it has type \c string
+     *     \arg \c expected -- the expected current value of the element; it
+     *     may be \c null
+     *     \arg \c value -- the new value of the element; it may be \c null
+     * \return \c true if the element has been replaced by \a value, \c false
+     * otherwise
+     * \throw exception::op_narg if the number of arguments (incl. \a
+     * method_name) is not 4
+     * \throw exception::value_null if \a key is \c null
+     * \throw exception::value_type if \a key is not of type \c string, or if
+     * the element and \a expected cannot be compared by predef::f_eq
+     * \throw exception::value_mt_unsafe if \a value is not mt-safe */
+    typename basic_shared_hash::value_ptr
+    cas(typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node);
     //! Tests if the hash contains an element with \a key.
     /*! \param[in] thread the current thread
      * \param[in] l_vars the symbol table of the current stack frame
@@ -100,6 +161,98 @@ private:
     erase(typename threadscript::basic_state<A>& thread,
           typename threadscript::basic_symbol_table<A>& l_vars,
           const typename threadscript::basic_code_node<A>& node);
+    //! Deletes several elements.
+    /*! All elements with keys in \a keys are deleted while holding the
+     * internal mutex only once. Nonexistent keys are ignored.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c keys -- a \c vector of keys of type \c string
+     * \return \c null
+     * \throw exception::op_narg if the number of arguments (incl. \a
+     * method_name) is not 2
+     * \throw exception::value_null if \a keys or any of its elements is \c
+     * null
+     * \throw exception::value_type if \a keys is not of type \c vector, or
+     * any of its elements is not of type \c string */
+    typename basic_shared_hash::value_ptr
+    erase_many(typename threadscript::basic_state<A>& thread,
+               typename threadscript::basic_symbol_table<A>& l_vars,
+               const typename threadscript::basic_code_node<A>& node);
+    //! Atomically adds a number to a hash element.
+    /*! The element with \a key is replaced by a new mt-safe value equal to
+     * the sum of the old value and \a delta. A missing or \c null element is
+     * treated as zero of the type of \a delta. Addition is done as by
+     * predef::f_add, that is, using modulo arithmetic for \c unsigned and
+     * checking overflow for \c int. Reading the old value and storing the new
+     * one are done while holding the internal mutex, hence concurrent
+     * increments are never lost.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c key -- a key of an element; it has type \c string
+     *     \arg \c delta -- the value added to the element; it has type \c int
+     *     or \c unsigned
+     * \return the old value of the element (zero if the element was missing
+     * or \c null)
+     * \throw exception::op_narg if the number of arguments (incl. \a
+     * method_name) is not 3
+     * \throw exception::value_null if \a key or \a delta is \c null
+     * \throw exception::value_type if \a key is not of type \c string, if \a
+     * delta is not of type \c int or \c unsigned, or if the element has
+     * a type different from \a delta
+     * \throw exception::op_overflow if the addition of \c int values
+     * overflows; the element remains unchanged */
+    typename basic_shared_hash::value_ptr
+    fetch_add(typename threadscript::basic_state<A>& thread,
+              typename threadscript::basic_symbol_table<A>& l_vars,
+              const typename threadscript::basic_code_node<A>& node);
+    //! Gets several elements.
+    /*! All elements are read while holding the internal mutex only once,
+     * therefore the result is a consistent snapshot of the selected elements.
+     * Unlike at(), a nonexistent key does not cause an exception.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c keys -- a \c vector of keys of type \c string
+     * \return a \c vector (not \c shared_vector) containing an element for
+     * each item of \a keys, in the same order; \c null for a nonexistent key
+     * \throw exception::op_narg if the number of arguments (incl. \a
+     * method_name) is not 2
+     * \throw exception::value_null if \a keys or any of its elements is \c
+     * null
+     * \throw exception::value_type if \a keys is not of type \c vector, or
+     * any of its elements is not of type \c string */
+    typename basic_shared_hash::value_ptr
+    get_many(typename threadscript::basic_state<A>& thread,
+             typename threadscript::basic_symbol_table<A>& l_vars,
+             const typename threadscript::basic_code_node<A>& node);
+    //! Gets a hash element, inserting it if it does not exist.
+    /*! If the element with \a key exists and is not \c null, it is returned
+     * and the hash remains unchanged. Otherwise, \a value is stored as the
+     * element with \a key and returned. Testing and inserting are done while
+     * holding the internal mutex, hence at most one thread can insert the
+     * element.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c key -- a key of an element; it has type \c string
+     *     \arg \c value -- the element inserted if there is no element with
+     *     \a key
+     * \return the existing or the inserted element with \a key
+     * \throw exception::op_narg if the number of arguments (incl. \a
+     * method_name) is not 3
+     * \throw exception::value_null if \a key is \c null
+     * \throw exception::value_type if \a key is not of type \c string
+     * \throw exception::value_mt_unsafe if \a value is not mt-safe */
+    typename basic_shared_hash::value_ptr
+    get_or_insert(typename threadscript::basic_state<A>& thread,
+                  typename threadscript::basic_symbol_table<A>& l_vars,
+                  const typename threadscript::basic_code_node<A>& node);
     //! Gets a \c vector (not \c shared_vector) for keys.
     /*! The elements of the returned vector, but not the vector itself, are
      * thread-safe (function predef::f_is_mt_safe returns \c true for them).
@@ -113,6 +266,25 @@ private:
     keys(typename threadscript::basic_state<A>& thread,
          typename threadscript::basic_symbol_table<A>& l_vars,
          const typename threadscript::basic_code_node<A>& node);
+    //! Sets several elements.
+    /*! All elements of \a values are stored while holding the internal mutex
+     * only once, therefore other threads see either none or all of them.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c values -- a \c hash of elements to be stored
+     * \return \c null
+     * \throw exception::op_narg if the number of arguments (incl. \a
+     * method_name) is not 2
+     * \throw exception::value_null if \a values is \c null
+     * \throw exception::value_type if \a values is not of type \c hash
+     * \throw exception::value_mt_unsafe if any element of \a values is not
+     * mt-safe */
+    typename basic_shared_hash::value_ptr
+    set_many(typename threadscript::basic_state<A>& thread,
+             typename threadscript::basic_symbol_table<A>& l_vars,
+             const typename threadscript::basic_code_node<A>& node);
     //! Gets the number of elements.
     /*! \param[in] thread the current thread
      * \param[in] l_vars the symbol table of the current stack frame
@@ -125,6 +297,39 @@ private:
     size(typename threadscript::basic_state<A>& thread,
          typename threadscript::basic_symbol_table<A>& l_vars,
          const typename threadscript::basic_code_node<A>& node);
+    //! Atomically updates a hash element by a function.
+    /*! Function \a fun is called with a single argument, the current value of
+     * the element with \a key (\c null if the element does not exist). The
+     * value returned by \a fun is stored as the new element with \a key. The
+     * function is called without holding the internal mutex, hence it may
+     * block and access this hash. If the element has been changed by
+     * another call before \a fun returns, the result is discarded and \a fun
+     * is called again with the new value of the element. Therefore \a fun
+     * can be called more than once and it should not have side effects. If
+     * \a fun throws an exception, the hash remains unchanged.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c key -- a key of an element; it has type \c string
+     *     \arg \c fun -- the name of a function (of type \c string)
+     *     computing the new value of the element
+     * \return the new element with \a key
+     * \throw exception::op_narg if the number of arguments (incl. \a
+     * method_name) is not 3
+     * \throw exception::value_null if \a key or \a fun is \c null
+     * \throw exception::value_type if \a key is not of type \c string, or
+     * \a fun is not a \c string or if it is not a name of a function
+     * \throw exception::unknown_symbol if function \a fun does not exist
+     * \throw exception::value_mt_unsafe if the value returned by \a fun is
+     * not mt-safe
+     * \throw any exception thrown by \a fun
+     * \warning If \a fun always changes the element with \a key, this method
+     * does not terminate. */
+    typename basic_shared_hash::value_ptr
+    update(typename threadscript::basic_state<A>& thread,
+           typename threadscript::basic_symbol_table<A>& l_vars,
+           const typename threadscript::basic_code_node<A>& node);
     //! Storage of hash content
     a_basic_hash<a_basic_string<A>, typename basic_shared_hash::value_ptr, A>
         data;
@@ -5,6 +5,9 @@
  */
 
 #include "threadscript/shared_hash.hpp"
+#include "threadscript/code.hpp"
+#include "threadscript/green.hpp"
+#include "threadscript/predef.hpp"
 
 namespace threadscript {
 
@@ -21,6 +24,40 @@ basic_shared_hash<A>::basic_shared_hash(
     this->set_mt_safe();
 }
 
+template <impl::allocator A> typename basic_value_string<A>::typed_value_ptr
+basic_shared_hash<A>::arg_key(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node, size_t idx)
+{
+    auto a = this->arg(thread, l_vars, node, idx);
+    if (!a)
+        throw exception::value_null();
+    auto key = std::dynamic_pointer_cast<basic_value_string<A>>(a);
+    if (!key)
+        throw exception::value_type();
+    return key;
+}
+
+template <impl::allocator A> typename basic_value_vector<A>::typed_value_ptr
+basic_shared_hash<A>::arg_keys(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node, size_t idx)
+{
+    auto a = this->arg(thread, l_vars, node, idx);
+    if (!a)
+        throw exception::value_null();
+    auto keys = std::dynamic_pointer_cast<basic_value_vector<A>>(a);
+    if (!keys)
+        throw exception::value_type();
+    for (auto&& k: keys->cvalue()) {
+        if (!k)
+            throw exception::value_null();
+        if (!dynamic_cast<basic_value_string<A>*>(k.get()))
+            throw exception::value_type();
+    }
+    return keys;
+}
+
 template <impl::allocator A> basic_shared_hash<A>::value_ptr
 basic_shared_hash<A>::at(typename threadscript::basic_state<A>& thread,
     typename threadscript::basic_symbol_table<A>& l_vars,
@@ -29,12 +66,7 @@ basic_shared_hash<A>::at(typename threadscript::basic_state<A>& thread,
     size_t narg = this->narg(node);
     if (narg !=2 && narg != 3)
         throw exception::op_narg();
-    auto a1 = this->arg(thread, l_vars, node, 1);
-    if (!a1)
-        throw exception::value_null();
-    auto key = dynamic_cast<basic_value_string<A>*>(a1.get());
-    if (!key)
-        throw exception::value_type();
+    auto key = arg_key(thread, l_vars, node, 1);
     if (narg == 2) {
         std::lock_guard lck(mtx);
         auto it = data.find(key->cvalue());
@@ -53,6 +85,37 @@ basic_shared_hash<A>::at(typename threadscript::basic_state<A>& thread,
     }
 }
 
+template <impl::allocator A> basic_shared_hash<A>::value_ptr
+basic_shared_hash<A>::cas(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 4)
+        throw exception::op_narg();
+    auto key = arg_key(thread, l_vars, node, 1);
+    auto expected = this->arg(thread, l_vars, node, 2);
+    auto v = this->arg(thread, l_vars, node, 3);
+    if (v && !v->mt_safe())
+        throw exception::value_mt_unsafe();
+    auto result = basic_value_bool<A>::create(thread.get_allocator());
+    std::lock_guard lck(mtx);
+    auto it = data.find(key->cvalue());
+    typename basic_shared_hash::value_ptr current =
+        it == data.end() ? nullptr : it->second;
+    if (!current || !expected)
+        result->value() = !current && !expected;
+    else
+        result->value() = current == expected ||
+            predef::f_eq<A>::compare(current, expected);
+    if (result->cvalue()) {
+        if (it == data.end())
+            data.emplace(key->cvalue(), std::move(v));
+        else
+            it->second = std::move(v);
+    }
+    return result;
+}
+
 template <impl::allocator A> basic_shared_hash<A>::value_ptr
 basic_shared_hash<A>::contains(
     typename threadscript::basic_state<A>& thread,
@@ -62,12 +125,7 @@ basic_shared_hash<A>::contains(
     size_t narg = this->narg(node);
     if (narg != 2)
         throw exception::op_narg();
-    auto a1 = this->arg(thread, l_vars, node, 1);
-    if (!a1)
-        throw exception::value_null();
-    auto key = dynamic_cast<basic_value_string<A>*>(a1.get());
-    if (!key)
-        throw exception::value_type();
+    auto key = arg_key(thread, l_vars, node, 1);
     auto result = basic_value_bool<A>::create(thread.get_allocator());
     std::lock_guard lck(mtx);
     result->value() = data.contains(key->cvalue());
@@ -87,12 +145,7 @@ basic_shared_hash<A>::erase(
         std::lock_guard lck(mtx);
         data.clear();
     } else {
-        auto a1 = this->arg(thread, l_vars, node, 1);
-        if (!a1)
-            throw exception::value_null();
-        auto key = dynamic_cast<basic_value_string<A>*>(a1.get());
-        if (!key)
-            throw exception::value_type();
+        auto key = arg_key(thread, l_vars, node, 1);
         std::lock_guard lck(mtx);
         data.erase(key->cvalue());
         std_container_shrink(data);
@@ -100,16 +153,120 @@ basic_shared_hash<A>::erase(
     return nullptr;
 }
 
+template <impl::allocator A> basic_shared_hash<A>::value_ptr
+basic_shared_hash<A>::erase_many(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 2)
+        throw exception::op_narg();
+    auto keys = arg_keys(thread, l_vars, node, 1);
+    std::lock_guard lck(mtx);
+    for (auto&& k: keys->cvalue())
+        data.erase(static_cast<basic_value_string<A>&>(*k).cvalue());
+    std_container_shrink(data);
+    return nullptr;
+}
+
+template <impl::allocator A> basic_shared_hash<A>::value_ptr
+basic_shared_hash<A>::fetch_add(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 3)
+        throw exception::op_narg();
+    auto key = arg_key(thread, l_vars, node, 1);
+    auto delta = this->arg(thread, l_vars, node, 2);
+    if (!delta)
+        throw exception::value_null();
+    auto add = [&]<class T>(T* d) -> typename basic_shared_hash::value_ptr {
+        auto sum = T::create(thread.get_allocator());
+        std::lock_guard lck(mtx);
+        auto it = data.find(key->cvalue());
+        typename basic_shared_hash::value_ptr old =
+            it == data.end() ? nullptr : it->second;
+        if (old) {
+            auto po = dynamic_cast<T*>(old.get());
+            if (!po)
+                throw exception::value_type();
+            sum->value() = predef::f_add<A>::add(po->cvalue(), d->cvalue());
+        } else {
+            old = T::create(thread.get_allocator());
+            old->set_mt_safe();
+            sum->value() = d->cvalue();
+        }
+        sum->set_mt_safe();
+        if (it == data.end())
+            data.emplace(key->cvalue(), std::move(sum));
+        else
+            it->second = std::move(sum);
+        return old;
+    };
+    if (auto d = dynamic_cast<basic_value_int<A>*>(delta.get()))
+        return add(d);
+    else if (auto d = dynamic_cast<basic_value_unsigned<A>*>(delta.get()))
+        return add(d);
+    else
+        throw exception::value_type();
+}
+
+template <impl::allocator A> basic_shared_hash<A>::value_ptr
+basic_shared_hash<A>::get_many(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 2)
+        throw exception::op_narg();
+    auto keys = arg_keys(thread, l_vars, node, 1);
+    auto result = basic_value_vector<A>::create(thread.get_allocator());
+    auto& r = result->value();
+    r.reserve(keys->cvalue().size());
+    std::lock_guard lck(mtx);
+    for (auto&& k: keys->cvalue()) {
+        auto it = data.find(static_cast<basic_value_string<A>&>(*k).cvalue());
+        r.push_back(it == data.end() ? nullptr : it->second);
+    }
+    return result;
+}
+
+template <impl::allocator A> basic_shared_hash<A>::value_ptr
+basic_shared_hash<A>::get_or_insert(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 3)
+        throw exception::op_narg();
+    auto key = arg_key(thread, l_vars, node, 1);
+    auto v = this->arg(thread, l_vars, node, 2);
+    if (v && !v->mt_safe())
+        throw exception::value_mt_unsafe();
+    std::lock_guard lck(mtx);
+    auto& element = data[key->cvalue()];
+    if (!element)
+        element = std::move(v);
+    return element;
+}
+
 template <impl::allocator A> basic_shared_hash<A>::method_table
 basic_shared_hash<A>::init_methods()
 {
     return {
         //! [methods]
         {"at", &basic_shared_hash::at},
+        {"cas", &basic_shared_hash::cas},
         {"contains", &basic_shared_hash::contains},
         {"erase", &basic_shared_hash::erase},
+        {"erase_many", &basic_shared_hash::erase_many},
+        {"fetch_add", &basic_shared_hash::fetch_add},
+        {"get_many", &basic_shared_hash::get_many},
+        {"get_or_insert", &basic_shared_hash::get_or_insert},
         {"keys", &basic_shared_hash::keys},
+        {"set_many", &basic_shared_hash::set_many},
         {"size", &basic_shared_hash::size},
+        {"update", &basic_shared_hash::update},
         //! [methods]
     };
 }
@@ -140,6 +297,29 @@ basic_shared_hash<A>::keys(typename threadscript::basic_state<A>& thread,
     return result;
 }
 
+template <impl::allocator A> basic_shared_hash<A>::value_ptr
+basic_shared_hash<A>::set_many(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 2)
+        throw exception::op_narg();
+    auto a = this->arg(thread, l_vars, node, 1);
+    if (!a)
+        throw exception::value_null();
+    auto values = dynamic_cast<basic_value_hash<A>*>(a.get());
+    if (!values)
+        throw exception::value_type();
+    for (auto&& v: values->cvalue())
+        if (v.second && !v.second->mt_safe())
+            throw exception::value_mt_unsafe();
+    std::lock_guard lck(mtx);
+    for (auto&& v: values->cvalue())
+        data[v.first] = v.second;
+    return nullptr;
+}
+
 template <impl::allocator A> basic_shared_hash<A>::value_ptr
 basic_shared_hash<A>::size(typename threadscript::basic_state<A>& thread,
     typename threadscript::basic_symbol_table<A>&,
@@ -153,4 +333,56 @@ basic_shared_hash<A>::size(typename threadscript::basic_state<A>& thread,
     return res;
 }
 
+template <impl::allocator A> basic_shared_hash<A>::value_ptr
+basic_shared_hash<A>::update(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 3)
+        throw exception::op_narg();
+    auto key = arg_key(thread, l_vars, node, 1);
+    auto a2 = this->arg(thread, l_vars, node, 2);
+    if (!a2)
+        throw exception::value_null();
+    auto name = dynamic_cast<basic_value_string<A>*>(a2.get());
+    if (!name)
+        throw exception::value_type();
+    auto f = l_vars.lookup(name->cvalue());
+    if (!f)
+        throw exception::unknown_symbol(name->cvalue());
+    auto fun = std::dynamic_pointer_cast<basic_value_function<A>>(*f);
+    if (!fun)
+        throw exception::value_type();
+    // The function is called without holding mtx, so that it can block and
+    // access this hash. Its result is stored only if the element has not
+    // been changed in the meantime, otherwise the function is called again.
+    for (;;) {
+        typename basic_shared_hash::value_ptr old = nullptr;
+        bool found = false;
+        {
+            std::lock_guard lck(mtx);
+            if (auto it = data.find(key->cvalue()); it != data.end()) {
+                old = it->second;
+                found = true;
+            }
+        }
+        auto args = basic_value_vector<A>::create(thread.get_allocator());
+        args->value().push_back(old);
+        auto v = fun->call(thread, name->cvalue(), std::move(args));
+        if (v && !v->mt_safe())
+            throw exception::value_mt_unsafe();
+        std::lock_guard lck(mtx);
+        auto it = data.find(key->cvalue());
+        if (it == data.end()) {
+            if (!found) {
+                data.emplace(key->cvalue(), v);
+                return v;
+            }
+        } else if (found && it->second == old) {
+            it->second = v;
+            return v;
+        }
+    }
+}
+
 } // namespace threadscript
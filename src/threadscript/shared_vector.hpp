@@ -26,6 +26,13 @@ template <allocator A> using basic_shared_vector_base =
  * managed automatically using the same algorithm as for basic_value_vector, as
  * described in basic_value_vector::value().
  *
+ * Methods cas(), fetch_add(), get_or_insert(), and update() perform
+ * a read-modify-write operation on a single element atomically. Except for
+ * update(), they do it in a single critical section.
+ *
+ * Methods get_many(), set_many(), and slice() process several elements while
+ * locking the internal mutex only once.
+ *
  * Methods:
  * \snippet shared_vector_impl.hpp methods
  * \tparam A an allocator type
@@ -72,6 +79,38 @@ private:
     at(typename threadscript::basic_state<A>& thread,
        typename threadscript::basic_symbol_table<A>& l_vars,
        const typename threadscript::basic_code_node<A>& node);
+    //! Atomically compares and sets a vector element.
+    /*! If the element at \a idx is equal to \a expected, it is replaced by
+     * \a value. Otherwise, the vector remains unchanged. Elements are compared
+     * by predef::f_eq::compare(), except that an element at an index greater
+     * than the greatest existing index is equal to \c null and two
+     * references to the same value are always equal. If the element is
+     * replaced, the vector is extended as needed as in at(). The comparison
+     * and the replacement are done while holding the internal mutex, hence no
+     * other thread can modify the element in between.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c idx -- an index of type \c int or \c unsigned
+     *     \arg \c expected -- the expected current value of the element; it
+     *     may be \c null
+     *     \arg \c value -- the new value of the element; it may be \c null
+     * \return \c true if the element has been replaced by \a value, \c false
+     * otherwise
+     * \throw exception::op_narg if the number of arguments (incl. \a
+     * method_name) is not 4
+     * \throw exception::value_null if \a idx is \c null
+     * \throw exception::value_type if \a idx is not of type \c int or \c
+     * unsigned, or if the element and \a expected cannot be compared by
+     * predef::f_eq
+     * \throw exception::value_out_of_range if \a idx is negative, or greater
+     * or equal to \link a_basic_vector a_basic_vector::max_size()\endlink
+     * \throw exception::value_mt_unsafe if \a value is not mt-safe */
+    typename basic_shared_vector::value_ptr
+    cas(typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node);
     //! Removes elements.
     /*! Elements from index \a idx to the end of the vector are deleted and the
      * vector is shrinked to the first \a idx elements. If \a idx is greater or
@@ -94,6 +133,115 @@ private:
     erase(typename threadscript::basic_state<A>& thread,
           typename threadscript::basic_symbol_table<A>& l_vars,
           const typename threadscript::basic_code_node<A>& node);
+    //! Atomically adds a number to a vector element.
+    /*! The element at \a idx is replaced by a new mt-safe value equal to the
+     * sum of the old value and \a delta. A \c null element, or an element at
+     * an index greater than the greatest existing index, is treated as zero
+     * of the type of \a delta. The vector is extended as needed as in at().
+     * Addition is done as by predef::f_add, that is, using modulo arithmetic
+     * for \c unsigned and checking overflow for \c int. Reading the old value
+     * and storing the new one are done while holding the internal mutex,
+     * hence concurrent increments are never lost.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c idx -- an index of type \c int or \c unsigned
+     *     \arg \c delta -- the value added to the element; it has type \c int
+     *     or \c unsigned
+     * \return the old value of the element (zero if the element did not exist
+     * or was \c null)
+     * \throw exception::op_narg if the number of arguments (incl. \a
+     * method_name) is not 3
+     * \throw exception::value_null if \a idx or \a delta is \c null
+     * \throw exception::value_type if \a idx or \a delta is not of type \c
+     * int or \c unsigned, or if the element has a type different from \a
+     * delta
+     * \throw exception::value_out_of_range if \a idx is negative, or greater
+     * or equal to \link a_basic_vector a_basic_vector::max_size()\endlink
+     * \throw exception::op_overflow if the addition of \c int values
+     * overflows; the element remains unchanged */
+    typename basic_shared_vector::value_ptr
+    fetch_add(typename threadscript::basic_state<A>& thread,
+              typename threadscript::basic_symbol_table<A>& l_vars,
+              const typename threadscript::basic_code_node<A>& node);
+    //! Gets several elements.
+    /*! All elements are read while holding the internal mutex only once,
+     * therefore the result is a consistent snapshot of the selected elements.
+     * Unlike at(), an index greater than the greatest existing index does not
+     * cause an exception.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c indices -- a \c vector of indices of type \c int or \c
+     *     unsigned
+     * \return a \c vector (not \c shared_vector) containing an element for
+     * each item of \a indices, in the same order; \c null for an index
+     * greater than the greatest existing index
+     * \throw exception::op_narg if the number of arguments (incl. \a
+     * method_name) is not 2
+     * \throw exception::value_null if \a indices or any of its elements is
+     * \c null
+     * \throw exception::value_type if \a indices is not of type \c vector,
+     * or any of its elements is not of type \c int or \c unsigned
+     * \throw exception::value_out_of_range if any index is negative */
+    typename basic_shared_vector::value_ptr
+    get_many(typename threadscript::basic_state<A>& thread,
+             typename threadscript::basic_symbol_table<A>& l_vars,
+             const typename threadscript::basic_code_node<A>& node);
+    //! Gets a vector element, inserting it if it does not exist.
+    /*! If the element at \a idx exists and is not \c null, it is returned
+     * and the vector remains unchanged. Otherwise, \a value is stored as the
+     * element at \a idx, extending the vector as in at(), and returned.
+     * Testing and inserting are done while holding the internal mutex, hence
+     * at most one thread can insert the element.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c idx -- an index of type \c int or \c unsigned
+     *     \arg \c value -- the element inserted if there is no element at \a
+     *     idx
+     * \return the existing or the inserted element at \a idx
+     * \throw exception::op_narg if the number of arguments (incl. \a
+     * method_name) is not 3
+     * \throw exception::value_null if \a idx is \c null
+     * \throw exception::value_type if \a idx is not of type \c int or \c
+     * unsigned
+     * \throw exception::value_out_of_range if \a idx is negative, or greater
+     * or equal to \link a_basic_vector a_basic_vector::max_size()\endlink
+     * \throw exception::value_mt_unsafe if \a value is not mt-safe */
+    typename basic_shared_vector::value_ptr
+    get_or_insert(typename threadscript::basic_state<A>& thread,
+                  typename threadscript::basic_symbol_table<A>& l_vars,
+                  const typename threadscript::basic_code_node<A>& node);
+    //! Sets several consecutive elements.
+    /*! All elements of \a values are stored, starting at index \a idx, while
+     * holding the internal mutex only once, therefore other threads see either
+     * none or all of them. The vector is extended as needed as in at().
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c idx -- the index of the first element to be set; it has
+     *     type \c int or \c unsigned
+     *     \arg \c values -- a \c vector of elements to be stored
+     * \return \c null
+     * \throw exception::op_narg if the number of arguments (incl. \a
+     * method_name) is not 3
+     * \throw exception::value_null if \a idx or \a values is \c null
+     * \throw exception::value_type if \a idx is not of type \c int or \c
+     * unsigned, or \a values is not of type \c vector
+     * \throw exception::value_out_of_range if \a idx is negative, or if the
+     * resulting size would be greater than \link a_basic_vector
+     * a_basic_vector::max_size()\endlink
+     * \throw exception::value_mt_unsafe if any element of \a values is not
+     * mt-safe */
+    typename basic_shared_vector::value_ptr
+    set_many(typename threadscript::basic_state<A>& thread,
+             typename threadscript::basic_symbol_table<A>& l_vars,
+             const typename threadscript::basic_code_node<A>& node);
     //! Gets the number of elements.
     /*! \param[in] thread the current thread
      * \param[in] l_vars the symbol table of the current stack frame
@@ -106,6 +254,71 @@ private:
     size(typename threadscript::basic_state<A>& thread,
          typename threadscript::basic_symbol_table<A>& l_vars,
          const typename threadscript::basic_code_node<A>& node);
+    //! Gets a range of elements.
+    /*! All elements are read while holding the internal mutex only once,
+     * therefore the result is a consistent snapshot of the range. The range is
+     * silently truncated to the existing elements.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c from -- the index of the first element of the range; it has
+     *     type \c int or \c unsigned
+     *     \arg \c to -- the index one past the last element of the range; it
+     *     has type \c int or \c unsigned
+     * \return a \c vector (not \c shared_vector) containing elements with
+     * indices from \a from (inclusive) to \a to (exclusive); it is empty if
+     * \a from is not less than \a to or not less than the size of this
+     * vector
+     * \throw exception::op_narg if the number of arguments (incl. \a
+     * method_name) is not 3
+     * \throw exception::value_null if \a from or \a to is \c null
+     * \throw exception::value_type if \a from or \a to is not of type \c
+     * int or \c unsigned
+     * \throw exception::value_out_of_range if \a from or \a to is negative
+     */
+    typename basic_shared_vector::value_ptr
+    slice(typename threadscript::basic_state<A>& thread,
+          typename threadscript::basic_symbol_table<A>& l_vars,
+          const typename threadscript::basic_code_node<A>& node);
+    //! Atomically updates a vector element by a function.
+    /*! Function \a fun is called with a single argument, the current value of
+     * the element at \a idx (\c null if \a idx is greater than the greatest
+     * existing index). The value returned by \a fun is stored as the new
+     * element at \a idx, extending the vector as in at(). The function is
+     * called without holding the internal mutex, hence it may block and
+     * access this vector. If the element has been changed (or the vector has
+     * been resized over \a idx) by another call before \a fun returns, the
+     * result is discarded and \a fun is called again with the new value of
+     * the element. Therefore \a fun can be called more than once and it
+     * should not have side effects. If \a fun throws an exception, the
+     * vector remains unchanged.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c idx -- an index of type \c int or \c unsigned
+     *     \arg \c fun -- the name of a function (of type \c string)
+     *     computing the new value of the element
+     * \return the new element at \a idx
+     * \throw exception::op_narg if the number of arguments (incl. \a
+     * method_name) is not 3
+     * \throw exception::value_null if \a idx or \a fun is \c null
+     * \throw exception::value_type if \a idx is not of type \c int or \c
+     * unsigned, or \a fun is not a \c string or if it is not a name of a
+     * function
+     * \throw exception::unknown_symbol if function \a fun does not exist
+     * \throw exception::value_out_of_range if \a idx is negative, or greater
+     * or equal to \link a_basic_vector a_basic_vector::max_size()\endlink
+     * \throw exception::value_mt_unsafe if the value returned by \a fun is
+     * not mt-safe
+     * \throw any exception thrown by \a fun
+     * \warning If \a fun always changes the element at \a idx, this method
+     * does not terminate. */
+    typename basic_shared_vector::value_ptr
+    update(typename threadscript::basic_state<A>& thread,
+           typename threadscript::basic_symbol_table<A>& l_vars,
+           const typename threadscript::basic_code_node<A>& node);
     //! Storage of vector content
     a_basic_vector<typename basic_shared_vector::value_ptr, A> data;
     //! The mutex for synchronizing access from threads
@@ -5,6 +5,11 @@
  */
 
 #include "threadscript/shared_vector.hpp"
+#include "threadscript/code.hpp"
+#include "threadscript/green.hpp"
+#include "threadscript/predef.hpp"
+
+#include <algorithm>
 
 namespace threadscript {
 
@@ -49,6 +54,37 @@ basic_shared_vector<A>::at(typename threadscript::basic_state<A>& thread,
     }
 }
 
+template <impl::allocator A> basic_shared_vector<A>::value_ptr
+basic_shared_vector<A>::cas(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 4)
+        throw exception::op_narg();
+    size_t i = this->arg_index(thread, l_vars, node, 1);
+    auto expected = this->arg(thread, l_vars, node, 2);
+    auto v = this->arg(thread, l_vars, node, 3);
+    if (v && !v->mt_safe())
+        throw exception::value_mt_unsafe();
+    auto result = basic_value_bool<A>::create(thread.get_allocator());
+    std::lock_guard lck(mtx);
+    if (i >= data.max_size())
+        throw exception::value_out_of_range();
+    typename basic_shared_vector::value_ptr current =
+        i < data.size() ? data[i] : nullptr;
+    if (!current || !expected)
+        result->value() = !current && !expected;
+    else
+        result->value() = current == expected ||
+            predef::f_eq<A>::compare(current, expected);
+    if (result->cvalue()) {
+        if (i >= data.size())
+            data.resize(i + 1);
+        data[i] = std::move(v);
+    }
+    return result;
+}
+
 template <impl::allocator A> basic_shared_vector<A>::value_ptr
 basic_shared_vector<A>::erase(
     typename threadscript::basic_state<A>& thread,
@@ -72,18 +108,144 @@ basic_shared_vector<A>::erase(
     return nullptr;
 }
 
+template <impl::allocator A> basic_shared_vector<A>::value_ptr
+basic_shared_vector<A>::fetch_add(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 3)
+        throw exception::op_narg();
+    size_t i = this->arg_index(thread, l_vars, node, 1);
+    auto delta = this->arg(thread, l_vars, node, 2);
+    if (!delta)
+        throw exception::value_null();
+    auto add = [&]<class T>(T* d) -> typename basic_shared_vector::value_ptr {
+        auto sum = T::create(thread.get_allocator());
+        std::lock_guard lck(mtx);
+        if (i >= data.max_size())
+            throw exception::value_out_of_range();
+        typename basic_shared_vector::value_ptr old =
+            i < data.size() ? data[i] : nullptr;
+        if (old) {
+            auto po = dynamic_cast<T*>(old.get());
+            if (!po)
+                throw exception::value_type();
+            sum->value() = predef::f_add<A>::add(po->cvalue(), d->cvalue());
+        } else {
+            old = T::create(thread.get_allocator());
+            old->set_mt_safe();
+            sum->value() = d->cvalue();
+        }
+        sum->set_mt_safe();
+        if (i >= data.size())
+            data.resize(i + 1);
+        data[i] = std::move(sum);
+        return old;
+    };
+    if (auto d = dynamic_cast<basic_value_int<A>*>(delta.get()))
+        return add(d);
+    else if (auto d = dynamic_cast<basic_value_unsigned<A>*>(delta.get()))
+        return add(d);
+    else
+        throw exception::value_type();
+}
+
+template <impl::allocator A> basic_shared_vector<A>::value_ptr
+basic_shared_vector<A>::get_many(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 2)
+        throw exception::op_narg();
+    auto a = this->arg(thread, l_vars, node, 1);
+    if (!a)
+        throw exception::value_null();
+    auto indices = dynamic_cast<basic_value_vector<A>*>(a.get());
+    if (!indices)
+        throw exception::value_type();
+    a_basic_vector<size_t, A> idx{thread.get_allocator()};
+    idx.reserve(indices->cvalue().size());
+    for (auto&& i: indices->cvalue())
+        idx.push_back(this->to_index(i));
+    auto result = basic_value_vector<A>::create(thread.get_allocator());
+    auto& r = result->value();
+    r.reserve(idx.size());
+    std::lock_guard lck(mtx);
+    for (size_t i: idx)
+        r.push_back(i < data.size() ? data[i] : nullptr);
+    return result;
+}
+
+template <impl::allocator A> basic_shared_vector<A>::value_ptr
+basic_shared_vector<A>::get_or_insert(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 3)
+        throw exception::op_narg();
+    size_t i = this->arg_index(thread, l_vars, node, 1);
+    auto v = this->arg(thread, l_vars, node, 2);
+    if (v && !v->mt_safe())
+        throw exception::value_mt_unsafe();
+    std::lock_guard lck(mtx);
+    if (i >= data.max_size())
+        throw exception::value_out_of_range();
+    if (i >= data.size())
+        data.resize(i + 1);
+    if (!data[i])
+        data[i] = std::move(v);
+    return data[i];
+}
+
 template <impl::allocator A> basic_shared_vector<A>::method_table
 basic_shared_vector<A>::init_methods()
 {
     return {
         //! [methods]
         {"at", &basic_shared_vector::at},
+        {"cas", &basic_shared_vector::cas},
         {"erase", &basic_shared_vector::erase},
+        {"fetch_add", &basic_shared_vector::fetch_add},
+        {"get_many", &basic_shared_vector::get_many},
+        {"get_or_insert", &basic_shared_vector::get_or_insert},
+        {"set_many", &basic_shared_vector::set_many},
         {"size", &basic_shared_vector::size},
+        {"slice", &basic_shared_vector::slice},
+        {"update", &basic_shared_vector::update},
         //! [methods]
     };
 }
 
+template <impl::allocator A> basic_shared_vector<A>::value_ptr
+basic_shared_vector<A>::set_many(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 3)
+        throw exception::op_narg();
+    size_t i = this->arg_index(thread, l_vars, node, 1);
+    auto a = this->arg(thread, l_vars, node, 2);
+    if (!a)
+        throw exception::value_null();
+    auto values = dynamic_cast<basic_value_vector<A>*>(a.get());
+    if (!values)
+        throw exception::value_type();
+    auto& v = values->cvalue();
+    for (auto&& e: v)
+        if (e && !e->mt_safe())
+            throw exception::value_mt_unsafe();
+    std::lock_guard lck(mtx);
+    if (i > data.max_size() || v.size() > data.max_size() - i)
+        throw exception::value_out_of_range();
+    if (!v.empty() && i + v.size() > data.size())
+        data.resize(i + v.size());
+    std::copy(v.begin(), v.end(), data.begin() + ptrdiff_t(i));
+    return nullptr;
+}
+
 template <impl::allocator A> basic_shared_vector<A>::value_ptr
 basic_shared_vector<A>::size(typename threadscript::basic_state<A>& thread,
     typename threadscript::basic_symbol_table<A>&,
@@ -97,4 +259,73 @@ basic_shared_vector<A>::size(typename threadscript::basic_state<A>& thread,
     return res;
 }
 
+template <impl::allocator A> basic_shared_vector<A>::value_ptr
+basic_shared_vector<A>::slice(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 3)
+        throw exception::op_narg();
+    size_t from = this->arg_index(thread, l_vars, node, 1);
+    size_t to = this->arg_index(thread, l_vars, node, 2);
+    auto result = basic_value_vector<A>::create(thread.get_allocator());
+    std::lock_guard lck(mtx);
+    to = std::min(to, data.size());
+    if (from < to)
+        result->value().assign(data.begin() + ptrdiff_t(from),
+                               data.begin() + ptrdiff_t(to));
+    return result;
+}
+
+template <impl::allocator A> basic_shared_vector<A>::value_ptr
+basic_shared_vector<A>::update(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 3)
+        throw exception::op_narg();
+    size_t i = this->arg_index(thread, l_vars, node, 1);
+    auto a2 = this->arg(thread, l_vars, node, 2);
+    if (!a2)
+        throw exception::value_null();
+    auto name = dynamic_cast<basic_value_string<A>*>(a2.get());
+    if (!name)
+        throw exception::value_type();
+    auto f = l_vars.lookup(name->cvalue());
+    if (!f)
+        throw exception::unknown_symbol(name->cvalue());
+    auto fun = std::dynamic_pointer_cast<basic_value_function<A>>(*f);
+    if (!fun)
+        throw exception::value_type();
+    // The function is called without holding mtx, so that it can block and
+    // access this vector. Its result is stored only if the element has not
+    // been changed in the meantime, otherwise the function is called again.
+    for (;;) {
+        typename basic_shared_vector::value_ptr old = nullptr;
+        bool found = false;
+        {
+            std::lock_guard lck(mtx);
+            if (i >= data.max_size())
+                throw exception::value_out_of_range();
+            if (i < data.size()) {
+                old = data[i];
+                found = true;
+            }
+        }
+        auto args = basic_value_vector<A>::create(thread.get_allocator());
+        args->value().push_back(old);
+        auto v = fun->call(thread, name->cvalue(), std::move(args));
+        if (v && !v->mt_safe())
+            throw exception::value_mt_unsafe();
+        std::lock_guard lck(mtx);
+        if (i < data.size()) {
+            if (found && data[i] == old)
+                return data[i] = v;
+        } else if (!found) {
+            data.resize(i + 1);
+            return data[i] = v;
+        }
+    }
+}
+
 } // namespace threadscript
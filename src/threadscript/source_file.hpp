@@ -0,0 +1,71 @@
+#pragma once
+
+/*! \file
+ * \brief Access to the content of script source files without copying
+ *
+ * A parser works with the whole source text as a contiguous sequence of
+ * characters. Reading a large file into a string, possibly through
+ * intermediate stream buffers, needs at least as much memory as the size of
+ * the file, often twice as much. Class source_file avoids copying by mapping a
+ * regular file into memory.
+ *
+ * \test in file test_source_file.cpp
+ */
+
+#include <istream>
+#include <string>
+#include <string_view>
+
+namespace threadscript {
+
+//! A read-only view of the content of a source file
+/*! A regular file is mapped into memory, hence its content is not copied and
+ * it is loaded lazily by the operating system as it is being parsed. If the
+ * file cannot be mapped (e.g., it is a pipe, or memory mapping is not
+ * supported by the platform), its content is read into memory.
+ * \note If a mapped file is truncated by another process while being
+ * accessed, the program may be terminated by a signal. Script files are not
+ * expected to be modified during parsing. */
+class source_file {
+public:
+    //! Opens a file and makes its content available.
+    /*! \param[in] file a file name
+     * \throw std::ios_base::failure if \a file cannot be opened */
+    explicit source_file(std::string_view file);
+    //! No copy
+    source_file(const source_file&) = delete;
+    //! No move
+    source_file(source_file&&) = delete;
+    //! Unmaps the file.
+    ~source_file();
+    //! No copy
+    source_file& operator=(const source_file&) = delete;
+    //! No move
+    source_file& operator=(source_file&&) = delete;
+    //! Gets the content of the file.
+    /*! \return a view valid during the lifetime of this object */
+    [[nodiscard]] std::string_view view() const noexcept {
+        return _view;
+    }
+    //! Tests if the file is mapped into memory.
+    /*! \return \c true if the file is mapped, \c false if it has been read */
+    [[nodiscard]] bool mapped() const noexcept {
+        return _map;
+    }
+    //! Reads the rest of a stream.
+    /*! If the stream is seekable, the remaining size is determined first and
+     * the data are read directly into the result. Otherwise, the stream is
+     * read by chunks.
+     * \param[in] is an input stream
+     * \return the data read from \a is
+     * \throw std::ios_base::failure if the stream is in a failed state on
+     * entry, which happens if it is an \c std::ifstream that cannot be opened
+     */
+    [[nodiscard]] static std::string read(std::istream& is);
+private:
+    void* _map = nullptr; //!< The mapped memory, \c nullptr if not mapped
+    std::string _data; //!< The file content if the file is not mapped
+    std::string_view _view; //!< The content of the file
+};
+
+} // namespace threadscript
@@ -0,0 +1,154 @@
+#pragma once
+
+/*! \file
+ * \brief A pool of reusable thread states of a virtual machine
+ */
+
+#include "threadscript/virtual_machine.hpp"
+
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace threadscript {
+
+//! A pool of reusable basic_state objects
+/*! It is intended for embedding ThreadScript into a server, which calls
+ * a script function for each request. Instead of creating a new basic_state
+ * for each call, a thread acquires a state from the pool and returns it to
+ * the pool after the call. A state returned to the pool is reset by
+ * basic_state::reset(), which keeps memory allocated by its symbol table, but
+ * releases the shared variables, so that an idle state does not keep old
+ * shared variables alive. A state acquired from the pool is attached to the
+ * current basic_virtual_machine::sh_vars by basic_state::update_sh_vars().
+ * States are allocated by the allocator of the virtual machine.
+ *
+ * There is at most one state pool in a basic_virtual_machine. It is created
+ * on demand by get(), and it is destroyed by the destructor of the VM. All
+ * states acquired from the pool must be returned before destroying the VM.
+ * \tparam A an allocator type
+ * \threadsafe{safe,safe}
+ * \test in file test_state_pool.cpp */
+template <impl::allocator A>
+class basic_state_pool final: public impl::state_pool_base {
+public:
+    //! A shared pointer to a state
+    /*! States are allocated by the allocator of the virtual machine. */
+    using state_ptr = std::shared_ptr<basic_state<A>>;
+    //! An owner of a state acquired from the pool
+    /*! It returns the state to the pool when destroyed. */
+    class handle {
+    public:
+        //! Creates an empty handle.
+        handle() = default;
+        //! No copying
+        handle(const handle&) = delete;
+        //! Move constructor
+        /*! \param[in] o the source object, it becomes empty */
+        handle(handle&& o) noexcept:
+            pool(std::exchange(o.pool, nullptr)), state(std::move(o.state))
+        {}
+        //! Returns the state to the pool.
+        ~handle() {
+            release();
+        }
+        //! No copying
+        handle& operator=(const handle&) = delete;
+        //! Move assignment
+        /*! It returns the current state to the pool.
+         * \param[in] o the source object, it becomes empty
+         * \return \c *this */
+        handle& operator=(handle&& o) noexcept {
+            if (&o != this) {
+                release();
+                pool = std::exchange(o.pool, nullptr);
+                state = std::move(o.state);
+            }
+            return *this;
+        }
+        //! Gets the state.
+        /*! \return the state, \c nullptr if the handle is empty */
+        [[nodiscard]] basic_state<A>* get() const noexcept {
+            return state.get();
+        }
+        //! Gets the state.
+        /*! The handle must not be empty.
+         * \return the state */
+        basic_state<A>& operator*() const noexcept {
+            assert(state);
+            return *state;
+        }
+        //! Accesses the state.
+        /*! The handle must not be empty.
+         * \return the state */
+        basic_state<A>* operator->() const noexcept {
+            assert(state);
+            return state.get();
+        }
+        //! Tests if the handle is not empty.
+        /*! \return \c true if the handle holds a state */
+        explicit operator bool() const noexcept {
+            return bool(state);
+        }
+        //! Returns the state to the pool.
+        /*! The handle becomes empty. It does nothing if the handle is
+         * already empty. */
+        void release() noexcept;
+    private:
+        //! Creates a handle holding a state.
+        /*! \param[in] pool the pool
+         * \param[in] state the state acquired from \a pool */
+        handle(basic_state_pool& pool, state_ptr state):
+            pool(&pool), state(std::move(state)) {}
+        //! The owner pool of \ref state
+        basic_state_pool* pool = nullptr;
+        //! The state
+        state_ptr state;
+        //! Needs access to the constructor
+        friend class basic_state_pool;
+    };
+    //! Creates an empty pool.
+    /*! \param[in] vm the virtual machine, which the states are attached to */
+    explicit basic_state_pool(basic_virtual_machine<A>& vm):
+        vm(vm), states(vm.get_allocator()) {}
+    //! No copying
+    basic_state_pool(const basic_state_pool&) = delete;
+    //! No moving
+    basic_state_pool(basic_state_pool&&) = delete;
+    //! Destroys all idle states.
+    ~basic_state_pool() override = default;
+    //! No copying
+    basic_state_pool& operator=(const basic_state_pool&) = delete;
+    //! No moving
+    basic_state_pool& operator=(basic_state_pool&&) = delete;
+    //! Gets the state pool of a virtual machine.
+    /*! The pool is created by the first call for \a vm.
+     * \param[in] vm a virtual machine
+     * \return the state pool of \a vm */
+    static basic_state_pool& get(basic_virtual_machine<A>& vm);
+    //! Gets a state from the pool.
+    /*! It takes an idle state or creates a new one if there is no idle state.
+     * The state uses the current basic_virtual_machine::sh_vars.
+     * \return a handle owning the state until it is destroyed */
+    handle acquire();
+    //! Gets the number of idle states in the pool.
+    /*! \return the number of states that can be acquired without creating a
+     * new one */
+    [[nodiscard]] size_t idle() const;
+    //! Destroys idle states.
+    /*! \param[in] keep the number of idle states that are kept */
+    void shrink(size_t keep = 0);
+private:
+    //! Returns a state to the pool.
+    /*! \param[in] state a state previously acquired from this pool */
+    void put(state_ptr state) noexcept;
+    //! The virtual machine
+    basic_virtual_machine<A>& vm;
+    //! The mutex protecting \ref states
+    mutable std::mutex mtx;
+    //! Idle states
+    a_basic_vector<state_ptr, A> states;
+};
+
+} // namespace threadscript
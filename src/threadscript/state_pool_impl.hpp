@@ -0,0 +1,82 @@
+#pragma once
+
+/*! \file
+ * \brief The implementation part of state_pool.hpp
+ */
+
+#include "threadscript/state_pool.hpp"
+
+namespace threadscript {
+
+/*** basic_state_pool::handle ************************************************/
+
+template <impl::allocator A> void basic_state_pool<A>::handle::release() noexcept
+{
+    if (state) {
+        assert(pool);
+        pool->put(std::move(state));
+    }
+    pool = nullptr;
+}
+
+/*** basic_state_pool ********************************************************/
+
+template <impl::allocator A> auto basic_state_pool<A>::acquire() -> handle
+{
+    state_ptr state;
+    {
+        std::lock_guard lck{mtx};
+        if (!states.empty()) {
+            state = std::move(states.back());
+            states.pop_back();
+        }
+    }
+    if (state)
+        state->update_sh_vars();
+    else
+        state = std::allocate_shared<basic_state<A>>(vm.get_allocator(), vm);
+    return handle{*this, std::move(state)};
+}
+
+template <impl::allocator A>
+basic_state_pool<A>& basic_state_pool<A>::get(basic_virtual_machine<A>& vm)
+{
+    std::lock_guard lck{vm.state_pool_mtx};
+    if (!vm.state_pool)
+        vm.state_pool = std::make_unique<basic_state_pool>(vm);
+    return static_cast<basic_state_pool&>(*vm.state_pool);
+}
+
+template <impl::allocator A> size_t basic_state_pool<A>::idle() const
+{
+    std::lock_guard lck{mtx};
+    return states.size();
+}
+
+template <impl::allocator A>
+void basic_state_pool<A>::put(state_ptr state) noexcept
+{
+    state->reset();
+    std::lock_guard lck{mtx};
+    try {
+        states.push_back(std::move(state));
+    } catch (...) {
+        // Out of memory, the state is destroyed
+    }
+}
+
+template <impl::allocator A> void basic_state_pool<A>::shrink(size_t keep)
+{
+    a_basic_vector<state_ptr, A> drop(vm.get_allocator());
+    {
+        std::lock_guard lck{mtx};
+        if (states.size() > keep) {
+            drop.reserve(states.size() - keep);
+            std::move(states.begin() + keep, states.end(),
+                      std::back_inserter(drop));
+            states.resize(keep);
+        }
+    }
+}
+
+} // namespace threadscript
@@ -0,0 +1,161 @@
+#pragma once
+
+/*! \file
+ * \brief A builder of long strings created by repeated appending
+ */
+
+#include "threadscript/vm_data.hpp"
+
+namespace threadscript {
+
+template <impl::allocator A> class basic_string_builder;
+
+namespace impl {
+//! The name of string_builder
+inline constexpr char name_string_builder[] = "string_builder";
+//! The base class of basic_string_builder
+/*! \tparam A an allocator type */
+template <allocator A> using basic_string_builder_base =
+    basic_value_object<basic_string_builder<A>, name_string_builder, A>;
+} // namespace impl
+
+//! A string builder class
+/*! Building a string by a sequence of calls <tt>add(s1, s2)</tt> creates a
+ * new string in each step, copying the whole string built so far, so the
+ * total number of copied characters is quadratic in the length of the result.
+ * This class keeps a growing buffer instead, so that each append() has
+ * amortized complexity linear in the length of the appended string. The final
+ * string is obtained by str(). Function \c add also appends in place, but
+ * only if its result argument is the same object as its first operand.
+ *
+ * An object is thread-local by default. Marking it thread-safe by
+ * set_mt_safe() makes it read-only.
+ *
+ * Methods:
+ * \snippet string_builder_impl.hpp methods
+ * \tparam A an allocator type
+ * \threadsafe{safe,unsafe} if not marked thread-safe; \threadsafe{safe,safe}
+ * if marked thread-safe (then all methods modifying the object throw
+ * exception::value_read_only)
+ * \test in file test_string_builder.cpp */
+template <impl::allocator A>
+class basic_string_builder final: public impl::basic_string_builder_base<A> {
+public:
+    //! Creates the string builder.
+    /*! \param[in] t an ignored parameter that prevents using this
+     * \param[in] methods the mapping from method names to implementations
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with constructor arguments:
+     *     \arg \c init (optional) the initial contents, of type \c string; if
+     *     missing, the builder is empty
+     * \throw exception::op_narg if the number of arguments is not 0 or 1
+     * \throw exception::value_null if \a init is \c null
+     * \throw exception::value_type if \a init does not have type \c string */
+    basic_string_builder(typename basic_string_builder::tag t,
+        std::shared_ptr<const typename basic_string_builder::method_table>
+            methods,
+        typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node);
+    //! \copydoc basic_value_object::init_methods()
+    [[nodiscard]] static
+    typename basic_string_builder::method_table init_methods();
+private:
+    //! Appends a string at the end.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c str the appended string
+     * \return \c null
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 2
+     * \throw exception::value_null if \a str is \c null
+     * \throw exception::value_type if \a str does not have type \c string
+     * \throw exception::value_out_of_range if the resulting length would be
+     * greater than the maximum length of a string
+     * \throw exception::value_read_only if the object is thread-safe */
+    typename basic_string_builder::value_ptr
+    append(typename threadscript::basic_state<A>& thread,
+           typename threadscript::basic_symbol_table<A>& l_vars,
+           const typename threadscript::basic_code_node<A>& node);
+    //! Appends any number of strings at the end.
+    /*! The storage is extended at most once for all the appended strings.
+     * Nothing is appended if an exception is thrown.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c str1 the first appended string
+     *     \arg \c str2 the second appended string
+     *     \arg ... more strings
+     * \return \c null
+     * \throw exception::value_null if any \a str is \c null
+     * \throw exception::value_type if any \a str does not have type \c string
+     * \throw exception::value_out_of_range if the resulting length would be
+     * greater than the maximum length of a string
+     * \throw exception::value_read_only if the object is thread-safe */
+    typename basic_string_builder::value_ptr
+    append_many(typename threadscript::basic_state<A>& thread,
+                typename threadscript::basic_symbol_table<A>& l_vars,
+                const typename threadscript::basic_code_node<A>& node);
+    //! Removes all characters.
+    /*! The allocated storage is kept, so that the object can be reused for
+     * building another string of a similar length.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     * \return \c null
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 1
+     * \throw exception::value_read_only if the object is thread-safe */
+    typename basic_string_builder::value_ptr
+    clear(typename threadscript::basic_state<A>& thread,
+          typename threadscript::basic_symbol_table<A>& l_vars,
+          const typename threadscript::basic_code_node<A>& node);
+    //! Gets the length of the string.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     * \return the number of characters, of type \c unsigned
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 1 */
+    typename basic_string_builder::value_ptr
+    size(typename threadscript::basic_state<A>& thread,
+         typename threadscript::basic_symbol_table<A>& l_vars,
+         const typename threadscript::basic_code_node<A>& node);
+    //! Gets the built string.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     * \return a new \c string containing a copy of the characters of this
+     * object
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 1 */
+    typename basic_string_builder::value_ptr
+    str(typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node);
+    //! Gets a string passed as a method argument.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments
+     * \param[in] idx the (zero-based) index of the argument
+     * \return the argument value, guaranteed to have type \c string
+     * \throw exception::value_null if the argument is \c null
+     * \throw exception::value_type if the argument does not have type \c
+     * string */
+    typename basic_string_builder::value_ptr
+    arg_string(typename threadscript::basic_state<A>& thread,
+               typename threadscript::basic_symbol_table<A>& l_vars,
+               const typename threadscript::basic_code_node<A>& node,
+               size_t idx);
+    //! The characters appended so far
+    a_basic_string<A> data;
+};
+
+} // namespace threadscript
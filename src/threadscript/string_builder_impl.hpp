@@ -0,0 +1,144 @@
+#pragma once
+
+/*! \file
+ * \brief The implementation part of string_builder.hpp
+ */
+
+#include "threadscript/string_builder.hpp"
+
+namespace threadscript {
+
+template <impl::allocator A>
+basic_string_builder<A>::basic_string_builder(
+        typename basic_string_builder<A>::tag,
+        std::shared_ptr<const typename basic_string_builder<A>::method_table>
+            methods,
+        typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node):
+    impl::basic_string_builder_base<A>(
+        typename basic_string_builder::tag_args{}, methods, thread, l_vars,
+        node),
+    data(thread.get_allocator())
+{
+    size_t narg = this->narg(node);
+    if (narg > 1)
+        throw exception::op_narg();
+    if (narg == 1) {
+        auto v = arg_string(thread, l_vars, node, 0);
+        data = static_cast<basic_value_string<A>*>(v.get())->cvalue();
+    }
+}
+
+template <impl::allocator A> basic_string_builder<A>::value_ptr
+basic_string_builder<A>::append(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 2)
+        throw exception::op_narg();
+    auto v = arg_string(thread, l_vars, node, 1);
+    if (this->mt_safe())
+        throw exception::value_read_only();
+    auto& s = static_cast<basic_value_string<A>*>(v.get())->cvalue();
+    if (s.size() > data.max_size() - data.size())
+        throw exception::value_out_of_range();
+    data.append(s);
+    return nullptr;
+}
+
+template <impl::allocator A> basic_string_builder<A>::value_ptr
+basic_string_builder<A>::append_many(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    size_t narg = this->narg(node);
+    // Keep all arguments until appended, so that the total length is known
+    // before the storage is extended
+    a_basic_vector<typename basic_string_builder::value_ptr, A>
+        args(thread.get_allocator());
+    args.reserve(narg - 1);
+    size_t total = data.size();
+    for (size_t i = 1; i < narg; ++i) {
+        auto& v = args.emplace_back(arg_string(thread, l_vars, node, i));
+        size_t sz = static_cast<basic_value_string<A>*>(v.get())->cvalue().
+            size();
+        if (sz > data.max_size() - total)
+            throw exception::value_out_of_range();
+        total += sz;
+    }
+    if (this->mt_safe())
+        throw exception::value_read_only();
+    data.reserve(total);
+    for (auto&& v: args)
+        data.append(static_cast<basic_value_string<A>*>(v.get())->cvalue());
+    return nullptr;
+}
+
+template <impl::allocator A> basic_string_builder<A>::value_ptr
+basic_string_builder<A>::arg_string(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node, size_t idx)
+{
+    auto v = this->arg(thread, l_vars, node, idx);
+    if (!v)
+        throw exception::value_null();
+    if (!dynamic_cast<basic_value_string<A>*>(v.get()))
+        throw exception::value_type();
+    return v;
+}
+
+template <impl::allocator A> basic_string_builder<A>::value_ptr
+basic_string_builder<A>::clear(typename threadscript::basic_state<A>&,
+    typename threadscript::basic_symbol_table<A>&,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 1)
+        throw exception::op_narg();
+    if (this->mt_safe())
+        throw exception::value_read_only();
+    data.clear();
+    return nullptr;
+}
+
+template <impl::allocator A> basic_string_builder<A>::method_table
+basic_string_builder<A>::init_methods()
+{
+    return {
+        //! [methods]
+        {"append", &basic_string_builder::append},
+        {"append_many", &basic_string_builder::append_many},
+        {"clear", &basic_string_builder::clear},
+        {"size", &basic_string_builder::size},
+        {"str", &basic_string_builder::str},
+        //! [methods]
+    };
+}
+
+template <impl::allocator A> basic_string_builder<A>::value_ptr
+basic_string_builder<A>::size(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>&,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 1)
+        throw exception::op_narg();
+    auto result = basic_value_unsigned<A>::create(thread.get_allocator());
+    result->value() = data.size();
+    return result;
+}
+
+template <impl::allocator A> basic_string_builder<A>::value_ptr
+basic_string_builder<A>::str(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>&,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 1)
+        throw exception::op_narg();
+    auto result = basic_value_string<A>::create(thread.get_allocator());
+    result->value() = data;
+    return result;
+}
+
+} // namespace threadscript
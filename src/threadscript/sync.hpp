@@ -0,0 +1,491 @@
+#pragma once
+
+/*! \file
+ * \brief Synchronization objects: a barrier, a latch, a mutex, and
+ * a semaphore.
+ *
+ * All the objects wait using impl::green_cond, therefore a waiting task
+ * running in a green thread does not block a thread of basic_task_pool.
+ */
+
+#include "threadscript/code.hpp"
+#include "threadscript/green.hpp"
+#include "threadscript/vm_data.hpp"
+
+#include <limits>
+#include <mutex>
+
+namespace threadscript {
+
+template <impl::allocator A> class basic_barrier;
+template <impl::allocator A> class basic_latch;
+template <impl::allocator A> class basic_mutex;
+template <impl::allocator A> class basic_semaphore;
+
+namespace impl {
+//! The name of barrier
+inline constexpr char name_barrier[] = "barrier";
+//! The base class of basic_barrier
+/*! \tparam A an allocator type */
+template <allocator A> using basic_barrier_base =
+    basic_value_object<basic_barrier<A>, name_barrier, A>;
+//! The name of latch
+inline constexpr char name_latch[] = "latch";
+//! The base class of basic_latch
+/*! \tparam A an allocator type */
+template <allocator A> using basic_latch_base =
+    basic_value_object<basic_latch<A>, name_latch, A>;
+//! The name of mutex
+inline constexpr char name_mutex[] = "mutex";
+//! The base class of basic_mutex
+/*! \tparam A an allocator type */
+template <allocator A> using basic_mutex_base =
+    basic_value_object<basic_mutex<A>, name_mutex, A>;
+//! The name of semaphore
+inline constexpr char name_semaphore[] = "semaphore";
+//! The base class of basic_semaphore
+/*! \tparam A an allocator type */
+template <allocator A> using basic_semaphore_base =
+    basic_value_object<basic_semaphore<A>, name_semaphore, A>;
+} // namespace impl
+
+//! A reusable thread barrier class
+/*! It has semantics similar to \c std::barrier. A barrier is created with an
+ * expected number of participating threads. Each participating thread
+ * arrives at the barrier by arrive_and_wait() or arrive_and_drop(). When all
+ * expected threads arrive, the barrier runs the optional completion function
+ * in the last arriving thread, then it releases the waiting threads and
+ * starts a new phase. Method arrive_and_drop() also decrements the expected
+ * number of threads for the following phases.
+ *
+ * The completion function is looked up when the barrier is created, but it is
+ * executed by any of the participating threads, hence any functions called by
+ * it must be accessible via shared variables. If it throws an exception, the
+ * phase completes anyway and the exception is propagated to the thread that
+ * has run the function.
+ *
+ * Methods:
+ * \snippet sync_impl.hpp barrier_methods
+ * \tparam A an allocator type
+ * \threadsafe{safe,safe}
+ * \test in file test_sync.cpp */
+template <impl::allocator A>
+class basic_barrier final: public impl::basic_barrier_base<A> {
+public:
+    //! Creates the barrier object.
+    /*! It marks the object mt-safe.
+     * \param[in] t an ignored parameter that prevents using this
+     * \param[in] methods the mapping from method names to implementations
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with constructor arguments:
+     *     \arg \c count the expected number of threads, of type \c int or \c
+     *     unsigned
+     *     \arg \c fun (optional) the name of the completion function, of type
+     *     \c string
+     * \throw exception::op_narg if the number of arguments is not 1 or 2
+     * \throw exception::value_null if \a count or \a fun is \c null
+     * \throw exception::value_type if \a count is not \c int or \c unsigned,
+     * or if \a fun is not a \c string or it is not a name of a function
+     * \throw exception::value_out_of_range if \a count is not positive
+     * \throw exception::unknown_symbol if function \a fun does not exist */
+    basic_barrier(typename basic_barrier::tag t,
+        std::shared_ptr<const typename basic_barrier::method_table> methods,
+        typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node);
+    //! \copydoc basic_value_object::init_methods()
+    [[nodiscard]] static
+    typename basic_barrier::method_table init_methods();
+private:
+    //! Arrives at the barrier and decrements the expected number of threads.
+    /*! It does not wait for the end of the current phase.
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     * \return \c null
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 1
+     * \throw exception::value_out_of_range if the expected number of threads
+     * is already 0
+     * \throw any exception thrown by the completion function */
+    typename basic_barrier::value_ptr
+    arrive_and_drop(typename threadscript::basic_state<A>& thread,
+                    typename threadscript::basic_symbol_table<A>& l_vars,
+                    const typename threadscript::basic_code_node<A>& node);
+    //! Arrives at the barrier and waits for the end of the current phase.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     * \return \c null
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 1
+     * \throw any exception thrown by the completion function */
+    typename basic_barrier::value_ptr
+    arrive_and_wait(typename threadscript::basic_state<A>& thread,
+                    typename threadscript::basic_symbol_table<A>& l_vars,
+                    const typename threadscript::basic_code_node<A>& node);
+    //! Registers an arrival and completes the phase if it is the last one.
+    /*! \param[in] thread the current thread
+     * \param[in] lck a lock of \ref mtx, released while running \ref fun
+     * \param[in] drop whether to decrement \ref expected
+     * \return \c true if the phase has been completed by this call
+     * \throw exception::value_out_of_range if \a drop is \c true and \ref
+     * expected is 0
+     * \throw any exception thrown by the completion function */
+    bool arrive(basic_state<A>& thread, std::unique_lock<std::mutex>& lck,
+                bool drop);
+    //! The completion function, \c nullptr if none
+    std::shared_ptr<basic_value_function<A>> fun;
+    //! The name used for calling \ref fun
+    a_basic_string<A> fun_name;
+    //! The mutex protecting the state of the barrier
+    std::mutex mtx;
+    //! Used to wait for the end of a phase
+    impl::green_cond cond;
+    //! The expected number of threads in the current phase
+    size_t expected = 0;
+    //! The number of threads arrived in the current phase
+    size_t arrived = 0;
+    //! The number of the current phase
+    size_t phase = 0;
+};
+
+//! A single-use thread latch class
+/*! It has semantics similar to \c std::latch. A latch is created with
+ * a counter value. Threads decrement the counter by count_down() and wait
+ * until the counter reaches zero by wait(). The counter cannot be reset or
+ * increased.
+ *
+ * Methods:
+ * \snippet sync_impl.hpp latch_methods
+ * \tparam A an allocator type
+ * \threadsafe{safe,safe}
+ * \test in file test_sync.cpp */
+template <impl::allocator A>
+class basic_latch final: public impl::basic_latch_base<A> {
+public:
+    //! Creates the latch object.
+    /*! It marks the object mt-safe.
+     * \param[in] t an ignored parameter that prevents using this
+     * \param[in] methods the mapping from method names to implementations
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with constructor arguments:
+     *     \arg \c count the initial value of the counter, of type \c int or
+     *     \c unsigned
+     * \throw exception::op_narg if the number of arguments is not 1
+     * \throw exception::value_null if \a count is \c null
+     * \throw exception::value_type if \a count is not \c int or \c unsigned
+     * \throw exception::value_out_of_range if \a count is negative */
+    basic_latch(typename basic_latch::tag t,
+        std::shared_ptr<const typename basic_latch::method_table> methods,
+        typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node);
+    //! \copydoc basic_value_object::init_methods()
+    [[nodiscard]] static
+    typename basic_latch::method_table init_methods();
+private:
+    //! Decrements the counter and waits until it reaches zero.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c n (optional) the decrement, of type \c int or \c unsigned;
+     *     1 if missing
+     * \return \c null
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 1 or 2
+     * \throw exception::value_null if \a n is \c null
+     * \throw exception::value_type if \a n is not \c int or \c unsigned
+     * \throw exception::value_out_of_range if \a n is negative or greater
+     * than the counter */
+    typename basic_latch::value_ptr
+    arrive_and_wait(typename threadscript::basic_state<A>& thread,
+                    typename threadscript::basic_symbol_table<A>& l_vars,
+                    const typename threadscript::basic_code_node<A>& node);
+    //! Decrements the counter without waiting.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c n (optional) the decrement, of type \c int or \c unsigned;
+     *     1 if missing
+     * \return \c null
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 1 or 2
+     * \throw exception::value_null if \a n is \c null
+     * \throw exception::value_type if \a n is not \c int or \c unsigned
+     * \throw exception::value_out_of_range if \a n is negative or greater
+     * than the counter */
+    typename basic_latch::value_ptr
+    count_down(typename threadscript::basic_state<A>& thread,
+               typename threadscript::basic_symbol_table<A>& l_vars,
+               const typename threadscript::basic_code_node<A>& node);
+    //! Tests if the counter has reached zero.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     * \return a \c bool value, \c true if the counter is zero
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 1 */
+    typename basic_latch::value_ptr
+    try_wait(typename threadscript::basic_state<A>& thread,
+             typename threadscript::basic_symbol_table<A>& l_vars,
+             const typename threadscript::basic_code_node<A>& node);
+    //! Waits until the counter reaches zero.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     * \return \c null
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 1 */
+    typename basic_latch::value_ptr
+    wait(typename threadscript::basic_state<A>& thread,
+         typename threadscript::basic_symbol_table<A>& l_vars,
+         const typename threadscript::basic_code_node<A>& node);
+    //! Decrements the counter by a method argument.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments as in
+     * count_down()
+     * \throw as count_down() */
+    void decrement(typename threadscript::basic_state<A>& thread,
+                   typename threadscript::basic_symbol_table<A>& l_vars,
+                   const typename threadscript::basic_code_node<A>& node);
+    //! The mutex protecting \ref counter
+    std::mutex mtx;
+    //! Used to wait for \ref counter reaching zero
+    impl::green_cond cond;
+    //! The counter
+    size_t counter = 0;
+};
+
+//! A mutex class
+/*! It provides mutual exclusion of threads. The mutex is owned by the thread
+ * (basic_state) that locked it and only the owner can unlock it. It is not
+ * recursive, an attempt to lock it again by the owner fails. Method
+ * run_locked() calls a function with the mutex locked and unlocks the mutex
+ * when the function returns or throws an exception, hence it is preferred
+ * over pairs of lock() and unlock().
+ *
+ * Methods:
+ * \snippet sync_impl.hpp mutex_methods
+ * \tparam A an allocator type
+ * \threadsafe{safe,safe}
+ * \test in file test_sync.cpp */
+template <impl::allocator A>
+class basic_mutex final: public impl::basic_mutex_base<A> {
+public:
+    //! Creates the mutex object.
+    /*! It marks the object mt-safe. The mutex is unlocked.
+     * \param[in] t an ignored parameter that prevents using this
+     * \param[in] methods the mapping from method names to implementations
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, without arguments
+     * \throw exception::op_narg if the number of arguments is not 0 */
+    basic_mutex(typename basic_mutex::tag t,
+        std::shared_ptr<const typename basic_mutex::method_table> methods,
+        typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node);
+    //! \copydoc basic_value_object::init_methods()
+    [[nodiscard]] static
+    typename basic_mutex::method_table init_methods();
+private:
+    //! Locks the mutex, waiting while it is locked by another thread.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     * \return \c null
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 1
+     * \throw exception::op_would_block if the mutex is already locked by the
+     * current thread */
+    typename basic_mutex::value_ptr
+    lock(typename threadscript::basic_state<A>& thread,
+         typename threadscript::basic_symbol_table<A>& l_vars,
+         const typename threadscript::basic_code_node<A>& node);
+    //! Calls a function with the mutex locked.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c fun the name of the called function, of type \c string
+     *     \arg \c args (0 or more) arguments passed to the function
+     * \return the result of the function
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is less than 2
+     * \throw exception::value_null if \a fun is \c null
+     * \throw exception::value_type if \a fun is not a \c string or if it is
+     * not a name of a function
+     * \throw exception::unknown_symbol if function \a fun does not exist
+     * \throw exception::op_would_block if the mutex is already locked by the
+     * current thread
+     * \throw any exception thrown by the function */
+    typename basic_mutex::value_ptr
+    run_locked(typename threadscript::basic_state<A>& thread,
+               typename threadscript::basic_symbol_table<A>& l_vars,
+               const typename threadscript::basic_code_node<A>& node);
+    //! Locks the mutex if it is not locked.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     * \return a \c bool value, \c true if the mutex has been locked, \c false
+     * if it has been already locked
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 1 */
+    typename basic_mutex::value_ptr
+    try_lock(typename threadscript::basic_state<A>& thread,
+             typename threadscript::basic_symbol_table<A>& l_vars,
+             const typename threadscript::basic_code_node<A>& node);
+    //! Unlocks the mutex.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     * \return \c null
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 1
+     * \throw exception::op_bad if the mutex is not locked by the current
+     * thread */
+    typename basic_mutex::value_ptr
+    unlock(typename threadscript::basic_state<A>& thread,
+           typename threadscript::basic_symbol_table<A>& l_vars,
+           const typename threadscript::basic_code_node<A>& node);
+    //! Locks the mutex for a thread.
+    /*! \param[in] thread the new owner
+     * \throw exception::op_would_block if the mutex is already locked by \a
+     * thread */
+    void acquire(basic_state<A>& thread);
+    //! Unlocks the mutex locked by acquire().
+    void release();
+    //! The mutex protecting \ref owner
+    std::mutex mtx;
+    //! Used to wait for unlocking
+    impl::green_cond cond;
+    //! The thread owning the mutex, \c nullptr if unlocked
+    basic_state<A>* owner = nullptr;
+};
+
+//! A counting semaphore class
+/*! It has semantics similar to \c std::counting_semaphore, with the maximum
+ * value of the counter set at runtime. Method acquire() decrements the
+ * counter, waiting while it is zero. Method release() increments the counter.
+ *
+ * Methods:
+ * \snippet sync_impl.hpp semaphore_methods
+ * \tparam A an allocator type
+ * \threadsafe{safe,safe}
+ * \test in file test_sync.cpp */
+template <impl::allocator A>
+class basic_semaphore final: public impl::basic_semaphore_base<A> {
+public:
+    //! The clock used for timeouts
+    using clock = impl::green_cond::clock;
+    //! Creates the semaphore object.
+    /*! It marks the object mt-safe.
+     * \param[in] t an ignored parameter that prevents using this
+     * \param[in] methods the mapping from method names to implementations
+     * \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with constructor arguments:
+     *     \arg \c count the initial value of the counter, of type \c int or
+     *     \c unsigned
+     *     \arg \c max (optional) the maximum value of the counter, of type \c
+     *     int or \c unsigned; unlimited if missing
+     * \throw exception::op_narg if the number of arguments is not 1 or 2
+     * \throw exception::value_null if \a count or \a max is \c null
+     * \throw exception::value_type if \a count or \a max is not \c int or \c
+     * unsigned
+     * \throw exception::value_out_of_range if \a count or \a max is negative,
+     * or if \a count is greater than \a max */
+    basic_semaphore(typename basic_semaphore::tag t,
+        std::shared_ptr<const typename basic_semaphore::method_table> methods,
+        typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node);
+    //! \copydoc basic_value_object::init_methods()
+    [[nodiscard]] static
+    typename basic_semaphore::method_table init_methods();
+private:
+    //! Decrements the counter, waiting while it is zero.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     * \return \c null
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 1 */
+    typename basic_semaphore::value_ptr
+    acquire(typename threadscript::basic_state<A>& thread,
+            typename threadscript::basic_symbol_table<A>& l_vars,
+            const typename threadscript::basic_code_node<A>& node);
+    //! Decrements the counter, waiting at most for a timeout.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c timeout the maximum waiting time in milliseconds, of type \c
+     *     int or \c unsigned
+     * \return a \c bool value, \c true if the counter has been decremented,
+     * \c false if the timeout expired
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 2
+     * \throw exception::value_null if \a timeout is \c null
+     * \throw exception::value_type if \a timeout is not \c int or \c unsigned
+     * \throw exception::value_out_of_range if \a timeout is negative */
+    typename basic_semaphore::value_ptr
+    acquire_for(typename threadscript::basic_state<A>& thread,
+                typename threadscript::basic_symbol_table<A>& l_vars,
+                const typename threadscript::basic_code_node<A>& node);
+    //! Increments the counter.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     *     \arg \c n (optional) the increment, of type \c int or \c unsigned;
+     *     1 if missing
+     * \return \c null
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 1 or 2
+     * \throw exception::value_null if \a n is \c null
+     * \throw exception::value_type if \a n is not \c int or \c unsigned
+     * \throw exception::value_out_of_range if \a n is negative or if the
+     * counter would exceed the maximum */
+    typename basic_semaphore::value_ptr
+    release(typename threadscript::basic_state<A>& thread,
+            typename threadscript::basic_symbol_table<A>& l_vars,
+            const typename threadscript::basic_code_node<A>& node);
+    //! Decrements the counter if it is not zero.
+    /*! \param[in] thread the current thread
+     * \param[in] l_vars the symbol table of the current stack frame
+     * \param[in] node the code node, with method call arguments:
+     *     \arg \c method_name
+     * \return a \c bool value, \c true if the counter has been decremented,
+     * \c false if it is zero
+     * \throw exception::op_narg if the number of arguments (incl. \c
+     * method_name) is not 1 */
+    typename basic_semaphore::value_ptr
+    try_acquire(typename threadscript::basic_state<A>& thread,
+                typename threadscript::basic_symbol_table<A>& l_vars,
+                const typename threadscript::basic_code_node<A>& node);
+    //! The mutex protecting \ref counter
+    std::mutex mtx;
+    //! Used to wait for a nonzero \ref counter
+    impl::green_cond cond;
+    //! The counter
+    size_t counter = 0;
+    //! The maximum value of \ref counter
+    size_t max = std::numeric_limits<size_t>::max();
+};
+
+} // namespace threadscript
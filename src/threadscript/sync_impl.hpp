@@ -0,0 +1,466 @@
+#pragma once
+
+/*! \file
+ * \brief The implementation part of sync.hpp
+ */
+
+#include "threadscript/sync.hpp"
+
+#include <chrono>
+
+namespace threadscript {
+
+/*** basic_barrier ***********************************************************/
+
+template <impl::allocator A>
+basic_barrier<A>::basic_barrier(
+        typename basic_barrier<A>::tag,
+        std::shared_ptr<const typename basic_barrier<A>::method_table>
+            methods,
+        typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node):
+    impl::basic_barrier_base<A>(typename basic_barrier::tag_args{}, methods,
+                                thread, l_vars, node),
+    fun_name(thread.get_allocator())
+{
+    size_t narg = this->narg(node);
+    if (narg != 1 && narg != 2)
+        throw exception::op_narg();
+    expected = this->arg_index(thread, l_vars, node, 0);
+    if (expected == 0)
+        throw exception::value_out_of_range();
+    if (narg == 2) {
+        auto a1 = this->arg(thread, l_vars, node, 1);
+        if (!a1)
+            throw exception::value_null();
+        auto name = dynamic_cast<basic_value_string<A>*>(a1.get());
+        if (!name)
+            throw exception::value_type();
+        auto f = l_vars.lookup(name->cvalue());
+        if (!f)
+            throw exception::unknown_symbol(name->cvalue());
+        fun = std::dynamic_pointer_cast<basic_value_function<A>>(*f);
+        if (!fun)
+            throw exception::value_type();
+        fun_name = name->cvalue();
+    }
+    this->set_mt_safe();
+}
+
+template <impl::allocator A>
+bool basic_barrier<A>::arrive(basic_state<A>& thread,
+                              std::unique_lock<std::mutex>& lck, bool drop)
+{
+    if (drop) {
+        if (expected == 0)
+            throw exception::value_out_of_range();
+        --expected;
+    } else
+        ++arrived;
+    if (arrived < expected || arrived == 0)
+        return false;
+    // All other threads of this phase are waiting, so no other thread can
+    // arrive while the completion function runs unlocked
+    std::exception_ptr exc;
+    if (fun) {
+        lck.unlock();
+        try {
+            fun->call(thread, fun_name);
+        } catch (...) {
+            exc = std::current_exception();
+        }
+        lck.lock();
+    }
+    arrived = 0;
+    ++phase;
+    cond.notify_all();
+    if (exc)
+        std::rethrow_exception(exc);
+    return true;
+}
+
+template <impl::allocator A> basic_barrier<A>::value_ptr
+basic_barrier<A>::arrive_and_drop(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>&,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 1)
+        throw exception::op_narg();
+    std::unique_lock lck{mtx};
+    arrive(thread, lck, true);
+    return nullptr;
+}
+
+template <impl::allocator A> basic_barrier<A>::value_ptr
+basic_barrier<A>::arrive_and_wait(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>&,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 1)
+        throw exception::op_narg();
+    std::unique_lock lck{mtx};
+    size_t current = phase;
+    if (!arrive(thread, lck, false))
+        cond.wait(lck, [&]() { return phase != current; });
+    return nullptr;
+}
+
+template <impl::allocator A> basic_barrier<A>::method_table
+basic_barrier<A>::init_methods()
+{
+    return {
+        //! [barrier_methods]
+        {"arrive_and_drop", &basic_barrier::arrive_and_drop},
+        {"arrive_and_wait", &basic_barrier::arrive_and_wait},
+        //! [barrier_methods]
+    };
+}
+
+/*** basic_latch *************************************************************/
+
+template <impl::allocator A>
+basic_latch<A>::basic_latch(
+        typename basic_latch<A>::tag,
+        std::shared_ptr<const typename basic_latch<A>::method_table>
+            methods,
+        typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node):
+    impl::basic_latch_base<A>(typename basic_latch::tag_args{}, methods,
+                              thread, l_vars, node)
+{
+    if (this->narg(node) != 1)
+        throw exception::op_narg();
+    counter = this->arg_index(thread, l_vars, node, 0);
+    this->set_mt_safe();
+}
+
+template <impl::allocator A> basic_latch<A>::value_ptr
+basic_latch<A>::arrive_and_wait(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    decrement(thread, l_vars, node);
+    std::unique_lock lck{mtx};
+    cond.wait(lck, [this]() { return counter == 0; });
+    return nullptr;
+}
+
+template <impl::allocator A> basic_latch<A>::value_ptr
+basic_latch<A>::count_down(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    decrement(thread, l_vars, node);
+    return nullptr;
+}
+
+template <impl::allocator A>
+void basic_latch<A>::decrement(typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    size_t narg = this->narg(node);
+    if (narg != 1 && narg != 2)
+        throw exception::op_narg();
+    size_t n = narg == 2 ? this->arg_index(thread, l_vars, node, 1) : 1;
+    {
+        std::lock_guard lck{mtx};
+        if (n > counter)
+            throw exception::value_out_of_range();
+        counter -= n;
+        if (counter > 0 || n == 0)
+            return;
+    }
+    cond.notify_all();
+}
+
+template <impl::allocator A> basic_latch<A>::method_table
+basic_latch<A>::init_methods()
+{
+    return {
+        //! [latch_methods]
+        {"arrive_and_wait", &basic_latch::arrive_and_wait},
+        {"count_down", &basic_latch::count_down},
+        {"try_wait", &basic_latch::try_wait},
+        {"wait", &basic_latch::wait},
+        //! [latch_methods]
+    };
+}
+
+template <impl::allocator A> basic_latch<A>::value_ptr
+basic_latch<A>::try_wait(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>&,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 1)
+        throw exception::op_narg();
+    auto result = basic_value_bool<A>::create(thread.get_allocator());
+    std::lock_guard lck{mtx};
+    result->value() = counter == 0;
+    return result;
+}
+
+template <impl::allocator A> basic_latch<A>::value_ptr
+basic_latch<A>::wait(
+    typename threadscript::basic_state<A>&,
+    typename threadscript::basic_symbol_table<A>&,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 1)
+        throw exception::op_narg();
+    std::unique_lock lck{mtx};
+    cond.wait(lck, [this]() { return counter == 0; });
+    return nullptr;
+}
+
+/*** basic_mutex *************************************************************/
+
+template <impl::allocator A>
+basic_mutex<A>::basic_mutex(
+        typename basic_mutex<A>::tag,
+        std::shared_ptr<const typename basic_mutex<A>::method_table>
+            methods,
+        typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node):
+    impl::basic_mutex_base<A>(typename basic_mutex::tag_args{}, methods,
+                              thread, l_vars, node)
+{
+    if (this->narg(node) != 0)
+        throw exception::op_narg();
+    this->set_mt_safe();
+}
+
+template <impl::allocator A> basic_mutex<A>::method_table
+basic_mutex<A>::init_methods()
+{
+    return {
+        //! [mutex_methods]
+        {"lock", &basic_mutex::lock},
+        {"run_locked", &basic_mutex::run_locked},
+        {"try_lock", &basic_mutex::try_lock},
+        {"unlock", &basic_mutex::unlock},
+        //! [mutex_methods]
+    };
+}
+
+template <impl::allocator A> void basic_mutex<A>::acquire(basic_state<A>& thread)
+{
+    std::unique_lock lck{mtx};
+    if (owner == &thread)
+        throw exception::op_would_block();
+    cond.wait(lck, [this]() { return !owner; });
+    owner = &thread;
+}
+
+template <impl::allocator A> basic_mutex<A>::value_ptr
+basic_mutex<A>::lock(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>&,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 1)
+        throw exception::op_narg();
+    acquire(thread);
+    return nullptr;
+}
+
+template <impl::allocator A> basic_mutex<A>::value_ptr
+basic_mutex<A>::run_locked(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    size_t narg = this->narg(node);
+    if (narg < 2)
+        throw exception::op_narg();
+    auto a1 = this->arg(thread, l_vars, node, 1);
+    if (!a1)
+        throw exception::value_null();
+    auto name = dynamic_cast<basic_value_string<A>*>(a1.get());
+    if (!name)
+        throw exception::value_type();
+    auto f = l_vars.lookup(name->cvalue());
+    if (!f)
+        throw exception::unknown_symbol(name->cvalue());
+    auto fun = std::dynamic_pointer_cast<basic_value_function<A>>(*f);
+    if (!fun)
+        throw exception::value_type();
+    auto args = basic_value_vector<A>::create(thread.get_allocator());
+    args->value().reserve(narg - 2);
+    for (size_t i = 2; i < narg; ++i)
+        args->value().push_back(this->arg(thread, l_vars, node, i));
+    acquire(thread);
+    try {
+        auto result = fun->call(thread, name->cvalue(), std::move(args));
+        release();
+        return result;
+    } catch (...) {
+        release();
+        throw;
+    }
+}
+
+template <impl::allocator A> basic_mutex<A>::value_ptr
+basic_mutex<A>::try_lock(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>&,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 1)
+        throw exception::op_narg();
+    auto result = basic_value_bool<A>::create(thread.get_allocator());
+    std::lock_guard lck{mtx};
+    if (!owner) {
+        owner = &thread;
+        result->value() = true;
+    } else
+        result->value() = false;
+    return result;
+}
+
+template <impl::allocator A> void basic_mutex<A>::release()
+{
+    {
+        std::lock_guard lck{mtx};
+        owner = nullptr;
+    }
+    cond.notify_one();
+}
+
+template <impl::allocator A> basic_mutex<A>::value_ptr
+basic_mutex<A>::unlock(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>&,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 1)
+        throw exception::op_narg();
+    {
+        std::lock_guard lck{mtx};
+        if (owner != &thread)
+            throw exception::op_bad();
+    }
+    release();
+    return nullptr;
+}
+
+/*** basic_semaphore *********************************************************/
+
+template <impl::allocator A>
+basic_semaphore<A>::basic_semaphore(
+        typename basic_semaphore<A>::tag,
+        std::shared_ptr<const typename basic_semaphore<A>::method_table>
+            methods,
+        typename threadscript::basic_state<A>& thread,
+        typename threadscript::basic_symbol_table<A>& l_vars,
+        const typename threadscript::basic_code_node<A>& node):
+    impl::basic_semaphore_base<A>(typename basic_semaphore::tag_args{},
+                                  methods, thread, l_vars, node)
+{
+    size_t narg = this->narg(node);
+    if (narg != 1 && narg != 2)
+        throw exception::op_narg();
+    counter = this->arg_index(thread, l_vars, node, 0);
+    if (narg == 2)
+        max = this->arg_index(thread, l_vars, node, 1);
+    if (counter > max)
+        throw exception::value_out_of_range();
+    this->set_mt_safe();
+}
+
+template <impl::allocator A> basic_semaphore<A>::value_ptr
+basic_semaphore<A>::acquire(
+    typename threadscript::basic_state<A>&,
+    typename threadscript::basic_symbol_table<A>&,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 1)
+        throw exception::op_narg();
+    std::unique_lock lck{mtx};
+    cond.wait(lck, [this]() { return counter > 0; });
+    --counter;
+    return nullptr;
+}
+
+template <impl::allocator A> basic_semaphore<A>::value_ptr
+basic_semaphore<A>::acquire_for(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 2)
+        throw exception::op_narg();
+    auto deadline =
+        impl::deadline_after(this->arg_index(thread, l_vars, node, 1));
+    auto result = basic_value_bool<A>::create(thread.get_allocator());
+    std::unique_lock lck{mtx};
+    result->value() =
+        cond.wait_until(lck, deadline, [this]() { return counter > 0; });
+    if (result->value())
+        --counter;
+    return result;
+}
+
+template <impl::allocator A> basic_semaphore<A>::method_table
+basic_semaphore<A>::init_methods()
+{
+    return {
+        //! [semaphore_methods]
+        {"acquire", &basic_semaphore::acquire},
+        {"acquire_for", &basic_semaphore::acquire_for},
+        {"release", &basic_semaphore::release},
+        {"try_acquire", &basic_semaphore::try_acquire},
+        //! [semaphore_methods]
+    };
+}
+
+template <impl::allocator A> basic_semaphore<A>::value_ptr
+basic_semaphore<A>::release(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>& l_vars,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    size_t narg = this->narg(node);
+    if (narg != 1 && narg != 2)
+        throw exception::op_narg();
+    size_t n = narg == 2 ? this->arg_index(thread, l_vars, node, 1) : 1;
+    {
+        std::lock_guard lck{mtx};
+        if (n > max - counter)
+            throw exception::value_out_of_range();
+        counter += n;
+    }
+    if (n == 1)
+        cond.notify_one();
+    else if (n > 1)
+        cond.notify_all();
+    return nullptr;
+}
+
+template <impl::allocator A> basic_semaphore<A>::value_ptr
+basic_semaphore<A>::try_acquire(
+    typename threadscript::basic_state<A>& thread,
+    typename threadscript::basic_symbol_table<A>&,
+    const typename threadscript::basic_code_node<A>& node)
+{
+    if (this->narg(node) != 1)
+        throw exception::op_narg();
+    auto result = basic_value_bool<A>::create(thread.get_allocator());
+    std::lock_guard lck{mtx};
+    if (counter > 0) {
+        --counter;
+        result->value() = true;
+    } else
+        result->value() = false;
+    return result;
+}
+
+} // namespace threadscript
@@ -65,10 +65,11 @@ public:
     void parse(script_builder& builder, std::string_view src,
                std::string_view file = {}, parser::context::trace_t trace = {});
     //! Parses a script from an input stream
-    /*! It reads the \a src stream and passes it to parse(). The \a file is not
-     * accessed during parsing. It is expected that its content is provided in
-     * \a src. The file name is only stored in \a builder for later reporting
-     * of code locations, or it is recorded in a thrown exception.
+    /*! It reads the \a src stream by source_file::read() and passes it to
+     * parse(). The \a file is not accessed during parsing. It is expected
+     * that its content is provided in \a src. The file name is only stored in
+     * \a builder for later reporting of code locations, or it is recorded in
+     * a thrown exception.
      * \param[in,out] builder a builder object used to create the internal
      * representation of the parsed script
      * \param[in] is the source code to be parsed
@@ -81,7 +82,8 @@ public:
                       std::string_view file = {},
                       parser::context::trace_t trace = {});
     //! Parses a script file
-    /*! It opens the \a file and passes it to parse_stream().
+    /*! It opens the \a file as a source_file, which maps a regular file into
+     * memory instead of copying it, and passes its content to parse().
      * \param[in,out] builder a builder object used to create the internal
      * representation of the parsed script
      * \param[in] file the file name
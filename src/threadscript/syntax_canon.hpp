@@ -13,11 +13,19 @@
 namespace threadscript::syntax {
 
 //! The parser for ThreadScript canonical syntax
-/*! \test in file test_syntax_canon.cpp */
+/*! The grammar is defined by parser rules built from
+ * parser_ascii::rules::factory. Because these rules are relatively slow,
+ * a valid input is normally parsed by an equivalent hand-written recursive
+ * descent parser. The rules are used only if tracing is requested or if the
+ * input contains a syntax error, so that tracing output and error messages do
+ * not depend on the parser used.
+ * \test in file test_syntax_canon.cpp */
 class canon final: public syntax_base {
 public:
-    //! Creates implementation of rules.
-    canon();
+    //! Creates the parser.
+    /*! \param[in] fast whether to use the hand-written parser; if \c false,
+     * the parser rules are always used */
+    explicit canon(bool fast = true);
     //! Destroys the implementation of rules.
     /*! \note It is explicitly defaulted in syntax_canon.cpp, because it needs
      * complete type \ref rules in order to be able to generate the destructor
@@ -28,7 +36,15 @@ protected:
                     parser::context::trace_t trace) override;
 private:
     struct rules;
-    std::unique_ptr<rules> _rules; //!< PImpl (rules)
+    class fast_parser;
+    //! Parses using the parser rules.
+    /*! \copydetails run_parser() */
+    void run_rules(script_builder& builder, std::string_view src,
+                   parser::context::trace_t trace);
+    //! PImpl (rules), created when first needed
+    std::unique_ptr<rules> _rules;
+    //! Whether to use the hand-written parser
+    bool fast;
 };
 
 } // namespace threadscript::syntax
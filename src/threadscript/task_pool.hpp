@@ -0,0 +1,248 @@
+#pragma once
+
+/*! \file
+ * \brief A pool of threads executing tasks of a virtual machine
+ */
+
+#include "threadscript/green.hpp"
+#include "threadscript/virtual_machine.hpp"
+
+#include <concepts>
+#include <condition_variable>
+#include <thread>
+
+namespace threadscript {
+
+//! A work-stealing pool of threads executing tasks
+/*! There is at most one task pool in a basic_virtual_machine. It is created
+ * on demand by get(), and it is destroyed by the destructor of the VM. Each
+ * thread of the pool has its own basic_state and its own queue of tasks. A
+ * task submitted by a pool thread is added to the back of the queue of that
+ * thread, other tasks are distributed to queues in round-robin fashion. A
+ * pool thread takes tasks from the back of its own queue (which tends to keep
+ * the data of recently spawned tasks in the cache). If its queue is empty, it
+ * steals a task from the front of a queue of another thread. An idle pool
+ * thread blocks on a condition variable.
+ *
+ * A task can run in its own green thread (impl::green_thread), with its own
+ * basic_state. A green thread stays in the pool thread that started it. If
+ * it waits using impl::green_cond, e.g., in a blocking channel operation, it
+ * is suspended and the pool thread executes other tasks and green threads in
+ * the meantime. Hence a small number of pool threads can run a large number
+ * of green threads that spend most of the time waiting.
+ *
+ * A task not running in a green thread is executed with the basic_state of
+ * the pool thread, which is reset by basic_state::reset() after each task, so
+ * that global variables of a task are not visible to later tasks.
+ *
+ * A task not running in a green thread and waiting for a result of another
+ * task should call run_one() repeatedly instead of blocking, so that the pool
+ * cannot deadlock if all its threads wait.
+ *
+ * The destructor executes all remaining tasks before stopping the threads.
+ * \tparam A an allocator type
+ * \threadsafe{safe,safe}
+ * \test in file test_future.cpp */
+template <impl::allocator A>
+class basic_task_pool final: public impl::task_pool_base {
+public:
+    //! A task executed by the pool
+    class task {
+    public:
+        //! Default constructor
+        task() = default;
+        //! No copying
+        task(const task&) = delete;
+        //! No moving
+        task(task&&) = delete;
+        //! Virtual destructor, because tasks are deleted via this class
+        virtual ~task() = default;
+        //! No copying
+        task& operator=(const task&) = delete;
+        //! No moving
+        task& operator=(task&&) = delete;
+        //! Executes the task.
+        /*! \param[in] thread the state of the pool thread or of the green
+         * thread executing the task */
+        virtual void run(basic_state<A>& thread) noexcept = 0;
+        //! Checks if the task should run in its own green thread.
+        /*! \return \c false in this default implementation */
+        [[nodiscard]] virtual bool green() const noexcept { return false; }
+    };
+    //! A shared pointer to a task
+    using task_ptr = std::shared_ptr<task>;
+    //! Creates the pool and starts its threads.
+    /*! \param[in] vm the virtual machine used by pool threads
+     * \param[in] threads the number of threads; must be positive */
+    basic_task_pool(basic_virtual_machine<A>& vm, size_t threads);
+    //! No copying
+    basic_task_pool(const basic_task_pool&) = delete;
+    //! No moving
+    basic_task_pool(basic_task_pool&&) = delete;
+    //! Executes all remaining tasks and stops the pool threads.
+    ~basic_task_pool() override;
+    //! No copying
+    basic_task_pool& operator=(const basic_task_pool&) = delete;
+    //! No moving
+    basic_task_pool& operator=(basic_task_pool&&) = delete;
+    //! Gets the task pool of a virtual machine.
+    /*! The pool is created by the first call for \a vm, with the number of
+     * threads set by basic_virtual_machine::task_pool_threads.
+     * \param[in] vm a virtual machine
+     * \return the task pool of \a vm */
+    static basic_task_pool& get(basic_virtual_machine<A>& vm);
+    //! Gets the number of pool threads.
+    /*! \return the number of threads */
+    [[nodiscard]] size_t size() const noexcept {
+        return workers.size();
+    }
+    //! Adds a task to the pool.
+    /*! \param[in] t the task */
+    void submit(task_ptr t);
+    //! Executes a single pending task in the current thread.
+    /*! It does nothing if called by a thread that does not belong to this
+     * pool. The task is executed with a new basic_state, because the state of
+     * the pool thread is used by the task calling this function.
+     * \return \c true if a task has been executed, \c false if there is no
+     * task pending or the current thread does not belong to this pool */
+    bool run_one();
+    //! Executes a function for all indices of a range in parallel.
+    /*! The range <tt>[0, n)</tt> is split into chunks of consecutive indices
+     * automatically. Chunks are processed by pool threads and by the calling
+     * thread, which takes chunks until none is left and then waits until the
+     * chunks taken by pool threads are finished. Therefore, it cannot
+     * deadlock if called from a task. A pool thread uses basic_state::max_stack
+     * of \a thread while processing a chunk. If \a f throws an exception, no
+     * more chunks are started and the first exception is rethrown after all
+     * started chunks finish.
+     * \tparam F the type of the function
+     * \param[in] thread the state of the current thread
+     * \param[in] n the number of indices
+     * \param[in] f the function, called as <tt>f(state, begin, end)</tt> for
+     * each chunk <tt>[begin, end)</tt>, where \c state is the state of the
+     * thread processing the chunk */
+    template <std::invocable<basic_state<A>&, size_t, size_t> F>
+    void parallel_for(basic_state<A>& thread, size_t n, F&& f);
+    //! Checks if the current thread belongs to this pool.
+    /*! \return whether the current thread is a pool thread */
+    [[nodiscard]] bool in_pool() const noexcept {
+        return current_pool == this;
+    }
+private:
+    //! The clock used for timeouts of green threads
+    using clock = impl::green_thread::clock;
+    //! A shared pointer to a green thread
+    using green_ptr = std::shared_ptr<impl::green_thread>;
+    //! A green thread executing a task
+    class green_task final: public impl::green_thread {
+    public:
+        //! Creates the green thread and its basic_state.
+        /*! \param[in] pool the task pool
+         * \param[in] idx the index of the pool thread executing this green
+         * thread
+         * \param[in] t the task */
+        green_task(basic_task_pool& pool, size_t idx, task_ptr t);
+    protected:
+        //! Runs the task.
+        void body() noexcept override;
+        //! Adds this green thread to the ready queue of its pool thread.
+        /*! \param[in] self a shared pointer to this object */
+        void schedule(std::shared_ptr<green_thread> self) override;
+    private:
+        basic_task_pool& pool; //!< The task pool
+        size_t idx; //!< The index of the pool thread in \ref workers
+        task_ptr t; //!< The task, released after it finishes
+        basic_state<A> thread; //!< The state of this green thread
+    };
+    //! A timeout of a parked green thread
+    /*! It does not keep the green thread alive. It is stale if the green
+     * thread has finished or it has been suspended again since adding the
+     * timer. */
+    struct timer {
+        clock::time_point deadline; //!< The time of the timeout
+        std::weak_ptr<impl::green_thread> g; //!< The green thread to be woken
+        //! The value of impl::green_thread::suspends() when adding the timer
+        uint64_t suspends;
+    };
+    //! Data of a single pool thread
+    struct worker {
+        //! Creates the data of a worker thread.
+        /*! \param[in] alloc an allocator */
+        explicit worker(const A& alloc):
+            tasks(alloc), ready(alloc), timers(alloc) {}
+        //! The mutex protecting \ref tasks and \ref ready
+        std::mutex mtx;
+        //! The queue of tasks
+        a_basic_deque<task_ptr, A> tasks;
+        //! Green threads of this thread that can be resumed
+        a_basic_deque<green_ptr, A> ready;
+        //! The number of elements in \ref ready
+        std::atomic<size_t> n_ready = 0;
+        //! The number of unfinished green threads of this thread
+        /*! It is used only by this thread. */
+        size_t n_green = 0;
+        //! Timeouts of parked green threads, a heap ordered by deadlines
+        /*! It is used only by this thread. Stale timers are removed by
+         * purge_timers() when they are the majority. */
+        a_basic_vector<timer, A> timers;
+        //! The thread
+        std::thread thr;
+    };
+    //! The target number of chunks per thread created by parallel_for()
+    /*! Using more chunks than threads balances the load if processing of
+     * some chunks takes longer than of others. */
+    static constexpr size_t chunks_per_thread = 4;
+    //! Executes all remaining tasks and stops the pool threads.
+    /*! It is used by the destructor and if the constructor fails. */
+    void shutdown() noexcept;
+    //! The function running in each pool thread
+    /*! \param[in] idx the index of the thread in \ref workers */
+    void thread_main(size_t idx);
+    //! Adds a green thread to the ready queue of a pool thread.
+    /*! \param[in] idx the index of a pool thread in \ref workers
+     * \param[in] g the green thread */
+    void make_ready(size_t idx, green_ptr g);
+    //! Resumes a green thread of the current pool thread.
+    /*! \param[in] w the current pool thread
+     * \param[in] g the green thread */
+    void run_green(worker& w, green_ptr g);
+    //! Wakes green threads with expired timeouts.
+    /*! \param[in] w the current pool thread */
+    void expire_timers(worker& w);
+    //! Removes stale timers.
+    /*! \param[in] w the current pool thread */
+    void purge_timers(worker& w);
+    //! Gets the green thread of a timer that is not stale.
+    /*! \param[in] t a timer
+     * \return the green thread; \c nullptr if \a t is stale */
+    static green_ptr timer_thread(const timer& t);
+    //! Gets a green thread of the current pool thread that can be resumed.
+    /*! \param[in] w the current pool thread
+     * \return a green thread; \c nullptr if there is none */
+    green_ptr take_ready(worker& w);
+    //! Gets a pending task.
+    /*! \param[in] idx the index of the current thread in \ref workers
+     * \return a task taken from the back of the own queue or stolen from the
+     * front of another queue; \c nullptr if all queues are empty */
+    task_ptr take(size_t idx);
+    //! The virtual machine
+    basic_virtual_machine<A>& vm;
+    //! Pool threads
+    a_basic_deque<worker, A> workers;
+    //! The number of tasks in all queues
+    std::atomic<size_t> pending = 0;
+    //! The index of the queue used by the next submit() from outside the pool
+    std::atomic<size_t> next = 0;
+    //! The mutex used by idle threads
+    std::mutex mtx;
+    //! Used by idle threads to wait for a task
+    std::condition_variable cond;
+    //! Signals pool threads to terminate, protected by \ref mtx
+    bool stop = false;
+    //! The pool of the current thread (\c nullptr outside pool threads)
+    static inline thread_local basic_task_pool* current_pool = nullptr;
+    //! The index of the current thread in \ref workers of \ref current_pool
+    static inline thread_local size_t current_idx = 0;
+};
+
+} // namespace threadscript
@@ -0,0 +1,351 @@
+#pragma once
+
+/*! \file
+ * \brief The implementation part of task_pool.hpp
+ */
+
+#include "threadscript/task_pool.hpp"
+
+#include <algorithm>
+
+namespace threadscript {
+
+template <impl::allocator A>
+basic_task_pool<A>::basic_task_pool(basic_virtual_machine<A>& vm,
+                                    size_t threads):
+    vm(vm), workers(vm.get_allocator())
+{
+    assert(threads > 0);
+    for (size_t i = 0; i < threads; ++i)
+        workers.emplace_back(vm.get_allocator());
+    try {
+        for (size_t i = 0; i < threads; ++i)
+            workers[i].thr = std::thread([this, i]() { thread_main(i); });
+    } catch (...) {
+        shutdown();
+        throw;
+    }
+}
+
+template <impl::allocator A> basic_task_pool<A>::~basic_task_pool()
+{
+    shutdown();
+}
+
+template <impl::allocator A>
+basic_task_pool<A>& basic_task_pool<A>::get(basic_virtual_machine<A>& vm)
+{
+    std::lock_guard lck{vm.task_pool_mtx};
+    if (!vm.task_pool) {
+        size_t threads = vm.task_pool_threads;
+        if (threads == 0)
+            threads = std::max(std::thread::hardware_concurrency(), 1U);
+        vm.task_pool = std::make_unique<basic_task_pool>(vm, threads);
+    }
+    return static_cast<basic_task_pool&>(*vm.task_pool);
+}
+
+template <impl::allocator A>
+template <std::invocable<basic_state<A>&, size_t, size_t> F>
+void basic_task_pool<A>::parallel_for(basic_state<A>& thread, size_t n, F&& f)
+{
+    if (n == 0)
+        return;
+    // A task shared by all threads processing the chunks
+    class job final: public task {
+    public:
+        job(F& f, size_t n, size_t chunk, size_t max_stack):
+            f(f), n(n), chunk(chunk), chunks((n + chunk - 1) / chunk),
+            max_stack(max_stack), remaining(chunks)
+        {}
+        void run(basic_state<A>& thread) noexcept override {
+            size_t saved = thread.max_stack;
+            thread.max_stack = max_stack;
+            work(thread);
+            thread.max_stack = saved;
+        }
+        // Processes chunks until all are taken
+        void work(basic_state<A>& thread) noexcept {
+            for (size_t c = next++; c < chunks; c = next++) {
+                if (!failed.load(std::memory_order_relaxed))
+                    try {
+                        f(thread, c * chunk, std::min((c + 1) * chunk, n));
+                    } catch (...) {
+                        std::lock_guard lck{mtx};
+                        if (!exc)
+                            exc = std::current_exception();
+                        failed = true;
+                    }
+                if (--remaining == 0) {
+                    {
+                        std::lock_guard lck{mtx};
+                    }
+                    cond.notify_all();
+                }
+            }
+        }
+        // Waits until all chunks are finished
+        void wait() {
+            std::unique_lock lck{mtx};
+            cond.wait(lck, [this]() { return remaining == 0; });
+            if (exc)
+                std::rethrow_exception(exc);
+        }
+    private:
+        F& f;
+        const size_t n;
+        const size_t chunk;
+        const size_t chunks;
+        const size_t max_stack;
+        std::atomic<size_t> next = 0;
+        std::atomic<size_t> remaining;
+        std::atomic<bool> failed = false;
+        std::mutex mtx;
+        impl::green_cond cond;
+        std::exception_ptr exc;
+    };
+    size_t chunk = std::max(n / (chunks_per_thread * (size() + 1)), size_t{1});
+    auto j = std::allocate_shared<job>(vm.get_allocator(), f, n, chunk,
+                                       thread.max_stack);
+    // The calling thread processes chunks, too, hence it does not need help
+    // if there is only a single chunk. If submitting fails, all chunks not
+    // taken by pool threads are processed by the calling thread.
+    try {
+        size_t helpers = std::min((n + chunk - 1) / chunk, size() + 1);
+        for (size_t i = 1; i < helpers; ++i)
+            submit(j);
+    } catch (...) {
+    }
+    j->work(thread);
+    j->wait();
+}
+
+template <impl::allocator A> bool basic_task_pool<A>::run_one()
+{
+    if (!in_pool())
+        return false;
+    if (auto t = take(current_idx)) {
+        basic_state<A> thread{vm};
+        t->run(thread);
+        return true;
+    }
+    return false;
+}
+
+template <impl::allocator A> void basic_task_pool<A>::expire_timers(worker& w)
+{
+    auto now = clock::now();
+    while (!w.timers.empty() && w.timers.front().deadline <= now) {
+        std::ranges::pop_heap(w.timers, std::ranges::greater{},
+                              &timer::deadline);
+        auto g = timer_thread(w.timers.back());
+        w.timers.pop_back();
+        // The green thread may have been woken, but not resumed yet, then
+        // this is a spurious wake up
+        if (g)
+            g->wake();
+    }
+}
+
+template <impl::allocator A> void basic_task_pool<A>::purge_timers(worker& w)
+{
+    std::erase_if(w.timers, [](auto&& t) { return !timer_thread(t); });
+    std::ranges::make_heap(w.timers, std::ranges::greater{}, &timer::deadline);
+}
+
+template <impl::allocator A>
+auto basic_task_pool<A>::timer_thread(const timer& t) -> green_ptr
+{
+    if (auto g = t.g.lock(); g && g->suspends() == t.suspends)
+        return g;
+    return nullptr;
+}
+
+template <impl::allocator A>
+void basic_task_pool<A>::make_ready(size_t idx, green_ptr g)
+{
+    {
+        std::lock_guard lck{workers[idx].mtx};
+        workers[idx].ready.push_back(std::move(g));
+        ++workers[idx].n_ready;
+    }
+    // Locking prevents notifying between checking the wait condition and
+    // blocking in thread_main(). All threads are notified, because only the
+    // one owning the green thread can resume it.
+    {
+        std::lock_guard lck{mtx};
+    }
+    cond.notify_all();
+}
+
+template <impl::allocator A>
+void basic_task_pool<A>::run_green(worker& w, green_ptr g)
+{
+    if (g->resume()) {
+        --w.n_green;
+        return;
+    }
+    if (!g->park(g)) {
+        std::lock_guard lck{w.mtx};
+        w.ready.push_back(std::move(g));
+        ++w.n_ready;
+        return;
+    }
+    // A saturated deadline means waiting without a timeout
+    if (auto& deadline = g->deadline();
+        deadline && *deadline != clock::time_point::max())
+    {
+        // Each green thread has at most one timer that is not stale, hence
+        // purging keeps the heap size proportional to the number of green
+        // threads in spite of repeated timed waits
+        if (w.timers.size() >= 2 * w.n_green)
+            purge_timers(w);
+        w.timers.push_back({*deadline, g, g->suspends()});
+        std::ranges::push_heap(w.timers, std::ranges::greater{},
+                               &timer::deadline);
+    }
+}
+
+template <impl::allocator A> void basic_task_pool<A>::shutdown() noexcept
+{
+    {
+        std::lock_guard lck{mtx};
+        stop = true;
+    }
+    cond.notify_all();
+    for (auto&& w: workers)
+        if (w.thr.joinable())
+            w.thr.join();
+}
+
+template <impl::allocator A> void basic_task_pool<A>::submit(task_ptr t)
+{
+    size_t idx = in_pool() ? current_idx : next++ % workers.size();
+    // Incrementing before pushing keeps pending >= the number of queued tasks
+    ++pending;
+    try {
+        std::lock_guard lck{workers[idx].mtx};
+        workers[idx].tasks.push_back(std::move(t));
+    } catch (...) {
+        --pending;
+        throw;
+    }
+    // Locking prevents notifying between checking the wait condition and
+    // blocking in thread_main()
+    {
+        std::lock_guard lck{mtx};
+    }
+    cond.notify_one();
+}
+
+template <impl::allocator A>
+auto basic_task_pool<A>::take(size_t idx) -> task_ptr
+{
+    if (pending == 0)
+        return nullptr;
+    task_ptr result;
+    {
+        std::lock_guard lck{workers[idx].mtx};
+        if (auto& q = workers[idx].tasks; !q.empty()) {
+            result = std::move(q.back());
+            q.pop_back();
+        }
+    }
+    for (size_t i = 1; !result && i < workers.size(); ++i) {
+        auto& w = workers[(idx + i) % workers.size()];
+        std::lock_guard lck{w.mtx};
+        if (!w.tasks.empty()) {
+            result = std::move(w.tasks.front());
+            w.tasks.pop_front();
+        }
+    }
+    if (result)
+        --pending;
+    return result;
+}
+
+template <impl::allocator A>
+auto basic_task_pool<A>::take_ready(worker& w) -> green_ptr
+{
+    if (w.n_ready == 0)
+        return nullptr;
+    std::lock_guard lck{w.mtx};
+    auto g = std::move(w.ready.front());
+    w.ready.pop_front();
+    --w.n_ready;
+    return g;
+}
+
+template <impl::allocator A> void basic_task_pool<A>::thread_main(size_t idx)
+{
+    basic_state<A> thread{vm};
+    current_pool = this;
+    current_idx = idx;
+    auto& w = workers[idx];
+    for (;;) {
+        expire_timers(w);
+        // Resuming started green threads first reduces the number of
+        // simultaneously existing green threads
+        if (auto g = take_ready(w)) {
+            run_green(w, std::move(g));
+            continue;
+        }
+        if (auto t = take(idx)) {
+            green_ptr g;
+            if (t->green())
+                try {
+                    g = std::allocate_shared<green_task>(vm.get_allocator(),
+                                                         *this, idx, t);
+                } catch (...) {
+                    // Run the task directly if a green thread is not available
+                }
+            if (g) {
+                ++w.n_green;
+                run_green(w, std::move(g));
+            } else {
+                // Each task sees the current shared variables of the VM
+                thread.update_sh_vars();
+                t->run(thread);
+                // Global variables of a task are not visible to later tasks
+                thread.reset();
+            }
+            continue;
+        }
+        std::unique_lock lck{mtx};
+        auto wakeup = [this, &w]() {
+            return (stop && w.n_green == 0) || pending > 0 || w.n_ready > 0;
+        };
+        if (w.timers.empty())
+            cond.wait(lck, wakeup);
+        else
+            cond.wait_until(lck, w.timers.front().deadline, wakeup);
+        if (stop && pending == 0 && w.n_green == 0)
+            break;
+    }
+    current_pool = nullptr;
+}
+
+/*** basic_task_pool::green_task *********************************************/
+
+template <impl::allocator A>
+basic_task_pool<A>::green_task::green_task(basic_task_pool& pool, size_t idx,
+                                           task_ptr t):
+    green_thread(pool.vm.task_stack_size), pool(pool), idx(idx),
+    t(std::move(t)), thread(pool.vm)
+{
+}
+
+template <impl::allocator A>
+void basic_task_pool<A>::green_task::body() noexcept
+{
+    t->run(thread);
+    t.reset();
+}
+
+template <impl::allocator A> void
+basic_task_pool<A>::green_task::schedule(std::shared_ptr<green_thread> self)
+{
+    pool.make_ready(idx, std::move(self));
+}
+
+} // namespace threadscript
@@ -7,14 +7,29 @@
  */
 
 #include "threadscript/configure.hpp"
+#include "threadscript/atomic.hpp"
+#include "threadscript/bytes.hpp"
 #include "threadscript/channel.hpp"
 #include "threadscript/code.hpp"
 #include "threadscript/code_builder_impl.hpp"
+#include "threadscript/code_cache.hpp"
 #include "threadscript/code_parser.hpp"
+#include "threadscript/future.hpp"
+#include "threadscript/host_view.hpp"
+#include "threadscript/module.hpp"
+#include "threadscript/native_binding.hpp"
+#include "threadscript/parse_files.hpp"
 #include "threadscript/predef.hpp"
+#include "threadscript/prepared_call.hpp"
+#include "threadscript/reload.hpp"
 #include "threadscript/shared_hash.hpp"
 #include "threadscript/shared_vector.hpp"
+#include "threadscript/source_file.hpp"
+#include "threadscript/state_pool.hpp"
+#include "threadscript/string_builder.hpp"
 #include "threadscript/symbol_table.hpp"
+#include "threadscript/sync.hpp"
+#include "threadscript/task_pool.hpp"
 #include "threadscript/virtual_machine.hpp"
 #include "threadscript/vm_data.hpp"
 
@@ -43,6 +58,22 @@ template <class T> using a_vector = a_basic_vector<T, allocator_any>;
 /*! \tparam T a type of deque elements */
 template <class T> using a_deque = a_basic_deque<T, allocator_any>;
 
+/*** threadscript/atomic.hpp *************************************************/
+
+//! The atomic integer using the configured allocator
+using atomic = basic_atomic<allocator_any>;
+extern template class basic_value_object<basic_atomic<allocator_any>,
+    threadscript::impl::name_atomic, allocator_any>;
+extern template class basic_atomic<allocator_any>;
+
+/*** threadscript/bytes.hpp **************************************************/
+
+//! The byte buffer using the configured allocator
+using bytes = basic_bytes<allocator_any>;
+extern template class basic_value_object<basic_bytes<allocator_any>,
+    threadscript::impl::name_bytes, allocator_any>;
+extern template class basic_bytes<allocator_any>;
+
 /*** threadscript/channel.hpp ************************************************/
 
 //! The channel using the configured allocator
@@ -91,6 +122,34 @@ extern template class basic_value_script<allocator_any>;
 using script_builder_impl = basic_script_builder_impl<allocator_any>;
 extern template class basic_script_builder_impl<allocator_any>;
 
+/*** threadscript/code_cache.hpp *********************************************/
+
+extern template class impl::script_writer<allocator_any>;
+
+//! Rebuilds a script from the binary form, using the configured allocator
+/*! Documentation of the primary template function applies, except that \a A is
+ * fixed to allocator_any:
+ *
+ * \copydetails deserialize_script(const A&, std::string_view,
+ * code_cache::key_t, std::string_view) */
+extern template script::script_ptr
+deserialize_script<allocator_any>(const allocator_any& alloc,
+                                  std::string_view data, code_cache::key_t key,
+                                  std::string_view file);
+
+//! The cached script parser using the configured allocator
+/*! Documentation of the primary template function applies, except that \a A is
+ * fixed to allocator_any:
+ *
+ * \copydetails parse_code_file_cached(const A&, std::string_view,
+ * std::string_view, std::string_view, parser::context::trace_t) */
+extern template script::script_ptr
+parse_code_file_cached<allocator_any>(const allocator_any& alloc,
+                                      std::string_view file,
+                                      std::string_view cache_dir,
+                                      std::string_view syntax,
+                                      parser::context::trace_t trace);
+
 /*** threadscript/code_parser.hpp ********************************************/
 
 //! The script parser using the configured allocator
@@ -126,6 +185,56 @@ parse_code_file<allocator_any>(const allocator_any& alloc,
                                std::string_view file, std::string_view syntax,
                                parser::context::trace_t trace);
 
+/*** threadscript/future.hpp *************************************************/
+
+//! The future using the configured allocator
+using future = basic_future<allocator_any>;
+extern template class basic_value_object<basic_future<allocator_any>,
+    threadscript::impl::name_future, allocator_any>;
+extern template class basic_future<allocator_any>;
+
+/*** threadscript/host_view.hpp **********************************************/
+
+//! The view of a host container using the configured allocator
+using host_view = basic_host_view<allocator_any>;
+extern template class basic_value_object<basic_host_view<allocator_any>,
+    threadscript::impl::name_host_view, allocator_any>;
+extern template class basic_host_view<allocator_any>;
+
+/*** threadscript/module.hpp *************************************************/
+
+//! The module registry using the configured allocator
+using module_registry = basic_module_registry<allocator_any>;
+extern template class basic_module_registry<allocator_any>;
+
+/*** threadscript/native_binding.hpp *****************************************/
+
+//! The lazy argument of a native binding using the configured allocator
+using lazy_arg = basic_lazy_arg<allocator_any>;
+extern template class basic_lazy_arg<allocator_any>;
+
+//! The native binding of a C++ callable using the configured allocator
+/*! \tparam F a callable type */
+template <class F>
+using native_binding = basic_native_binding<allocator_any, F>;
+
+/*** threadscript/parse_files.hpp ********************************************/
+
+//! The result of parsing a file using the configured allocator
+using parsed_file = basic_parsed_file<allocator_any>;
+
+//! The parallel script parser using the configured allocator
+/*! Documentation of the primary template function applies, except that \a A is
+ * fixed to allocator_any:
+ *
+ * \copydetails parse_code_files(basic_virtual_machine<A>&,
+ * std::span<const std::string>, std::string_view, std::string_view) */
+extern template std::vector<parsed_file>
+parse_code_files<allocator_any>(basic_virtual_machine<allocator_any>& vm,
+                                std::span<const std::string> files,
+                                std::string_view syntax,
+                                std::string_view cache_dir);
+
 /*** threadscript/predef.hpp *************************************************/
 
 //! Creates a new symbol table containing predefined built-in symbols.
@@ -167,21 +276,28 @@ extern template class f_at<allocator_any>;
 extern template class f_bool<allocator_any>;
 extern template class f_clone<allocator_any>;
 extern template class f_contains<allocator_any>;
+extern template class f_count<allocator_any>;
 extern template class f_div<allocator_any>;
+extern template class f_dot<allocator_any>;
 extern template class f_eq<allocator_any>;
 extern template class f_erase<allocator_any>;
+extern template class f_find<allocator_any>;
 extern template class f_fun<allocator_any>;
 extern template class f_ge<allocator_any>;
 extern template class f_gt<allocator_any>;
 extern template class f_gvar<allocator_any>;
 extern template class f_hash<allocator_any>;
 extern template class f_if<allocator_any>;
+extern template class f_import<allocator_any>;
 extern template class f_int<allocator_any>;
+extern template class f_int_vector<allocator_any>;
 extern template class f_is_mt_safe<allocator_any>;
 extern template class f_is_null<allocator_any>;
 extern template class f_keys<allocator_any>;
 extern template class f_le<allocator_any>;
 extern template class f_lt<allocator_any>;
+extern template class f_max<allocator_any>;
+extern template class f_min<allocator_any>;
 extern template class f_mod<allocator_any>;
 extern template class f_mt_safe<allocator_any>;
 extern template class f_mul<allocator_any>;
@@ -189,22 +305,43 @@ extern template class f_ne<allocator_any>;
 extern template class f_not<allocator_any>;
 extern template class f_or<allocator_any>;
 extern template class f_or_r<allocator_any>;
+extern template class f_par_for<allocator_any>;
+extern template class f_par_map<allocator_any>;
+extern template class f_par_reduce<allocator_any>;
 extern template class f_print<allocator_any>;
 extern template class f_is_same<allocator_any>;
+extern template class f_select<allocator_any>;
 extern template class f_seq<allocator_any>;
 extern template class f_size<allocator_any>;
+extern template class f_spawn<allocator_any>;
 extern template class f_sub<allocator_any>;
 extern template class f_substr<allocator_any>;
+extern template class f_sum<allocator_any>;
 extern template class f_throw<allocator_any>;
 extern template class f_try<allocator_any>;
 extern template class f_type<allocator_any>;
 extern template class f_unsigned<allocator_any>;
+extern template class f_unsigned_vector<allocator_any>;
+extern template class f_update_sh_vars<allocator_any>;
 extern template class f_var<allocator_any>;
 extern template class f_vector<allocator_any>;
 extern template class f_while<allocator_any>;
 
 } // namespace predef
 
+/*** threadscript/prepared_call.hpp ******************************************/
+
+//! The prepared call of a script function using the configured allocator
+/*! \tparam Sig a function signature */
+template <class Sig>
+using prepared_call = basic_prepared_call<allocator_any, Sig>;
+
+/*** threadscript/reload.hpp *************************************************/
+
+//! The script reloader using the configured allocator
+using reloader = basic_reloader<allocator_any>;
+extern template class basic_reloader<allocator_any>;
+
 /*** threadscript/shared_hash.hpp ********************************************/
 
 //! The shared hash using the configured allocator
@@ -221,12 +358,58 @@ extern template class basic_value_object<basic_shared_vector<allocator_any>,
     threadscript::impl::name_shared_vector, allocator_any>;
 extern template class basic_shared_vector<allocator_any>;
 
+/*** threadscript/state_pool.hpp *********************************************/
+
+//! The state pool using the configured allocator
+using state_pool = basic_state_pool<allocator_any>;
+extern template class basic_state_pool<allocator_any>;
+
+/*** threadscript/string_builder.hpp *****************************************/
+
+//! The string builder using the configured allocator
+using string_builder = basic_string_builder<allocator_any>;
+extern template class basic_value_object<basic_string_builder<allocator_any>,
+    threadscript::impl::name_string_builder, allocator_any>;
+extern template class basic_string_builder<allocator_any>;
+
 /*** threadscript/symbol_table.hpp *******************************************/
 
 //! The symbol table using the configured allocator
 using symbol_table = basic_symbol_table<allocator_any>;
 extern template class basic_symbol_table<allocator_any>;
 
+/*** threadscript/sync.hpp ***************************************************/
+
+//! The barrier using the configured allocator
+using barrier = basic_barrier<allocator_any>;
+extern template class basic_value_object<basic_barrier<allocator_any>,
+    threadscript::impl::name_barrier, allocator_any>;
+extern template class basic_barrier<allocator_any>;
+
+//! The latch using the configured allocator
+using latch = basic_latch<allocator_any>;
+extern template class basic_value_object<basic_latch<allocator_any>,
+    threadscript::impl::name_latch, allocator_any>;
+extern template class basic_latch<allocator_any>;
+
+//! The mutex using the configured allocator
+using mutex = basic_mutex<allocator_any>;
+extern template class basic_value_object<basic_mutex<allocator_any>,
+    threadscript::impl::name_mutex, allocator_any>;
+extern template class basic_mutex<allocator_any>;
+
+//! The semaphore using the configured allocator
+using semaphore = basic_semaphore<allocator_any>;
+extern template class basic_value_object<basic_semaphore<allocator_any>,
+    threadscript::impl::name_semaphore, allocator_any>;
+extern template class basic_semaphore<allocator_any>;
+
+/*** threadscript/task_pool.hpp **********************************************/
+
+//! The task pool using the configured allocator
+using task_pool = basic_task_pool<allocator_any>;
+extern template class basic_task_pool<allocator_any>;
+
 /*** threadscript/virtual_machine.hpp ****************************************/
 
 //! The virtual machine class using the configured allocator
@@ -285,6 +468,20 @@ extern template class basic_typed_value<value_hash,
     threadscript::impl::name_value_hash, allocator_any>;
 extern template class basic_value_hash<allocator_any>;
 
+//! The \ref basic_value_int_vector using the configured allocator
+using value_int_vector = basic_value_int_vector<allocator_any>;
+extern template class basic_typed_value<value_int_vector,
+    a_basic_vector<config::value_int_type, allocator_any>,
+    threadscript::impl::name_value_int_vector, allocator_any>;
+extern template class basic_value_int_vector<allocator_any>;
+
+//! The \ref basic_value_unsigned_vector using the configured allocator
+using value_unsigned_vector = basic_value_unsigned_vector<allocator_any>;
+extern template class basic_typed_value<value_unsigned_vector,
+    a_basic_vector<config::value_unsigned_type, allocator_any>,
+    threadscript::impl::name_value_unsigned_vector, allocator_any>;
+extern template class basic_value_unsigned_vector<allocator_any>;
+
 //! The \ref basic_value_object using the configured allocator
 template <class Object, str_literal Name>
 using value_object = basic_value_object<Object, Name, allocator_any>;
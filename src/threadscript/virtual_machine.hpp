@@ -10,7 +10,11 @@
 
 #include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <utility>
 
 namespace threadscript {
 
@@ -18,7 +22,166 @@ template <impl::allocator A> class basic_code_node;
 template <impl::allocator A> class basic_script;
 template <impl::allocator A> class basic_value_function;
 
+template <impl::allocator A> class basic_module_registry;
 template <impl::allocator A> class basic_state;
+template <impl::allocator A> class basic_state_pool;
+template <impl::allocator A> class basic_task_pool;
+
+namespace impl {
+//! The base class of basic_module_registry
+/*! It allows basic_virtual_machine to own a module registry without depending
+ * on the definition of basic_module_registry. */
+class module_registry_base {
+public:
+    //! Default constructor
+    module_registry_base() = default;
+    //! No copying
+    module_registry_base(const module_registry_base&) = delete;
+    //! No moving
+    module_registry_base(module_registry_base&&) = delete;
+    //! Virtual destructor, because objects are deleted via the base class
+    virtual ~module_registry_base() = default;
+    //! No copying
+    module_registry_base& operator=(const module_registry_base&) = delete;
+    //! No moving
+    module_registry_base& operator=(module_registry_base&&) = delete;
+};
+
+//! The base class of basic_state_pool
+/*! It allows basic_virtual_machine to own a state pool without depending on
+ * the definition of basic_state_pool. */
+class state_pool_base {
+public:
+    //! Default constructor
+    state_pool_base() = default;
+    //! No copying
+    state_pool_base(const state_pool_base&) = delete;
+    //! No moving
+    state_pool_base(state_pool_base&&) = delete;
+    //! Virtual destructor, because objects are deleted via the base class
+    virtual ~state_pool_base() = default;
+    //! No copying
+    state_pool_base& operator=(const state_pool_base&) = delete;
+    //! No moving
+    state_pool_base& operator=(state_pool_base&&) = delete;
+};
+
+//! The base class of basic_task_pool
+/*! It allows basic_virtual_machine to own a task pool without depending on
+ * the definition of basic_task_pool. */
+class task_pool_base {
+public:
+    //! Default constructor
+    task_pool_base() = default;
+    //! No copying
+    task_pool_base(const task_pool_base&) = delete;
+    //! No moving
+    task_pool_base(task_pool_base&&) = delete;
+    //! Virtual destructor, because objects are deleted via the base class
+    virtual ~task_pool_base() = default;
+    //! No copying
+    task_pool_base& operator=(const task_pool_base&) = delete;
+    //! No moving
+    task_pool_base& operator=(task_pool_base&&) = delete;
+};
+
+//! A shared pointer published by a writer to many readers
+/*! It replaces \c std::atomic<std::shared_ptr<T>>, which is implemented with
+ * an internal lock by libstdc++, for values that are read often and replaced
+ * rarely. Each store() increments a generation number. A reader remembers the
+ * generation of the pointer it has loaded and checks by generation() or
+ * load_if_changed() whether a new pointer has been published. The check is
+ * a single atomic load, hence it is wait-free and it does not touch the
+ * reference count of the pointer. Only loading a new pointer locks the
+ * internal mutex.
+ * \tparam T the type of the pointed object
+ * \threadsafe{safe,safe} */
+template <class T> class published_ptr {
+public:
+    //! The type of the stored pointer
+    using ptr_t = std::shared_ptr<T>;
+    //! The type of the generation number
+    using generation_t = uint64_t;
+    //! Creates a \c nullptr with generation 0.
+    published_ptr() = default;
+    //! No copying
+    published_ptr(const published_ptr&) = delete;
+    //! No moving
+    published_ptr(published_ptr&&) = delete;
+    //! Default destructor
+    ~published_ptr() = default;
+    //! No copying
+    published_ptr& operator=(const published_ptr&) = delete;
+    //! No moving
+    published_ptr& operator=(published_ptr&&) = delete;
+    //! Publishes a new pointer.
+    /*! It is equivalent to store().
+     * \param[in] p the new pointer
+     * \return \c *this */
+    published_ptr& operator=(ptr_t p) {
+        store(std::move(p));
+        return *this;
+    }
+    //! Publishes a new pointer and increments the generation.
+    /*! The old pointer is released after unlocking the internal mutex, so
+     * that a possible destruction of the old object does not delay readers.
+     * \param[in] p the new pointer */
+    void store(ptr_t p) {
+        {
+            std::lock_guard lck{mtx};
+            ptr.swap(p);
+            _generation.store(_generation.load(std::memory_order_relaxed) + 1,
+                              std::memory_order_release);
+        }
+    }
+    //! Gets the current pointer.
+    /*! \return the current pointer */
+    [[nodiscard]] ptr_t load() const {
+        std::lock_guard lck{mtx};
+        return ptr;
+    }
+    //! Gets the current pointer and its generation.
+    /*! The previous value of \a p is released after unlocking the internal
+     * mutex, like in store().
+     * \param[out] p the current pointer
+     * \param[out] gen the generation of \a p */
+    void load(ptr_t& p, generation_t& gen) const {
+        ptr_t current;
+        {
+            std::lock_guard lck{mtx};
+            current = ptr;
+            gen = _generation.load(std::memory_order_relaxed);
+        }
+        p.swap(current);
+    }
+    //! Gets the current pointer if it differs from a loaded generation.
+    /*! \param[in,out] p the loaded pointer, replaced by the current pointer
+     * if \a gen is not the current generation
+     * \param[in,out] gen the generation of \a p, replaced by the current
+     * generation
+     * \return whether \a p and \a gen have been replaced */
+    bool load_if_changed(ptr_t& p, generation_t& gen) const {
+        if (generation() == gen)
+            return false;
+        load(p, gen);
+        return true;
+    }
+    //! Gets the current generation.
+    /*! It is wait-free.
+     * \return the generation number incremented by each store() */
+    [[nodiscard]] generation_t generation() const noexcept {
+        return _generation.load(std::memory_order_acquire);
+    }
+private:
+    //! The mutex protecting \ref ptr
+    mutable std::mutex mtx;
+    //! The current pointer
+    ptr_t ptr;
+    //! The generation of \ref ptr
+    /*! It is modified only with \ref mtx locked. */
+    std::atomic<generation_t> _generation{0};
+};
+} // namespace impl
 
 //! The ThreadScript virtual machine
 /*! An object of this class represents a single instance of the ThreadScript
@@ -49,7 +212,14 @@ public:
     //! No moving
     basic_virtual_machine(basic_virtual_machine&&) = delete;
     //! The destructor checks that no basic_state refers this VM.
+    /*! If a task pool has been created, it first waits for all its tasks and
+     * stops the pool threads, which own their basic_state objects. Then it
+     * destroys the imported modules and idle states of the state pool, if
+     * they have been created. */
     ~basic_virtual_machine() {
+        task_pool.reset();
+        module_registry.reset();
+        state_pool.reset();
         assert(_num_states.load() == 0);
     }
     //! No copying
@@ -68,20 +238,54 @@ public:
     /*! It is a shared pointer to a symbol table, so that the global symbol
      * table can be replaced without synchronization of all thread. Existing
      * threads will continue to use the old symbol table until they request the
-     * new one by calling basic_state::update_sh_vars(). */
-    std::atomic<std::shared_ptr<const basic_symbol_table<A>>> sh_vars;
+     * new one by calling basic_state::update_sh_vars(). Checking for a new
+     * symbol table is cheap, so a thread can do it before handling each
+     * request. */
+    impl::published_ptr<const basic_symbol_table<A>> sh_vars;
     //! Used as the standard output stream.
     /*! If \c nullptr, standard output is discarded. It can be overriden
      * for a thread by basic_state::std_out. The user of this stream must
      * ensure proper synchronization, e.g., by using std::osyncstream. */
     std::atomic<std::ostream*> std_out = &std::cout;
+    //! The number of threads of the task pool
+    /*! It is used when the task pool is created by the first call of
+     * basic_task_pool::get() for this VM. Changing it later has no effect. If
+     * it is 0, the number of threads is std::thread::hardware_concurrency(),
+     * but at least 1. */
+    std::atomic<size_t> task_pool_threads = 0;
+    //! The default value of \ref task_stack_size
+    static constexpr size_t default_task_stack_size = 1024 * 1024;
+    //! The stack size of a green thread running a task in the task pool
+    /*! It limits the depth of nested calls in a task, see
+     * basic_task_pool::task::green(). A call that would nearly exhaust the
+     * stack throws exception::op_recursion, even if basic_state::max_stack of
+     * the task is not reached. */
+    std::atomic<size_t> task_stack_size = default_task_stack_size;
 private:
     //! The allocator used by this VM.
     [[no_unique_address]] A alloc;
     //! The number of basic_state objects attached to this VM
     std::atomic<size_t> _num_states{0};
+    //! The mutex protecting creation of \ref state_pool
+    std::mutex state_pool_mtx;
+    //! The state pool, created on demand by basic_state_pool::get()
+    std::unique_ptr<impl::state_pool_base> state_pool;
+    //! The mutex protecting creation of \ref task_pool
+    std::mutex task_pool_mtx;
+    //! The task pool, created on demand by basic_task_pool::get()
+    std::unique_ptr<impl::task_pool_base> task_pool;
+    //! The mutex protecting creation of \ref module_registry
+    std::mutex module_registry_mtx;
+    //! The module registry, created on demand by basic_module_registry::get()
+    std::unique_ptr<impl::module_registry_base> module_registry;
+    //! Needs access to \ref module_registry
+    friend class basic_module_registry<A>;
     //! Needs access to num_states
     friend class basic_state<A>;
+    //! Needs access to \ref state_pool
+    friend class basic_state_pool<A>;
+    //! Needs access to \ref task_pool
+    friend class basic_task_pool<A>;
 };
 
 //! The state of a single thread in a basic_virtual_machine
@@ -100,7 +304,24 @@ public:
         vm(vm), t_vars(vm.get_allocator(), nullptr), alloc(vm.get_allocator())
     {
         ++vm._num_states;
-        update_sh_vars();
+        vm.sh_vars.load(sh_vars, sh_vars_gen);
+        t_vars.parent = sh_vars.get();
+    }
+    //! The constructor registers basic_state in \a vm with given variables.
+    /*! It sets \a sh_vars as the parent symbol table of \ref t_vars instead
+     * of \c vm.sh_vars. The next call of update_sh_vars() replaces \a sh_vars
+     * by \c vm.sh_vars only if \c vm.sh_vars is changed after this
+     * constructor. It is used to run a script with a symbol table that has not
+     * been published yet, see basic_reloader.
+     * \param[in] vm the virtual machine which this state is attached to.
+     * \param[in] sh_vars the shared variables used by this state */
+    basic_state(vm_t& vm, std::shared_ptr<const basic_symbol_table<A>> sh_vars):
+        vm(vm), t_vars(vm.get_allocator(), nullptr),
+        alloc(vm.get_allocator()), sh_vars(std::move(sh_vars)),
+        sh_vars_gen(vm.sh_vars.generation())
+    {
+        ++vm._num_states;
+        t_vars.parent = this->sh_vars.get();
     }
     //! No copying
     basic_state(const basic_state&) = delete;
@@ -122,8 +343,34 @@ public:
      * trace is returned.
      * \return the stack trace */
     [[nodiscard]] stack_trace current_stack() const noexcept;
+    //! Resets the state for reuse by basic_state_pool.
+    /*! It removes all symbols from \ref t_vars, and it sets \ref std_out and
+     * \ref max_stack to their initial values. It keeps the allocated memory
+     * of \ref t_vars. It releases the shared variables and removes the
+     * parent symbol table of \ref t_vars, which are restored by the next
+     * update_sh_vars(). It must not be called while the state is running
+     * a script or a function. */
+    void reset() noexcept;
     //! Sets parent symbol table of t_vars to global shared variables of \ref vm
-    void update_sh_vars();
+    /*! If \c vm.sh_vars has not been replaced since the last call, it does
+     * nothing and it does not lock anything. If called while the stack is not
+     * empty, e.g., by a script calling function \c update_sh_vars, the shared
+     * variables used when the outermost stack frame was entered are kept
+     * alive until the stack becomes empty, because the running code may
+     * belong to a script that has published them. Therefore basic_reloader
+     * does not unresolve such a script while its code can still be executed
+     * by this thread. Shared variables switched to and replaced while the
+     * stack is not empty are not kept.
+     * \return \c true if the parent symbol table has been changed */
+    bool update_sh_vars();
+    //! Gets the generation of shared variables used by this thread.
+    /*! It is changed whenever update_sh_vars() switches to new shared
+     * variables. It can be used to detect that values cached from the shared
+     * variables (e.g., by basic_prepared_call) may be outdated.
+     * \return the generation of \c vm.sh_vars used by this thread */
+    [[nodiscard]] auto sh_vars_generation() const noexcept {
+        return sh_vars_gen;
+    }
     //! The virtual machine
     vm_t& vm;
     //! Global variables of this thread
@@ -161,7 +408,9 @@ private:
     //! Pushes a new stack frame to \ref stack.
     /*! \param[in] frame the new stack frame
      * \return a reference to the pushed stack frame
-     * \throw exception::op_recursion if the new frame would exceed max_stack */
+     * \throw exception::op_recursion if the new frame would exceed max_stack
+     * or if the stack of the current green thread is nearly exhausted, see
+     * impl::green_thread::stack_exhausted() */
     stack_frame& push_frame(stack_frame&& frame);
     //! Pops the top element from the stack.
     /*! It handles freeing memory consumed by the stack. The stack must not be
@@ -171,6 +420,13 @@ private:
     [[no_unique_address]] A alloc;
     //! The currently used shared variables of the virtual machine
     std::shared_ptr<const basic_symbol_table<A>> sh_vars;
+    //! The generation of \ref sh_vars in \c vm.sh_vars
+    typename impl::published_ptr<const basic_symbol_table<A>>::generation_t
+        sh_vars_gen = 0;
+    //! Shared variables used when the outermost frame of \ref stack was entered
+    /*! They are set by update_sh_vars() called with a nonempty stack and
+     * released when the stack becomes empty. */
+    std::shared_ptr<const basic_symbol_table<A>> entry_sh_vars;
     //! The stack of this thread
     stack_t stack;
     //! basic_code_node::eval() needs access to basic_state
@@ -5,6 +5,7 @@
  */
 
 #include "threadscript/virtual_machine.hpp"
+#include "threadscript/green.hpp"
 
 namespace threadscript {
 
@@ -30,22 +31,47 @@ void basic_state<A>::pop_frame() noexcept
     assert(!stack.empty());
     stack.pop_back();
     std_container_shrink(stack);
+    if (stack.empty())
+        entry_sh_vars.reset();
 }
 
 template <impl::allocator A>
 auto basic_state<A>::push_frame(stack_frame&& frame) -> stack_frame&
 {
-    if (stack.size() >= max_stack)
+    if (stack.size() >= max_stack || impl::green_thread::stack_exhausted())
         throw exception::op_recursion(current_stack());
     stack.push_back(std::move(frame));
     return stack.back();
 }
 
 template <impl::allocator A>
-void basic_state<A>::update_sh_vars()
+void basic_state<A>::reset() noexcept
 {
-    sh_vars = vm.sh_vars.load();
+    assert(stack.empty());
+    t_vars.data.clear();
+    t_vars.parent = nullptr;
+    sh_vars.reset();
+    entry_sh_vars.reset();
+    // The next update_sh_vars() loads the current vm.sh_vars
+    sh_vars_gen = 0;
+    std_out.reset();
+    max_stack = basic_virtual_machine<A>::default_max_stack;
+}
+
+template <impl::allocator A>
+bool basic_state<A>::update_sh_vars()
+{
+    if (vm.sh_vars.generation() == sh_vars_gen)
+        return false;
+    // Code running in the current stack frames may belong to the script that
+    // has published the shared variables used when entering the outermost
+    // frame, keep them until it returns. They are the current ones if not set
+    // yet, because all previous switches were done with an empty stack.
+    if (!stack.empty() && !entry_sh_vars)
+        entry_sh_vars = sh_vars;
+    vm.sh_vars.load(sh_vars, sh_vars_gen);
     t_vars.parent = sh_vars.get();
+    return true;
 }
 
 } // namespace threadscript
@@ -13,9 +13,14 @@
 #include "threadscript/exception.hpp"
 #include "threadscript/template.hpp"
 
+#include <concepts>
 #include <memory>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <typeinfo>
+#include <utility>
 
 namespace threadscript {
 
@@ -168,6 +173,17 @@ protected:
      * \throw exception::out_of_range if \a idx is negative */
     size_t arg_index(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
                      const basic_code_node<A>& node, size_t idx);
+    //! Converts a value to an index.
+    /*! It is used by arg_index() and by implementations of functions and
+     * methods that get indices in other ways than as direct arguments, e.g.,
+     * as elements of a \c vector.
+     * \param[in] v a value
+     * \return the index represented by \a v
+     * \throw exception::value_null if \a v is \c null
+     * \throw exception::value_type if \a v does not have type \c int or \c
+     * unsigned
+     * \throw exception::value_out_of_range if \a v is negative */
+    static size_t to_index(const value_ptr& v);
     //! Creates a result of a function.
     /*! It is used by implementation classes for commands and function in
      * namespace threadscript::predef.
@@ -506,6 +522,93 @@ public:
     void set_mt_safe() override;
 };
 
+template <impl::allocator A> class basic_value_int_vector;
+
+namespace impl {
+//! The name of value_int_vector
+inline constexpr char name_value_int_vector[] = "int_vector";
+//! The base class of basic_value_int_vector
+/*! \tparam A an allocator type */
+template <allocator A> using basic_value_int_vector_base =
+    basic_typed_value<basic_value_int_vector<A>,
+        a_basic_vector<config::value_int_type, A>,
+        name_value_int_vector, A>;
+} // namespace impl
+
+//! The value class holding a packed vector of signed integers
+/*! Unlike basic_value_vector, elements are not stored as individual values,
+ * but as a contiguous array of config::value_int_type. It saves memory and
+ * allows efficient bulk operations, e.g., predef::f_sum.
+ * \tparam A an allocator type; used internally by the stored vector
+ * \test in file test_vm_data.cpp */
+template <impl::allocator A> class basic_value_int_vector final:
+    public impl::basic_value_int_vector_base<A>
+{
+    static_assert(impl::uses_allocator<
+                  typename basic_value_int_vector::value_type, A>);
+    using impl::basic_value_int_vector_base<A>::basic_value_int_vector_base;
+public:
+    //! The value type of an element
+    using element_value = basic_value_int<A>;
+    using impl::basic_value_int_vector_base<A>::value;
+    //! Gets writable access to the contained \ref data.
+    /*! It handles automatic resizing of storage in the same way as
+     * basic_value_vector::value().
+     * \return \ref data
+     * \throw exception::value_read_only if the value is read-only (that is,
+     * marked thread-safe) */
+    typename basic_value_int_vector::value_type& value() {
+        typename basic_value_int_vector::value_type& v =
+            impl::basic_value_int_vector_base<A>::value();
+        std_container_shrink(v);
+        return v;
+    }
+};
+
+template <impl::allocator A> class basic_value_unsigned_vector;
+
+namespace impl {
+//! The name of value_unsigned_vector
+inline constexpr char name_value_unsigned_vector[] = "unsigned_vector";
+//! The base class of basic_value_unsigned_vector
+/*! \tparam A an allocator type */
+template <allocator A> using basic_value_unsigned_vector_base =
+    basic_typed_value<basic_value_unsigned_vector<A>,
+        a_basic_vector<config::value_unsigned_type, A>,
+        name_value_unsigned_vector, A>;
+} // namespace impl
+
+//! The value class holding a packed vector of unsigned integers
+/*! Unlike basic_value_vector, elements are not stored as individual values,
+ * but as a contiguous array of config::value_unsigned_type. It saves memory
+ * and allows efficient bulk operations, e.g., predef::f_sum.
+ * \tparam A an allocator type; used internally by the stored vector
+ * \test in file test_vm_data.cpp */
+template <impl::allocator A> class basic_value_unsigned_vector final:
+    public impl::basic_value_unsigned_vector_base<A>
+{
+    static_assert(impl::uses_allocator<
+                  typename basic_value_unsigned_vector::value_type, A>);
+    using impl::basic_value_unsigned_vector_base<A>::
+        basic_value_unsigned_vector_base;
+public:
+    //! The value type of an element
+    using element_value = basic_value_unsigned<A>;
+    using impl::basic_value_unsigned_vector_base<A>::value;
+    //! Gets writable access to the contained \ref data.
+    /*! It handles automatic resizing of storage in the same way as
+     * basic_value_vector::value().
+     * \return \ref data
+     * \throw exception::value_read_only if the value is read-only (that is,
+     * marked thread-safe) */
+    typename basic_value_unsigned_vector::value_type& value() {
+        typename basic_value_unsigned_vector::value_type& v =
+            impl::basic_value_unsigned_vector_base<A>::value();
+        std_container_shrink(v);
+        return v;
+    }
+};
+
 //! The base class for objects of native classes implemented in C++
 /*! Each class \a Object derived from an instance of this template represents a
  * ThreadScript class with native C++ implementation. See the test program
@@ -637,6 +740,14 @@ protected:
     basic_value_object(tag_args t, std::shared_ptr<const method_table> methods,
                        basic_state<A>& thread, basic_symbol_table<A>& l_vars,
                        const basic_code_node<A>& node);
+    //! Creates the object outside of a script.
+    /*! It is used by a derived class that allows creating objects by native
+     * C++ code, without calling \ref constructor from a script.
+     * \param[in] t an ignored parameter that prevents using this constructor
+     * directly
+     * \param[in] methods the mapping from method names to implementations,
+     * usually obtained by calling init_methods() of \a Object */
+    basic_value_object(tag_args t, std::shared_ptr<const method_table> methods);
     //! Gets the object or calls a method of the object.
     /*! The method name is passed as the first argument,
      * <tt>arg(thread, l_vars, node, 0)</tt>. If called without arguments, the
@@ -656,6 +767,13 @@ protected:
                    basic_symbol_table<A>& l_vars,
                    const basic_code_node<A>& node,
                    std::string_view fun_name) override;
+    //! Gets the table of methods
+    /*! It is needed by a method that creates a new instance of \a Object.
+     * \return \ref methods */
+    [[nodiscard]] const std::shared_ptr<const method_table>&
+    get_methods() const noexcept {
+        return methods;
+    }
     /*! \copydoc threadscript::basic_value::shallow_copy()
      * \throw exception::not_implemented is always thrown, because \a Object is
      * not copyable by default */
@@ -668,4 +786,170 @@ private:
     std::shared_ptr<const method_table> methods;
 };
 
+namespace impl {
+
+//! Selects the script value class used for a C++ type
+/*! It is used by basic_prepared_call and basic_native_binding for converting
+ * between C++ values and script values. The primary template is used for
+ * types without a conversion.
+ * \tparam A an allocator type
+ * \tparam T a C++ type */
+template <allocator A, class T> struct cpp_value {
+    //! Indicates that \a T cannot be converted
+    static constexpr bool valid = false;
+};
+
+//! Passing a script value without conversion
+/*! \tparam A an allocator type */
+template <allocator A>
+struct cpp_value<A, typename basic_value<A>::value_ptr> {
+    //! Indicates that the type can be converted
+    static constexpr bool valid = true;
+    //! No script value object is created for this type
+    using value_type = void;
+};
+
+//! Conversion of \c bool
+/*! \tparam A an allocator type */
+template <allocator A> struct cpp_value<A, bool> {
+    //! Indicates that the type can be converted
+    static constexpr bool valid = true;
+    //! The script value class
+    using value_type = basic_value_bool<A>;
+};
+
+//! Conversion of signed integers
+/*! \tparam A an allocator type
+ * \tparam T an integer type */
+template <allocator A, std::signed_integral T> struct cpp_value<A, T> {
+    //! Indicates that the type can be converted
+    static constexpr bool valid = true;
+    //! The script value class
+    using value_type = basic_value_int<A>;
+};
+
+//! Conversion of unsigned integers
+/*! \tparam A an allocator type
+ * \tparam T an integer type */
+template <allocator A, std::unsigned_integral T>
+requires (!std::same_as<T, bool>)
+struct cpp_value<A, T> {
+    //! Indicates that the type can be converted
+    static constexpr bool valid = true;
+    //! The script value class
+    using value_type = basic_value_unsigned<A>;
+};
+
+//! Conversion of strings
+/*! Type <tt>const char*</tt> can be converted only to a script value.
+ * \tparam A an allocator type
+ * \tparam T a string type */
+template <allocator A, class T>
+requires std::same_as<T, std::string> || std::same_as<T, std::string_view> ||
+    std::same_as<T, const char*>
+struct cpp_value<A, T> {
+    //! Indicates that the type can be converted
+    static constexpr bool valid = true;
+    //! The script value class
+    using value_type = basic_value_string<A>;
+};
+
+//! Converts a value between integer types, checking that it is in range.
+/*! Other values are converted by \c static_cast without checking.
+ * \tparam T the target type
+ * \tparam U the source type
+ * \param[in] v a value
+ * \return \a v converted to \a T
+ * \throw exception::value_out_of_range if \a v is an integer not
+ * representable by integer type \a T */
+template <class T, class U> T checked_cast(const U& v)
+{
+    if constexpr (std::integral<T> && std::integral<U> &&
+                  !std::same_as<T, bool> && !std::same_as<U, bool>)
+    {
+        // std::in_range() does not accept character types
+        using t_t = std::conditional_t<std::signed_integral<T>,
+                            std::make_signed_t<T>, std::make_unsigned_t<T>>;
+        using u_t = std::conditional_t<std::signed_integral<U>,
+                            std::make_signed_t<U>, std::make_unsigned_t<U>>;
+        if (!std::in_range<t_t>(u_t(v)))
+            throw exception::value_out_of_range();
+    }
+    return static_cast<T>(v);
+}
+
+//! Stores a C++ value into an existing script value.
+/*! \tparam V the script value class selected by cpp_value
+ * \tparam T the C++ type
+ * \param[in] dst the script value
+ * \param[in] v a C++ value
+ * \throw exception::value_read_only if \a dst is not writable
+ * \throw exception::value_out_of_range if \a v is not representable by the
+ * script type */
+template <class V, class T> void assign_value(V& dst, const T& v)
+{
+    auto& d = dst.value();
+    if constexpr (std::is_convertible_v<const T&, std::string_view>)
+        d = std::string_view{v};
+    else
+        d = checked_cast<std::remove_cvref_t<decltype(d)>>(v);
+}
+
+//! Converts a script value to a C++ value.
+/*! Values are not converted between script types, e.g., an \c unsigned
+ * script value cannot be converted to a signed C++ integer type.
+ * \tparam A an allocator type
+ * \tparam T the C++ type; if it is \c std::string_view, the result refers to
+ * the string stored in \a v
+ * \param[in] v a script value
+ * \return \a v converted to \a T
+ * \throw exception::value_null if \a v is \c null and \a T is not
+ * basic_value::value_ptr
+ * \throw exception::value_type if \a v does not have the script type
+ * selected by cpp_value
+ * \throw exception::value_out_of_range if \a v is an integer not
+ * representable by \a T */
+template <allocator A, class T> requires cpp_value<A, T>::valid &&
+    (!std::same_as<T, const char*>)
+T from_value(const typename basic_value<A>::value_ptr& v)
+{
+    using value_t = typename cpp_value<A, T>::value_type;
+    if constexpr (std::is_void_v<value_t>)
+        return v;
+    else {
+        if (!v)
+            throw exception::value_null();
+        // Type names are unique, comparing them avoids dynamic_cast
+        if (v->type_name() != value_t::static_type_name())
+            throw exception::value_type();
+        const auto& r = static_cast<const value_t&>(*v).cvalue();
+        if constexpr (std::same_as<value_t, basic_value_string<A>>)
+            return T(std::string_view{r});
+        else
+            return checked_cast<T>(r);
+    }
+}
+
+//! Converts a C++ value to a new script value.
+/*! \tparam A an allocator type
+ * \tparam T the C++ type
+ * \param[in] alloc the allocator used for the new value
+ * \param[in] v a C++ value
+ * \return \a v converted to a script value; \a v itself if \a T is
+ * basic_value::value_ptr */
+template <allocator A, class T> requires cpp_value<A, T>::valid
+typename basic_value<A>::value_ptr to_value(const A& alloc, const T& v)
+{
+    using value_t = typename cpp_value<A, T>::value_type;
+    if constexpr (std::is_void_v<value_t>)
+        return v;
+    else {
+        auto result = value_t::create(alloc);
+        assign_value(*result, v);
+        return result;
+    }
+}
+
+} // namespace impl
+
 } // namespace threadscript
@@ -26,14 +26,19 @@ template <impl::allocator A> size_t
 basic_value<A>::arg_index(basic_state<A>& thread, basic_symbol_table<A>& l_vars,
                           const basic_code_node<A>& node, size_t idx)
 {
-    auto arg = this->arg(thread, l_vars, node, idx);
-    if (!arg)
+    return to_index(this->arg(thread, l_vars, node, idx));
+}
+
+template <impl::allocator A>
+size_t basic_value<A>::to_index(const value_ptr& v)
+{
+    if (!v)
         throw exception::value_null();
-    if (auto pi = dynamic_cast<basic_value_int<A>*>(arg.get())) {
+    if (auto pi = dynamic_cast<basic_value_int<A>*>(v.get())) {
         if (pi->cvalue() < 0)
             throw exception::value_out_of_range();
         return size_t(pi->cvalue());
-    } else if (auto pi = dynamic_cast<basic_value_unsigned<A>*>(arg.get()))
+    } else if (auto pi = dynamic_cast<basic_value_unsigned<A>*>(v.get()))
         return size_t(pi->cvalue());
     else
         throw exception::value_type();
@@ -201,6 +206,15 @@ basic_value_object<Object, Name, A>::basic_value_object(tag_args,
     static_assert(std::is_final_v<Object>);
 }
 
+template <class Object, str_literal Name, impl::allocator A>
+basic_value_object<Object, Name, A>::basic_value_object(tag_args,
+                                  std::shared_ptr<const method_table> methods):
+    methods(std::move(methods))
+{
+    static_assert(std::is_base_of_v<basic_value_object, Object>);
+    static_assert(std::is_final_v<Object>);
+}
+
 template <class Object, str_literal Name, impl::allocator A> auto
 basic_value_object<Object, Name, A>::eval(basic_state<A>& thread,
                                           basic_symbol_table<A>& l_vars,
@@ -12,11 +12,14 @@
 #include "threadscript/threadscript.hpp"
 #include "threadscript/symbol_table_impl.hpp"
 
+#include <signal.h>
 #include <unistd.h>
 
 #include <cstdlib>
 #include <cstring>
+#include <filesystem>
 #include <syncstream>
+#include <thread>
 #include <unordered_set>
 
 using namespace std::string_literals;
@@ -151,6 +154,35 @@ public:
     bool resolve_phase1() const {
         return _resolve_phase1;
     }
+    //! Gets the scripts loaded before the main script.
+    /*! \return the file names of the loaded scripts in the order of
+     * evaluation */
+    const std::vector<std::string>& load() const {
+        return _load;
+    }
+    //! Gets the module search path.
+    /*! \return the directories searched for modules imported by scripts */
+    const std::vector<std::string>& import_path() const {
+        return _import_path;
+    }
+    //! Gets the directory of cached parsed scripts.
+    /*! \return the cache directory; \c std::nullopt if the script is always
+     * parsed */
+    const std::optional<std::string>& cache_dir() const {
+        return _cache_dir;
+    }
+    //! Request reloading the script on signal \c SIGHUP.
+    /*! \return whether to reload the script on \c SIGHUP */
+    bool reload_signal() const {
+        return _reload_signal;
+    }
+    //! Request reloading the script when its file is modified.
+    /*! \return the period of checking the modification time of the script
+     * file in milliseconds (always nonzero); \c std::nullopt for no checking
+     */
+    std::optional<std::chrono::milliseconds> reload_watch() const {
+        return _reload_watch;
+    }
     //! Request reporting exceptions without a stack trace.
     /*! \return the exception message verbosity flag */
     bool quiet_exceptions() const {
@@ -196,6 +228,16 @@ private:
     bool _resolve_parsed = false;
     //! Resolve names after the first run phase
     bool _resolve_phase1 = false;
+    //! The scripts loaded before the main script
+    std::vector<std::string> _load;
+    //! The module search path
+    std::vector<std::string> _import_path;
+    //! The directory of cached parsed scripts
+    std::optional<std::string> _cache_dir = {};
+    //! Reload the script on \c SIGHUP
+    bool _reload_signal = false;
+    //! The period of checking modification of the script file
+    std::optional<std::chrono::milliseconds> _reload_watch = {};
     //! Flag for reporting exceptions without a stack trace
     bool _quiet_exceptions = false;
     //! Flag for reporting help
@@ -262,6 +304,48 @@ std::to_string(threadscript::virtual_machine::default_max_stack) + R"(.
         thread. It allows to resolve names of variables and functions defined
         during the first phase and use the resolved values in the second phase.
 
+    -l FILE[:FILE...]
+        Load a colon-separated list of script files before running the main
+        script. The loaded files and the main script file are parsed in
+        parallel, by threads of the task pool. If any file cannot be parsed,
+        errors of all files are reported and no script is run. Otherwise, the
+        loaded scripts are evaluated by the main thread in the order of the
+        list, followed by the first phase of the main script. Options -R and
+        -r apply to all scripts. This option cannot be used with options -H
+        and -W.
+
+    -I DIR[:DIR...]
+        Search modules imported by function import in a colon-separated list
+        of directories. If the option is not used, modules are searched in the
+        current directory. Each module is parsed and evaluated once, and its
+        thread-safe definitions are shared by all threads. With option -R,
+        modules imported by the scripts with a constant name are loaded before
+        the first phase and names of imported functions are resolved.
+
+    -c DIR
+        Use directory DIR as a cache of parsed scripts. If the directory
+        contains the parsed script, it is loaded without parsing. Otherwise,
+        the script is parsed and stored in the directory, which is created if
+        it does not exist. A cached script is used only if both the script
+        source and the program version are unchanged. This option cannot be
+        used with a script read from the standard input.
+
+    -H
+        Reload the script when signal SIGHUP is received during the second
+        phase. The script is parsed and run again in a new thread, and
+        thread-safe symbols defined by it replace the shared variables of the
+        virtual machine. Running threads switch to the new shared variables
+        when they call function update_sh_vars or start a task. This option
+        cannot be used with a script read from the standard input or with
+        options -R and -r.
+
+    -W NUMBER
+        NUMBER must be positive. During the second phase, check modification
+        time of the script file every NUMBER milliseconds and reload the
+        script if it changes, as described for option -H. This option cannot
+        be used with a script read from the standard input or with options -R
+        and -r.
+
     -q
         Quiet exceptions. Report exceptions without a full stack trace.
 
@@ -286,7 +370,7 @@ args::args(int argc, char* argv[])
     optind = 1;
     opterr = 0;
     for (int o;
-         (o = getopt(argc, argv, "+s:t:M:S:nRrqhvC")) != -1;
+         (o = getopt(argc, argv, "+s:t:M:S:nRrl:I:c:HW:qhvC")) != -1;
          used_opts.insert(o))
     {
         if (used_opts.contains(o))
@@ -336,6 +420,43 @@ args::args(int argc, char* argv[])
         case 'r':
             _resolve_phase1 = true;
             break;
+        case 'l':
+            for (std::string_view files = optarg;;) {
+                auto sep = files.find(':');
+                _load.emplace_back(files.substr(0, sep));
+                err = err || _load.back().empty();
+                if (sep == std::string_view::npos)
+                    break;
+                files.remove_prefix(sep + 1);
+            }
+            break;
+        case 'I':
+            for (std::string_view dirs = optarg;;) {
+                auto sep = dirs.find(':');
+                _import_path.emplace_back(dirs.substr(0, sep));
+                err = err || _import_path.back().empty();
+                if (sep == std::string_view::npos)
+                    break;
+                dirs.remove_prefix(sep + 1);
+            }
+            break;
+        case 'c':
+            _cache_dir = optarg;
+            err = _cache_dir->empty();
+            break;
+        case 'H':
+            _reload_signal = true;
+            break;
+        case 'W':
+            try {
+                auto ms = std::stoull(optarg, &pos, 10);
+                err = pos != strlen(optarg) || ms == 0 ||
+                    ms > uint64_t(std::chrono::milliseconds::max().count());
+                _reload_watch = std::chrono::milliseconds(ms);
+            } catch (...) {
+                err = true;
+            }
+            break;
         case 'q':
             _quiet_exceptions = true;
             break;
@@ -376,6 +497,17 @@ args::args(int argc, char* argv[])
         _script_args.reserve(argc - optind);
         for (; optind < argc; ++optind)
             _script_args.emplace_back(argv[optind]);
+        if (_cache_dir && _script == script_stdin)
+            throw args_error("Option -c requires a script file");
+        if (_reload_signal || _reload_watch) {
+            if (_script == script_stdin)
+                throw args_error("Options -H and -W require a script file");
+            if (_resolve_parsed || _resolve_phase1)
+                throw args_error(
+                        "Options -H and -W cannot be used with -R and -r");
+            if (!_load.empty())
+                throw args_error("Options -H and -W cannot be used with -l");
+        }
     }
 }
 
@@ -402,6 +534,61 @@ exit_status value_to_status(threadscript::value::value_ptr v)
         return exit_status::success;
 }
 
+//! Reloads a script on request until stopped.
+/*! It is run in a separate thread during the second phase of script
+ * execution. It waits for signal \c SIGHUP, which must be blocked in all
+ * threads, if requested by args::reload_signal(). It checks the modification
+ * time of the script file if requested by args::reload_watch(). Errors of
+ * reloading are reported to the standard error and the previously loaded
+ * script remains active.
+ * \param[in] a processed command line arguments
+ * \param[in] reloader the script reloader
+ * \param[in] stop a request to stop reloading */
+void reload_script(const args& a, threadscript::reloader& reloader,
+                   std::stop_token stop)
+{
+    using namespace std::chrono_literals;
+    sigset_t sigs;
+    sigemptyset(&sigs);
+    if (a.reload_signal())
+        sigaddset(&sigs, SIGHUP);
+    // Also limits the delay of a stop request
+    auto period = std::min<std::chrono::milliseconds>(
+                                            a.reload_watch().value_or(100ms),
+                                            100ms);
+    const timespec timeout{period / 1s, (period % 1s) / 1ns};
+    std::error_code ec;
+    auto mtime = std::filesystem::last_write_time(a.script(), ec);
+    // Saturated, because a long period could overflow the clock
+    auto next_check = [&a]() {
+        return threadscript::impl::deadline_after(
+                        uint64_t(a.reload_watch().value_or(0ms).count()));
+    };
+    auto check = next_check();
+    while (!stop.stop_requested()) {
+        bool load = sigtimedwait(&sigs, nullptr, &timeout) == SIGHUP;
+        if (a.reload_watch() && std::chrono::steady_clock::now() >= check) {
+            check = next_check();
+            auto t = std::filesystem::last_write_time(a.script(), ec);
+            if (!ec && t != mtime) {
+                mtime = t;
+                load = true;
+            }
+        }
+        if (!load)
+            continue;
+        try {
+            reloader.reload();
+        } catch (threadscript::exception::base& e) {
+            std::osyncstream(std::cerr) << "Cannot reload " << a.script() <<
+                ": " << e.to_string(!a.quiet_exceptions()) << "\n";
+        } catch (std::exception& e) {
+            std::osyncstream(std::cerr) << "Cannot reload " << a.script() <<
+                ": " << e.what() << "\n";
+        }
+    }
+}
+
 //! The actions requested by command line options
 namespace actions {
 
@@ -459,36 +646,92 @@ namespace actions {
         alloc_cfg.limits(limits);
     }
     threadscript::allocator_any alloc{&alloc_cfg};
-    // Parse the script
+    // Signal SIGHUP will be accepted only by reload_script()
+    if (a.reload_signal()) {
+        sigset_t sigs;
+        sigemptyset(&sigs);
+        sigaddset(&sigs, SIGHUP);
+        pthread_sigmask(SIG_BLOCK, &sigs, nullptr);
+    }
+    // The virtual machine, its task pool parses loaded scripts
+    threadscript::virtual_machine vm{alloc};
+    // Configure importing of modules
+    auto& modules = threadscript::module_registry::get(vm);
+    modules.search_path(a.import_path());
+    modules.resolve_modules = a.resolve_parsed();
+    // Parse the loaded scripts and the main script file in parallel
+    std::vector<threadscript::script::script_ptr> loaded;
     threadscript::script::script_ptr parsed = nullptr;
-    try {
-        parsed = a.script() == args::script_stdin ?
-            threadscript::parse_code_stream(alloc, std::cin, a.script(),
-                                            a.syntax()) :
-            threadscript::parse_code_file(alloc, a.script(), a.syntax());
-    } catch (std::exception& e) {
-        std::cerr << "Cannot parse " << a.script() << ": " << e.what() <<
-            std::endl;
-        return exit_status::parse_error;
+    if (!a.load().empty()) {
+        auto files = a.load();
+        if (a.script() != args::script_stdin)
+            files.push_back(a.script());
+        bool ok = true;
+        for (auto&& f: threadscript::parse_code_files(vm, files, a.syntax(),
+                                                  a.cache_dir().value_or("")))
+        {
+            if (f.error) {
+                try {
+                    std::rethrow_exception(f.error);
+                } catch (std::exception& e) {
+                    std::cerr << "Cannot parse " << f.file << ": " <<
+                        e.what() << std::endl;
+                }
+                ok = false;
+            } else
+                loaded.push_back(f.script);
+        }
+        if (!ok)
+            return exit_status::parse_error;
+        if (a.script() != args::script_stdin) {
+            parsed = loaded.back();
+            loaded.pop_back();
+        }
     }
+    // Parse the script if not parsed together with the loaded scripts
+    if (!parsed)
+        try {
+            if (a.script() == args::script_stdin)
+                parsed = threadscript::parse_code_stream(alloc, std::cin,
+                                                         a.script(),
+                                                         a.syntax());
+            else if (a.cache_dir())
+                parsed = threadscript::parse_code_file_cached(alloc,
+                                                              a.script(),
+                                                              *a.cache_dir(),
+                                                              a.syntax());
+            else
+                parsed = threadscript::parse_code_file(alloc, a.script(),
+                                                       a.syntax());
+        } catch (std::exception& e) {
+            std::cerr << "Cannot parse " << a.script() << ": " << e.what() <<
+                std::endl;
+            return exit_status::parse_error;
+        }
     if (a.parse_only())
         return exit_status::success;
     // Prepare the virtual machine for phase one
-    threadscript::virtual_machine vm{alloc};
-    auto sh_vars = threadscript::predef_symbols(alloc);
-    threadscript::add_predef_objects(sh_vars, true);
-    auto cmdline = threadscript::value_vector::create(alloc);
-    for (auto& arg: a.script_args()) {
-        auto val = threadscript::value_string::create(alloc);
-        val->value() = arg;
-        val->set_mt_safe();
-        cmdline->value().push_back(std::move(val));
-    }
-    cmdline->set_mt_safe();
-    sh_vars->insert(cmdline_var, std::move(cmdline));
+    auto make_sh_vars = [&a, alloc]() {
+        auto sh_vars = threadscript::predef_symbols(alloc);
+        threadscript::add_predef_objects(sh_vars, true);
+        auto cmdline = threadscript::value_vector::create(alloc);
+        for (auto& arg: a.script_args()) {
+            auto val = threadscript::value_string::create(alloc);
+            val->value() = arg;
+            val->set_mt_safe();
+            cmdline->value().push_back(std::move(val));
+        }
+        cmdline->set_mt_safe();
+        sh_vars->insert(cmdline_var, std::move(cmdline));
+        return sh_vars;
+    };
+    auto sh_vars = make_sh_vars();
     vm.sh_vars = sh_vars;
-    if (a.resolve_parsed())
+    if (a.resolve_parsed()) {
+        for (auto&& s: loaded)
+            s->resolve(*sh_vars, false, false);
         parsed->resolve(*sh_vars, false, false);
+    }
     threadscript::state main_thread{vm};
     if (a.max_stack())
         main_thread.max_stack = *a.max_stack();
@@ -500,6 +743,13 @@ namespace actions {
     // Run phase one
     exit_status result = exit_status::success;
     try {
+        if (a.resolve_parsed()) {
+            for (auto&& s: loaded)
+                modules.resolve(*s);
+            modules.resolve(*parsed);
+        }
+        for (auto&& s: loaded)
+            s->eval(main_thread);
         result = value_to_status(parsed->eval(main_thread));
     } catch (threadscript::exception::base& e) {
         std::cerr << "Script terminated by exception: " <<
@@ -531,8 +781,11 @@ namespace actions {
         } else
             ++it;
     }
-    if (a.resolve_phase1())
+    if (a.resolve_phase1()) {
+        for (auto&& s: loaded)
+            s->resolve(main_thread.t_vars, true, true);
         parsed->resolve(main_thread.t_vars, true, true);
+    }
     // Run phase two
     auto f_main = dynamic_pointer_cast<threadscript::value_function>(
                             sh_vars->lookup(main_fun.data()).value_or(nullptr));
@@ -546,6 +799,13 @@ namespace actions {
         std::cerr << "Function " << thread_fun << " not defined" << std::endl;
         return exit_status::no_fun;
     }
+    // Reload the script on request while phase two is running
+    threadscript::reloader reloader{vm, a.script(), a.syntax(), make_sh_vars};
+    std::jthread reload_thread;
+    if (a.reload_signal() || a.reload_watch())
+        reload_thread = std::jthread([&a, &reloader](std::stop_token stop) {
+            reload_script(a, reloader, std::move(stop));
+        });
     std::vector<std::thread> threads;
     std::atomic<size_t> thread_exc = 0;
     bool main_exc = false;
@@ -595,10 +855,17 @@ namespace actions {
     }
     for (auto&& t: threads)
         t.join();
+    if (reload_thread.joinable()) {
+        reload_thread.request_stop();
+        reload_thread.join();
+    }
     if (!main_exc && thread_exc > 0)
         result = exit_status::thread_exception;
-    if (parsed && (a.resolve_parsed() || a.resolve_phase1()))
+    if (parsed && (a.resolve_parsed() || a.resolve_phase1())) {
+        for (auto&& s: loaded)
+            s->unresolve();
         parsed->unresolve();
+    }
     return result;
     //! [script]
 }
@@ -0,0 +1,2 @@
+# A module importing itself
+import("import_cycle.ts")
@@ -0,0 +1,5 @@
+# A module imported by import_main.ts
+seq(
+    print("Imported\n"),
+    fun("greet", print("Hello ", at(_args(), 0), "!\n"))
+)
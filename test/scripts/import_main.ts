@@ -0,0 +1,6 @@
+# Imports a module twice and calls a function defined by it
+seq(
+    import("import_greet.ts"),
+    import("import_greet.ts"),
+    greet("World")
+)
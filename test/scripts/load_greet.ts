@@ -0,0 +1,2 @@
+# Defines a function used by load_main.ts
+fun("greet", print("Hello ", at(_args(), 0), "!\n"))
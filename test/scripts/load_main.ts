@@ -0,0 +1,2 @@
+# Calls a function defined by load_greet.ts
+greet("World")
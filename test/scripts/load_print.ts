@@ -0,0 +1,2 @@
+# Prints a message when loaded
+print("Loaded\n")
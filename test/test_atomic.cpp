@@ -0,0 +1,402 @@
+/*! \file
+ * \brief Tests of class threadscript::basic_atomic
+ */
+
+//! \cond
+#include "threadscript/threadscript.hpp"
+#include "threadscript/symbol_table_impl.hpp"
+
+#define BOOST_TEST_MODULE atomic
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <boost/test/data/test_case.hpp>
+
+#include "script_runner.hpp"
+
+auto sh_vars = test::make_sh_vars<ts::atomic, ts::channel>();
+//! \endcond
+
+/*! \file
+ * \test \c create_object -- Creates a threadscript::basic_atomic object
+ */
+//! \cond
+BOOST_DATA_TEST_CASE(create_object, (std::vector<test::runner_result>{
+    {R"(atomic())", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(atomic(1, 2))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(atomic(null))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(atomic("1"))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(type(atomic(0)))", "atomic", ""},
+    {R"(is_mt_safe(atomic(0)))", true, ""},
+    {R"(seq(var("o", atomic(-5)), o("load")))", test::int_t(-5), ""},
+    {R"(seq(var("o", atomic(5)), o("load")))", test::uint_t(5U), ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_add -- Tests method
+ * threadscript::basic_atomic::add() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_add, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", atomic(10)),
+            o("add")
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", atomic(10)),
+            o("add", null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", atomic(10)),
+            o("add", +1)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", atomic(+10)),
+            o("add", 1)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", atomic(10)),
+            print(o("add", 5), ","),
+            o("load")
+        ))", test::uint_t(15U), "10,"},
+    {R"(seq(
+            var("o", atomic(+10)),
+            print(o("add", -15), ","),
+            o("load")
+        ))", test::int_t(-5), "10,"},
+    {R"(seq(
+            var("o", atomic(18446744073709551615)),
+            print(o("add", 2), ","),
+            o("load")
+        ))", test::uint_t(1U), "18446744073709551615,"},
+    {R"(seq(
+            var("o", atomic(+9223372036854775807)),
+            try(o("add", +1), "op_overflow", print("overflow,")),
+            o("load")
+        ))", test::int_t(9223372036854775807), "overflow,"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_cas -- Tests method
+ * threadscript::basic_atomic::cas() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_cas, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", atomic(10)),
+            o("cas", 10)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", atomic(10)),
+            o("cas", null, 1)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", atomic(10)),
+            o("cas", 10, null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", atomic(10)),
+            o("cas", +10, 1)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", atomic(10)),
+            o("cas", 10, +1)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", atomic(10)),
+            print(o("cas", 11, 1), ",", o("load"), ","),
+            print(o("cas", 10, 1), ","),
+            o("load")
+        ))", test::uint_t(1U), "false,10,true,"},
+    {R"(seq(
+            var("o", atomic(+10)),
+            print(o("cas", -10, +1), ",", o("load"), ","),
+            print(o("cas", +10, -1), ","),
+            o("load")
+        ))", test::int_t(-1), "false,10,true,"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_exchange -- Tests method
+ * threadscript::basic_atomic::exchange() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_exchange, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", atomic(10)),
+            o("exchange")
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", atomic(10)),
+            o("exchange", null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", atomic(10)),
+            o("exchange", +1)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", atomic(10)),
+            print(o("exchange", 3), ","),
+            o("load")
+        ))", test::uint_t(3U), "10,"},
+    {R"(seq(
+            var("o", atomic(+10)),
+            print(o("exchange", -3), ","),
+            o("load")
+        ))", test::int_t(-3), "10,"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_load -- Tests method
+ * threadscript::basic_atomic::load() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_load, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", atomic(10)),
+            o("load", 1)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", atomic(10)),
+            var("v", o("load")),
+            print(is_mt_safe(v()), ","),
+            add(v(), v(), 1),
+            o("load")
+        ))", test::uint_t(10U), "false,"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_store -- Tests method
+ * threadscript::basic_atomic::store() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_store, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", atomic(10)),
+            o("store")
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", atomic(10)),
+            o("store", null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", atomic(+10)),
+            o("store", 1)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", atomic(10)),
+            print(o("store", 7), ","),
+            o("load")
+        ))", test::uint_t(7U), "null,"},
+    {R"(seq(
+            var("o", atomic(+10)),
+            print(o("store", -7), ","),
+            o("load")
+        ))", test::int_t(-7), "null,"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_sub -- Tests method
+ * threadscript::basic_atomic::sub() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_sub, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", atomic(10)),
+            o("sub")
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", atomic(10)),
+            o("sub", null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", atomic(10)),
+            o("sub", +1)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", atomic(10)),
+            print(o("sub", 4), ","),
+            o("load")
+        ))", test::uint_t(6U), "10,"},
+    {R"(seq(
+            var("o", atomic(+10)),
+            print(o("sub", +15), ","),
+            o("load")
+        ))", test::int_t(-5), "10,"},
+    {R"(seq(
+            var("o", atomic(0)),
+            print(o("sub", 1), ","),
+            o("load")
+        ))", test::uint_t(18446744073709551615U), "0,"},
+    {R"(seq(
+            var("o", atomic(-9223372036854775807)),
+            o("sub", +1),
+            try(o("sub", +1), "op_overflow", print("overflow,")),
+            add(o("load"), +1)
+        ))", test::int_t(-9223372036854775807), "overflow,"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c threads -- Tests modifying threadscript::basic_atomic from multiple
+ * threads */
+//! \cond
+BOOST_DATA_TEST_CASE(threads, (std::vector<test::runner_result>{
+    {R"(seq(
+            gvar("num_threads", 10),
+            gvar("num_iter", 1000),
+            gvar("o", atomic(0)),
+            gvar("done", channel(0)),
+            fun("f_main", seq(
+                var("i", clone(0)),
+                while(lt(i(), num_threads()), seq(
+                    done("recv"),
+                    add(i(), i(), 1)
+                )),
+                o("load")
+            )),
+            fun("f_thread", seq(
+                var("i", clone(0)),
+                while(lt(i(), num_iter()), seq(
+                    o("add", 3),
+                    o("sub", 1),
+                    add(i(), i(), 1)
+                )),
+                done("send", null)
+            ))
+        ))", test::uint_t(20000U), ""},
+    {R"(seq(
+            gvar("num_threads", 10),
+            gvar("o", atomic(+0)),
+            gvar("winner", atomic(+0)),
+            gvar("done", channel(0)),
+            fun("f_main", seq(
+                var("i", clone(0)),
+                while(lt(i(), num_threads()), seq(
+                    done("recv"),
+                    add(i(), i(), 1)
+                )),
+                winner("load")
+            )),
+            fun("f_thread", seq(
+                if(o("cas", +0, +1), winner("add", +1)),
+                done("send", null)
+            ))
+        ))", test::int_t(1), ""},
+}))
+{
+    test::check_runner<test::script_runner_threads>(sample, sh_vars);
+}
+//! \endcond
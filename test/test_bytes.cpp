@@ -0,0 +1,721 @@
+/*! \file
+ * \brief Tests of class threadscript::basic_bytes
+ */
+
+//! \cond
+#include "threadscript/threadscript.hpp"
+#include "threadscript/symbol_table_impl.hpp"
+
+#define BOOST_TEST_MODULE bytes
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <boost/test/data/test_case.hpp>
+
+#include "script_runner.hpp"
+
+auto sh_vars = test::make_sh_vars<ts::bytes, ts::channel>();
+//! \endcond
+
+/*! \file
+ * \test \c create_object -- Creates a threadscript::basic_bytes object */
+//! \cond
+BOOST_DATA_TEST_CASE(create_object, (std::vector<test::runner_result>{
+    {R"(bytes(1, 2))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(bytes(null))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(bytes(true))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(bytes(-1))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(type(bytes()))", "bytes", ""},
+    {R"(is_mt_safe(bytes()))", false, ""},
+    {R"(seq(
+            var("b", bytes()),
+            b("size")
+        ))", test::uint_t(0U), ""},
+    {R"(seq(
+            var("b", bytes(+3)),
+            b("size")
+        ))", test::uint_t(3U), ""},
+    {R"(seq(
+            var("b", bytes(5)),
+            b("read_unsigned", 0, 5)
+        ))", test::uint_t(0U), ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("str")
+        ))", "abcdef", ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_append -- Tests method threadscript::basic_bytes::append() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_append, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("b", bytes()),
+            b("append")
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("b", bytes()),
+            b("append", null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("b", bytes()),
+            b("append", 1)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("b", bytes()),
+            mt_safe(b()),
+            b("append", "x")
+        ))", test::exc{
+            typeid(ts::exception::value_read_only),
+            ts::frame_location("", "", 4, 13),
+            "Runtime error: Read-only value"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("append", "gh"),
+            b("append", bytes("ij")),
+            print(b("size")),
+            b("str")
+        ))", "abcdefghij", "10"},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("append", b()),
+            b("str")
+        ))", "abcdefabcdef", ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            var("s", b("slice", 2, 4)),
+            b("append", s()),
+            b("str")
+        ))", "abcdefcd", ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            var("s", b("slice", 1, 3)),
+            s("append", "XY"),
+            print(s("str")),
+            b("str")
+        ))", "abcdef", "bcXY"},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            var("s", b("slice", 4)),
+            s("append", "XY"),
+            print(s("str")),
+            b("str")
+        ))", "abcdef", "efXY"},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            var("s", b("slice", 1, 3)),
+            mt_safe(b()),
+            s("append", "x")
+        ))", test::exc{
+            typeid(ts::exception::value_read_only),
+            ts::frame_location("", "", 5, 13),
+            "Runtime error: Read-only value"
+        }, ""},
+    {R"(seq(
+            var("b", bytes()),
+            var("i", clone(0)),
+            while(lt(i(), 1000), seq(b("append", "xy"), add(i(), i(), 1))),
+            b("size")
+        ))", test::uint_t(2000U), ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_concat -- Tests method threadscript::basic_bytes::concat() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_concat, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("b", bytes()),
+            b("concat")
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("b", bytes()),
+            b("concat", null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("b", bytes()),
+            b("concat", 1)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            var("c", b("concat", "gh")),
+            print(b("str")),
+            c("str")
+        ))", "abcdefgh", "abcdef"},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            var("c", b("concat", b())),
+            print(type(c())),
+            c("str")
+        ))", "abcdefabcdef", "bytes"},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            var("c", b("concat", "")),
+            c("write", 0, 1, 65),
+            print(c("str")),
+            b("str")
+        ))", "abcdef", "Abcdef"},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            mt_safe(b()),
+            var("c", b("concat", "g")),
+            c("write", 0, 1, 65),
+            c("str")
+        ))", "Abcdefg", ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_read_int -- Tests method
+ * threadscript::basic_bytes::read_int() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_read_int, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("read_int", 0)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("read_int", 0, 1, "big", 1)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("read_int", null, 1)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("read_int", 0, 1, null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("read_int", "0", 1)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("read_int", 0, 1, 1)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("read_int", 0, 0)
+        ))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("read_int", 0, 9)
+        ))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("read_int", 5, 2)
+        ))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("read_int", -1, 2)
+        ))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("read_int", 0, 2, "middle")
+        ))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("read_int", 0, 1)
+        ))", test::int_t(0x61), ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("read_int", 0, 2)
+        ))", test::int_t(0x6162), ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("read_int", 0, 2, "big")
+        ))", test::int_t(0x6162), ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("read_int", 1, 3, "little")
+        ))", test::int_t(0x646362), ""},
+    {R"(seq(
+            var("b", bytes(8)),
+            b("write", 0, 8, -2),
+            print(b("read_int", 6, 2)),
+            b("read_int", 0, 8)
+        ))", test::int_t(-2), "-2"},
+    {R"(seq(
+            var("b", bytes(3)),
+            b("write", 0, 3, 8388608),
+            b("read_int", 0, 3)
+        ))", test::int_t(-8388608), ""},
+    {R"(seq(
+            var("b", bytes(3)),
+            b("write", 0, 3, 8388607),
+            b("read_int", 0, 3)
+        ))", test::int_t(8388607), ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_read_unsigned -- Tests method
+ * threadscript::basic_bytes::read_unsigned() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_read_unsigned, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("read_unsigned", 0)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("read_unsigned", 0, 9)
+        ))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("read_unsigned", 6, 1)
+        ))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("read_unsigned", 5, 1)
+        ))", test::uint_t(0x66U), ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("read_unsigned", 0, 4)
+        ))", test::uint_t(0x61626364U), ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("read_unsigned", 0, 4, "little")
+        ))", test::uint_t(0x64636261U), ""},
+    {R"(seq(
+            var("b", bytes(8)),
+            b("write", 0, 8, -1),
+            b("read_unsigned", 0, 8)
+        ))", test::uint_t(~test::uint_t(0)), ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_size -- Tests method threadscript::basic_bytes::size() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_size, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("size", 1)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("size")
+        ))", test::uint_t(6U), ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            var("s", b("slice", 2, 5)),
+            s("size")
+        ))", test::uint_t(3U), ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_slice -- Tests method threadscript::basic_bytes::slice() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_slice, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("slice")
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("slice", 1, 2, 3)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("slice", null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("slice", "1")
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("slice", -1)
+        ))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            var("s", b("slice", 2)),
+            s("str")
+        ))", "cdef", ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            var("s", b("slice", 2, 4)),
+            s("str")
+        ))", "cd", ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            var("s", b("slice", 4, 100)),
+            s("str")
+        ))", "ef", ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            var("s", b("slice", 4, 2)),
+            s("size")
+        ))", test::uint_t(0U), ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            var("s", b("slice", 10, 20)),
+            s("size")
+        ))", test::uint_t(0U), ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            var("s", b("slice", 1, 5)),
+            var("t", s("slice", 1, 3)),
+            t("str")
+        ))", "cd", ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            var("s", b("slice", 2, 4)),
+            s("write", 1, 1, 88),
+            print(s("str")),
+            b("str")
+        ))", "abcXef", "cX"},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            var("s", b("slice", 2, 4)),
+            b("write", 2, 1, 88),
+            s("str")
+        ))", "Xd", ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            var("s", b("slice", 2, 4)),
+            print(is_mt_safe(s())),
+            mt_safe(b()),
+            var("t", b("slice", 2, 4)),
+            is_mt_safe(t())
+        ))", true, "false"},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            var("s", b("slice", 2, 4)),
+            mt_safe(b()),
+            s("write", 0, 1, 0)
+        ))", test::exc{
+            typeid(ts::exception::value_read_only),
+            ts::frame_location("", "", 5, 13),
+            "Runtime error: Read-only value"
+        }, ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_str -- Tests method threadscript::basic_bytes::str() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_str, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("str", 1)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("b", bytes()),
+            b("str")
+        ))", "", ""},
+    {R"(seq(
+            var("b", bytes(2)),
+            b("write", 0, 2, 16706),
+            b("str")
+        ))", "AB", ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            var("s", b("slice", 3)),
+            s("str")
+        ))", "def", ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_write -- Tests method threadscript::basic_bytes::write() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_write, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("write", 0, 1)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("write", 0, 1, 1, "big", 1)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("write", 0, 1, null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("write", 0, 1, "a")
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("write", 0, 9, 1)
+        ))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("write", 4, 3, 1)
+        ))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("write", 0, 2, 1, "")
+        ))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            mt_safe(b()),
+            b("write", 0, 1, 1)
+        ))", test::exc{
+            typeid(ts::exception::value_read_only),
+            ts::frame_location("", "", 4, 13),
+            "Runtime error: Read-only value"
+        }, ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            print(b("write", 1, 2, 16706)),
+            b("str")
+        ))", "aABdef", "null"},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("write", 1, 2, 16706, "little"),
+            b("str")
+        ))", "aBAdef", ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("write", 0, 1, 833),
+            b("str")
+        ))", "Abcdef", ""},
+    {R"(seq(
+            var("b", bytes("abcdef")),
+            b("write", 0, 2, -1),
+            b("read_unsigned", 0, 2)
+        ))", test::uint_t(0xffffU), ""},
+    {R"(seq(
+            var("b", bytes(8)),
+            b("write", 0, 8, 18446744073709551615, "little"),
+            b("read_int", 0, 8)
+        ))", test::int_t(-1), ""},
+    {R"(seq(
+            var("b", bytes("ab")),
+            b("write", 0, 1, seq(
+                b("append", "0123456789"),
+                65
+            )),
+            substr(b("str"), 0, 4)
+        ))", "Ab01", ""},
+    {R"(seq(
+            var("b", bytes("ab")),
+            b("write", 0, 2, 16706, seq(
+                b("append", "0123456789"),
+                "little"
+            )),
+            substr(b("str"), 0, 4)
+        ))", "BA01", ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c threads -- Sharing a thread-safe threadscript::basic_bytes object
+ * among threads */
+//! \cond
+BOOST_DATA_TEST_CASE(threads, (std::vector<test::runner_result>{
+    {R"(seq(
+            gvar("num_threads", 8),
+            var("b", bytes(16)),
+            var("i", clone(0)),
+            while(lt(i(), 16), seq(
+                b("write", i(), 1, i()),
+                add(i(), i(), 1)
+            )),
+            gvar("data", mt_safe(b("slice", 8))),
+            gvar("result", channel(0)),
+            fun("f_main", seq(
+                var("total", clone(0)),
+                var("i", clone(0)),
+                while(lt(i(), num_threads()), seq(
+                    add(total(), total(), result("recv")),
+                    add(i(), i(), 1)
+                )),
+                total()
+            )),
+            fun("f_thread", seq(
+                var("s", data("slice", at(_args(), 0))),
+                result("send", mt_safe(s("read_unsigned", 0, 1)))
+            ))
+        ))", test::uint_t(8U + 9U + 10U + 11U + 12U + 13U + 14U + 15U), ""},
+}))
+{
+    test::check_runner<test::script_runner_threads>(sample, sh_vars);
+}
+//! \endcond
@@ -27,7 +27,7 @@ BOOST_DATA_TEST_CASE(create_object, (std::vector<test::runner_result>{
             ts::frame_location("", "", 1, 1),
             "Runtime error: Bad number of arguments"
         }, ""},
-    {R"(channel(1, 2))", test::exc{
+    {R"(channel(1, 2, 3))", test::exc{
             typeid(ts::exception::op_narg),
             ts::frame_location("", "", 1, 1),
             "Runtime error: Bad number of arguments"
@@ -72,6 +72,24 @@ BOOST_DATA_TEST_CASE(create_object, (std::vector<test::runner_result>{
     {R"(type(channel(2)))", "channel", ""},
     {R"(type(channel(20)))", "channel", ""},
     {R"(type(channel(+100)))", "channel", ""},
+    {R"(channel(1, null))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(channel(1, "2"))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(channel(1, -1))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(type(channel(0, 0)))", "channel", ""},
+    {R"(type(channel(0, 100)))", "channel", ""},
+    {R"(type(channel(10, +100)))", "channel", ""},
 }))
 {
     test::check_runner(sample, sh_vars);
@@ -129,6 +147,151 @@ BOOST_DATA_TEST_CASE(method_recv, (std::vector<test::runner_result>{
 }
 //! \endcond
 
+/*! \file
+ * \test \c method_recv_for -- Tests method
+ * threadscript::basic_channel::recv_for() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_recv_for, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", channel(1)),
+            o("recv_for")
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", channel(1)),
+            o("recv_for", 1, 2)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", channel(1)),
+            o("recv_for", null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", channel(1)),
+            o("recv_for", "1")
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", channel(1)),
+            o("recv_for", -1)
+        ))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(seq(
+            var("o", channel(1)),
+            o("recv_for", 10)
+        ))", test::exc{
+            typeid(ts::exception::op_would_block),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Operation would block"
+        }, ""},
+    {R"(seq(
+            var("o", channel(1, 20)),
+            o("recv_for", 0)
+        ))", test::exc{
+            typeid(ts::exception::op_would_block),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Operation would block"
+        }, ""},
+    {R"(seq(
+            var("o", channel(0)),
+            o("recv_for", 10)
+        ))", test::exc{
+            typeid(ts::exception::op_would_block),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Operation would block"
+        }, ""},
+    {R"(seq(
+            var("o", channel(0, 20)),
+            try(o("recv_for", +10), "", null),
+            o("balance")
+        ))", test::int_t(0), ""},
+    {R"(seq(
+            var("o", channel(2)),
+            o("send", 1),
+            o("send", null),
+            print(o("recv_for", 0)),
+            o("recv_for", 10)
+        ))", nullptr, "1"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_recv_many -- Tests method
+ * threadscript::basic_channel::recv_many() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_recv_many, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", channel(1)),
+            o("recv_many")
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", channel(1)),
+            o("recv_many", null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", channel(1)),
+            o("recv_many", "1")
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", channel(1)),
+            o("recv_many", 0)
+        ))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(seq(
+            var("o", channel(5)),
+            o("send", "a"),
+            var("v", o("recv_many", 3)),
+            print(size(v()), at(v(), 0))
+        ))", nullptr, "1a"},
+    {R"(seq(
+            var("o", channel(5)),
+            o("send", "a"), o("send", null), o("send", "c"), o("send", "d"),
+            var("v", o("recv_many", 3)),
+            print(size(v()), at(v(), 0), at(v(), 1), at(v(), 2)),
+            var("v", o("recv_many", 3)),
+            print(size(v()), at(v(), 0)),
+            is_mt_safe(v())
+        ))", false, "3anullc1d"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
 /*! \file
  * \test \c method_send -- Tests method threadscript::basic_channel::send() */
 //! \cond
@@ -167,6 +330,167 @@ BOOST_DATA_TEST_CASE(method_send, (std::vector<test::runner_result>{
 }
 //! \endcond
 
+/*! \file
+ * \test \c method_send_for -- Tests method
+ * threadscript::basic_channel::send_for() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_send_for, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", channel(1)),
+            o("send_for", 1)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", channel(1)),
+            o("send_for", 1, 2, 3)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", channel(1)),
+            o("send_for", clone(1), 10)
+        ))", test::exc{
+            typeid(ts::exception::value_mt_unsafe),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Thread-unsafe value"
+        }, ""},
+    {R"(seq(
+            var("o", channel(1)),
+            o("send_for", 1, null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", channel(1)),
+            o("send_for", 1, -1)
+        ))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(seq(
+            var("o", channel(1)),
+            o("send", 1),
+            o("send_for", 2, 10)
+        ))", test::exc{
+            typeid(ts::exception::op_would_block),
+            ts::frame_location("", "", 4, 13),
+            "Runtime error: Operation would block"
+        }, ""},
+    {R"(seq(
+            var("o", channel(1, 20)),
+            o("send", 1),
+            o("send_for", 2, 0)
+        ))", test::exc{
+            typeid(ts::exception::op_would_block),
+            ts::frame_location("", "", 4, 13),
+            "Runtime error: Operation would block"
+        }, ""},
+    {R"(seq(
+            var("o", channel(0)),
+            o("send_for", 1, 10)
+        ))", test::exc{
+            typeid(ts::exception::op_would_block),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Operation would block"
+        }, ""},
+    {R"(seq(
+            var("o", channel(0, 20)),
+            try(o("send_for", 1, +10), "", null),
+            o("balance")
+        ))", test::int_t(0), ""},
+    {R"(seq(
+            var("o", channel(2)),
+            print(o("send_for", 1, 0)),
+            o("send_for", 2, 10),
+            print(o("recv")),
+            o("recv")
+        ))", test::uint_t(2U), "null1"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_send_many -- Tests method
+ * threadscript::basic_channel::send_many() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_send_many, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", channel(1)),
+            o("send_many")
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", channel(1)),
+            o("send_many", null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", channel(1)),
+            o("send_many", "a")
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", channel(3)),
+            var("v", vector()),
+            at(v(), 0, "a"),
+            at(v(), 1, clone("b")),
+            o("send_many", v())
+        ))", test::exc{
+            typeid(ts::exception::value_mt_unsafe),
+            ts::frame_location("", "", 6, 13),
+            "Runtime error: Thread-unsafe value"
+        }, ""},
+    {R"(seq(
+            var("o", channel(3)),
+            var("v", vector()),
+            at(v(), 0, "a"),
+            at(v(), 1, clone("b")),
+            try(o("send_many", v()), "", null),
+            o("try_recv")
+        ))", test::exc{
+            typeid(ts::exception::op_would_block),
+            ts::frame_location("", "", 7, 13),
+            "Runtime error: Operation would block"
+        }, ""},
+    {R"(seq(
+            var("o", channel(3)),
+            o("send_many", vector()),
+            o("balance")
+        ))", test::int_t(0), ""},
+    {R"(seq(
+            var("o", channel(3)),
+            var("v", vector()),
+            at(v(), 0, "a"),
+            at(v(), 1, null),
+            at(v(), 2, "c"),
+            print(o("send_many", v())),
+            print(o("recv"), o("recv"), o("recv"))
+        ))", nullptr, "nullanullc"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
 /*! \file
  * \test \c method_try_recv -- Tests method
  * threadscript::basic_channel::try_recv() */
@@ -212,6 +536,62 @@ BOOST_DATA_TEST_CASE(method_try_recv, (std::vector<test::runner_result>{
 }
 //! \endcond
 
+/*! \file
+ * \test \c method_try_recv_many -- Tests method
+ * threadscript::basic_channel::try_recv_many() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_try_recv_many, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", channel(1)),
+            o("try_recv_many", 1, 2)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", channel(1)),
+            o("try_recv_many", -1)
+        ))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(seq(
+            var("o", channel(0)),
+            o("try_recv_many", 1)
+        ))", test::exc{
+            typeid(ts::exception::op_would_block),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Operation would block"
+        }, ""},
+    {R"(seq(
+            var("o", channel(2)),
+            o("try_recv_many", 2)
+        ))", test::exc{
+            typeid(ts::exception::op_would_block),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Operation would block"
+        }, ""},
+    {R"(seq(
+            var("o", channel(4)),
+            o("send", "a"), o("send", "b"), o("send", "c"),
+            var("v", o("try_recv_many", 2)),
+            print(size(v()), at(v(), 0), at(v(), 1)),
+            var("v", o("try_recv_many", 2)),
+            print(size(v()), at(v(), 0)),
+            o("try_recv_many", 2)
+        ))", test::exc{
+            typeid(ts::exception::op_would_block),
+            ts::frame_location("", "", 8, 13),
+            "Runtime error: Operation would block"
+        }, "2ab1c"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
 /*! \file
  * \test \c method_try_send -- Tests method
  * threadscript::basic_channel::try_send() */
@@ -276,6 +656,254 @@ BOOST_DATA_TEST_CASE(method_try_send, (std::vector<test::runner_result>{
 }
 //! \endcond
 
+/*! \file
+ * \test \c method_try_send_many -- Tests method
+ * threadscript::basic_channel::try_send_many() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_try_send_many, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", channel(1)),
+            o("try_send_many")
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", channel(1)),
+            o("try_send_many", 1)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", channel(1)),
+            var("v", vector()),
+            at(v(), 0, clone(1)),
+            o("try_send_many", v())
+        ))", test::exc{
+            typeid(ts::exception::value_mt_unsafe),
+            ts::frame_location("", "", 5, 13),
+            "Runtime error: Thread-unsafe value"
+        }, ""},
+    {R"(seq(
+            var("o", channel(0)),
+            var("v", vector()),
+            at(v(), 0, "a"),
+            o("try_send_many", v())
+        ))", test::exc{
+            typeid(ts::exception::op_would_block),
+            ts::frame_location("", "", 5, 13),
+            "Runtime error: Operation would block"
+        }, ""},
+    {R"(seq(
+            var("o", channel(0)),
+            o("try_send_many", vector())
+        ))", test::uint_t(0U), ""},
+    {R"(seq(
+            var("o", channel(2)),
+            var("v", vector()),
+            at(v(), 0, "a"),
+            at(v(), 1, "b"),
+            at(v(), 2, "c"),
+            print(o("try_send_many", v())),
+            print(o("recv"), o("recv")),
+            o("try_send_many", v())
+        ))", test::uint_t(2U), "2ab"},
+    {R"(seq(
+            var("o", channel(2)),
+            var("v", vector()),
+            at(v(), 0, "a"),
+            at(v(), 1, "b"),
+            o("try_send_many", v()),
+            o("try_send_many", v())
+        ))", test::exc{
+            typeid(ts::exception::op_would_block),
+            ts::frame_location("", "", 7, 13),
+            "Runtime error: Operation would block"
+        }, ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c fun_select -- Tests function threadscript::predef::f_select in
+ * a single thread */
+//! \cond
+BOOST_DATA_TEST_CASE(fun_select, (std::vector<test::runner_result>{
+    {R"(select())", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(select(vector(), 1, 2))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(select(null))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(select(channel(1)))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(select(vector()))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(select(vector(), null))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(select(vector(), -1))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(select(vector(), 0))", nullptr, ""},
+    {R"(seq(
+            var("ops", vector()),
+            at(ops(), 1, channel(1)),
+            select(ops(), 0)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 4, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("ops", vector()),
+            at(ops(), 0, "channel"),
+            select(ops(), 0)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 4, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("ops", vector()),
+            var("op", vector()),
+            at(op(), 0, channel(1)),
+            at(ops(), 0, op()),
+            select(ops(), 0)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 6, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("ops", vector()),
+            var("op", vector()),
+            at(op(), 0, 1),
+            at(op(), 1, mt_safe(2)),
+            at(ops(), 0, op()),
+            select(ops(), 0)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 7, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("ops", vector()),
+            var("op", vector()),
+            at(op(), 0, channel(1)),
+            at(op(), 1, clone(2)),
+            at(ops(), 0, op()),
+            select(ops(), 0)
+        ))", test::exc{
+            typeid(ts::exception::value_mt_unsafe),
+            ts::frame_location("", "", 7, 13),
+            "Runtime error: Thread-unsafe value"
+        }, ""},
+    {R"(seq(
+            # receive from a ready channel
+            var("c1", channel(1)),
+            var("c2", channel(1)),
+            c2("send", mt_safe("abc")),
+            var("ops", vector()),
+            at(ops(), 0, c1()),
+            at(ops(), 1, c2()),
+            var("r", select(ops())),
+            print(size(r()), ":", at(r(), 0), ":", at(r(), 1)),
+            select(ops(), 0)
+        ))", nullptr, "2:1:abc"},
+    {R"(seq(
+            # send to a ready channel, a full channel is not selected
+            var("c1", channel(1)),
+            var("c2", channel(1)),
+            c1("send", mt_safe(1)),
+            var("ops", vector()),
+            var("op", vector()),
+            at(op(), 0, c1()),
+            at(op(), 1, mt_safe(2)),
+            at(ops(), 0, op()),
+            var("op", vector()),
+            at(op(), 0, c2()),
+            at(op(), 1, null),
+            at(ops(), 1, op()),
+            var("r", select(ops())),
+            print(at(r(), 0), ":", at(r(), 1), ":", c2("try_recv")),
+            c1("recv")
+        ))", test::uint_t(1U), "1:null:null"},
+    {R"(seq(
+            # timeout for an empty and a full channel
+            var("c1", channel(1)),
+            var("c2", channel(1)),
+            c2("send", mt_safe(1)),
+            var("ops", vector()),
+            at(ops(), 0, c1()),
+            var("op", vector()),
+            at(op(), 0, c2()),
+            at(op(), 1, mt_safe(2)),
+            at(ops(), 1, op()),
+            select(ops(), 10)
+        ))", nullptr, ""},
+    {R"(seq(
+            # timeout for a zero-capacity channel
+            var("c", channel(0)),
+            var("ops", vector()),
+            at(ops(), 0, c()),
+            select(ops(), +5)
+        ))", nullptr, ""},
+    {R"(seq(
+            # all ready operations are selected eventually
+            var("c1", channel(100)),
+            var("c2", channel(100)),
+            var("ops", vector()),
+            at(ops(), 0, c1()),
+            at(ops(), 1, c2()),
+            var("i", clone(0)),
+            while(lt(i(), 100), seq(
+                c1("send", mt_safe(1)),
+                c2("send", mt_safe(2)),
+                add(i(), i(), 1)
+            )),
+            var("n", vector()),
+            at(n(), 0, clone(0)),
+            at(n(), 1, clone(0)),
+            var("i", clone(0)),
+            while(lt(i(), 100), seq(
+                var("r", select(ops())),
+                var("k", at(n(), at(r(), 0))),
+                add(k(), k(), 1),
+                add(i(), i(), 1)
+            )),
+            and(gt(at(n(), 0), 0), gt(at(n(), 1), 0))
+        ))", true, ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
 /*! \file
  * \test \c types -- Tests sending and receiving data of various types */
 //! \cond
@@ -879,6 +1507,229 @@ BOOST_DATA_TEST_CASE(threads, (std::vector<test::runner_result>{
                 ))
             ))
         ))", nullptr, ""},
+    {R"(seq(
+            # M-to-1, capacity 1, check that no value is lost or duplicated
+            gvar("num_threads", 8),
+            gvar("o", channel(1)),
+            gvar("num_vals", 500),
+            fun("f_main", seq(
+                var("total", clone(0)),
+                var("i", clone(0)),
+                while(lt(i(), mul(num_threads(), num_vals())), seq(
+                    add(total(), total(), o("recv")),
+                    add(i(), i(), 1)
+                )),
+                total()
+            )),
+            fun("f_thread", seq(
+                var("i", clone(0)),
+                while(lt(i(), num_vals()), seq(
+                    o("send", mt_safe(add(at(_args(), 0), 1))),
+                    add(i(), i(), 1)
+                ))
+            ))
+        ))", test::uint_t(500U * (1U + 2U + 3U + 4U + 5U + 6U + 7U + 8U)),
+        ""},
+    {R"(seq(
+            # M-to-1, batches of messages
+            gvar("num_threads", 4),
+            gvar("o", channel(3)),
+            gvar("num_vals", 100),
+            fun("f_main", seq(
+                var("total", clone(0)),
+                var("n", clone(0)),
+                while(lt(n(), mul(num_threads(), num_vals())), seq(
+                    var("v", o("recv_many", 5)),
+                    add(n(), n(), size(v())),
+                    var("i", clone(0)),
+                    while(lt(i(), size(v())), seq(
+                        add(total(), total(), at(v(), i())),
+                        add(i(), i(), 1)
+                    ))
+                )),
+                total()
+            )),
+            fun("f_thread", seq(
+                var("v", vector()),
+                var("i", clone(0)),
+                while(lt(i(), num_vals()), seq(
+                    at(v(), i(), mt_safe(clone(i()))),
+                    add(i(), i(), 1)
+                )),
+                o("send_many", v())
+            ))
+        ))", test::uint_t(4U * (99U * 100U / 2U)), ""},
+    {R"(seq(
+            # 1-to-1, capacity 0, batches of messages
+            gvar("num_threads", 1),
+            gvar("o", channel(0)),
+            fun("f_main", seq(
+                var("n", clone(0)),
+                while(lt(n(), 10), seq(
+                    var("v", o("recv_many", 4)),
+                    add(n(), n(), size(v()))
+                )),
+                n()
+            )),
+            fun("f_thread", seq(
+                var("v", vector()),
+                var("i", clone(0)),
+                while(lt(i(), 10), seq(
+                    at(v(), i(), mt_safe(clone(i()))),
+                    add(i(), i(), 1)
+                )),
+                o("send_many", v())
+            ))
+        ))", test::uint_t(10U), ""},
+    {R"(seq(
+            # 2-to-1, select among a zero-capacity and a buffered channel
+            gvar("num_threads", 2),
+            gvar("c0", channel(0)),
+            gvar("c1", channel(2)),
+            gvar("num_vals", 100),
+            fun("f_main", seq(
+                var("ops", vector()),
+                at(ops(), 0, c0()),
+                at(ops(), 1, c1()),
+                var("total", clone(0)),
+                var("i", clone(0)),
+                while(lt(i(), mul(num_threads(), num_vals())), seq(
+                    var("r", select(ops())),
+                    add(total(), total(), at(r(), 1)),
+                    add(i(), i(), 1)
+                )),
+                total()
+            )),
+            fun("f_thread", seq(
+                var("c", if(eq(at(_args(), 0), 0), c0(), c1())),
+                var("i", clone(0)),
+                while(lt(i(), num_vals()), seq(
+                    c("send", mt_safe(add(at(_args(), 0), 1))),
+                    add(i(), i(), 1)
+                ))
+            ))
+        ))", test::uint_t(100U * (1U + 2U)), ""},
+    {R"(seq(
+            # 1-to-1, select sending to a zero-capacity channel
+            gvar("num_threads", 1),
+            gvar("c", channel(0)),
+            fun("f_main", seq(
+                var("total", clone(0)),
+                var("i", clone(0)),
+                while(lt(i(), 100), seq(
+                    add(total(), total(), c("recv")),
+                    add(i(), i(), 1)
+                )),
+                total()
+            )),
+            fun("f_thread", seq(
+                var("ops", vector()),
+                var("op", vector()),
+                at(op(), 0, c()),
+                at(ops(), 0, op()),
+                var("i", clone(0)),
+                while(lt(i(), 100), seq(
+                    at(op(), 1, mt_safe(clone(i()))),
+                    select(ops()),
+                    add(i(), i(), 1)
+                ))
+            ))
+        ))", test::uint_t(99U * 100U / 2U), ""},
+    {R"(seq(
+            # request/response over zero-capacity channels with spinning
+            gvar("num_threads", 1),
+            gvar("req", channel(0, 100)),
+            gvar("resp", channel(0, 100)),
+            fun("f_main", seq(
+                var("total", clone(0)),
+                var("i", clone(0)),
+                while(lt(i(), 100), seq(
+                    req("send", mt_safe(clone(i()))),
+                    add(total(), total(), resp("recv")),
+                    add(i(), i(), 1)
+                )),
+                req("send", null),
+                total()
+            )),
+            fun("f_thread", seq(
+                var("v", req("recv")),
+                while(not(is_null(v())), seq(
+                    resp("send", mt_safe(mul(v(), 2))),
+                    var("v", req("recv"))
+                ))
+            ))
+        ))", test::uint_t(99U * 100U), ""},
+    {R"(seq(
+            # M-to-1, capacity 1, with spinning and timeouts
+            gvar("num_threads", 4),
+            gvar("o", channel(1, 10)),
+            gvar("num_vals", 100),
+            fun("f_main", seq(
+                var("total", clone(0)),
+                var("i", clone(0)),
+                while(lt(i(), mul(num_threads(), num_vals())), seq(
+                    try(seq(
+                        add(total(), total(), o("recv_for", 1)),
+                        add(i(), i(), 1)
+                    ), "", null)
+                )),
+                total()
+            )),
+            fun("f_thread", seq(
+                var("i", clone(0)),
+                while(lt(i(), num_vals()), seq(
+                    try(seq(
+                        o("send_for", mt_safe(add(at(_args(), 0), 1)), 1),
+                        add(i(), i(), 1)
+                    ), "", null)
+                ))
+            ))
+        ))", test::uint_t(100U * (1U + 2U + 3U + 4U)), ""},
+    {R"(seq(
+            # M-to-N, capacity 0, with timeouts
+            gvar("num_threads", 4),
+            gvar("o", channel(0)),
+            gvar("num_vals", 50),
+            fun("f_main", null),
+            fun("f_thread", seq(
+                var("i", clone(0)),
+                while(lt(i(), num_vals()), seq(
+                    try(seq(
+                        if(lt(at(_args(), 0), 2),
+                            o("send_for", 1, 1),
+                            o("recv_for", 1)
+                        ),
+                        add(i(), i(), 1)
+                    ), "", null)
+                ))
+            ))
+        ))", nullptr, ""},
+    {R"(seq(
+            # recv_for with the maximum timeout waits for a delayed send
+            gvar("num_threads", 1),
+            gvar("o", channel(1)),
+            gvar("delay", channel(1)),
+            fun("f_main", o("recv_for", 18446744073709551615)),
+            fun("f_thread", seq(
+                try(delay("recv_for", 50), "", null),
+                o("send", "MSG")
+            ))
+        ))", "MSG", ""},
+    {R"(seq(
+            # select with the maximum timeout waits for a delayed send
+            gvar("num_threads", 1),
+            gvar("o", channel(1)),
+            gvar("delay", channel(1)),
+            fun("f_main", seq(
+                var("ops", vector()),
+                at(ops(), 0, o()),
+                at(select(ops(), 18446744073709551615), 1)
+            )),
+            fun("f_thread", seq(
+                try(delay("recv_for", 50), "", null),
+                o("send", "MSG")
+            ))
+        ))", "MSG", ""},
 }))
 {
     test::check_runner<test::script_runner_threads>(sample, sh_vars);
@@ -0,0 +1,183 @@
+/*! \file
+ * \brief Tests of the binary form of scripts and of the cache of parsed
+ * scripts
+ */
+
+//! \cond
+#include "threadscript/threadscript.hpp"
+
+#define BOOST_TEST_MODULE code_cache
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <boost/test/data/test_case.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <unistd.h>
+
+namespace ts = threadscript;
+
+namespace test {
+
+ts::allocator_any alloc;
+
+// Scripts containing all kinds of nodes and values
+const std::vector<std::string> scripts{
+    "null",
+    "true",
+    R"(print("Hello World!"))",
+    R"(print(true, false, null, 0, 1, -1, +123, -9223372036854775808,
+        18446744073709551615, "", "a\"b\\c\n", ""))",
+    R"(seq(
+        fun("f", add(at(_args(), 0), +1)),
+        var("v", vector()),
+        at(v(), 0, -42),
+        print(f(+1), " ", at(v(), 0), "\n")
+    ))",
+};
+
+// Runs a script and returns its output
+std::string run(const ts::script& script)
+{
+    std::ostringstream os;
+    ts::virtual_machine vm{alloc};
+    vm.sh_vars = ts::predef_symbols(alloc);
+    ts::state thread{vm};
+    thread.std_out = &os;
+    script.eval(thread);
+    return os.str();
+}
+
+} // namespace test
+//! \endcond
+
+/*! \file
+ * \test \c round_trip -- A script converted to the binary form and back is
+ * equal to the original script */
+//! \cond
+BOOST_DATA_TEST_CASE(round_trip, test::scripts)
+{
+    auto key = ts::code_cache::key(sample, ts::syntax_factory::syntax_canon);
+    auto parsed = ts::parse_code(test::alloc, sample, "file.ts");
+    auto data = ts::serialize_script(*parsed, key);
+    BOOST_TEST(data.starts_with(ts::code_cache::magic));
+    auto loaded = ts::deserialize_script(test::alloc, data, key, "file.ts");
+    BOOST_REQUIRE(loaded);
+    BOOST_CHECK(*loaded == *parsed);
+    BOOST_CHECK_EQUAL(loaded->file(), "file.ts");
+    BOOST_CHECK_EQUAL(test::run(*loaded), test::run(*parsed));
+    BOOST_CHECK_EQUAL(ts::serialize_script(*loaded, key), data);
+}
+//! \endcond
+
+/*! \file
+ * \test \c resolved -- A resolved script is stored as unresolved */
+//! \cond
+BOOST_AUTO_TEST_CASE(resolved)
+{
+    auto& src = test::scripts.back();
+    auto parsed = ts::parse_code(test::alloc, src, "file.ts");
+    auto data = ts::serialize_script(*parsed, 1);
+    auto sym = ts::predef_symbols(test::alloc);
+    parsed->resolve(*sym, false, false);
+    BOOST_CHECK_EQUAL(ts::serialize_script(*parsed, 1), data);
+    parsed->unresolve();
+}
+//! \endcond
+
+/*! \file
+ * \test \c key -- Keys of scripts */
+//! \cond
+BOOST_AUTO_TEST_CASE(key)
+{
+    auto canon = ts::syntax_factory::syntax_canon;
+    BOOST_CHECK_EQUAL(ts::code_cache::key("null", canon),
+                      ts::code_cache::key("null", canon));
+    BOOST_CHECK_NE(ts::code_cache::key("null", canon),
+                   ts::code_cache::key("true", canon));
+    BOOST_CHECK_NE(ts::code_cache::key("null", canon),
+                   ts::code_cache::key("null", "other"));
+    auto parsed = ts::parse_code(test::alloc, "null", "file.ts");
+    auto data = ts::serialize_script(*parsed, 1);
+    BOOST_CHECK(ts::deserialize_script(test::alloc, data, 1, "file.ts"));
+    BOOST_CHECK(!ts::deserialize_script(test::alloc, data, 2, "file.ts"));
+    BOOST_CHECK_EQUAL(ts::code_cache::path("dir", 0x1234),
+                      (std::filesystem::path("dir") /
+                       "0000000000001234.tsc").string());
+}
+//! \endcond
+
+/*! \file
+ * \test \c malformed -- Invalid binary data are rejected */
+//! \cond
+BOOST_AUTO_TEST_CASE(malformed)
+{
+    auto parsed = ts::parse_code(test::alloc, test::scripts.back(), "file.ts");
+    auto data = ts::serialize_script(*parsed, 1);
+    BOOST_REQUIRE(ts::deserialize_script(test::alloc, data, 1, "file.ts"));
+    for (size_t i = 0; i < data.size(); ++i) {
+        BOOST_TEST_INFO("size=" << i);
+        BOOST_CHECK(!ts::deserialize_script(test::alloc, data.substr(0, i), 1,
+                                            "file.ts"));
+    }
+    BOOST_CHECK(!ts::deserialize_script(test::alloc, data + "x", 1,
+                                        "file.ts"));
+    auto bad = data;
+    bad[0] = 'X';
+    BOOST_CHECK(!ts::deserialize_script(test::alloc, bad, 1, "file.ts"));
+    bad = data;
+    bad[ts::code_cache::magic.size()] =
+        char(ts::code_cache::format_version + 1);
+    BOOST_CHECK(!ts::deserialize_script(test::alloc, bad, 1, "file.ts"));
+}
+//! \endcond
+
+/*! \file
+ * \test \c cache_dir -- Function threadscript::parse_code_file_cached() */
+//! \cond
+BOOST_AUTO_TEST_CASE(cache_dir)
+{
+    auto dir = std::filesystem::temp_directory_path() /
+        ("test_code_cache." + std::to_string(getpid()));
+    std::filesystem::remove_all(dir);
+    auto file = (dir / "script.ts").string();
+    auto cache = (dir / "cache").string();
+    std::filesystem::create_directories(dir);
+    std::ofstream(file) << test::scripts.back();
+    // The first call parses the script and stores it in the cache
+    auto parsed = ts::parse_code_file_cached(test::alloc, file, cache);
+    BOOST_REQUIRE(parsed);
+    auto key = ts::code_cache::key(test::scripts.back(),
+                                   ts::syntax_factory::syntax_canon);
+    auto path = ts::code_cache::path(cache, key);
+    BOOST_REQUIRE(std::filesystem::exists(path));
+    BOOST_CHECK_EQUAL(test::run(*parsed), "2 -42\n");
+    // The second call loads the script from the cache
+    auto other = ts::parse_code(test::alloc, R"(print("cached"))", file);
+    std::ofstream(path, std::ios::binary | std::ios::trunc) <<
+        ts::serialize_script(*other, key);
+    auto loaded = ts::parse_code_file_cached(test::alloc, file, cache);
+    BOOST_REQUIRE(loaded);
+    BOOST_CHECK_EQUAL(test::run(*loaded), "cached");
+    // An invalid cache file is replaced
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "invalid";
+    loaded = ts::parse_code_file_cached(test::alloc, file, cache);
+    BOOST_REQUIRE(loaded);
+    BOOST_CHECK(*loaded == *parsed);
+    BOOST_CHECK(ts::deserialize_script(test::alloc,
+                    ts::code_cache::read_cache(path).value_or(""), key, file));
+    // A modified script is parsed again
+    std::ofstream(file) << R"(print("modified"))";
+    loaded = ts::parse_code_file_cached(test::alloc, file, cache);
+    BOOST_REQUIRE(loaded);
+    BOOST_CHECK_EQUAL(test::run(*loaded), "modified");
+    // A missing script
+    BOOST_CHECK_THROW(ts::parse_code_file_cached(test::alloc,
+                                                 (dir / "missing.ts").string(),
+                                                 cache),
+                      std::ios_base::failure);
+    std::filesystem::remove_all(dir);
+}
+//! \endcond
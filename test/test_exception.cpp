@@ -631,6 +631,33 @@ BOOST_AUTO_TEST_CASE(op_would_block)
 }
 //! \endcond
 
+/*! \file
+ * \test \c op_import_cycle -- Class threadscript::exception::op_import_cycle */
+//! \cond
+BOOST_AUTO_TEST_CASE(op_import_cycle)
+{
+    ex::op_import_cycle exc({ts::frame_location{"main", "script", 10, 1}});
+    BOOST_TEST(exc.type() == "op_import_cycle");
+    BOOST_TEST(exc.trace().size() == 1);
+    BOOST_TEST(exc.to_string(false) ==
+               "script:10:1:main(): Runtime error: Import cycle");
+}
+//! \endcond
+
+/*! \file
+ * \test \c op_import_not_found -- Class
+ * threadscript::exception::op_import_not_found */
+//! \cond
+BOOST_AUTO_TEST_CASE(op_import_not_found)
+{
+    ex::op_import_not_found exc({ts::frame_location{"main", "script", 10, 1}});
+    BOOST_TEST(exc.type() == "op_import_not_found");
+    BOOST_TEST(exc.trace().size() == 1);
+    BOOST_TEST(exc.to_string(false) ==
+               "script:10:1:main(): Runtime error: Module not found");
+}
+//! \endcond
+
 /*! \file
  * \test \c op_library -- Class threadscript::exception::op_library */
 //! \cond
@@ -0,0 +1,393 @@
+/*! \file
+ * \brief Tests of function \c spawn and class threadscript::basic_future
+ */
+
+//! \cond
+#include "threadscript/threadscript.hpp"
+#include "threadscript/symbol_table_impl.hpp"
+
+#define BOOST_TEST_MODULE future
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <boost/test/data/test_case.hpp>
+
+#include "script_runner.hpp"
+
+auto sh_vars = test::make_sh_vars<ts::channel>();
+//! \endcond
+
+/*! \file
+ * \test \c fun_spawn -- Function \c spawn creating a
+ * threadscript::basic_future object */
+//! \cond
+BOOST_DATA_TEST_CASE(fun_spawn, (std::vector<test::runner_result>{
+    {R"(spawn())", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(spawn(null))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(spawn(1))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(spawn("f"))", test::exc{
+            typeid(ts::exception::unknown_symbol),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Symbol not found: f"
+        }, ""},
+    {R"(spawn("add", 1, 2))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(gvar("f", 1), spawn("f")))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 1, 19),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(fun("f", 1), spawn("f", vector())))", test::exc{
+            typeid(ts::exception::value_mt_unsafe),
+            ts::frame_location("", "", 1, 18),
+            "Runtime error: Thread-unsafe value"
+        }, ""},
+    {R"(future())", test::exc{
+            typeid(ts::exception::unknown_symbol),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Symbol not found: future"
+        }, ""},
+    {R"(seq(fun("f", 1), type(spawn("f"))))", "future", ""},
+    {R"(seq(fun("f", 1), is_mt_safe(spawn("f"))))", true, ""},
+    {R"(seq(fun("f", 1), var("r", spawn("f")), r("get")))", test::uint_t(1),
+        ""},
+    {R"(seq(
+            fun("f", add(at(_args(), 0), at(_args(), 1))),
+            var("r", spawn("f", 1, 2)),
+            r("get")
+        ))", test::uint_t(3), ""},
+    {R"(seq(
+            fun("f", size(_args())),
+            var("r", spawn("f", 1, "a", null, mt_safe(vector()))),
+            r("get")
+        ))", test::uint_t(4), ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_get -- Method threadscript::basic_future::get() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_get, (std::vector<test::runner_result>{
+    {R"(seq(fun("f", 1), var("r", spawn("f")), r("get", 1)))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 40),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(fun("f", null), var("r", spawn("f")), is_null(r("get"))))", true,
+        ""},
+    {R"(seq(
+            fun("f", clone(1)),
+            var("r", spawn("f")),
+            and(is_same(r("get"), r("get")), is_mt_safe(r("get")))
+        ))", true, ""},
+    {R"(seq(
+            fun("f", seq(var("v", vector()), at(v(), 1, "a"), v())),
+            var("r", spawn("f")),
+            var("v", r("get")),
+            and(is_mt_safe(v()), eq(size(v()), 2), eq(at(v(), 1), "a"))
+        ))", true, ""},
+    {R"(seq(
+            fun("f", seq(var("v", vector()), at(v(), 0, vector()), v())),
+            var("r", spawn("f")),
+            try(r("get"), "value_mt_unsafe", "caught")
+        ))", "caught", ""},
+    {R"(seq(fun("f", throw("failed")), var("r", spawn("f")), r("get")))",
+        test::exc{
+            typeid(ts::exception::script_throw),
+            ts::frame_location("f", "", 1, 14),
+            "Script exception: failed"
+        }, ""},
+    {R"(seq(
+            fun("f", throw("failed")),
+            var("r", spawn("f")),
+            try(r("get"), "!failed", null),
+            try(r("get"), "!failed", "caught twice")
+        ))", "caught twice", ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c max_stack -- A task uses basic_state::max_stack of the thread
+ * that spawned it, and deep recursion in a task throws an exception instead
+ * of overflowing the stack of its green thread */
+//! \cond
+BOOST_AUTO_TEST_CASE(max_stack)
+{
+    test::script_runner runner{R"(seq(
+            fun("rec", if(eq(at(_args(), 0), 0),
+                0,
+                add(rec(sub(at(_args(), 0), 1)), 1)
+            ))
+        ))", test::make_sh_vars<>()};
+    {
+        ts::state thread{runner.vm};
+        ts::parse_code(test::alloc, runner.script, "defs")->eval(thread);
+        for (auto&& sym: thread.t_vars.csymbols())
+            runner.sh_vars->insert(sym.first, sym.second);
+    }
+    auto spawn_rec = [&runner](size_t max_stack, size_t depth) {
+        ts::state thread{runner.vm};
+        thread.max_stack = max_stack;
+        auto src = "seq(var(\"r\", spawn(\"rec\", " +
+            std::to_string(depth) + ")), r(\"get\"))";
+        return ts::parse_code(test::alloc, src, "main")->eval(thread);
+    };
+    auto r = dynamic_pointer_cast<ts::value_unsigned>(spawn_rec(10, 5));
+    BOOST_REQUIRE(r);
+    BOOST_CHECK_EQUAL(r->cvalue(), 5U);
+    BOOST_CHECK_THROW(spawn_rec(10, 20), ts::exception::op_recursion);
+    BOOST_CHECK_THROW(spawn_rec(ts::virtual_machine::default_max_stack,
+                                100000),
+                      ts::exception::op_recursion);
+    BOOST_CHECK_THROW(spawn_rec(100000000, 10000000),
+                      ts::exception::op_recursion);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_ready -- Methods threadscript::basic_future::ready() and
+ * threadscript::basic_future::try_get() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_ready, (std::vector<test::runner_result>{
+    {R"(seq(fun("f", 1), var("r", spawn("f")), r("ready", 1)))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 40),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(fun("f", 1), var("r", spawn("f")), r("try_get", 1)))",
+        test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 40),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            fun("f", seq(var("c", at(_args(), 0)), add(c("recv"), 1))),
+            var("c", channel(0)),
+            var("r", spawn("f", c())),
+            var("before", r("ready")),
+            var("result", try(r("try_get"), "op_would_block", "blocked")),
+            c("send", 10),
+            r("get"),
+            print(before(), " ", result(), " ", r("ready"), " ",
+                r("try_get"))
+        ))", nullptr, "false blocked true 11"},
+    {R"(seq(
+            fun("f", throw("failed")),
+            var("r", spawn("f")),
+            while(not(r("ready")), null),
+            try(r("try_get"), "!failed", "caught")
+        ))", "caught", ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c green -- Tasks running in green threads, which are suspended
+ * while blocked in channel operations or waiting for other tasks. Most of
+ * the scripts would deadlock if a blocked task blocked a pool thread. */
+//! \cond
+BOOST_DATA_TEST_CASE(green, (std::vector<test::runner_result>{
+    {R"(seq(
+            # Many tasks blocked in channels
+            fun("actor", seq(
+                var("cin", at(_args(), 0)),
+                var("cout", at(_args(), 1)),
+                cout("send", mt_safe(mul(cin("recv"), 2)))
+            )),
+            var("cin", channel(0)),
+            var("cout", channel(0)),
+            var("fs", vector()),
+            var("i", clone(0)),
+            while(lt(i(), 200), seq(
+                at(fs(), i(), spawn("actor", cin(), cout())),
+                add(i(), i(), 1)
+            )),
+            var("i", clone(0)),
+            while(lt(i(), 200), seq(
+                cin("send", mt_safe(clone(i()))),
+                add(i(), i(), 1)
+            )),
+            var("total", clone(0)),
+            var("i", clone(0)),
+            while(lt(i(), 200), seq(
+                add(total(), total(), cout("recv")),
+                add(i(), i(), 1)
+            )),
+            var("i", clone(0)),
+            while(lt(i(), 200), seq(
+                var("r", at(fs(), i())),
+                r("get"),
+                add(i(), i(), 1)
+            )),
+            total()
+        ))", test::uint_t(39800), ""},
+    {R"(seq(
+            # Two tasks communicating with each other
+            fun("ping", seq(
+                var("a", at(_args(), 0)),
+                var("b", at(_args(), 1)),
+                var("n", clone(0)),
+                while(lt(n(), 100), seq(
+                    a("send", mt_safe(clone(n()))),
+                    var("n", clone(b("recv")))
+                )),
+                n()
+            )),
+            fun("pong", seq(
+                var("a", at(_args(), 0)),
+                var("b", at(_args(), 1)),
+                var("k", clone(0)),
+                while(lt(k(), 100), seq(
+                    b("send", mt_safe(add(a("recv"), 1))),
+                    add(k(), k(), 1)
+                )),
+                k()
+            )),
+            var("a", channel(0)),
+            var("b", channel(0)),
+            var("p", spawn("ping", a(), b())),
+            var("q", spawn("pong", a(), b())),
+            print(p("get"), " ", q("get"))
+        ))", nullptr, "100 100"},
+    {R"(seq(
+            # Timeouts in tasks
+            fun("f", seq(
+                var("c", at(_args(), 0)),
+                try(c("recv_for", at(_args(), 1)), "op_would_block",
+                    "timeout")
+            )),
+            var("c1", channel(0)),
+            var("c2", channel(0)),
+            var("r1", spawn("f", c1(), 20)),
+            var("r2", spawn("f", c2(), 60000)),
+            print(r1("get"), " "),
+            c2("send", "value"),
+            print(r2("get"))
+        ))", nullptr, "timeout value"},
+    {R"(seq(
+            # Function select in a task
+            fun("f", seq(
+                var("ops", vector()),
+                at(ops(), 0, at(_args(), 0)),
+                at(ops(), 1, at(_args(), 1)),
+                var("r", select(ops())),
+                print(at(r(), 0), ":", at(r(), 1))
+            )),
+            var("c1", channel(0)),
+            var("c2", channel(0)),
+            var("r", spawn("f", c1(), c2())),
+            c2("send", "x"),
+            r("get")
+        ))", nullptr, "1:x"},
+    {R"(seq(
+            # A task waiting for another task
+            fun("inner", seq(var("c", at(_args(), 0)), c("recv"))),
+            fun("outer", seq(var("r", at(_args(), 0)), add(r("get"), 1))),
+            var("c", channel(0)),
+            var("r", spawn("outer", spawn("inner", c()))),
+            c("send", 10),
+            r("get")
+        ))", test::uint_t(11), ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c threads -- Tasks spawned by multiple threads and recursively by
+ * tasks, and parallel functions \c par_map and \c par_reduce called by
+ * threads and tasks */
+//! \cond
+BOOST_DATA_TEST_CASE(threads, (std::vector<test::runner_result>{
+    {R"(seq(
+            # Recursive spawning, a task waits for its subtasks
+            gvar("num_threads", 2),
+            fun("fib", seq(
+                var("n", at(_args(), 0)),
+                if(lt(n(), 2),
+                    n(),
+                    seq(
+                        var("r1", spawn("fib", mt_safe(sub(n(), 1)))),
+                        var("r2", spawn("fib", mt_safe(sub(n(), 2)))),
+                        add(r1("get"), r2("get"))
+                    )
+                )
+            )),
+            fun("f_main", seq(var("r", spawn("fib", 15)), r("get"))),
+            fun("f_thread", seq(
+                var("r", spawn("fib", mt_safe(add(at(_args(), 0), 10)))),
+                if(not(eq(r("get"), if(eq(at(_args(), 0), 0), 55, 89))),
+                    throw("bad result"), null)
+            ))
+        ))", test::uint_t(610), ""},
+    {R"(seq(
+            # Many independent tasks spawned by multiple threads
+            gvar("num_threads", 4),
+            gvar("num_tasks", 200),
+            fun("sq", mul(at(_args(), 0), at(_args(), 0))),
+            fun("f_main", null),
+            fun("f_thread", seq(
+                var("fs", vector()),
+                var("i", clone(0)),
+                while(lt(i(), num_tasks()), seq(
+                    at(fs(), i(), spawn("sq", mt_safe(clone(i())))),
+                    add(i(), i(), 1)
+                )),
+                var("total", clone(0)),
+                var("i", clone(0)),
+                while(lt(i(), num_tasks()), seq(
+                    var("r", at(fs(), i())),
+                    add(total(), total(), r("get")),
+                    add(i(), i(), 1)
+                )),
+                if(not(eq(total(), 2646700)), throw("bad total"), null)
+            ))
+        ))", nullptr, ""},
+    {R"(seq(
+            # Parallel functions called by multiple threads and by tasks
+            gvar("num_threads", 4),
+            fun("sq", mt_safe(mul(at(_args(), 0), at(_args(), 0)))),
+            fun("plus", add(at(_args(), 0), at(_args(), 1))),
+            fun("sum_sq", par_reduce(
+                mt_safe(par_map(at(_args(), 0), "sq")), "plus", 0)),
+            var("w", vector()),
+            var("i", clone(0)),
+            while(lt(i(), 300), seq(
+                at(w(), i(), mt_safe(clone(i()))),
+                add(i(), i(), 1)
+            )),
+            gvar("v", mt_safe(w())),
+            fun("f_main", sum_sq(v())),
+            fun("f_thread", seq(
+                var("r", spawn("sum_sq", v())),
+                if(ne(r("get"), 8955050), throw("bad result"), null)
+            ))
+        ))", test::uint_t(8955050), ""},
+}))
+{
+    test::check_runner<test::script_runner_threads>(sample, sh_vars);
+}
+//! \endcond
@@ -0,0 +1,269 @@
+/*! \file
+ * \brief Tests of class threadscript::basic_host_view
+ */
+
+//! \cond
+#include "threadscript/threadscript.hpp"
+#include "threadscript/symbol_table_impl.hpp"
+
+#define BOOST_TEST_MODULE host_view
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <boost/test/data/test_case.hpp>
+
+#include <atomic>
+#include <map>
+#include <thread>
+#include <unordered_map>
+
+#include "script_runner.hpp"
+
+namespace test {
+
+// A custom adapter that generates squares and counts created values
+class squares final: public ts::host_view::adapter {
+public:
+    size_t size() const override {
+        return 10;
+    }
+    std::optional<ts::value::value_ptr> at(const ts::allocator_any& alloc,
+                                           size_t idx) const override
+    {
+        if (idx >= size())
+            return std::nullopt;
+        ++created;
+        return ts::impl::to_value(alloc, unsigned(idx * idx));
+    }
+    mutable std::atomic<size_t> created = 0;
+};
+
+auto vec = std::make_shared<const std::vector<int>>(
+                                            std::vector<int>{10, -20, 30});
+auto map = std::make_shared<const std::map<std::string, std::string,
+                                           std::less<>>>(
+    std::map<std::string, std::string, std::less<>>{
+        {"a", "A"}, {"b", "B"},
+    });
+auto umap = std::make_shared<const std::unordered_map<std::string, bool>>(
+    std::unordered_map<std::string, bool>{{"yes", true}, {"no", false}});
+auto sq = std::make_shared<squares>();
+
+std::shared_ptr<ts::symbol_table> make_views()
+{
+    auto sh_vars = make_sh_vars<ts::host_view>();
+    sh_vars->insert("vec", ts::host_view::create(alloc, vec));
+    sh_vars->insert("map", ts::host_view::create(alloc, map));
+    sh_vars->insert("umap", ts::host_view::create(alloc, umap));
+    sh_vars->insert("sq", ts::host_view::create(alloc, sq));
+    return sh_vars;
+}
+
+} // namespace test
+
+auto sh_vars = test::make_views();
+//! \endcond
+
+/*! \file
+ * \test \c create_object -- Creates a threadscript::basic_host_view object
+ * from a script and from C++ */
+//! \cond
+BOOST_DATA_TEST_CASE(create_object, (std::vector<test::runner_result>{
+    {R"(host_view(1))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(type(host_view()))", "host_view", ""},
+    {R"(is_mt_safe(host_view()))", true, ""},
+    {R"(seq(var("v", host_view()), v("size")))", test::uint_t{0}, ""},
+    {R"(seq(var("v", host_view()), v("contains", 0)))", false, ""},
+    {R"(seq(var("v", host_view()), v("at", "a")))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 1, 28),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(type(vec()))", "host_view", ""},
+    {R"(is_mt_safe(vec()))", true, ""},
+    {R"(is_mt_safe(map()))", true, ""},
+    {R"(vec("unknown"))", test::exc{
+            typeid(ts::exception::not_implemented),
+            ts::frame_location("", "", 1, 1),
+            "unknown not implemented"
+        }, ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_at -- Tests method threadscript::basic_host_view::at() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_at, (std::vector<test::runner_result>{
+    {R"(vec("at"))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(vec("at", 0, 1))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(vec("at", null))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(vec("at", true))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(vec("at", -1))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(vec("at", 3))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(vec("at", "a"))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(vec("at", 0))", test::int_t{10}, ""},
+    {R"(vec("at", +1))", test::int_t{-20}, ""},
+    {R"(vec("at", 2))", test::int_t{30}, ""},
+    {R"(is_mt_safe(vec("at", 2)))", false, ""},
+    {R"(map("at", 0))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(map("at", "c"))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(map("at", "a"))", "A", ""},
+    {R"(map("at", "b"))", "B", ""},
+    {R"(umap("at", "yes"))", true, ""},
+    {R"(umap("at", "no"))", false, ""},
+    {R"(sq("at", 7))", test::uint_t{49}, ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_contains -- Tests method
+ * threadscript::basic_host_view::contains() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_contains, (std::vector<test::runner_result>{
+    {R"(vec("contains"))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(vec("contains", null))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(vec("contains", "a"))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(vec("contains", 2))", true, ""},
+    {R"(vec("contains", 3))", false, ""},
+    {R"(map("contains", "a"))", true, ""},
+    {R"(map("contains", "c"))", false, ""},
+    {R"(umap("contains", "no"))", true, ""},
+    {R"(umap("contains", "maybe"))", false, ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_size -- Tests method threadscript::basic_host_view::size()
+ */
+//! \cond
+BOOST_DATA_TEST_CASE(method_size, (std::vector<test::runner_result>{
+    {R"(vec("size", 0))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(vec("size"))", test::uint_t{3}, ""},
+    {R"(map("size"))", test::uint_t{2}, ""},
+    {R"(umap("size"))", test::uint_t{2}, ""},
+    {R"(sq("size"))", test::uint_t{10}, ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c lazy -- Values are created only for accessed elements and the
+ * container is not copied */
+//! \cond
+BOOST_AUTO_TEST_CASE(lazy)
+{
+    test::sq->created = 0;
+    test::check_runner({R"(sq("size"))", test::uint_t{10}, ""}, sh_vars);
+    BOOST_CHECK_EQUAL(test::sq->created, 0U);
+    test::check_runner({R"(sq("at", 3))", test::uint_t{9}, ""}, sh_vars);
+    BOOST_CHECK_EQUAL(test::sq->created, 1U);
+    auto data = std::make_shared<std::vector<std::string>>(
+                                        std::vector<std::string>{"x"});
+    auto sym = test::make_sh_vars<>();
+    sym->insert("data", ts::host_view::create(test::alloc,
+        std::shared_ptr<const std::vector<std::string>>(data)));
+    test::check_runner({R"(data("at", 0))", "x", ""}, sym);
+    (*data)[0] = "y";
+    test::check_runner({R"(data("at", 0))", "y", ""}, sym);
+}
+//! \endcond
+
+/*! \file
+ * \test \c threads -- A view shared by multiple threads */
+//! \cond
+BOOST_AUTO_TEST_CASE(threads)
+{
+    ts::virtual_machine vm{test::alloc};
+    vm.sh_vars = sh_vars;
+    auto script = ts::parse_code(test::alloc, R"(seq(
+            gvar("sum", 0),
+            gvar("i", 0),
+            while(lt(i(), sq("size")), seq(
+                gvar("sum", add(sum(), sq("at", i()))),
+                gvar("i", add(i(), 1))
+            )),
+            sum()
+        ))", "string");
+    std::atomic<size_t> ok = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+        threads.emplace_back([&]() {
+            ts::state thread{vm};
+            for (int r = 0; r < 100; ++r) {
+                auto v = std::dynamic_pointer_cast<ts::value_unsigned>(
+                                                        script->eval(thread));
+                if (v && v->cvalue() == 285)
+                    ++ok;
+            }
+        });
+    for (auto&& t: threads)
+        t.join();
+    BOOST_CHECK_EQUAL(ok, 800U);
+}
+//! \endcond
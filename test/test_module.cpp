@@ -0,0 +1,271 @@
+/*! \file
+ * \brief Tests of class threadscript::basic_module_registry and function
+ * import
+ */
+
+//! \cond
+#include "threadscript/threadscript.hpp"
+#include "threadscript/symbol_table_impl.hpp"
+
+#define BOOST_TEST_MODULE module
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <thread>
+
+#include "tmp_dir.hpp"
+
+namespace ts = threadscript;
+
+namespace test {
+
+ts::allocator_any alloc;
+
+// A virtual machine with predefined symbols and captured standard output
+struct vm_fixture {
+    vm_fixture() {
+        auto sh_vars = ts::predef_symbols(alloc);
+        ts::add_predef_objects(sh_vars, true);
+        vm.sh_vars = sh_vars;
+        vm.std_out = &out;
+    }
+    ts::module_registry& modules() {
+        return ts::module_registry::get(vm);
+    }
+    // Parses and runs a script in a new thread
+    ts::value::value_ptr run(const std::string& src) {
+        ts::state thread{vm};
+        return ts::parse_code(alloc, src, "main")->eval(thread);
+    }
+    ts::virtual_machine vm{alloc};
+    std::ostringstream out;
+};
+
+// A module printing a message when loaded and defining a function
+const std::string module_f =
+    R"(seq(print("loaded\n"), fun("f", "result of f")))";
+
+// Gets a string value
+std::string str(const ts::value::value_ptr& v)
+{
+    auto s = std::dynamic_pointer_cast<ts::value_string>(v);
+    BOOST_REQUIRE(s);
+    return std::string{s->cvalue()};
+}
+
+} // namespace test
+//! \endcond
+
+/*! \file
+ * \test \c once -- A module imported by several threads and names is loaded
+ * once */
+//! \cond
+BOOST_AUTO_TEST_CASE(once)
+{
+    test::tmp_dir dir{"test_module"};
+    dir.write("m.ts", test::module_f);
+    test::vm_fixture f;
+    f.modules().search_path({dir.path.string()});
+    BOOST_CHECK_EQUAL(f.modules().search_path().size(), 1U);
+    for (std::string name: {"m.ts", "m.ts", "./m.ts"}) {
+        BOOST_TEST_INFO("name=" << name);
+        auto r = f.run("seq(import(\"" + name + "\"), f())");
+        BOOST_CHECK_EQUAL(test::str(r), "result of f");
+    }
+    BOOST_CHECK_EQUAL(f.out.str(), "loaded\n");
+    BOOST_CHECK_EQUAL(f.modules().size(), 1U);
+    auto exports = f.modules().import("m.ts");
+    BOOST_REQUIRE(exports);
+    BOOST_CHECK(exports->lookup("f"));
+    BOOST_CHECK_EQUAL(f.modules().import((dir.path / "m.ts").string()),
+                      exports);
+}
+//! \endcond
+
+/*! \file
+ * \test \c threads -- A module imported concurrently is loaded once and its
+ * exports are shared */
+//! \cond
+BOOST_AUTO_TEST_CASE(threads)
+{
+    test::tmp_dir dir{"test_module"};
+    dir.write("m.ts", test::module_f);
+    test::vm_fixture f;
+    f.modules().search_path({dir.path.string()});
+    constexpr size_t n = 8;
+    std::vector<ts::module_registry::exports_ptr> exports(n);
+    {
+        std::vector<std::jthread> threads;
+        for (size_t i = 0; i < n; ++i)
+            threads.emplace_back([&f, &exports, i]() {
+                exports[i] = f.modules().import("m.ts");
+            });
+    }
+    for (auto&& e: exports)
+        BOOST_CHECK_EQUAL(e, exports[0]);
+    BOOST_CHECK_EQUAL(f.out.str(), "loaded\n");
+}
+//! \endcond
+
+/*! \file
+ * \test \c green -- A module imported by tasks running in green threads of
+ * the same pool thread, which wait while the module is being loaded */
+//! \cond
+BOOST_AUTO_TEST_CASE(green)
+{
+    test::tmp_dir dir{"test_module"};
+    dir.write("slow.ts", R"(seq(
+        var("c", channel(1)),
+        try(c("recv_for", 100), "", null),
+        print("loaded\n"),
+        fun("f", "slow")
+    ))");
+    test::vm_fixture f;
+    f.vm.task_pool_threads = 1;
+    f.modules().search_path({dir.path.string()});
+    auto r = f.run(R"(seq(
+        fun("imp", seq(import("slow.ts"), f())),
+        var("r1", spawn("imp")),
+        var("r2", spawn("imp")),
+        add(add(r1("get"), " "), r2("get"))
+    ))");
+    BOOST_CHECK_EQUAL(test::str(r), "slow slow");
+    BOOST_CHECK_EQUAL(f.out.str(), "loaded\n");
+}
+//! \endcond
+
+/*! \file
+ * \test \c search_path -- Directories of the search path are searched in
+ * order */
+//! \cond
+BOOST_AUTO_TEST_CASE(search_path)
+{
+    test::tmp_dir dir{"test_module"};
+    dir.write("d1/m.ts", R"(fun("f", "d1"))");
+    dir.write("d2/m.ts", R"(fun("f", "d2"))");
+    dir.write("d2/n.ts", R"(fun("g", "d2"))");
+    test::vm_fixture f;
+    f.modules().search_path({(dir.path / "d0").string(),
+                             (dir.path / "d1").string(),
+                             (dir.path / "d2").string()});
+    BOOST_CHECK_EQUAL(test::str(f.run(R"(seq(import("m.ts"), f()))")), "d1");
+    BOOST_CHECK_EQUAL(test::str(f.run(R"(seq(import("n.ts"), g()))")), "d2");
+    BOOST_CHECK_THROW(f.run(R"(import("missing.ts"))"),
+                      ts::exception::op_import_not_found);
+    BOOST_CHECK_THROW(f.run(R"(import(""))"),
+                      ts::exception::op_import_not_found);
+    // Changing the search path does not unload modules
+    f.modules().search_path({(dir.path / "d2").string()});
+    BOOST_CHECK_EQUAL(test::str(f.run(R"(seq(import("m.ts"), f()))")), "d2");
+    BOOST_CHECK_EQUAL(f.modules().size(), 3U);
+}
+//! \endcond
+
+/*! \file
+ * \test \c cycle -- Import cycles are detected and a failed module can be
+ * imported again */
+//! \cond
+BOOST_AUTO_TEST_CASE(cycle)
+{
+    test::tmp_dir dir{"test_module"};
+    dir.write("a.ts", R"(seq(import("b.ts"), fun("fa", "a")))");
+    dir.write("b.ts", R"(seq(import("a.ts"), fun("fb", "b")))");
+    dir.write("self.ts", R"(import("self.ts"))");
+    test::vm_fixture f;
+    f.modules().search_path({dir.path.string()});
+    BOOST_CHECK_THROW(f.run(R"(import("a.ts"))"),
+                      ts::exception::op_import_cycle);
+    BOOST_CHECK_THROW(f.run(R"(import("self.ts"))"),
+                      ts::exception::op_import_cycle);
+    BOOST_CHECK_EQUAL(f.modules().size(), 0U);
+    dir.write("b.ts", R"(fun("fb", "b"))");
+    BOOST_CHECK_EQUAL(test::str(f.run(R"(seq(import("a.ts"), fb()))")), "b");
+    BOOST_CHECK_EQUAL(f.modules().size(), 2U);
+}
+//! \endcond
+
+/*! \file
+ * \test \c exports -- Only thread-safe symbols are exported */
+//! \cond
+BOOST_AUTO_TEST_CASE(exports)
+{
+    test::tmp_dir dir{"test_module"};
+    dir.write("m.ts", R"(seq(
+        gvar("unsafe", hash()),
+        gvar("safe", mt_safe(hash())),
+        var("local", 1),
+        fun("f", null)
+    ))");
+    test::vm_fixture f;
+    f.modules().search_path({dir.path.string()});
+    auto exports = f.modules().import("m.ts");
+    BOOST_CHECK(exports->lookup("f"));
+    BOOST_CHECK(exports->lookup("safe"));
+    BOOST_CHECK(!exports->lookup("unsafe"));
+    BOOST_CHECK(!exports->lookup("local"));
+    ts::state thread{f.vm};
+    ts::parse_code(test::alloc, R"(import("m.ts"))", "main")->eval(thread);
+    BOOST_CHECK(thread.t_vars.lookup("f"));
+    BOOST_CHECK(thread.t_vars.lookup("safe"));
+    BOOST_CHECK(!thread.t_vars.lookup("unsafe"));
+}
+//! \endcond
+
+/*! \file
+ * \test \c errors -- Errors of function import and of loading modules */
+//! \cond
+BOOST_AUTO_TEST_CASE(errors)
+{
+    test::tmp_dir dir{"test_module"};
+    dir.write("syntax.ts", "syntax error");
+    dir.write("throw.ts", R"(throw("in module"))");
+    test::vm_fixture f;
+    f.modules().search_path({dir.path.string()});
+    BOOST_CHECK_THROW(f.run("import()"), ts::exception::op_narg);
+    BOOST_CHECK_THROW(f.run(R"(import("a", "b"))"), ts::exception::op_narg);
+    BOOST_CHECK_THROW(f.run("import(null)"), ts::exception::value_null);
+    BOOST_CHECK_THROW(f.run("import(1)"), ts::exception::value_type);
+    BOOST_CHECK_THROW(f.run(R"(import("syntax.ts"))"),
+                      ts::exception::wrapped);
+    BOOST_CHECK_THROW(f.modules().import("syntax.ts"), ts::parse_error);
+    BOOST_CHECK_THROW(f.run(R"(import("throw.ts"))"),
+                      ts::exception::script_throw);
+    BOOST_CHECK_EQUAL(f.modules().size(), 0U);
+}
+//! \endcond
+
+/*! \file
+ * \test \c resolve -- Modules imported by a script are loaded and their
+ * functions are bound by basic_module_registry::resolve() */
+//! \cond
+BOOST_AUTO_TEST_CASE(resolve)
+{
+    test::tmp_dir dir{"test_module"};
+    dir.write("m.ts", test::module_f);
+    dir.write("n1.ts", R"(seq(if(false, import("m.ts")), fun("g", f())))");
+    dir.write("n2.ts", R"(seq(if(false, import("m.ts")), fun("g", f())))");
+    test::vm_fixture f;
+    f.modules().search_path({dir.path.string()});
+    // Function f is not known without resolving
+    auto src = R"(seq(if(false, import("m.ts")), f()))";
+    BOOST_CHECK_THROW(f.run(src), ts::exception::unknown_symbol);
+    BOOST_CHECK_EQUAL(f.modules().size(), 0U);
+    // The import is not evaluated, but f is bound to the module function
+    auto script = ts::parse_code(test::alloc, src, "main");
+    f.modules().resolve(*script);
+    BOOST_CHECK_EQUAL(f.modules().size(), 1U);
+    {
+        ts::state thread{f.vm};
+        BOOST_CHECK_EQUAL(test::str(script->eval(thread)), "result of f");
+    }
+    script->unresolve();
+    // Imports of modules are resolved if enabled
+    BOOST_CHECK_THROW(f.run(R"(seq(import("n1.ts"), g()))"),
+                      ts::exception::unknown_symbol);
+    f.modules().resolve_modules = true;
+    BOOST_CHECK_EQUAL(test::str(f.run(R"(seq(import("n2.ts"), g()))")),
+                      "result of f");
+    BOOST_CHECK_EQUAL(f.out.str(), "loaded\n");
+}
+//! \endcond
@@ -0,0 +1,146 @@
+/*! \file
+ * \brief Tests of class threadscript::basic_native_binding
+ */
+
+//! \cond
+#include "threadscript/threadscript.hpp"
+#include "threadscript/symbol_table_impl.hpp"
+
+#define BOOST_TEST_MODULE native_binding
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+
+namespace ts = threadscript;
+
+namespace test {
+
+ts::allocator_any alloc;
+
+// A plain function bound as a native function
+int64_t mul(int64_t a, int64_t b)
+{
+    return a * b;
+}
+
+// Creates shared variables with predefined symbols and native bindings
+std::shared_ptr<ts::symbol_table> make_sh_vars()
+{
+    auto sh_vars = ts::predef_symbols(alloc);
+    sh_vars->insert("mul", ts::make_native_fun(alloc, &mul));
+    sh_vars->insert("neg", ts::make_native_fun(alloc,
+                                               [](bool b) { return !b; }));
+    sh_vars->insert("len", ts::make_native_fun(alloc,
+        [](std::string_view s) -> unsigned { return s.size(); }));
+    sh_vars->insert("greet", ts::make_native_fun(alloc,
+        [](const std::string& s) { return "Hello " + s; }));
+    sh_vars->insert("byte", ts::make_native_fun(alloc,
+        [](uint8_t b) -> unsigned { return b; }));
+    sh_vars->insert("i32", ts::make_native_fun(alloc,
+        [](int32_t i) -> int64_t { return i; }));
+    sh_vars->insert("nothing", ts::make_native_fun(alloc, []() {}));
+    sh_vars->insert("same", ts::make_native_fun(alloc,
+        [](ts::value::value_ptr v) { return v; }));
+    sh_vars->insert("depth", ts::make_native_fun(alloc,
+        [](ts::state& thread, unsigned u) {
+            return u + thread.current_stack().size();
+        }));
+    sh_vars->insert("when", ts::make_native_fun(alloc,
+        [](bool cond, ts::lazy_arg then, ts::lazy_arg other) {
+            return cond ? then() : other.eval();
+        }));
+    sh_vars->insert("repeat", ts::make_native_fun(alloc,
+        [](unsigned n, const ts::lazy_arg& body) {
+            for (unsigned i = 0; i < n; ++i)
+                body.eval();
+        }));
+    return sh_vars;
+}
+
+// Runs a script and returns its result
+ts::value::value_ptr run(std::string_view src, std::ostream* out = nullptr)
+{
+    ts::virtual_machine vm{alloc};
+    vm.sh_vars = make_sh_vars();
+    ts::state thread{vm};
+    thread.std_out = out;
+    return ts::parse_code(alloc, src, "string")->eval(thread);
+}
+
+template <class V> auto result(std::string_view src)
+{
+    auto v = run(src);
+    auto p = dynamic_cast<V*>(v.get());
+    BOOST_REQUIRE(p);
+    return p->cvalue();
+}
+
+} // namespace test
+//! \endcond
+
+/*! \file
+ * \test \c convert -- Conversion of arguments and results */
+//! \cond
+BOOST_AUTO_TEST_CASE(convert)
+{
+    BOOST_TEST(test::result<ts::value_int>("mul(int(6), int(-7))") == -42);
+    BOOST_TEST(test::result<ts::value_bool>("neg(false)"));
+    BOOST_TEST(test::result<ts::value_unsigned>(R"(len("abc"))") == 3U);
+    BOOST_TEST(test::result<ts::value_string>(R"(greet("world"))") ==
+               "Hello world");
+    BOOST_TEST(test::result<ts::value_unsigned>("byte(255)") == 255U);
+    BOOST_TEST(test::result<ts::value_int>("i32(-2147483648)") ==
+               -2147483648);
+    BOOST_TEST(!test::run("nothing()"));
+    BOOST_TEST(!test::run("same(null)"));
+    BOOST_TEST(test::result<ts::value_unsigned>("same(5)") == 5U);
+    BOOST_TEST(test::result<ts::value_unsigned>("depth(10)") == 11U);
+}
+//! \endcond
+
+/*! \file
+ * \test \c errors -- Bad arguments */
+//! \cond
+BOOST_AUTO_TEST_CASE(errors)
+{
+    BOOST_CHECK_THROW(test::run("mul(int(1))"), ts::exception::op_narg);
+    BOOST_CHECK_THROW(test::run("mul(int(1), int(2), int(3))"),
+                      ts::exception::op_narg);
+    BOOST_CHECK_THROW(test::run("nothing(1)"), ts::exception::op_narg);
+    BOOST_CHECK_THROW(test::run("mul(int(1), 2)"), ts::exception::value_type);
+    BOOST_CHECK_THROW(test::run("mul(int(1), null)"),
+                      ts::exception::value_null);
+    BOOST_CHECK_THROW(test::run("neg(1)"), ts::exception::value_type);
+    BOOST_CHECK_THROW(test::run("len(1)"), ts::exception::value_type);
+    BOOST_CHECK_THROW(test::run("byte(256)"),
+                      ts::exception::value_out_of_range);
+    BOOST_CHECK_THROW(test::run("i32(+4294967297)"),
+                      ts::exception::value_out_of_range);
+    BOOST_CHECK_THROW(test::run("i32(-2147483649)"),
+                      ts::exception::value_out_of_range);
+}
+//! \endcond
+
+/*! \file
+ * \test \c lazy -- Lazily evaluated arguments */
+//! \cond
+BOOST_AUTO_TEST_CASE(lazy)
+{
+    std::ostringstream os;
+    auto v = test::run(R"(when(true, print("then"), print("else")))", &os);
+    BOOST_TEST(os.str() == "then");
+    os.str("");
+    test::run(R"(when(false, print("then"), print("else")))", &os);
+    BOOST_TEST(os.str() == "else");
+    BOOST_CHECK_THROW(test::run(R"(when(1, 2, 3))"),
+                      ts::exception::value_type);
+    BOOST_TEST(test::result<ts::value_unsigned>("when(true, 1, 2)") == 1U);
+    os.str("");
+    test::run(R"(repeat(3, print("x")))", &os);
+    BOOST_TEST(os.str() == "xxx");
+    os.str("");
+    test::run(R"(repeat(0, print("x")))", &os);
+    BOOST_TEST(os.str() == "");
+}
+//! \endcond
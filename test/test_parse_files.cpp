@@ -0,0 +1,120 @@
+/*! \file
+ * \brief Tests of function threadscript::parse_code_files()
+ */
+
+//! \cond
+#include "threadscript/threadscript.hpp"
+#include "threadscript/symbol_table_impl.hpp"
+
+#define BOOST_TEST_MODULE parse_files
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <filesystem>
+
+#include "tmp_dir.hpp"
+
+namespace ts = threadscript;
+
+namespace test {
+
+ts::allocator_any alloc;
+
+// The source of the i-th script
+std::string source(size_t i)
+{
+    return "gvar(\"v\", add(v(), " + std::to_string(i) + "))";
+}
+
+} // namespace test
+//! \endcond
+
+/*! \file
+ * \test \c parse_all -- Many files parsed in parallel and evaluated in order
+ */
+//! \cond
+BOOST_AUTO_TEST_CASE(parse_all)
+{
+    test::tmp_dir dir{"test_parse_files"};
+    std::vector<std::string> files;
+    for (size_t i = 0; i < 100; ++i)
+        files.push_back(dir.write(std::to_string(i) + ".ts", test::source(i)));
+    ts::virtual_machine vm{test::alloc};
+    vm.task_pool_threads = 4;
+    vm.sh_vars = ts::predef_symbols(test::alloc);
+    auto parsed = ts::parse_code_files(vm, files);
+    BOOST_REQUIRE_EQUAL(parsed.size(), files.size());
+    for (size_t i = 0; i < parsed.size(); ++i) {
+        BOOST_TEST_INFO("i=" << i);
+        BOOST_CHECK_EQUAL(parsed[i].file, files[i]);
+        BOOST_CHECK(!parsed[i].error);
+        BOOST_REQUIRE(parsed[i].script);
+        BOOST_CHECK(*parsed[i].script ==
+                    *ts::parse_code(test::alloc, test::source(i), files[i]));
+    }
+    ts::state thread{vm};
+    thread.t_vars.insert("v", ts::impl::to_value(test::alloc, 0U));
+    for (auto&& p: parsed)
+        p.script->eval(thread);
+    auto v = std::dynamic_pointer_cast<ts::value_unsigned>(
+                            thread.t_vars.lookup("v").value_or(nullptr));
+    BOOST_REQUIRE(v);
+    BOOST_CHECK_EQUAL(v->cvalue(), 4950U);
+}
+//! \endcond
+
+/*! \file
+ * \test \c errors -- Errors are reported for each file separately */
+//! \cond
+BOOST_AUTO_TEST_CASE(errors)
+{
+    test::tmp_dir dir{"test_parse_files"};
+    std::vector<std::string> files{
+        dir.write("ok1.ts", "null"),
+        dir.write("bad.ts", "syntax error"),
+        (dir.path / "missing.ts").string(),
+        dir.write("ok2.ts", "true"),
+    };
+    ts::virtual_machine vm{test::alloc};
+    auto parsed = ts::parse_code_files(vm, files);
+    BOOST_REQUIRE_EQUAL(parsed.size(), files.size());
+    BOOST_CHECK(parsed[0].script && !parsed[0].error);
+    BOOST_CHECK(!parsed[1].script);
+    BOOST_CHECK_THROW(std::rethrow_exception(parsed[1].error),
+                      ts::parse_error);
+    BOOST_CHECK(!parsed[2].script);
+    BOOST_CHECK_THROW(std::rethrow_exception(parsed[2].error),
+                      std::ios_base::failure);
+    BOOST_CHECK(parsed[3].script && !parsed[3].error);
+    BOOST_CHECK(ts::parse_code_files(vm, {}).empty());
+}
+//! \endcond
+
+/*! \file
+ * \test \c cache -- Files parsed in parallel using a cache directory */
+//! \cond
+BOOST_AUTO_TEST_CASE(cache)
+{
+    test::tmp_dir dir{"test_parse_files"};
+    std::vector<std::string> files;
+    for (size_t i = 0; i < 10; ++i)
+        files.push_back(dir.write(std::to_string(i) + ".ts", test::source(i)));
+    auto cache = (dir.path / "cache").string();
+    ts::virtual_machine vm{test::alloc};
+    for (int run = 0; run < 2; ++run) {
+        BOOST_TEST_INFO("run=" << run);
+        auto parsed = ts::parse_code_files(vm, files,
+                                           ts::syntax_factory::syntax_canon,
+                                           cache);
+        for (size_t i = 0; i < parsed.size(); ++i) {
+            BOOST_REQUIRE(parsed[i].script);
+            BOOST_CHECK(*parsed[i].script ==
+                        *ts::parse_code(test::alloc, test::source(i),
+                                        files[i]));
+        }
+    }
+    BOOST_CHECK_EQUAL(std::distance(std::filesystem::directory_iterator(cache),
+                                    std::filesystem::directory_iterator()),
+                      10);
+}
+//! \endcond
@@ -205,6 +205,158 @@ BOOST_DATA_TEST_CASE(f_add, (std::vector<test::runner_result>{
             var("r")
         )
     )", "Hello World!", "true"},
+    {R"(
+        seq(
+            var("r", clone("ab")),
+            print(is_same(add(var("r"), var("r"), "cd"), var("r"))),
+            add(var("r"), var("r"), var("r")),
+            var("r")
+        )
+    )", "abcdabcd", "true"},
+    {R"(
+        seq(
+            var("r", clone("ab")),
+            print(is_same(add(var("r"), "xy", var("r")), var("r"))),
+            var("r")
+        )
+    )", "xyab", "true"},
+    {R"(
+        seq(
+            var("r", mt_safe(clone("ab"))),
+            add(var("r"), var("r"), "cd")
+        )
+    )", test::exc{
+        typeid(ts::exception::value_read_only),
+        ts::frame_location("", "", 4, 13),
+        "Runtime error: Read-only value"
+    }, ""},
+    // packed vectors
+    {R"(add(int_vector(), unsigned_vector()))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(add(int_vector(), vector()))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(add(vector(), vector()))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(add(int_vector(1), int_vector(2)))", test::exc{
+        typeid(ts::exception::value_out_of_range),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Value out of range"
+    }, ""},
+    {R"(size(add(int_vector(), int_vector())))", test::uint_t(0U), ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            var("w", int_vector(4)),
+            at(w(), 0, +2),
+            at(w(), 1, +4),
+            at(w(), 2, -1),
+            at(w(), 3, +10),
+            var("r", add(v(), w())),
+            print(type(r())),
+            print(at(r(), 0), at(r(), 1), at(r(), 2), at(r(), 3)),
+            size(r())
+        )
+    )", test::uint_t(4U), "int_vector5-1-113"},
+    {R"(
+        seq(
+            var("v", unsigned_vector(4)),
+            at(v(), 0, 3),
+            at(v(), 1, 5),
+            at(v(), 3, 3),
+            var("w", unsigned_vector(4)),
+            at(w(), 0, 2),
+            at(w(), 1, 4),
+            at(w(), 2, 1),
+            at(w(), 3, 10),
+            at(v(), 2, 18446744073709551615),
+            var("r", add(v(), w())),
+            print(type(r())),
+            print(at(r(), 0), at(r(), 1), at(r(), 2), at(r(), 3)),
+            size(r())
+        )
+    )", test::uint_t(4U), "unsigned_vector59013"},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            var("w", int_vector(4)),
+            at(w(), 0, +2),
+            at(w(), 1, +4),
+            at(w(), 2, -1),
+            at(w(), 3, +10),
+            at(v(), 3, +9223372036854775807),
+            add(v(), w())
+        )
+    )", test::exc{
+        typeid(ts::exception::op_overflow),
+        ts::frame_location("", "", 13, 13),
+        "Runtime error: Overflow"
+    }, ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            var("w", int_vector(4)),
+            at(w(), 0, +2),
+            at(w(), 1, +4),
+            at(w(), 2, -1),
+            at(w(), 3, +10),
+            at(v(), 2, -9223372036854775808),
+            add(v(), w())
+        )
+    )", test::exc{
+        typeid(ts::exception::op_overflow),
+        ts::frame_location("", "", 13, 13),
+        "Runtime error: Overflow"
+    }, ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            var("w", int_vector(4)),
+            at(w(), 0, +2),
+            at(w(), 1, +4),
+            at(w(), 2, -1),
+            at(w(), 3, +10),
+            at(v(), 2, -9223372036854775808),
+            at(w(), 2, +9223372036854775807),
+            var("r", add(v(), w())),
+            at(r(), 2)
+        )
+    )", test::int_t(-1), ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            var("w", int_vector(4)),
+            at(w(), 0, +2),
+            at(w(), 1, +4),
+            at(w(), 2, -1),
+            at(w(), 3, +10),
+            print(is_same(add(v(), v(), w()), v())),
+            sum(v())
+        )
+    )", test::int_t(16), "true"},
 }))
 {
     test::check_runner(sample);
@@ -494,6 +646,102 @@ BOOST_DATA_TEST_CASE(f_at, (std::vector<test::runner_result>{
         ts::frame_location("", "", 5, 13),
         "Runtime error: Thread-unsafe value"
     }, ""},
+    // packed vectors
+    {R"(at(int_vector(), 0))", test::exc{
+        typeid(ts::exception::value_out_of_range),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Value out of range"
+    }, ""},
+    {R"(at(int_vector(2), -1))", test::exc{
+        typeid(ts::exception::value_out_of_range),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Value out of range"
+    }, ""},
+    {R"(at(int_vector(2), "0"))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(at(int_vector(2), null))", test::exc{
+        typeid(ts::exception::value_null),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Null value"
+    }, ""},
+    {R"(at(int_vector(2), 0, null))", test::exc{
+        typeid(ts::exception::value_null),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Null value"
+    }, ""},
+    {R"(at(int_vector(2), 0, 1))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(at(unsigned_vector(2), 0, +1))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(at(unsigned_vector(2), 18446744073709551615, 1))", test::exc{
+        typeid(ts::exception::value_out_of_range),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Value out of range"
+    }, ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            at(v(), 1)
+        )
+    )", test::int_t(-5), ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            at(v(), +3)
+        )
+    )", test::int_t(3), ""},
+    {R"(
+        seq(
+            var("v", unsigned_vector(4)),
+            at(v(), 0, 3),
+            at(v(), 1, 5),
+            at(v(), 3, 3),
+            at(v(), 1)
+        )
+    )", test::uint_t(5U), ""},
+    {R"(
+        seq(
+            var("v", int_vector()),
+            print(at(v(), 2, +7)),
+            print(size(v())),
+            at(v(), 0)
+        )
+    )", test::int_t(0), "73"},
+    {R"(
+        seq(
+            var("v", unsigned_vector()),
+            at(v(), 1, 7),
+            var("e", at(v(), 1)),
+            at(v(), 1, 8),
+            e()
+        )
+    )", test::uint_t(7U), ""},
+    {R"(
+        seq(
+            var("v", unsigned_vector(2)),
+            mt_safe(v()),
+            at(v(), 0, 1)
+        )
+    )", test::exc{
+        typeid(ts::exception::value_read_only),
+        ts::frame_location("", "", 5, 13),
+        "Runtime error: Read-only value"
+    }, ""},
 }))
 {
     test::check_runner(sample);
@@ -688,6 +936,114 @@ BOOST_DATA_TEST_CASE(f_contains, (std::vector<test::runner_result>{
 }
 //! \endcond
 
+/*! \file
+ * \test \c f_count -- Test of threadscript::predef::f_count */
+//! \cond
+BOOST_DATA_TEST_CASE(f_count, (std::vector<test::runner_result>{
+    {R"(count())", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(count(int_vector()))", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(count(null, int_vector(), +1, 2))", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(count(null, +1))", test::exc{
+        typeid(ts::exception::value_null),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Null value"
+    }, ""},
+    {R"(count(int_vector(), null))", test::exc{
+        typeid(ts::exception::value_null),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Null value"
+    }, ""},
+    {R"(count(vector(), +1))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(count(int_vector(), 1))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(count(unsigned_vector(), +1))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(count(int_vector(), +1))", test::uint_t(0U), ""},
+    {R"(count(int_vector(5), +0))", test::uint_t(5U), ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            count(v(), +3)
+        )
+    )", test::uint_t(2U), ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            count(v(), -5)
+        )
+    )", test::uint_t(1U), ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            count(v(), +7)
+        )
+    )", test::uint_t(0U), ""},
+    {R"(
+        seq(
+            var("v", unsigned_vector(4)),
+            at(v(), 0, 3),
+            at(v(), 1, 5),
+            at(v(), 3, 3),
+            count(v(), 3)
+        )
+    )", test::uint_t(2U), ""},
+    {R"(
+        seq(
+            var("v", unsigned_vector(4)),
+            at(v(), 0, 3),
+            at(v(), 1, 5),
+            at(v(), 3, 3),
+            count(v(), 0)
+        )
+    )", test::uint_t(1U), ""},
+    {R"(
+        seq(
+            var("v", unsigned_vector(4)),
+            at(v(), 0, 3),
+            at(v(), 1, 5),
+            at(v(), 3, 3),
+            var("r", clone(0)),
+            print(is_same(count(r(), v(), 5), r())),
+            r()
+        )
+    )", test::uint_t(1U), "true"},
+}))
+{
+    test::check_runner(sample);
+}
+//! \endcond
+
 /*! \file
  * \test \c f_div -- Test of threadscript::predef::f_div, which also applies to
  * threadscript::predef::f_div_base (the part of implementation shared with
@@ -834,6 +1190,131 @@ BOOST_DATA_TEST_CASE(f_div, (std::vector<test::runner_result>{
 }
 //! \endcond
 
+/*! \file
+ * \test \c f_dot -- Test of threadscript::predef::f_dot */
+//! \cond
+BOOST_DATA_TEST_CASE(f_dot, (std::vector<test::runner_result>{
+    {R"(dot())", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(dot(int_vector()))", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(dot(null, int_vector(), int_vector(), int_vector()))", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(dot(null, int_vector()))", test::exc{
+        typeid(ts::exception::value_null),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Null value"
+    }, ""},
+    {R"(dot(int_vector(), null))", test::exc{
+        typeid(ts::exception::value_null),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Null value"
+    }, ""},
+    {R"(dot(vector(), vector()))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(dot(int_vector(), unsigned_vector()))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(dot(unsigned_vector(), vector()))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(dot(int_vector(1), int_vector(2)))", test::exc{
+        typeid(ts::exception::value_out_of_range),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Value out of range"
+    }, ""},
+    {R"(dot(int_vector(), int_vector()))", test::int_t(0), ""},
+    {R"(dot(unsigned_vector(), unsigned_vector()))", test::uint_t(0U), ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            var("w", int_vector(4)),
+            at(w(), 0, +2),
+            at(w(), 1, +4),
+            at(w(), 2, -1),
+            at(w(), 3, +10),
+            dot(v(), w())
+        )
+    )", test::int_t(16), ""},
+    {R"(
+        seq(
+            var("v", unsigned_vector(4)),
+            at(v(), 0, 3),
+            at(v(), 1, 5),
+            at(v(), 3, 3),
+            var("w", unsigned_vector(4)),
+            at(w(), 0, 2),
+            at(w(), 1, 4),
+            at(w(), 2, 1),
+            at(w(), 3, 10),
+            dot(v(), w())
+        )
+    )", test::uint_t(56U), ""},
+    {R"(
+        seq(
+            var("v", unsigned_vector(4)),
+            at(v(), 0, 3),
+            at(v(), 1, 5),
+            at(v(), 3, 3),
+            var("w", unsigned_vector(4)),
+            at(w(), 0, 2),
+            at(w(), 1, 4),
+            at(w(), 2, 1),
+            at(w(), 3, 10),
+            at(v(), 2, 18446744073709551615),
+            dot(v(), w())
+        )
+    )", test::uint_t(55U), ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            at(v(), 2, +9223372036854775807),
+            dot(v(), v())
+        )
+    )", test::exc{
+        typeid(ts::exception::op_overflow),
+        ts::frame_location("", "", 8, 13),
+        "Runtime error: Overflow"
+    }, ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            var("r", clone(+0)),
+            print(is_same(dot(r(), v(), v()), r())),
+            r()
+        )
+    )", test::int_t(43), "true"},
+}))
+{
+    test::check_runner(sample);
+}
+//! \endcond
+
 /*! \file
  * \test \c f_eq -- Test of threadscript::predef::f_eq */
 //! \cond
@@ -1193,6 +1674,149 @@ BOOST_DATA_TEST_CASE(f_erase, (std::vector<test::runner_result>{
             print(size(h()))
         )
     )", nullptr, "0"},
+    // packed vectors
+    {R"(erase(int_vector(), "0"))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(erase(int_vector(), -1))", test::exc{
+        typeid(ts::exception::value_out_of_range),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Value out of range"
+    }, ""},
+    {R"(
+        seq(
+            var("v", int_vector(5)),
+            erase(v()),
+            size(v())
+        )
+    )", test::uint_t(0U), ""},
+    {R"(
+        seq(
+            var("v", unsigned_vector(5)),
+            erase(v(), 2),
+            size(v())
+        )
+    )", test::uint_t(2U), ""},
+    {R"(
+        seq(
+            var("v", unsigned_vector(5)),
+            erase(v(), 7),
+            size(v())
+        )
+    )", test::uint_t(5U), ""},
+    {R"(seq(var("v", int_vector(2)), mt_safe(v()), erase(v())))", test::exc{
+        typeid(ts::exception::value_read_only),
+        ts::frame_location("", "", 1, 44),
+        "Runtime error: Read-only value"
+    }, ""},
+}))
+{
+    test::check_runner(sample);
+}
+//! \endcond
+
+/*! \file
+ * \test \c f_find -- Test of threadscript::predef::f_find */
+//! \cond
+BOOST_DATA_TEST_CASE(f_find, (std::vector<test::runner_result>{
+    {R"(find())", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(find(int_vector()))", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(find(null, int_vector(), +1))", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(find(null, +1))", test::exc{
+        typeid(ts::exception::value_null),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Null value"
+    }, ""},
+    {R"(find(int_vector(), null))", test::exc{
+        typeid(ts::exception::value_null),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Null value"
+    }, ""},
+    {R"(find(vector(), +1))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(find(int_vector(), 1))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(find(unsigned_vector(), -1))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(find(int_vector(), +1))", nullptr, ""},
+    {R"(find(int_vector(3), +0))", test::uint_t(0U), ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            find(v(), +3)
+        )
+    )", test::uint_t(0U), ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            find(v(), -5)
+        )
+    )", test::uint_t(1U), ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            find(v(), +0)
+        )
+    )", test::uint_t(2U), ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            find(v(), +1)
+        )
+    )", nullptr, ""},
+    {R"(
+        seq(
+            var("v", unsigned_vector(4)),
+            at(v(), 0, 3),
+            at(v(), 1, 5),
+            at(v(), 3, 3),
+            find(v(), 5)
+        )
+    )", test::uint_t(1U), ""},
+    {R"(
+        seq(
+            var("v", unsigned_vector(4)),
+            at(v(), 0, 3),
+            at(v(), 1, 5),
+            at(v(), 3, 3),
+            find(v(), 4)
+        )
+    )", nullptr, ""},
 }))
 {
     test::check_runner(sample);
@@ -1736,6 +2360,47 @@ BOOST_DATA_TEST_CASE(f_int, (std::vector<test::runner_result>{
 }
 //! \endcond
 
+/*! \file
+ * \test \c f_int_vector -- Test of threadscript::predef::f_int_vector */
+//! \cond
+BOOST_DATA_TEST_CASE(f_int_vector, (std::vector<test::runner_result>{
+    {R"(int_vector(1, 2))", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(int_vector(null))", test::exc{
+        typeid(ts::exception::value_null),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Null value"
+    }, ""},
+    {R"(int_vector("1"))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(int_vector(-1))", test::exc{
+        typeid(ts::exception::value_out_of_range),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Value out of range"
+    }, ""},
+    {R"(int_vector(18446744073709551615))", test::exc{
+        typeid(ts::exception::value_out_of_range),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Value out of range"
+    }, ""},
+    {R"(type(int_vector()))", "int_vector", {}},
+    {R"(size(int_vector()))", test::uint_t(0U), ""},
+    {R"(size(int_vector(5)))", test::uint_t(5U), ""},
+    {R"(size(int_vector(+3)))", test::uint_t(3U), ""},
+    {R"(at(int_vector(5), 4))", test::int_t(0), ""},
+    {R"(type(at(int_vector(1), 0)))", "int", {}},
+}))
+{
+    test::check_runner(sample);
+}
+//! \endcond
+
 /*! \file
  * \test \c f_is_mt_safe -- Test of threadscript::predef::f_is_mt_safe */
 //! \cond
@@ -2101,18 +2766,208 @@ BOOST_DATA_TEST_CASE(f_lt, (std::vector<test::runner_result>{
     {R"(lt(false, 1, 2))", test::exc{ // target is constant literal
         typeid(ts::exception::value_read_only),
         ts::frame_location("", "", 1, 1),
-        "Runtime error: Read-only value"
+        "Runtime error: Read-only value"
+    }, ""},
+    {R"(lt(null, 1, 2))", true, ""}, // target is null
+    {R"(lt(1, 1, 1))", false, ""}, // target is constant, but wrong type
+    {R"(lt(clone(true), 24, 24))", false, ""}, // target is modifiable
+    {R"(
+        seq(
+            var("r", clone(false)),
+            print(is_same(lt(var("r"), -1, +2), var("r"))),
+            var("r")
+        )
+    )", true, "true"},
+}))
+{
+    test::check_runner(sample);
+}
+//! \endcond
+
+/*! \file
+ * \test \c f_max -- Test of threadscript::predef::f_max */
+//! \cond
+BOOST_DATA_TEST_CASE(f_max, (std::vector<test::runner_result>{
+    {R"(max())", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(max(null, int_vector(1), null))", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(max(null))", test::exc{
+        typeid(ts::exception::value_null),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Null value"
+    }, ""},
+    {R"(max(vector()))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(max(+1))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(max(int_vector()))", test::exc{
+        typeid(ts::exception::value_out_of_range),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Value out of range"
+    }, ""},
+    {R"(max(unsigned_vector()))", test::exc{
+        typeid(ts::exception::value_out_of_range),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Value out of range"
+    }, ""},
+    {R"(max(int_vector(1)))", test::int_t(0), ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            max(v())
+        )
+    )", test::int_t(3), ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            at(v(), 2, +9223372036854775807),
+            max(v())
+        )
+    )", test::i_max, ""},
+    {R"(
+        seq(
+            var("v", unsigned_vector(4)),
+            at(v(), 0, 3),
+            at(v(), 1, 5),
+            at(v(), 3, 3),
+            max(v())
+        )
+    )", test::uint_t(5U), ""},
+    {R"(
+        seq(
+            var("v", unsigned_vector(4)),
+            at(v(), 0, 3),
+            at(v(), 1, 5),
+            at(v(), 3, 3),
+            at(v(), 2, 18446744073709551615),
+            max(v())
+        )
+    )", test::u_max, ""},
+    {R"(
+        seq(
+            var("v", unsigned_vector(4)),
+            at(v(), 0, 3),
+            at(v(), 1, 5),
+            at(v(), 3, 3),
+            var("r", clone(0)),
+            print(is_same(max(r(), v()), r())),
+            r()
+        )
+    )", test::uint_t(5U), "true"},
+}))
+{
+    test::check_runner(sample);
+}
+//! \endcond
+
+/*! \file
+ * \test \c f_min -- Test of threadscript::predef::f_min */
+//! \cond
+BOOST_DATA_TEST_CASE(f_min, (std::vector<test::runner_result>{
+    {R"(min())", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(min(null, int_vector(1), null))", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(min(null))", test::exc{
+        typeid(ts::exception::value_null),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Null value"
+    }, ""},
+    {R"(min(vector()))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(min(1))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(min(int_vector()))", test::exc{
+        typeid(ts::exception::value_out_of_range),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Value out of range"
     }, ""},
-    {R"(lt(null, 1, 2))", true, ""}, // target is null
-    {R"(lt(1, 1, 1))", false, ""}, // target is constant, but wrong type
-    {R"(lt(clone(true), 24, 24))", false, ""}, // target is modifiable
+    {R"(min(unsigned_vector()))", test::exc{
+        typeid(ts::exception::value_out_of_range),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Value out of range"
+    }, ""},
+    {R"(min(unsigned_vector(1)))", test::uint_t(0U), ""},
     {R"(
         seq(
-            var("r", clone(false)),
-            print(is_same(lt(var("r"), -1, +2), var("r"))),
-            var("r")
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            min(v())
         )
-    )", true, "true"},
+    )", test::int_t(-5), ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            at(v(), 2, -9223372036854775808),
+            min(v())
+        )
+    )", test::i_min, ""},
+    {R"(
+        seq(
+            var("v", unsigned_vector(4)),
+            at(v(), 0, 3),
+            at(v(), 1, 5),
+            at(v(), 3, 3),
+            min(v())
+        )
+    )", test::uint_t(0U), ""},
+    {R"(
+        seq(
+            var("v", unsigned_vector(4)),
+            at(v(), 0, 3),
+            at(v(), 1, 5),
+            at(v(), 3, 3),
+            at(v(), 2, 4),
+            min(v())
+        )
+    )", test::uint_t(3U), ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            var("r", clone(+0)),
+            print(is_same(min(r(), v()), r())),
+            r()
+        )
+    )", test::int_t(-5), "true"},
 }))
 {
     test::check_runner(sample);
@@ -2394,6 +3249,86 @@ BOOST_DATA_TEST_CASE(f_mul, (std::vector<test::runner_result>{
             var("r")
         )
     )", "HelloHello", "true"},
+    // packed vectors
+    {R"(mul(int_vector(), unsigned_vector()))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(mul(unsigned_vector(), 2))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(mul(int_vector(), "a"))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(mul(unsigned_vector(1), unsigned_vector(2)))", test::exc{
+        typeid(ts::exception::value_out_of_range),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Value out of range"
+    }, ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            var("w", int_vector(4)),
+            at(w(), 0, +2),
+            at(w(), 1, +4),
+            at(w(), 2, -1),
+            at(w(), 3, +10),
+            var("r", mul(v(), w())),
+            print(type(r())),
+            print(at(r(), 0), at(r(), 1), at(r(), 2), at(r(), 3)),
+            size(r())
+        )
+    )", test::uint_t(4U), "int_vector6-20030"},
+    {R"(
+        seq(
+            var("v", unsigned_vector(4)),
+            at(v(), 0, 3),
+            at(v(), 1, 5),
+            at(v(), 3, 3),
+            var("w", unsigned_vector(4)),
+            at(w(), 0, 2),
+            at(w(), 1, 4),
+            at(w(), 2, 1),
+            at(w(), 3, 10),
+            var("r", mul(v(), w())),
+            print(type(r())),
+            print(at(r(), 0), at(r(), 1), at(r(), 2), at(r(), 3)),
+            size(r())
+        )
+    )", test::uint_t(4U), "unsigned_vector620030"},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            at(v(), 2, +9223372036854775807),
+            mul(v(), v())
+        )
+    )", test::exc{
+        typeid(ts::exception::op_overflow),
+        ts::frame_location("", "", 8, 13),
+        "Runtime error: Overflow"
+    }, ""},
+    {R"(
+        seq(
+            var("v", unsigned_vector(4)),
+            at(v(), 0, 3),
+            at(v(), 1, 5),
+            at(v(), 3, 3),
+            var("r", clone(v())),
+            print(is_same(mul(r(), v(), v()), r())),
+            sum(r())
+        )
+    )", test::uint_t(43U), "true"},
 }))
 {
     test::check_runner(sample);
@@ -2573,6 +3508,281 @@ BOOST_DATA_TEST_CASE(f_or_r, (std::vector<test::runner_result>{
 }
 //! \endcond
 
+/*! \file
+ * \test \c f_par_for -- Test of threadscript::predef::f_par_for. The checks of
+ * arguments implemented in threadscript::predef::f_par_base are done only
+ * here. */
+//! \cond
+BOOST_DATA_TEST_CASE(f_par_for, (std::vector<test::runner_result>{
+    {R"(par_for())", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(par_for(vector()))", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(par_for(vector(), "f", null))", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(par_for(null, "f"))", test::exc{
+        typeid(ts::exception::value_null),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Null value"
+    }, ""},
+    {R"(par_for(hash(), "f"))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(par_for(vector(), "f"))", test::exc{
+        typeid(ts::exception::value_mt_unsafe),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Thread-unsafe value"
+    }, ""},
+    {R"(par_for(mt_safe(vector()), null))", test::exc{
+        typeid(ts::exception::value_null),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Null value"
+    }, ""},
+    {R"(par_for(mt_safe(vector()), 1))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(par_for(mt_safe(vector()), "f"))", test::exc{
+        typeid(ts::exception::unknown_symbol),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Symbol not found: f"
+    }, ""},
+    {R"(par_for(mt_safe(vector()), "add"))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(seq(
+            fun("f", throw("called")),
+            par_for(mt_safe(vector()), "f")
+        ))", nullptr, ""},
+    {R"(seq(
+            fun("f", print(at(_args(), 0), ":", at(_args(), 1))),
+            var("v", vector()),
+            at(v(), 0, "a"),
+            par_for(mt_safe(v()), "f")
+        ))", nullptr, "a:0"},
+    {R"(seq(
+            fun("f", if(eq(at(_args(), 1), 567), throw("bad"), null)),
+            var("v", vector()),
+            var("i", clone(0)),
+            while(lt(i(), 1000), seq(
+                at(v(), i(), null),
+                add(i(), i(), 1)
+            )),
+            try(par_for(mt_safe(v()), "f"), "!bad", "caught")
+        ))", "caught", ""},
+}))
+{
+    test::check_runner(sample);
+}
+//! \endcond
+
+/*! \file
+ * \test \c f_par_map -- Test of threadscript::predef::f_par_map */
+//! \cond
+BOOST_DATA_TEST_CASE(f_par_map, (std::vector<test::runner_result>{
+    {R"(par_map(mt_safe(vector()), "f", null))", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(par_map(vector(), "f"))", test::exc{
+        typeid(ts::exception::value_mt_unsafe),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Thread-unsafe value"
+    }, ""},
+    {R"(seq(
+            fun("f", throw("called")),
+            size(par_map(mt_safe(vector()), "f"))
+        ))", test::uint_t(0), ""},
+    {R"(seq(
+            fun("f", at(_args(), 1)),
+            var("v", vector()),
+            at(v(), 0, "a"),
+            at(v(), 1, "b"),
+            var("r", par_map(mt_safe(v()), "f")),
+            and(eq(size(r()), 2), eq(at(r(), 0), 0), eq(at(r(), 1), 1))
+        ))", true, ""},
+    {R"(seq(
+            fun("f", clone(at(_args(), 0))),
+            var("v", vector()),
+            at(v(), 0, "a"),
+            at(v(), 1, "b"),
+            var("r", par_map(mt_safe(v()), "f")),
+            and(is_mt_safe(at(r(), 0)), is_mt_safe(at(r(), 1)))
+        ))", true, ""},
+    {R"(seq(
+            fun("sq", mul(at(_args(), 0), at(_args(), 0))),
+            var("v", vector()),
+            var("i", clone(0)),
+            while(lt(i(), 1000), seq(
+                at(v(), i(), mt_safe(clone(i()))),
+                add(i(), i(), 1)
+            )),
+            var("r", par_map(mt_safe(v()), "sq")),
+            var("ok", eq(size(r()), 1000)),
+            var("i", clone(0)),
+            while(lt(i(), 1000), seq(
+                if(ne(at(r(), i()), mul(i(), i())), var("ok", false), null),
+                add(i(), i(), 1)
+            )),
+            ok()
+        ))", true, ""},
+    {R"(seq(
+            fun("f", if(eq(at(_args(), 1), 567), throw("bad"), null)),
+            var("v", vector()),
+            var("i", clone(0)),
+            while(lt(i(), 1000), seq(
+                at(v(), i(), null),
+                add(i(), i(), 1)
+            )),
+            try(par_map(mt_safe(v()), "f"), "!bad", "caught")
+        ))", "caught", ""},
+}))
+{
+    test::check_runner(sample);
+}
+//! \endcond
+
+/*! \file
+ * \test \c par_pool_state -- Global variables set by a parallel function in
+ * a pool thread are not visible to later parallel calls */
+//! \cond
+BOOST_AUTO_TEST_CASE(par_pool_state)
+{
+    // Repeated parallel calls, so that pool threads process some chunks
+    test::script_runner runner{R"(seq(
+        fun("f", gvar("mark", true)),
+        var("v", vector()),
+        var("i", clone(0)),
+        while(lt(i(), 1000), seq(
+            at(v(), i(), null),
+            add(i(), i(), 1)
+        )),
+        mt_safe(v()),
+        var("i", clone(0)),
+        while(lt(i(), 20), seq(
+            par_for(v(), "f"),
+            add(i(), i(), 1)
+        ))
+    ))"};
+    runner.run();
+    // A new state of the calling thread, so that only pool threads could
+    // have variable mark set
+    runner.script = R"(seq(
+        fun("f", try(mark(), "", false)),
+        fun("g", or(at(_args(), 0), at(_args(), 1))),
+        var("v", vector()),
+        var("i", clone(0)),
+        while(lt(i(), 1000), seq(
+            at(v(), i(), null),
+            add(i(), i(), 1)
+        )),
+        mt_safe(v()),
+        var("seen", false),
+        var("i", clone(0)),
+        while(lt(i(), 20), seq(
+            var("seen", or(seen(),
+                par_reduce(mt_safe(par_map(v(), "f")), "g"))),
+            add(i(), i(), 1)
+        )),
+        seen()
+    ))";
+    auto result = runner.run();
+    auto b = std::dynamic_pointer_cast<ts::value_bool>(result);
+    BOOST_REQUIRE(b);
+    BOOST_CHECK(!b->cvalue());
+}
+//! \endcond
+
+/*! \file
+ * \test \c f_par_reduce -- Test of threadscript::predef::f_par_reduce */
+//! \cond
+BOOST_DATA_TEST_CASE(f_par_reduce, (std::vector<test::runner_result>{
+    {R"(par_reduce(mt_safe(vector()), "add", null, null))", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(par_reduce(vector(), "f"))", test::exc{
+        typeid(ts::exception::value_mt_unsafe),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Thread-unsafe value"
+    }, ""},
+    {R"(seq(
+            fun("f", throw("called")),
+            par_reduce(mt_safe(vector()), "f")
+        ))", nullptr, ""},
+    {R"(seq(
+            fun("f", throw("called")),
+            par_reduce(mt_safe(vector()), "f", 5)
+        ))", test::uint_t(5), ""},
+    {R"(seq(
+            fun("f", throw("called")),
+            var("v", vector()),
+            at(v(), 0, 7),
+            par_reduce(mt_safe(v()), "f")
+        ))", test::uint_t(7), ""},
+    {R"(seq(
+            fun("f", add(at(_args(), 0), at(_args(), 1))),
+            var("v", vector()),
+            at(v(), 0, 7),
+            par_reduce(mt_safe(v()), "f", 5)
+        ))", test::uint_t(12), ""},
+    {R"(seq(
+            fun("f", add(at(_args(), 0), at(_args(), 1))),
+            var("v", vector()),
+            var("i", clone(0)),
+            while(lt(i(), 1000), seq(
+                add(i(), i(), 1),
+                at(v(), sub(i(), 1), mt_safe(clone(i())))
+            )),
+            mt_safe(v()),
+            add(par_reduce(v(), "f"), par_reduce(v(), "f", 1000000))
+        ))", test::uint_t(1500500 + 500500), ""},
+    {R"(seq(
+            fun("f", add(at(_args(), 0), at(_args(), 1))),
+            var("v", vector()),
+            var("s", clone("")),
+            var("i", clone(0)),
+            while(lt(i(), 1000), seq(
+                at(v(), i(),
+                    mt_safe(substr("abcdefghijklm", mod(i(), 13), 1))),
+                add(s(), s(), at(v(), i())),
+                add(i(), i(), 1)
+            )),
+            eq(par_reduce(mt_safe(v()), "f", "<"), add("<", s()))
+        ))", true, ""},
+    {R"(seq(
+            fun("f", if(eq(at(_args(), 1), 567), throw("bad"),
+                add(at(_args(), 0), at(_args(), 1)))),
+            var("v", vector()),
+            var("i", clone(0)),
+            while(lt(i(), 1000), seq(
+                at(v(), i(), mt_safe(clone(i()))),
+                add(i(), i(), 1)
+            )),
+            try(par_reduce(mt_safe(v()), "f"), "!bad", "caught")
+        ))", "caught", ""},
+}))
+{
+    test::check_runner(sample);
+}
+//! \endcond
+
 /*! \file
  * \test \c f_print -- Test of threadscript::predef::f_print */
 //! \cond
@@ -2663,6 +3873,14 @@ BOOST_DATA_TEST_CASE(f_size, (std::vector<test::runner_result>{
             r()
         )
     )", test::uint_t(3), "true"},
+    {R"(size(int_vector(3)))", test::uint_t(3U), ""},
+    {R"(
+        seq(
+            var("v", unsigned_vector()),
+            at(v(), 4, 1),
+            size(v())
+        )
+    )", test::uint_t(5U), ""},
 }))
 {
     test::check_runner(sample);
@@ -2976,6 +4194,121 @@ BOOST_DATA_TEST_CASE(f_substr, (std::vector<test::runner_result>{
 }
 //! \endcond
 
+/*! \file
+ * \test \c f_sum -- Test of threadscript::predef::f_sum */
+//! \cond
+BOOST_DATA_TEST_CASE(f_sum, (std::vector<test::runner_result>{
+    {R"(sum())", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(sum(null, int_vector(), null))", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(sum(null))", test::exc{
+        typeid(ts::exception::value_null),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Null value"
+    }, ""},
+    {R"(sum(vector()))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(sum(+1))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(sum(int_vector()))", test::int_t(0), ""},
+    {R"(sum(unsigned_vector()))", test::uint_t(0U), ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            sum(v())
+        )
+    )", test::int_t(1), ""},
+    {R"(
+        seq(
+            var("v", unsigned_vector(4)),
+            at(v(), 0, 3),
+            at(v(), 1, 5),
+            at(v(), 3, 3),
+            sum(v())
+        )
+    )", test::uint_t(11U), ""},
+    {R"(
+        seq(
+            var("v", unsigned_vector(4)),
+            at(v(), 0, 3),
+            at(v(), 1, 5),
+            at(v(), 3, 3),
+            at(v(), 2, 18446744073709551615),
+            sum(v())
+        )
+    )", test::uint_t(10U), ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            at(v(), 1, +9223372036854775807),
+            at(v(), 0, -3),
+            sum(v())
+        )
+    )", test::i_max, ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            at(v(), 2, +9223372036854775807),
+            sum(v())
+        )
+    )", test::exc{
+        typeid(ts::exception::op_overflow),
+        ts::frame_location("", "", 8, 13),
+        "Runtime error: Overflow"
+    }, ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            at(v(), 2, -9223372036854775808),
+            sum(v())
+        )
+    )", test::exc{
+        typeid(ts::exception::op_overflow),
+        ts::frame_location("", "", 8, 13),
+        "Runtime error: Overflow"
+    }, ""},
+    {R"(
+        seq(
+            var("v", int_vector(4)),
+            at(v(), 0, +3),
+            at(v(), 1, -5),
+            at(v(), 3, +3),
+            var("r", clone(+0)),
+            print(is_same(sum(r(), v()), r())),
+            r()
+        )
+    )", test::int_t(1), "true"},
+}))
+{
+    test::check_runner(sample);
+}
+//! \endcond
+
 /*! \file
  * \test \c f_throw -- Test of threadscript::predef::f_throw */
 //! \cond
@@ -3402,6 +4735,47 @@ BOOST_DATA_TEST_CASE(f_unsigned, (std::vector<test::runner_result>{
 }
 //! \endcond
 
+/*! \file
+ * \test \c f_unsigned_vector -- Test of
+ * threadscript::predef::f_unsigned_vector */
+//! \cond
+BOOST_DATA_TEST_CASE(f_unsigned_vector, (std::vector<test::runner_result>{
+    {R"(unsigned_vector(1, 2))", test::exc{
+        typeid(ts::exception::op_narg),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad number of arguments"
+    }, ""},
+    {R"(unsigned_vector(null))", test::exc{
+        typeid(ts::exception::value_null),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Null value"
+    }, ""},
+    {R"(unsigned_vector("1"))", test::exc{
+        typeid(ts::exception::value_type),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Bad value type"
+    }, ""},
+    {R"(unsigned_vector(-1))", test::exc{
+        typeid(ts::exception::value_out_of_range),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Value out of range"
+    }, ""},
+    {R"(unsigned_vector(18446744073709551615))", test::exc{
+        typeid(ts::exception::value_out_of_range),
+        ts::frame_location("", "", 1, 1),
+        "Runtime error: Value out of range"
+    }, ""},
+    {R"(type(unsigned_vector()))", "unsigned_vector", {}},
+    {R"(size(unsigned_vector()))", test::uint_t(0U), ""},
+    {R"(size(unsigned_vector(5)))", test::uint_t(5U), ""},
+    {R"(at(unsigned_vector(5), 4))", test::uint_t(0U), ""},
+    {R"(type(at(unsigned_vector(1), 0)))", "unsigned", {}},
+}))
+{
+    test::check_runner(sample);
+}
+//! \endcond
+
 /*! \file
  * \test \c f_var -- Test of threadscript::predef::f_var */
 //! \cond
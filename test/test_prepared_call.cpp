@@ -0,0 +1,161 @@
+/*! \file
+ * \brief Tests of class threadscript::basic_prepared_call
+ */
+
+//! \cond
+#include "threadscript/threadscript.hpp"
+#include "threadscript/symbol_table_impl.hpp"
+
+#define BOOST_TEST_MODULE prepared_call
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+namespace ts = threadscript;
+
+namespace test {
+
+ts::allocator_any alloc;
+
+// Runs a script defining functions and publishes them in vm.sh_vars
+void define(ts::virtual_machine& vm, std::string_view src)
+{
+    auto sh_vars = ts::predef_symbols(alloc);
+    {
+        ts::state thread{vm, sh_vars};
+        ts::parse_code(alloc, src, "string")->eval(thread);
+        auto& t_vars = thread.t_vars.symbols();
+        for (auto it = t_vars.begin(); it != t_vars.end(); ++it)
+            sh_vars->insert(it->first, std::move(it->second));
+    }
+    vm.sh_vars = sh_vars;
+}
+
+} // namespace test
+//! \endcond
+
+/*! \file
+ * \test \c convert -- Conversion of arguments and results */
+//! \cond
+BOOST_AUTO_TEST_CASE(convert)
+{
+    ts::virtual_machine vm{test::alloc};
+    test::define(vm, R"(seq(
+        fun("add_int", add(at(_args(), 0), at(_args(), 1))),
+        fun("negate", not(at(_args(), 0))),
+        fun("concat", add(at(_args(), 0), at(_args(), 1))),
+        fun("nargs", size(_args())),
+        fun("first", at(_args(), 0)),
+        fun("none", null)
+    ))");
+    ts::state thread{vm};
+    ts::prepared_call<int(int, int)> add_int{thread, "add_int"};
+    BOOST_TEST(add_int(1, 2) == 3);
+    BOOST_TEST(add_int(-10, 3) == -7);
+    ts::prepared_call<unsigned(unsigned, unsigned)> add_unsigned{thread,
+        "add_int"};
+    BOOST_TEST(add_unsigned(40, 2) == 42U);
+    ts::prepared_call<bool(bool)> negate{thread, "negate"};
+    BOOST_TEST(negate(false));
+    BOOST_TEST(!negate(true));
+    ts::prepared_call<std::string(std::string_view, const char*)> concat{
+        thread, "concat"};
+    BOOST_TEST(concat("abc", "def") == "abcdef");
+    BOOST_TEST(concat("", "x") == "x");
+    ts::prepared_call<unsigned()> nargs0{thread, "nargs"};
+    BOOST_TEST(nargs0() == 0U);
+    ts::prepared_call<unsigned(int, bool, std::string)> nargs3{thread,
+        "nargs"};
+    BOOST_TEST(nargs3(1, true, "s") == 3U);
+    ts::prepared_call<ts::value::value_ptr(ts::value::value_ptr)> first{
+        thread, "first"};
+    auto v = ts::value_int::create(test::alloc);
+    BOOST_TEST(first(v) == v);
+    BOOST_TEST(first(nullptr) == nullptr);
+    ts::prepared_call<void(int)> none{thread, "none"};
+    none(1);
+    ts::prepared_call<int()> none_int{thread, "none"};
+    BOOST_CHECK_THROW(none_int(), ts::exception::value_null);
+    ts::prepared_call<std::string(int, int)> bad_result{thread, "add_int"};
+    BOOST_CHECK_THROW(bad_result(1, 2), ts::exception::value_type);
+    ts::prepared_call<uint8_t(unsigned, unsigned)> add_byte{thread,
+        "add_int"};
+    BOOST_TEST(add_byte(200, 55) == 255U);
+    BOOST_CHECK_THROW(add_byte(200, 100), ts::exception::value_out_of_range);
+    ts::prepared_call<int32_t(int64_t, int64_t)> add_i32{thread, "add_int"};
+    BOOST_TEST(add_i32(-2147483647, -1) == -2147483648);
+    BOOST_CHECK_THROW(add_i32(4294967296, 1),
+                      ts::exception::value_out_of_range);
+}
+//! \endcond
+
+/*! \file
+ * \test \c lookup -- Finding the function */
+//! \cond
+BOOST_AUTO_TEST_CASE(lookup)
+{
+    ts::virtual_machine vm{test::alloc};
+    test::define(vm, R"(seq(
+        fun("f", 1),
+        gvar("v", 2)
+    ))");
+    ts::state thread{vm};
+    using call_t = ts::prepared_call<unsigned()>;
+    BOOST_CHECK_THROW(call_t(thread, "g"), ts::exception::unknown_symbol);
+    BOOST_CHECK_THROW(call_t(thread, "v"), ts::exception::value_type);
+    BOOST_CHECK_THROW(call_t(thread, "print"), ts::exception::value_type);
+    call_t f{thread, "f"};
+    BOOST_TEST(f() == 1U);
+}
+//! \endcond
+
+/*! \file
+ * \test \c reuse -- Reusing argument values */
+//! \cond
+BOOST_AUTO_TEST_CASE(reuse)
+{
+    ts::virtual_machine vm{test::alloc};
+    test::define(vm, R"(seq(
+        fun("dbl", add(at(_args(), 0), at(_args(), 0), at(_args(), 0))),
+        fun("keep", seq(gvar("kept", at(_args(), 0)), kept())),
+        fun("replace", seq(at(_args(), 0, "x"), 0))
+    ))");
+    ts::state thread{vm};
+    // The function modifies its argument in place
+    ts::prepared_call<int(int)> dbl{thread, "dbl"};
+    BOOST_TEST(dbl(1) == 2);
+    BOOST_TEST(dbl(1) == 2);
+    BOOST_TEST(dbl(10) == 20);
+    // The function keeps a reference to its argument
+    ts::prepared_call<int(int)> keep{thread, "keep"};
+    BOOST_TEST(keep(1) == 1);
+    auto kept = thread.t_vars.lookup("kept");
+    BOOST_REQUIRE(kept);
+    BOOST_TEST(keep(2) == 2);
+    BOOST_TEST(dynamic_cast<ts::value_int&>(**kept).cvalue() == 1);
+    // The function replaces its argument
+    ts::prepared_call<unsigned(int)> replace{thread, "replace"};
+    BOOST_TEST(replace(1) == 0U);
+    BOOST_TEST(replace(1) == 0U);
+}
+//! \endcond
+
+/*! \file
+ * \test \c sh_vars -- Finding the function again after switching to new
+ * shared variables */
+//! \cond
+BOOST_AUTO_TEST_CASE(sh_vars)
+{
+    ts::virtual_machine vm{test::alloc};
+    test::define(vm, R"(fun("version", 1))");
+    ts::state thread{vm};
+    ts::prepared_call<unsigned()> version{thread, "version"};
+    BOOST_TEST(version() == 1U);
+    test::define(vm, R"(fun("version", 2))");
+    BOOST_TEST(version() == 1U);
+    BOOST_TEST(thread.update_sh_vars());
+    BOOST_TEST(version() == 2U);
+    test::define(vm, R"(fun("other", 3))");
+    BOOST_TEST(thread.update_sh_vars());
+    BOOST_CHECK_THROW(version(), ts::exception::unknown_symbol);
+}
+//! \endcond
@@ -0,0 +1,317 @@
+/*! \file
+ * \brief Tests of class threadscript::basic_reloader
+ */
+
+//! \cond
+#include "threadscript/threadscript.hpp"
+#include "threadscript/symbol_table_impl.hpp"
+
+#define BOOST_TEST_MODULE reload
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <thread>
+
+#include "tmp_dir.hpp"
+
+namespace ts = threadscript;
+
+namespace test {
+
+ts::allocator_any alloc;
+
+// A script file in a temporary directory removed at the end of a test
+struct script_file: tmp_dir {
+    script_file(): tmp_dir("test_reload") {}
+    void write(std::string_view src) {
+        tmp_dir::write("script.ts", std::string{src});
+    }
+    std::string name() const {
+        return (path / "script.ts").string();
+    }
+};
+
+// Calls a shared function without arguments and returns an unsigned result
+ts::config::value_unsigned_type call(ts::state& thread, const char* name)
+{
+    auto f = thread.t_vars.lookup(name);
+    BOOST_REQUIRE(f);
+    auto fun = std::dynamic_pointer_cast<ts::value_function>(*f);
+    BOOST_REQUIRE(fun);
+    auto result = fun->call(thread, name);
+    auto u = dynamic_cast<ts::value_unsigned*>(result.get());
+    BOOST_REQUIRE(u);
+    return u->cvalue();
+}
+
+} // namespace test
+//! \endcond
+
+/*! \file
+ * \test \c reload -- Loading new versions of a script */
+//! \cond
+BOOST_AUTO_TEST_CASE(reload)
+{
+    test::script_file script;
+    ts::virtual_machine vm{test::alloc};
+    ts::reloader reloader{vm, script.name()};
+    BOOST_TEST(!reloader.script());
+    script.write(R"(fun("version", 1))");
+    auto s1 = reloader.reload();
+    BOOST_TEST(s1);
+    BOOST_TEST(reloader.script() == s1);
+    BOOST_TEST(vm.sh_vars.generation() == 1U);
+    ts::state thread{vm};
+    BOOST_TEST(test::call(thread, "version") == 1);
+    BOOST_TEST(thread.t_vars.contains("print"));
+    script.write(R"(fun("version", 2))");
+    auto s2 = reloader.reload();
+    BOOST_TEST(reloader.script() == s2);
+    BOOST_TEST(test::call(thread, "version") == 1);
+    BOOST_TEST(thread.update_sh_vars());
+    BOOST_TEST(test::call(thread, "version") == 2);
+    BOOST_TEST(!thread.update_sh_vars());
+    // The old script is owned only by this test
+    BOOST_TEST(s1.use_count() == 1);
+}
+//! \endcond
+
+/*! \file
+ * \test \c reload_error -- A failed reload keeps the current script */
+//! \cond
+BOOST_AUTO_TEST_CASE(reload_error)
+{
+    test::script_file script;
+    ts::virtual_machine vm{test::alloc};
+    ts::reloader reloader{vm, script.name()};
+    script.write(R"(fun("version", 1))");
+    auto s1 = reloader.reload();
+    script.write(R"(fun("version")");
+    BOOST_CHECK_THROW(reloader.reload(), std::exception);
+    script.write(R"(seq(fun("version", 2), throw("failed")))");
+    BOOST_CHECK_THROW(reloader.reload(), ts::exception::script_throw);
+    BOOST_TEST(reloader.script() == s1);
+    BOOST_TEST(vm.sh_vars.generation() == 1U);
+    ts::state thread{vm};
+    BOOST_TEST(test::call(thread, "version") == 1);
+}
+//! \endcond
+
+/*! \file
+ * \test \c reload_make_sh_vars -- A user-defined initial content of the shared
+ * symbol table */
+//! \cond
+BOOST_AUTO_TEST_CASE(reload_make_sh_vars)
+{
+    test::script_file script;
+    ts::virtual_machine vm{test::alloc};
+    ts::reloader reloader{vm, script.name(),
+        ts::syntax_factory::syntax_canon, []() {
+            auto sh_vars = ts::predef_symbols(test::alloc);
+            auto v = ts::value_unsigned::create(test::alloc);
+            v->value() = 10;
+            v->set_mt_safe();
+            sh_vars->insert("base", v);
+            return sh_vars;
+        }};
+    script.write(R"(fun("version", add(base(), 1)))");
+    reloader.reload();
+    ts::state thread{vm};
+    BOOST_TEST(test::call(thread, "version") == 11);
+    BOOST_TEST(!thread.t_vars.contains("shared_hash"));
+}
+//! \endcond
+
+/*! \file
+ * \test \c reload_resolve -- Unresolving old scripts */
+//! \cond
+BOOST_AUTO_TEST_CASE(reload_resolve)
+{
+    test::script_file script;
+    ts::virtual_machine vm{test::alloc};
+    std::weak_ptr<ts::script> s1;
+    {
+        ts::reloader reloader{vm, script.name(),
+            ts::syntax_factory::syntax_canon, {}, true};
+        script.write(R"(seq(
+            fun("one", 1),
+            fun("version", one())
+        ))");
+        s1 = reloader.reload();
+        ts::state thread{vm};
+        BOOST_TEST(test::call(thread, "version") == 1);
+        script.write(R"(seq(
+            fun("two", 2),
+            fun("version", two())
+        ))");
+        reloader.reload();
+        // The symbol table of s1 is still used by thread
+        BOOST_TEST(reloader.collect() == 1U);
+        BOOST_TEST(!s1.expired());
+        BOOST_TEST(thread.update_sh_vars());
+        BOOST_TEST(test::call(thread, "version") == 2);
+        BOOST_TEST(reloader.collect() == 0U);
+        BOOST_TEST(s1.expired());
+    }
+    vm.sh_vars = nullptr;
+}
+//! \endcond
+
+/*! \file
+ * \test \c update_sh_vars_resolve -- An old resolved script is not unresolved
+ * while a thread that has called function \c update_sh_vars still runs it */
+//! \cond
+BOOST_AUTO_TEST_CASE(update_sh_vars_resolve)
+{
+    test::script_file script;
+    ts::virtual_machine vm{test::alloc};
+    ts::reloader reloader{vm, script.name(),
+        ts::syntax_factory::syntax_canon, {}, true};
+    // After switching to new shared variables, the thread continues running
+    // the old script, which calls its resolved function one() until the
+    // next reload.
+    script.write(R"(seq(
+        fun("one", 1),
+        fun("wait", seq(
+            while(not(update_sh_vars()), one()),
+            while(not(update_sh_vars()), one()),
+            one()
+        ))
+    ))");
+    reloader.reload();
+    ts::config::value_unsigned_type result = 0;
+    std::atomic<bool> started = false;
+    std::thread thr([&vm, &result, &started]() {
+        ts::state thread{vm};
+        started = true;
+        auto parsed = ts::parse_code(test::alloc, "wait()", "string");
+        auto v = parsed->eval(thread);
+        if (auto u = dynamic_cast<ts::value_unsigned*>(v.get()))
+            result = u->cvalue();
+    });
+    while (!started)
+        std::this_thread::yield();
+    script.write(R"(fun("two", 2))");
+    reloader.reload();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    // The first script is kept by the stack of the thread
+    BOOST_TEST(reloader.collect() == 1U);
+    reloader.reload();
+    thr.join();
+    BOOST_TEST(result == 1U);
+    BOOST_TEST(reloader.collect() == 0U);
+    vm.sh_vars = nullptr;
+}
+//! \endcond
+
+/*! \file
+ * \test \c update_sh_vars_repeated -- A thread running a single call of an
+ * old resolved script does not keep scripts loaded during the call */
+//! \cond
+BOOST_AUTO_TEST_CASE(update_sh_vars_repeated)
+{
+    using namespace std::chrono_literals;
+    test::script_file script;
+    ts::virtual_machine vm{test::alloc};
+    ts::reloader reloader{vm, script.name(),
+        ts::syntax_factory::syntax_canon, {}, true};
+    // The thread runs the first script until a new script defines variable
+    // done, which is looked up by name in the current shared variables
+    script.write(R"(fun("wait", while(not(try(var("done"), "", false)),
+        update_sh_vars()
+    )))");
+    std::weak_ptr<ts::script> s1 = reloader.reload();
+    std::atomic<bool> started = false;
+    std::thread thr([&vm, &started]() {
+        ts::state thread{vm};
+        started = true;
+        ts::parse_code(test::alloc, "wait()", "string")->eval(thread);
+    });
+    while (!started)
+        std::this_thread::yield();
+    script.write(R"(fun("two", 2))");
+    for (int i = 0; i < 20; ++i) {
+        reloader.reload();
+        // Only the first script is kept by the thread, the previous one is
+        // released when the thread switches to a newer one
+        auto deadline = std::chrono::steady_clock::now() + 10s;
+        while (reloader.collect() > 1 &&
+               std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::yield();
+        }
+        BOOST_TEST(reloader.collect() == 1U);
+        BOOST_TEST(!s1.expired());
+    }
+    script.write(R"(gvar("done", true))");
+    reloader.reload();
+    thr.join();
+    BOOST_TEST(reloader.collect() == 0U);
+    BOOST_TEST(s1.expired());
+    vm.sh_vars = nullptr;
+}
+//! \endcond
+
+/*! \file
+ * \test \c update_sh_vars -- Function \c update_sh_vars used by threads
+ * running during reload */
+//! \cond
+BOOST_AUTO_TEST_CASE(update_sh_vars)
+{
+    test::script_file script;
+    ts::virtual_machine vm{test::alloc};
+    ts::reloader reloader{vm, script.name()};
+    script.write(R"(seq(
+        fun("version", 1),
+        fun("wait", seq(
+            var("v", 0),
+            while(ne(v(), 2), seq(
+                update_sh_vars(),
+                var("v", version())
+            )),
+            v()
+        ))
+    ))");
+    reloader.reload();
+    // Looked up before starting the threads, because a thread started after
+    // the second reload would not find it
+    std::shared_ptr<ts::value_function> f;
+    {
+        ts::state thread{vm};
+        f = std::dynamic_pointer_cast<ts::value_function>(
+                                    thread.t_vars.lookup("wait").value());
+        BOOST_REQUIRE(f);
+    }
+    constexpr size_t num_threads = 4;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> done = 0;
+    for (size_t t = 0; t < num_threads; ++t)
+        threads.emplace_back([&vm, &f, &done]() {
+            ts::state thread{vm};
+            auto v = f->call(thread, "wait");
+            if (auto u = dynamic_cast<ts::value_unsigned*>(v.get());
+                u && u->cvalue() == 2)
+            {
+                ++done;
+            }
+        });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    BOOST_TEST(done == 0U);
+    script.write(R"(fun("version", 2))");
+    reloader.reload();
+    for (auto&& t: threads)
+        t.join();
+    BOOST_TEST(done == num_threads);
+    ts::state thread{vm};
+    auto parsed = ts::parse_code(test::alloc, "update_sh_vars()", "string");
+    auto result = parsed->eval(thread);
+    auto b = dynamic_cast<ts::value_bool*>(result.get());
+    BOOST_REQUIRE(b);
+    BOOST_TEST(!b->cvalue());
+    reloader.reload();
+    result = parsed->eval(thread);
+    b = dynamic_cast<ts::value_bool*>(result.get());
+    BOOST_REQUIRE(b);
+    BOOST_TEST(b->cvalue());
+}
+//! \endcond
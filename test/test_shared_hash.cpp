@@ -15,7 +15,7 @@
 
 #include <thread>
 
-auto sh_vars = test::make_sh_vars<ts::shared_hash>();
+auto sh_vars = test::make_sh_vars<ts::shared_hash, ts::channel>();
 //! \endcond
 
 /*! \file
@@ -211,6 +211,72 @@ BOOST_DATA_TEST_CASE(method_at, (std::vector<test::runner_result>{
 }
 //! \endcond
 
+/*! \file
+ * \test \c method_cas -- Tests method
+ * threadscript::basic_shared_hash::cas() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_cas, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", shared_hash()),
+            o("cas", "k", null)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("cas", null, null, null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("cas", 1, null, null)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("cas", "k", null, clone(1))
+        ))", test::exc{
+            typeid(ts::exception::value_mt_unsafe),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Thread-unsafe value"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("at", "k", "a"),
+            o("cas", "k", 1, "b")
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 4, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            print(o("cas", "x", "a", "b"), ",", o("size"), ","),
+            print(o("cas", "x", null, "b"), ",", o("at", "x"), ","),
+            print(o("cas", "x", "a", "c"), ",", o("at", "x"), ","),
+            print(o("cas", "x", "b", "c"), ",", o("at", "x"), ","),
+            print(o("cas", "x", "c", null), ",", is_null(o("at", "x")))
+        ))", nullptr, "false,0,true,b,false,b,true,c,true,true"},
+    {R"(seq(
+            var("o", shared_hash()),
+            var("v", mt_safe(vector())),
+            o("at", "k", v()),
+            print(o("cas", "k", v(), 1), ",", o("at", "k"))
+        ))", nullptr, "true,1"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
 /*! \file
  * \test \c method_contains -- Tests method
  * threadscript::basic_shared_hash::contains() */
@@ -425,6 +491,248 @@ BOOST_DATA_TEST_CASE(method_erase, (std::vector<test::runner_result>{
 }
 //! \endcond
 
+/*! \file
+ * \test \c method_erase_many -- Tests method
+ * threadscript::basic_shared_hash::erase_many() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_erase_many, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", shared_hash()),
+            o("erase_many")
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("erase_many", null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("erase_many", "a")
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            var("k", vector()),
+            at(k(), 0, "a"),
+            at(k(), 1, 1),
+            o("at", "a", 1),
+            o("erase_many", k())
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 7, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            var("k", vector()),
+            at(k(), 1, "a"),
+            o("erase_many", k())
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 5, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("at", "a", 1),
+            o("at", "b", 2),
+            o("at", "c", 3),
+            var("k", vector()),
+            at(k(), 0, "c"),
+            at(k(), 1, "x"),
+            at(k(), 2, "a"),
+            o("erase_many", k()),
+            print(at(o("keys"), 0)),
+            o("size")
+        ))", test::uint_t(1U), "b"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_fetch_add -- Tests method
+ * threadscript::basic_shared_hash::fetch_add() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_fetch_add, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", shared_hash()),
+            o("fetch_add", "k")
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("fetch_add", "k", null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("fetch_add", "k", "1")
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("at", "k", 1),
+            o("fetch_add", "k", +1)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 4, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("at", "k", +9223372036854775807),
+            o("fetch_add", "k", +1)
+        ))", test::exc{
+            typeid(ts::exception::op_overflow),
+            ts::frame_location("", "", 4, 13),
+            "Runtime error: Overflow"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            print(o("fetch_add", "x", +10), ","),
+            print(o("fetch_add", "x", -3), ","),
+            print(o("at", "x"), ",", is_mt_safe(o("at", "x"))),
+            o("fetch_add", "k", +5)
+        ))", test::int_t(0), "0,10,7,true"},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("at", "k", 18446744073709551615),
+            print(o("fetch_add", "k", 2), ","),
+            o("at", "k")
+        ))", test::uint_t(1U), "18446744073709551615,"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_get_many -- Tests method
+ * threadscript::basic_shared_hash::get_many() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_get_many, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", shared_hash()),
+            o("get_many")
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("get_many", null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("get_many", hash())
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            var("k", vector()),
+            at(k(), 0, 1),
+            o("get_many", k())
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 5, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            size(o("get_many", vector()))
+        ))", test::uint_t(0U), ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("at", "a", 1),
+            o("at", "b", 2),
+            var("k", vector()),
+            at(k(), 0, "b"),
+            at(k(), 1, "x"),
+            at(k(), 2, "a"),
+            at(k(), 3, "b"),
+            var("v", o("get_many", k())),
+            print(at(v(), 0), ",", at(v(), 1), ",", at(v(), 2), ",",
+                at(v(), 3), ",", is_mt_safe(v())),
+            size(v())
+        ))", test::uint_t(4U), "2,null,1,2,false"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_get_or_insert -- Tests method
+ * threadscript::basic_shared_hash::get_or_insert() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_get_or_insert, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", shared_hash()),
+            o("get_or_insert", "k")
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("get_or_insert", null, 1)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("get_or_insert", "k", clone(1))
+        ))", test::exc{
+            typeid(ts::exception::value_mt_unsafe),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Thread-unsafe value"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            print(o("get_or_insert", "x", "a"), ","),
+            print(o("get_or_insert", "x", "b"), ","),
+            o("at", "x", null),
+            print(o("get_or_insert", "x", "c"), ","),
+            o("at", "x")
+        ))", "c", "a,a,c,"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
 /*! \file
  * \test \c method_keys -- Tests method
  * threadscript::basic_shared_hash::keys() */
@@ -470,6 +778,72 @@ BOOST_DATA_TEST_CASE(method_keys, (std::vector<test::runner_result>{
 }
 //! \endcond
 
+/*! \file
+ * \test \c method_set_many -- Tests method
+ * threadscript::basic_shared_hash::set_many() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_set_many, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", shared_hash()),
+            o("set_many")
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("set_many", null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("set_many", vector())
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            var("h", hash()),
+            at(h(), "a", 1),
+            at(h(), "b", clone(2)),
+            o("set_many", h())
+        ))", test::exc{
+            typeid(ts::exception::value_mt_unsafe),
+            ts::frame_location("", "", 6, 13),
+            "Runtime error: Thread-unsafe value"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            var("h", hash()),
+            at(h(), "a", 1),
+            at(h(), "b", clone(2)),
+            try(o("set_many", h()), "", null),
+            o("size")
+        ))", test::uint_t(0U), ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("at", "a", 0),
+            o("at", "c", 3),
+            var("h", hash()),
+            at(h(), "a", 1),
+            at(h(), "b", 2),
+            at(h(), "d", null),
+            o("set_many", h()),
+            print(o("at", "a"), o("at", "b"), o("at", "c"), o("at", "d")),
+            o("size")
+        ))", test::uint_t(4U), "123null"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
 /*! \file
  * \test \c method_size -- Tests method
  * threadscript::basic_shared_hash::size() */
@@ -507,6 +881,99 @@ BOOST_DATA_TEST_CASE(method_size, (std::vector<test::runner_result>{
 }
 //! \endcond
 
+/*! \file
+ * \test \c method_update -- Tests method
+ * threadscript::basic_shared_hash::update() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_update, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", shared_hash()),
+            o("update", "k")
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("update", "k", null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("update", "k", 1)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("update", "k", "f")
+        ))", test::exc{
+            typeid(ts::exception::unknown_symbol),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Symbol not found: f"
+        }, ""},
+    {R"(seq(
+            var("o", shared_hash()),
+            o("update", "k", "o")
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            fun("f", clone(1)),
+            var("o", shared_hash()),
+            o("update", "k", "f")
+        ))", test::exc{
+            typeid(ts::exception::value_mt_unsafe),
+            ts::frame_location("", "", 4, 13),
+            "Runtime error: Thread-unsafe value"
+        }, ""},
+    {R"(seq(
+            fun("f", if(is_null(at(_args(), 0)),
+                1,
+                mt_safe(add(at(_args(), 0), 1))
+            )),
+            var("o", shared_hash()),
+            print(o("update", "x", "f"), ","),
+            print(o("update", "x", "f"), ","),
+            o("update", "x", "f")
+        ))", test::uint_t(3U), "1,2,"},
+    {R"(seq(
+            gvar("c", channel(1)),
+            c("send", 5),
+            fun("f", c("recv")),
+            var("o", shared_hash()),
+            o("at", "x", 1),
+            print(o("update", "x", "f"), ","),
+            o("at", "x")
+        ))", test::uint_t(5U), "5,"},
+    {R"(seq(
+            gvar("n", clone(0)),
+            gvar("o", shared_hash()),
+            fun("g", 10),
+            fun("f", seq(
+                add(n(), n(), 1),
+                if(eq(n(), 1), o("update", "x", "g"), null),
+                mt_safe(add(at(_args(), 0), 1))
+            )),
+            o("at", "x", 1),
+            print(o("update", "x", "f"), ","),
+            print(n(), ","),
+            o("at", "x")
+        ))", test::uint_t(11U), "11,2,"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
 /*! \file
  * \test \c threads -- Tests accessing threadscript::basic_shared_hash from
  * multiple threads
@@ -611,7 +1078,7 @@ seq(
     ts::virtual_machine vm{test::alloc};
     vm.std_out = &std_out;
     // Pass variables from C++ to the script
-    auto sh_vars = test::make_sh_vars<ts::shared_hash>();
+    auto sh_vars = test::make_sh_vars<ts::shared_hash, ts::channel>();
     auto set_uint = [&sh_vars](auto&& name, auto val) {
         auto v = ts::value_unsigned::create(sh_vars->get_allocator());
         v->value() = val;
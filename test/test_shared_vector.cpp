@@ -15,7 +15,7 @@
 
 #include <thread>
 
-auto sh_vars = test::make_sh_vars<ts::shared_vector>();
+auto sh_vars = test::make_sh_vars<ts::shared_vector, ts::channel>();
 //! \endcond
 
 /*! \file
@@ -224,6 +224,72 @@ BOOST_DATA_TEST_CASE(method_at, (std::vector<test::runner_result>{
 }
 //! \endcond
 
+/*! \file
+ * \test \c method_cas -- Tests method
+ * threadscript::basic_shared_vector::cas() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_cas, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", shared_vector()),
+            o("cas", 0, null)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("cas", null, null, null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("cas", "0", null, null)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("cas", 0, null, clone(1))
+        ))", test::exc{
+            typeid(ts::exception::value_mt_unsafe),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Thread-unsafe value"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("at", 0, "a"),
+            o("cas", 0, 1, "b")
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 4, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            print(o("cas", 1, "a", "b"), ",", o("size"), ","),
+            print(o("cas", 1, null, "b"), ",", o("at", 1), ","),
+            print(o("cas", 1, "a", "c"), ",", o("at", 1), ","),
+            print(o("cas", 1, "b", "c"), ",", o("at", 1), ","),
+            print(o("cas", 1, "c", null), ",", is_null(o("at", 1)))
+        ))", nullptr, "false,0,true,b,false,b,true,c,true,true"},
+    {R"(seq(
+            var("o", shared_vector()),
+            var("v", mt_safe(vector())),
+            o("at", 0, v()),
+            print(o("cas", 0, v(), 1), ",", o("at", 0))
+        ))", nullptr, "true,1"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
 /*! \file
  * \test \c method_erase -- Tests method
  * threadscript::basic_shared_vector::erase() */
@@ -363,6 +429,262 @@ BOOST_DATA_TEST_CASE(method_erase, (std::vector<test::runner_result>{
 }
 //! \endcond
 
+/*! \file
+ * \test \c method_fetch_add -- Tests method
+ * threadscript::basic_shared_vector::fetch_add() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_fetch_add, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", shared_vector()),
+            o("fetch_add", 0)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("fetch_add", 0, null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("fetch_add", 0, "1")
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("at", 0, 1),
+            o("fetch_add", 0, +1)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 4, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("at", 0, +9223372036854775807),
+            o("fetch_add", 0, +1)
+        ))", test::exc{
+            typeid(ts::exception::op_overflow),
+            ts::frame_location("", "", 4, 13),
+            "Runtime error: Overflow"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            print(o("fetch_add", 1, +10), ","),
+            print(o("fetch_add", 1, -3), ","),
+            print(o("at", 1), ",", is_mt_safe(o("at", 1))),
+            o("fetch_add", 0, +5)
+        ))", test::int_t(0), "0,10,7,true"},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("at", 0, 18446744073709551615),
+            print(o("fetch_add", 0, 2), ","),
+            o("at", 0)
+        ))", test::uint_t(1U), "18446744073709551615,"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_get_many -- Tests method
+ * threadscript::basic_shared_vector::get_many() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_get_many, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", shared_vector()),
+            o("get_many")
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("get_many", null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("get_many", 0)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            var("k", vector()),
+            at(k(), 0, "0"),
+            o("get_many", k())
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 5, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            var("k", vector()),
+            at(k(), 0, -1),
+            o("get_many", k())
+        ))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 5, 13),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("at", 0, "a"),
+            o("at", 1, "b"),
+            var("k", vector()),
+            at(k(), 0, 1),
+            at(k(), 1, 5),
+            at(k(), 2, +0),
+            at(k(), 3, 1),
+            var("v", o("get_many", k())),
+            print(at(v(), 0), ",", at(v(), 1), ",", at(v(), 2), ",",
+                at(v(), 3), ",", is_mt_safe(v())),
+            size(v())
+        ))", test::uint_t(4U), "b,null,a,b,false"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_get_or_insert -- Tests method
+ * threadscript::basic_shared_vector::get_or_insert() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_get_or_insert, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", shared_vector()),
+            o("get_or_insert", 0)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("get_or_insert", null, 1)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("get_or_insert", 0, clone(1))
+        ))", test::exc{
+            typeid(ts::exception::value_mt_unsafe),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Thread-unsafe value"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            print(o("get_or_insert", 1, "a"), ","),
+            print(o("get_or_insert", 1, "b"), ","),
+            o("at", 1, null),
+            print(o("get_or_insert", 1, "c"), ","),
+            o("at", 1)
+        ))", "c", "a,a,c,"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_set_many -- Tests method
+ * threadscript::basic_shared_vector::set_many() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_set_many, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", shared_vector()),
+            o("set_many", 0)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("set_many", null, vector())
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("set_many", 0, null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("set_many", 0, hash())
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("set_many", -1, vector())
+        ))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            var("v", vector()),
+            at(v(), 0, 1),
+            at(v(), 1, clone(2)),
+            try(o("set_many", 0, v()), "", null),
+            o("size")
+        ))", test::uint_t(0U), ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("set_many", 2, vector()),
+            o("size")
+        ))", test::uint_t(0U), ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("at", 0, "a"),
+            o("at", 1, "b"),
+            var("v", vector()),
+            at(v(), 0, "X"),
+            at(v(), 1, "Y"),
+            at(v(), 2, "Z"),
+            o("set_many", 1, v()),
+            print(o("at", 0), o("at", 1), o("at", 2), o("at", 3)),
+            o("set_many", 5, v()),
+            print(",", o("at", 4), ",", o("at", 7)),
+            o("size")
+        ))", test::uint_t(8U), "aXYZ,null,Z"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
 /*! \file
  * \test \c method_size -- Tests method
  * threadscript::basic_shared_vector::size() */
@@ -397,6 +719,159 @@ BOOST_DATA_TEST_CASE(method_size, (std::vector<test::runner_result>{
 }
 //! \endcond
 
+/*! \file
+ * \test \c method_slice -- Tests method
+ * threadscript::basic_shared_vector::slice() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_slice, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", shared_vector()),
+            o("slice", 0)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("slice", 0, null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("slice", "0", 1)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("slice", 0, -1)
+        ))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            size(o("slice", 0, 10))
+        ))", test::uint_t(0U), ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("at", 0, "a"),
+            o("at", 1, "b"),
+            o("at", 2, "c"),
+            o("at", 3, "d"),
+            var("v", o("slice", 1, 3)),
+            print(at(v(), 0), at(v(), 1), ",", is_mt_safe(v()), ","),
+            print(size(o("slice", 2, 1)), size(o("slice", 4, 5)), ","),
+            var("v", o("slice", 2, 100)),
+            print(at(v(), 0), at(v(), 1)),
+            size(v())
+        ))", test::uint_t(2U), "bc,false,00,cd"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_update -- Tests method
+ * threadscript::basic_shared_vector::update() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_update, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("o", shared_vector()),
+            o("update", 0)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("update", 0, null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("update", 0, 1)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("update", 0, "f")
+        ))", test::exc{
+            typeid(ts::exception::unknown_symbol),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Symbol not found: f"
+        }, ""},
+    {R"(seq(
+            var("o", shared_vector()),
+            o("update", 0, "o")
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            fun("f", clone(1)),
+            var("o", shared_vector()),
+            o("update", 0, "f")
+        ))", test::exc{
+            typeid(ts::exception::value_mt_unsafe),
+            ts::frame_location("", "", 4, 13),
+            "Runtime error: Thread-unsafe value"
+        }, ""},
+    {R"(seq(
+            fun("f", if(is_null(at(_args(), 0)),
+                1,
+                mt_safe(add(at(_args(), 0), 1))
+            )),
+            var("o", shared_vector()),
+            print(o("update", 1, "f"), ","),
+            print(o("update", 1, "f"), ","),
+            o("update", 1, "f")
+        ))", test::uint_t(3U), "1,2,"},
+    {R"(seq(
+            gvar("c", channel(1)),
+            c("send", 5),
+            fun("f", c("recv")),
+            var("o", shared_vector()),
+            o("at", 0, 1),
+            print(o("update", 0, "f"), ","),
+            o("at", 0)
+        ))", test::uint_t(5U), "5,"},
+    {R"(seq(
+            gvar("n", clone(0)),
+            gvar("o", shared_vector()),
+            fun("g", 10),
+            fun("f", seq(
+                add(n(), n(), 1),
+                if(eq(n(), 1), o("update", 0, "g"), null),
+                mt_safe(add(at(_args(), 0), 1))
+            )),
+            o("at", 0, 1),
+            print(o("update", 0, "f"), ","),
+            print(n(), ","),
+            o("at", 0)
+        ))", test::uint_t(11U), "11,2,"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
 /*! \file
  * \test \c threads -- Tests accessing threadscript::basic_shared_vector from
  * multiple threads
@@ -490,7 +965,7 @@ seq(
     ts::virtual_machine vm{test::alloc};
     vm.std_out = &std_out;
     // Pass variables from C++ to the script
-    auto sh_vars = test::make_sh_vars<ts::shared_vector>();
+    auto sh_vars = test::make_sh_vars<ts::shared_vector, ts::channel>();
     auto set_uint = [&sh_vars](auto&& name, auto val) {
         auto v = ts::value_unsigned::create(sh_vars->get_allocator());
         v->value() = val;
@@ -0,0 +1,96 @@
+/*! \file
+ * \brief Tests of class threadscript::source_file
+ */
+
+//! \cond
+#include "threadscript/threadscript.hpp"
+
+#define BOOST_TEST_MODULE source_file
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <sstream>
+
+#include "tmp_dir.hpp"
+
+namespace ts = threadscript;
+//! \endcond
+
+/*! \file
+ * \test \c mapped -- A regular file is mapped into memory */
+//! \cond
+BOOST_AUTO_TEST_CASE(mapped)
+{
+    test::tmp_dir dir{"test_source_file"};
+    std::string data = "print(\"Hello\")\n";
+    data.push_back('\0');
+    data.append("\r\nend");
+    ts::source_file src{dir.write("file.ts", data)};
+    BOOST_CHECK(src.mapped());
+    BOOST_CHECK_EQUAL(src.view(), data);
+}
+//! \endcond
+
+/*! \file
+ * \test \c not_mapped -- An empty file, a missing file, and a file that
+ * cannot be mapped */
+//! \cond
+BOOST_AUTO_TEST_CASE(not_mapped)
+{
+    test::tmp_dir dir{"test_source_file"};
+    {
+        ts::source_file src{dir.write("empty.ts", "")};
+        BOOST_CHECK(!src.mapped());
+        BOOST_CHECK(src.view().empty());
+    }
+    BOOST_CHECK_THROW(ts::source_file{(dir.path / "missing.ts").string()},
+                      std::ios_base::failure);
+    {
+        ts::source_file src{"/dev/null"};
+        BOOST_CHECK(!src.mapped());
+        BOOST_CHECK(src.view().empty());
+    }
+}
+//! \endcond
+
+/*! \file
+ * \test \c read_stream -- Function threadscript::source_file::read() */
+//! \cond
+BOOST_AUTO_TEST_CASE(read_stream)
+{
+    std::istringstream is{"skipped data"};
+    is.ignore(8);
+    BOOST_CHECK_EQUAL(ts::source_file::read(is), "data");
+    std::istringstream empty{};
+    BOOST_CHECK_EQUAL(ts::source_file::read(empty), "");
+    std::ifstream missing{"/nonexistent/file"};
+    BOOST_CHECK_THROW(static_cast<void>(ts::source_file::read(missing)),
+                      std::ios_base::failure);
+}
+//! \endcond
+
+/*! \file
+ * \test \c parse -- A script parsed from a file is equal to the script parsed
+ * from a string or from a stream */
+//! \cond
+BOOST_AUTO_TEST_CASE(parse)
+{
+    test::tmp_dir dir{"test_source_file"};
+    ts::allocator_any alloc;
+    std::string src = "seq(\n  print(\"a\\x41\", 1, -2),\n  # comment\n  null\n)";
+    auto file = dir.write("file.ts", src);
+    auto parsed = ts::parse_code(alloc, src, file);
+    auto from_file = ts::parse_code_file(alloc, file);
+    BOOST_CHECK(*from_file == *parsed);
+    BOOST_CHECK_EQUAL(ts::serialize_script(*from_file, 0),
+                      ts::serialize_script(*parsed, 0));
+    std::istringstream is{src};
+    auto from_stream = ts::parse_code_stream(alloc, is, file);
+    BOOST_CHECK_EQUAL(ts::serialize_script(*from_stream, 0),
+                      ts::serialize_script(*parsed, 0));
+    BOOST_CHECK_THROW(ts::parse_code_file(alloc,
+                                          (dir.path / "missing.ts").string()),
+                      std::ios_base::failure);
+}
+//! \endcond
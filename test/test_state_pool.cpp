@@ -0,0 +1,151 @@
+/*! \file
+ * \brief Tests of class threadscript::basic_state_pool
+ */
+
+//! \cond
+#include "threadscript/threadscript.hpp"
+#include "threadscript/symbol_table_impl.hpp"
+
+#define BOOST_TEST_MODULE state_pool
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <thread>
+
+namespace ts = threadscript;
+
+namespace test {
+
+ts::allocator_any alloc;
+
+} // namespace test
+//! \endcond
+
+/*! \file
+ * \test \c acquire -- Acquiring and releasing states */
+//! \cond
+BOOST_AUTO_TEST_CASE(acquire)
+{
+    ts::virtual_machine vm{test::alloc};
+    auto& pool = ts::state_pool::get(vm);
+    BOOST_TEST(&ts::state_pool::get(vm) == &pool);
+    BOOST_TEST(pool.idle() == 0U);
+    BOOST_TEST(vm.num_states() == 0U);
+    ts::state* p = nullptr;
+    {
+        auto h = pool.acquire();
+        BOOST_REQUIRE(bool(h));
+        p = h.get();
+        BOOST_TEST(&h->vm == &vm);
+        BOOST_TEST(vm.num_states() == 1U);
+    }
+    BOOST_TEST(pool.idle() == 1U);
+    BOOST_TEST(vm.num_states() == 1U);
+    {
+        auto h1 = pool.acquire();
+        BOOST_TEST(h1.get() == p);
+        BOOST_TEST(pool.idle() == 0U);
+        auto h2 = pool.acquire();
+        BOOST_TEST(h2.get() != p);
+        BOOST_TEST(vm.num_states() == 2U);
+        auto h3 = std::move(h2);
+        BOOST_TEST(!bool(h2));
+        BOOST_TEST(bool(h3));
+        h3.release();
+        BOOST_TEST(!bool(h3));
+        BOOST_TEST(pool.idle() == 1U);
+    }
+    BOOST_TEST(pool.idle() == 2U);
+    pool.shrink(1);
+    BOOST_TEST(pool.idle() == 1U);
+    BOOST_TEST(vm.num_states() == 1U);
+    pool.shrink();
+    BOOST_TEST(pool.idle() == 0U);
+    BOOST_TEST(vm.num_states() == 0U);
+}
+//! \endcond
+
+/*! \file
+ * \test \c reset -- A state returned to the pool is reset */
+//! \cond
+BOOST_AUTO_TEST_CASE(reset)
+{
+    ts::virtual_machine vm{test::alloc};
+    vm.sh_vars = ts::predef_symbols(test::alloc);
+    auto& pool = ts::state_pool::get(vm);
+    std::ostringstream os;
+    {
+        auto h = pool.acquire();
+        h->std_out = &os;
+        h->max_stack = 10;
+        auto parsed = ts::parse_code(test::alloc,
+                                     R"(seq(gvar("x", 1), print("a")))",
+                                     "string");
+        parsed->eval(*h);
+        BOOST_TEST(h->t_vars.contains("x"));
+    }
+    BOOST_TEST(os.str() == "a");
+    auto h = pool.acquire();
+    BOOST_TEST(!h->t_vars.contains("x"));
+    BOOST_TEST(!h->std_out);
+    BOOST_TEST(h->max_stack == ts::virtual_machine::default_max_stack);
+}
+//! \endcond
+
+/*! \file
+ * \test \c sh_vars -- A state acquired from the pool uses the current shared
+ * variables of the VM */
+//! \cond
+BOOST_AUTO_TEST_CASE(sh_vars)
+{
+    ts::virtual_machine vm{test::alloc};
+    auto& pool = ts::state_pool::get(vm);
+    auto sh1 = ts::predef_symbols(test::alloc);
+    vm.sh_vars = sh1;
+    pool.acquire().release();
+    auto sh2 = ts::predef_symbols(test::alloc);
+    vm.sh_vars = sh2;
+    // An idle state does not keep the old shared variables alive
+    BOOST_TEST(sh1.use_count() == 1);
+    auto h = pool.acquire();
+    BOOST_TEST(h->t_vars.parent_table() == sh2.get());
+}
+//! \endcond
+
+/*! \file
+ * \test \c threads -- The pool used by multiple threads */
+//! \cond
+BOOST_AUTO_TEST_CASE(threads)
+{
+    ts::virtual_machine vm{test::alloc};
+    vm.sh_vars = ts::predef_symbols(test::alloc);
+    auto& pool = ts::state_pool::get(vm);
+    auto parsed = ts::parse_code(test::alloc,
+                                 R"(seq(gvar("x", clone(0)), add(x(), 1)))",
+                                 "string");
+    constexpr size_t num_threads = 4;
+    constexpr size_t iterations = 1000;
+    std::atomic<size_t> done = 0;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; ++t)
+        threads.emplace_back([&pool, &parsed, &done]() {
+            for (size_t i = 0; i < iterations; ++i) {
+                auto h = pool.acquire();
+                if (h->t_vars.contains("x"))
+                    return;
+                auto v = parsed->eval(*h);
+                if (auto u = dynamic_cast<ts::value_unsigned*>(v.get());
+                    u && u->cvalue() == 1)
+                {
+                    ++done;
+                }
+            }
+        });
+    for (auto&& t: threads)
+        t.join();
+    BOOST_TEST(done == num_threads * iterations);
+    BOOST_TEST(pool.idle() <= num_threads);
+    BOOST_TEST(pool.idle() == vm.num_states());
+}
+//! \endcond
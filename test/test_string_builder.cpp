@@ -0,0 +1,268 @@
+/*! \file
+ * \brief Tests of class threadscript::basic_string_builder
+ */
+
+//! \cond
+#include "threadscript/threadscript.hpp"
+#include "threadscript/symbol_table_impl.hpp"
+
+#define BOOST_TEST_MODULE string_builder
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <boost/test/data/test_case.hpp>
+
+#include "script_runner.hpp"
+
+auto sh_vars = test::make_sh_vars<ts::string_builder>();
+//! \endcond
+
+/*! \file
+ * \test \c create_object -- Creates a threadscript::basic_string_builder
+ * object */
+//! \cond
+BOOST_DATA_TEST_CASE(create_object, (std::vector<test::runner_result>{
+    {R"(string_builder("a", "b"))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(string_builder(null))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(string_builder(1))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(type(string_builder()))", "string_builder", ""},
+    {R"(is_mt_safe(string_builder()))", false, ""},
+    {R"(seq(
+            var("sb", string_builder()),
+            sb("str")
+        ))", "", ""},
+    {R"(seq(
+            var("sb", string_builder("abc")),
+            sb("str")
+        ))", "abc", ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_append -- Tests method
+ * threadscript::basic_string_builder::append() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_append, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("sb", string_builder()),
+            sb("append")
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("sb", string_builder()),
+            sb("append", "a", "b")
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("sb", string_builder()),
+            sb("append", null)
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("sb", string_builder()),
+            sb("append", 1)
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("sb", string_builder("abc")),
+            mt_safe(sb()),
+            sb("append", "def")
+        ))", test::exc{
+            typeid(ts::exception::value_read_only),
+            ts::frame_location("", "", 4, 13),
+            "Runtime error: Read-only value"
+        }, ""},
+    {R"(seq(
+            var("sb", string_builder("abc")),
+            print(sb("append", "def")),
+            sb("append", ""),
+            sb("append", "gh"),
+            sb("str")
+        ))", "abcdefgh", "null"},
+    {R"(seq(
+            var("sb", string_builder()),
+            var("i", clone(0)),
+            while(lt(i(), 1000), seq(
+                sb("append", "0123456789"),
+                add(i(), i(), 1)
+            )),
+            sb("size")
+        ))", test::uint_t(10000U), ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_append_many -- Tests method
+ * threadscript::basic_string_builder::append_many() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_append_many, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("sb", string_builder("x")),
+            sb("append_many", "a", null, "b")
+        ))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(seq(
+            var("sb", string_builder("x")),
+            sb("append_many", "a", 2, "b")
+        ))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(seq(
+            var("sb", string_builder("x")),
+            mt_safe(sb()),
+            sb("append_many", "a")
+        ))", test::exc{
+            typeid(ts::exception::value_read_only),
+            ts::frame_location("", "", 4, 13),
+            "Runtime error: Read-only value"
+        }, ""},
+    {R"(seq(
+            var("sb", string_builder("x")),
+            try(sb("append_many", "a", 2, "b"), "", null),
+            sb("str")
+        ))", "x", ""},
+    {R"(seq(
+            var("sb", string_builder("x")),
+            print(sb("append_many")),
+            sb("str")
+        ))", "x", "null"},
+    {R"(seq(
+            var("sb", string_builder("x")),
+            sb("append_many", "a", "", "bc", "def"),
+            sb("str")
+        ))", "xabcdef", ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_clear -- Tests method
+ * threadscript::basic_string_builder::clear() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_clear, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("sb", string_builder("abc")),
+            sb("clear", 1)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("sb", string_builder("abc")),
+            mt_safe(sb()),
+            sb("clear")
+        ))", test::exc{
+            typeid(ts::exception::value_read_only),
+            ts::frame_location("", "", 4, 13),
+            "Runtime error: Read-only value"
+        }, ""},
+    {R"(seq(
+            var("sb", string_builder("abc")),
+            print(sb("clear")),
+            print(sb("size")),
+            sb("append", "de"),
+            sb("str")
+        ))", "de", "null0"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_size -- Tests method
+ * threadscript::basic_string_builder::size() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_size, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("sb", string_builder()),
+            sb("size", 1)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("sb", string_builder()),
+            sb("size")
+        ))", test::uint_t(0U), ""},
+    {R"(seq(
+            var("sb", string_builder("abc")),
+            sb("append", "de"),
+            mt_safe(sb()),
+            sb("size")
+        ))", test::uint_t(5U), ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c method_str -- Tests method
+ * threadscript::basic_string_builder::str() */
+//! \cond
+BOOST_DATA_TEST_CASE(method_str, (std::vector<test::runner_result>{
+    {R"(seq(
+            var("sb", string_builder()),
+            sb("str", 1)
+        ))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 3, 13),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("sb", string_builder("abc")),
+            var("s", sb("str")),
+            sb("append", "de"),
+            print(s()),
+            print(is_mt_safe(s())),
+            sb("str")
+        ))", "abcde", "abcfalse"},
+    {R"(seq(
+            var("sb", string_builder("abc")),
+            mt_safe(sb()),
+            sb("str")
+        ))", "abc", ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
@@ -0,0 +1,333 @@
+/*! \file
+ * \brief Tests of classes threadscript::basic_barrier,
+ * threadscript::basic_latch, threadscript::basic_mutex, and
+ * threadscript::basic_semaphore
+ */
+
+//! \cond
+#include "threadscript/threadscript.hpp"
+#include "threadscript/symbol_table_impl.hpp"
+
+#define BOOST_TEST_MODULE sync
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <boost/test/data/test_case.hpp>
+
+#include "script_runner.hpp"
+
+auto sh_vars = test::make_sh_vars<ts::atomic, ts::barrier, ts::latch,
+    ts::mutex, ts::semaphore, ts::shared_hash>();
+//! \endcond
+
+/*! \file
+ * \test \c barrier -- Class threadscript::basic_barrier */
+//! \cond
+BOOST_DATA_TEST_CASE(barrier, (std::vector<test::runner_result>{
+    {R"(barrier())", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(barrier(1, "f", 2))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(barrier(null))", test::exc{
+            typeid(ts::exception::value_null),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Null value"
+        }, ""},
+    {R"(barrier(0))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(barrier(1, 2))", test::exc{
+            typeid(ts::exception::value_type),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad value type"
+        }, ""},
+    {R"(barrier(1, "f"))", test::exc{
+            typeid(ts::exception::unknown_symbol),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Symbol not found: f"
+        }, ""},
+    {R"(type(barrier(1)))", "barrier", ""},
+    {R"(is_mt_safe(barrier(1)))", true, ""},
+    {R"(seq(var("b", barrier(1)), b("arrive_and_wait", 1)))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 27),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            fun("f", print("phase ")),
+            var("b", barrier(1, "f")),
+            b("arrive_and_wait"),
+            b("arrive_and_wait"),
+            b("arrive_and_wait")
+        ))", nullptr, "phase phase phase "},
+    {R"(seq(
+            fun("f", throw("failed")),
+            var("b", barrier(1, "f")),
+            try(b("arrive_and_wait"), "!failed", print("caught ")),
+            try(b("arrive_and_wait"), "!failed", print("caught"))
+        ))", nullptr, "caught caught"},
+    {R"(seq(
+            fun("f", print("phase ")),
+            var("b", barrier(2, "f")),
+            b("arrive_and_drop"),
+            b("arrive_and_wait"),
+            b("arrive_and_wait")
+        ))", nullptr, "phase phase "},
+    {R"(seq(
+            var("b", barrier(1)),
+            b("arrive_and_drop"),
+            b("arrive_and_drop")
+        ))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 4, 13),
+            "Runtime error: Value out of range"
+        }, ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c latch -- Class threadscript::basic_latch */
+//! \cond
+BOOST_DATA_TEST_CASE(latch, (std::vector<test::runner_result>{
+    {R"(latch())", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(latch(-1))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(type(latch(1)))", "latch", ""},
+    {R"(is_mt_safe(latch(1)))", true, ""},
+    {R"(seq(var("l", latch(1)), l("count_down", 2)))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 1, 25),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(seq(var("l", latch(1)), l("wait", 1)))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 25),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(
+            var("l", latch(3)),
+            print(l("try_wait"), " "),
+            l("count_down"),
+            l("count_down", 0),
+            print(l("try_wait"), " "),
+            l("arrive_and_wait", 2),
+            l("wait"),
+            print(l("try_wait"))
+        ))", nullptr, "false false true"},
+    {R"(seq(var("l", latch(0)), l("wait"), l("try_wait")))", true, ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c mutex -- Class threadscript::basic_mutex */
+//! \cond
+BOOST_DATA_TEST_CASE(mutex, (std::vector<test::runner_result>{
+    {R"(mutex(1))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(type(mutex()))", "mutex", ""},
+    {R"(is_mt_safe(mutex()))", true, ""},
+    {R"(seq(var("m", mutex()), m("unlock")))", test::exc{
+            typeid(ts::exception::op_bad),
+            ts::frame_location("", "", 1, 24),
+            "Runtime error: Bad operation"
+        }, ""},
+    {R"(seq(var("m", mutex()), m("lock"), m("lock")))", test::exc{
+            typeid(ts::exception::op_would_block),
+            ts::frame_location("", "", 1, 35),
+            "Runtime error: Operation would block"
+        }, ""},
+    {R"(seq(var("m", mutex()), m("run_locked")))", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 24),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(seq(var("m", mutex()), m("run_locked", "f")))", test::exc{
+            typeid(ts::exception::unknown_symbol),
+            ts::frame_location("", "", 1, 24),
+            "Runtime error: Symbol not found: f"
+        }, ""},
+    {R"(seq(
+            var("m", mutex()),
+            print(m("try_lock"), " "),
+            print(m("try_lock"), " "),
+            m("unlock"),
+            m("lock"),
+            m("unlock"),
+            print(m("try_lock"))
+        ))", nullptr, "true false true"},
+    {R"(seq(
+            gvar("m", mutex()),
+            fun("f", seq(print(m("try_lock"), " "), add(at(_args(), 0), 1))),
+            print(m("run_locked", "f", 1), " "),
+            m("try_lock")
+        ))", true, "false 2 "},
+    {R"(seq(
+            var("m", mutex()),
+            fun("f", throw("failed")),
+            try(m("run_locked", "f"), "!failed", null),
+            m("try_lock")
+        ))", true, ""},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c semaphore -- Class threadscript::basic_semaphore */
+//! \cond
+BOOST_DATA_TEST_CASE(semaphore, (std::vector<test::runner_result>{
+    {R"(semaphore())", test::exc{
+            typeid(ts::exception::op_narg),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Bad number of arguments"
+        }, ""},
+    {R"(semaphore(2, 1))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 1, 1),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(type(semaphore(0)))", "semaphore", ""},
+    {R"(is_mt_safe(semaphore(0)))", true, ""},
+    {R"(seq(var("s", semaphore(1, 1)), s("release")))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 1, 32),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(seq(var("s", semaphore(0)), s("acquire_for", -1)))", test::exc{
+            typeid(ts::exception::value_out_of_range),
+            ts::frame_location("", "", 1, 29),
+            "Runtime error: Value out of range"
+        }, ""},
+    {R"(seq(
+            var("s", semaphore(1)),
+            print(s("try_acquire"), " "),
+            print(s("try_acquire"), " "),
+            print(s("acquire_for", 10), " "),
+            s("release", 2),
+            s("acquire"),
+            print(s("acquire_for", 10), " "),
+            print(s("try_acquire"))
+        ))", nullptr, "true false false true false"},
+}))
+{
+    test::check_runner(sample, sh_vars);
+}
+//! \endcond
+
+/*! \file
+ * \test \c threads -- Synchronization objects used by multiple threads and
+ * by tasks */
+//! \cond
+BOOST_DATA_TEST_CASE(threads, (std::vector<test::runner_result>{
+    {R"(seq(
+            # Phases separated by a barrier with a completion function
+            gvar("num_threads", 4),
+            gvar("phases", atomic(0)),
+            fun("done", phases("add", 1)),
+            gvar("b", barrier(add(num_threads(), 1), "done")),
+            fun("f_main", seq(
+                var("i", clone(0)),
+                while(lt(i(), 11), seq(
+                    b("arrive_and_wait"),
+                    add(i(), i(), 1)
+                )),
+                phases("load")
+            )),
+            fun("f_thread", seq(
+                var("i", clone(0)),
+                while(lt(i(), 11), seq(
+                    if(not(eq(phases("load"), i())), throw("bad phase"), null),
+                    b("arrive_and_wait"),
+                    add(i(), i(), 1)
+                ))
+            ))
+        ))", test::uint_t(11), ""},
+    {R"(seq(
+            # A counter protected by a mutex
+            gvar("num_threads", 4),
+            gvar("m", mutex()),
+            gvar("l", latch(num_threads())),
+            gvar("counter", shared_hash()),
+            counter("at", "n", 0),
+            fun("inc", counter("at", "n",
+                mt_safe(add(counter("at", "n"), 1)))),
+            fun("f_main", seq(
+                l("wait"),
+                counter("at", "n")
+            )),
+            fun("f_thread", seq(
+                var("i", clone(0)),
+                while(lt(i(), 100), seq(
+                    m("run_locked", "inc"),
+                    add(i(), i(), 1)
+                )),
+                l("count_down")
+            ))
+        ))", test::uint_t(400), ""},
+    {R"(seq(
+            # A semaphore limiting concurrency of tasks
+            gvar("num_threads", 1),
+            gvar("s", semaphore(2, 2)),
+            gvar("active", atomic(0)),
+            fun("task", seq(
+                s("acquire"),
+                if(ge(active("add", 1), 2), throw("too many"), null),
+                active("sub", 1),
+                s("release")
+            )),
+            fun("f_main", null),
+            fun("f_thread", seq(
+                var("fs", vector()),
+                var("i", clone(0)),
+                while(lt(i(), 50), seq(
+                    at(fs(), i(), spawn("task")),
+                    add(i(), i(), 1)
+                )),
+                var("i", clone(0)),
+                while(lt(i(), 50), seq(
+                    var("r", at(fs(), i())),
+                    r("get"),
+                    add(i(), i(), 1)
+                ))
+            ))
+        ))", nullptr, ""},
+    {R"(seq(
+            # acquire_for with the maximum timeout waits for a delayed release
+            gvar("num_threads", 1),
+            gvar("s", semaphore(0)),
+            gvar("delay", semaphore(0)),
+            fun("f_main", s("acquire_for", 18446744073709551615)),
+            fun("f_thread", seq(
+                delay("acquire_for", 50),
+                s("release")
+            ))
+        ))", true, ""},
+}))
+{
+    test::check_runner<test::script_runner_threads>(sample, sh_vars);
+}
+//! \endcond
@@ -3,7 +3,8 @@
  */
 
 //! \cond
-#include "threadscript/code_parser.hpp"
+#include "threadscript/syntax_canon.hpp"
+#include "threadscript/threadscript.hpp"
 
 #define BOOST_TEST_MODULE syntax_canon
 #define BOOST_TEST_DYN_LINK
@@ -78,6 +79,41 @@ template <class Sample> void test_parse(Sample&& sample)
     test_parse(std::forward<Sample>(sample), [](){});
 }
 
+// Parses by the rules (fast == false) or by the hand-written parser
+ts::script::script_ptr parse(std::string_view text, bool fast)
+{
+    ts::allocator_any alloc;
+    ts::script_builder_impl builder(alloc);
+    ts::syntax::canon parser(fast);
+    parser.parse(builder, text, "string");
+    return builder.get_script();
+}
+
+// Checks that both parsers create the same script or throw the same error
+void test_fast(std::string_view text)
+{
+    ts::script::script_ptr slow;
+    std::string slow_error;
+    try {
+        slow = parse(text, false);
+    } catch (const ts::parse_error& e) {
+        slow_error = e.what();
+    }
+    if (slow) {
+        ts::script::script_ptr fast;
+        BOOST_REQUIRE_NO_THROW(fast = parse(text, true));
+        BOOST_REQUIRE(fast);
+        BOOST_CHECK(*fast == *slow);
+        BOOST_CHECK_EQUAL(ts::serialize_script(*fast, 0),
+                          ts::serialize_script(*slow, 0));
+    } else
+        BOOST_CHECK_EXCEPTION(parse(text, true), ts::parse_error,
+            ([&slow_error](auto&& e) {
+                BOOST_CHECK_EQUAL(e.what(), slow_error);
+                return true;
+            }));
+}
+
 void test_parse(auto&& sample, auto&& check)
 {
     ts::allocator_any alloc;
@@ -106,6 +142,7 @@ void test_parse(auto&& sample, auto&& check)
                 BOOST_CHECK_EQUAL(e.pos().column, sample.column);
                 return true;
             }));
+    test_fast(sample.text);
 }
 
 } // namespace test
@@ -186,3 +223,63 @@ null
     test_parse(sample);
 }
 //! \endcond
+
+/*! \file
+ * \test \c fast -- The hand-written parser creates the same scripts and
+ * reports the same errors as the parser rules */
+//! \cond
+BOOST_DATA_TEST_CASE(fast, (std::vector<std::string>{
+    "\n\n  null  \n",
+    "# comment\tTAB\nnull",
+    "null # comment at end",
+    "null\r",
+    "\tnull\n#",
+    "nullx",
+    "nul",
+    "null()",
+    "true()",
+    "truex()",
+    "false1",
+    "0",
+    "007",
+    "18446744073709551615",
+    "18446744073709551616",
+    "99999999999999999999999",
+    "+0",
+    "-0",
+    "+9223372036854775807",
+    "+9223372036854775808",
+    "-9223372036854775808",
+    "-9223372036854775809",
+    "-",
+    "+-1",
+    "1 2",
+    R"("a\"b\\c\0\t\n\r\x41\X4a")",
+    "\"abc\ndef\"",
+    "\"abc\tdef\"",
+    "\"\\x4\"",
+    "\"\\x",
+    "\"\\",
+    "\"\x7f\"",
+    "\"\xc3\xa1\"",
+    "f\n(\n1\n,\n\"x\"\n)",
+    "f ( 1 , g ( ) , h(null,true) )",
+    "f(# comment\n1 # comment\n, 2)",
+    "f(1 2)",
+    "f(,)",
+    "f(1,",
+    "f(1",
+    "f(",
+    "f",
+    "_a_1(x_(), Y())",
+    "1f()",
+    "f(1)(2)",
+    "f(1) g(2)",
+    "@",
+    "f(@)",
+    "\n\n   f(\n  g(1,\n    \"a\\x\"))",
+}))
+{
+    test::test_fast(sample);
+}
+//! \endcond
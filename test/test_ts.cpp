@@ -16,6 +16,7 @@
 #include <fstream>
 #include <regex>
 #include <sstream>
+#include <thread>
 
 using namespace std::string_literals;
 using namespace std::string_view_literals;
@@ -145,6 +146,54 @@ BOOST_DATA_TEST_CASE(bad_opts, (std::vector<test::ts_result>{
                        R"(Run '.*ts -h' for help)"));
         }
     },
+    {{"-W", "0", "hello.ts"}, "", 65, // bad option value
+        [](auto&& s) { return s.empty(); },
+        [](auto&& s) {
+            return std::regex_search(s,
+                std::regex(R"(Invalid argument of command line option -W\n)"
+                           R"(Run '.*ts -h' for help)"));
+        }
+    },
+    {{"-H", "-"}, "", 65, // reloading the standard input
+        [](auto&& s) { return s.empty(); },
+        [](auto&& s) {
+            return std::regex_search(s,
+                std::regex(R"(Options -H and -W require a script file\n)"
+                           R"(Run '.*ts -h' for help)"));
+        }
+    },
+    {{"-W", "100", "-r", "hello.ts"}, "", 65, // invalid combination of options
+        [](auto&& s) { return s.empty(); },
+        [](auto&& s) {
+            return std::regex_search(s,
+            std::regex(R"(Options -H and -W cannot be used with -R and -r\n)"
+                       R"(Run '.*ts -h' for help)"));
+        }
+    },
+    {{"-l", "a.ts::b.ts", "hello.ts"}, "", 65, // bad option value
+        [](auto&& s) { return s.empty(); },
+        [](auto&& s) {
+            return std::regex_search(s,
+                std::regex(R"(Invalid argument of command line option -l\n)"
+                           R"(Run '.*ts -h' for help)"));
+        }
+    },
+    {{"-l", "a.ts", "-H", "hello.ts"}, "", 65, // invalid combination
+        [](auto&& s) { return s.empty(); },
+        [](auto&& s) {
+            return std::regex_search(s,
+                std::regex(R"(Options -H and -W cannot be used with -l\n)"
+                           R"(Run '.*ts -h' for help)"));
+        }
+    },
+    {{"-c", "cache", "-"}, "", 65, // caching the standard input
+        [](auto&& s) { return s.empty(); },
+        [](auto&& s) {
+            return std::regex_search(s,
+                std::regex(R"(Option -c requires a script file\n)"
+                           R"(Run '.*ts -h' for help)"));
+        }
+    },
 }))
 {
     check_ts(boost::unit_test::framework::current_test_case().full_name(),
@@ -192,6 +241,128 @@ BOOST_DATA_TEST_CASE(script_file, (std::vector<test::ts_result>{
 }
 //! \endcond
 
+/*! \file
+ * \test \c cache -- Program \link ts.cpp ts\endlink with a cache of parsed
+ * scripts; the first run stores the script in the cache, the second run loads
+ * it */
+//! \cond
+BOOST_DATA_TEST_CASE(cache, (std::vector<test::ts_result>{
+    {{"-c", (test::io_dir / "cache").string(), test::script_path("hello.ts")},
+        "", 0,
+        [](auto&& s) { return s == "Hello World!\n"; },
+        [](auto&& s) { return s.empty(); }
+    },
+    {{"-c", (test::io_dir / "cache").string(), test::script_path("hello.ts")},
+        "", 0,
+        [](auto&& s) { return s == "Hello World!\n"; },
+        [](auto&& s) { return s.empty(); }
+    },
+}))
+{
+    check_ts(boost::unit_test::framework::current_test_case().full_name(),
+             sample);
+    BOOST_CHECK(!std::filesystem::is_empty(test::io_dir / "cache"));
+}
+//! \endcond
+
+/*! \file
+ * \test \c load -- Program \link ts.cpp ts\endlink loading scripts by option
+ * \c -l */
+//! \cond
+BOOST_DATA_TEST_CASE(load, (std::vector<test::ts_result>{
+    {{"-l", test::script_path("load_print.ts") + ":" +
+            test::script_path("load_greet.ts"),
+            test::script_path("load_main.ts")},
+        "", 0,
+        [](auto&& s) { return s == "Loaded\nHello World!\n"; },
+        [](auto&& s) { return s.empty(); }
+    },
+    {{"-l", test::script_path("load_greet.ts") + ":" +
+            test::script_path("load_print.ts"),
+            "-R", "-c", (test::io_dir / "cache").string(),
+            test::script_path("load_main.ts")},
+        "", 0,
+        [](auto&& s) { return s == "Loaded\nHello World!\n"; },
+        [](auto&& s) { return s.empty(); }
+    },
+    {{"-l", test::script_path("load_greet.ts"), "-"}, R"(greet("stdin"))", 0,
+        [](auto&& s) { return s == "Hello stdin!\n"; },
+        [](auto&& s) { return s.empty(); }
+    },
+    {{"-n", "-l", test::script_path("load_print.ts"),
+            test::script_path("hello.ts")},
+        "", 0,
+        [](auto&& s) { return s.empty(); },
+        [](auto&& s) { return s.empty(); }
+    },
+    {{"-l", test::script_path("syntax_error.ts") + ":" +
+            test::script_path("load_print.ts") + ":" +
+            test::script_path("missing.ts"),
+            test::script_path("hello.ts")},
+        "", 66,
+        [](auto&& s) { return s.empty(); },
+        [](auto&& s) {
+            return std::regex_search(s, std::regex(
+                    R"(^Cannot parse /.*/syntax_error.ts: .*\n)"
+                    R"(Cannot parse /.*/missing.ts: .*\n$)"));
+        }
+    },
+}))
+{
+    check_ts(boost::unit_test::framework::current_test_case().full_name(),
+             sample);
+}
+//! \endcond
+
+/*! \file
+ * \test \c modules -- Program \link ts.cpp ts\endlink importing modules
+ * from a search path set by option \c -I */
+//! \cond
+BOOST_DATA_TEST_CASE(modules, (std::vector<test::ts_result>{
+    {{"-I", "/nonexistent:" + test::script_dir.string(),
+            test::script_path("import_main.ts")},
+        "", 0,
+        [](auto&& s) { return s == "Imported\nHello World!\n"; },
+        [](auto&& s) { return s.empty(); }
+    },
+    {{"-R", "-I", test::script_dir.string(),
+            test::script_path("import_main.ts")},
+        "", 0,
+        [](auto&& s) { return s == "Imported\nHello World!\n"; },
+        [](auto&& s) { return s.empty(); }
+    },
+    {{"-I", "/nonexistent", test::script_path("import_main.ts")}, "", 67,
+        [](auto&& s) { return s.empty(); },
+        [](auto&& s) {
+            return std::regex_search(s, std::regex(
+                    R"(^Script terminated by exception: .*)"
+                    R"(Runtime error: Module not found\n)"));
+        }
+    },
+    {{"-I", test::script_dir.string(), test::script_path("import_cycle.ts")},
+        "", 67,
+        [](auto&& s) { return s.empty(); },
+        [](auto&& s) {
+            return std::regex_search(s, std::regex(
+                    R"(^Script terminated by exception: .*)"
+                    R"(Runtime error: Import cycle\n)"));
+        }
+    },
+    {{"-I", "a::b", "hello.ts"}, "", 65, // bad option value
+        [](auto&& s) { return s.empty(); },
+        [](auto&& s) {
+            return std::regex_search(s,
+                std::regex(R"(Invalid argument of command line option -I\n)"
+                           R"(Run '.*ts -h' for help)"));
+        }
+    },
+}))
+{
+    check_ts(boost::unit_test::framework::current_test_case().full_name(),
+             sample);
+}
+//! \endcond
+
 /*! \file
  * \test \c no_script_file -- Program \link ts.cpp ts\endlink with a script
  * file that does not exist */
@@ -1085,3 +1256,82 @@ BOOST_DATA_TEST_CASE(stack_limit, (std::vector<test::ts_result>{
              sample);
 }
 //! \endcond
+
+/*! \file
+ * \test \c reload_watch_period -- Program \link ts.cpp ts\endlink with
+ * option \c -W accepts a period that would overflow the clock */
+//! \cond
+BOOST_DATA_TEST_CASE(reload_watch_period, (std::vector<test::ts_result>{
+    {{"-W", "9223372036854775807", test::script_path("hello.ts")}, "", 0,
+        [](auto&& s) { return s == "Hello World!\n"; },
+        [](auto&& s) { return s.empty(); }
+    },
+}))
+{
+    check_ts(boost::unit_test::framework::current_test_case().full_name(),
+             sample);
+}
+//! \endcond
+
+/*! \file
+ * \test \c reload_watch -- Program \link ts.cpp ts\endlink reloads the
+ * script file modified during the second phase, if requested by option \c
+ * -W */
+//! \cond
+BOOST_AUTO_TEST_CASE(reload_watch)
+{
+    using namespace std::chrono_literals;
+    auto script = test::io_dir / "reload_watch.ts";
+    auto out_file = test::io_dir / "reload_watch.stdout";
+    auto err_file = test::io_dir / "reload_watch.stderr";
+    // Thread 0 reports the start of the second phase by an exception, which
+    // is written to the unbuffered standard error. The main thread waits
+    // until it sees the reloaded version of function version.
+    auto write_script = [&script](int version) {
+        std::ofstream(script) << R"(seq(
+            fun("version", )" << version << R"(),
+            fun("_thread", throw("started")),
+            fun("_main", seq(
+                var("c", channel(1)),
+                var("i", clone(0)),
+                while(and(eq(version(), 1), lt(i(), 1000)), seq(
+                    try(c("recv_for", 10), "", null),
+                    update_sh_vars(),
+                    add(i(), i(), 1)
+                )),
+                print("version ", version(), "\n")
+            ))
+        ))";
+    };
+    auto read = [](const std::filesystem::path& file) {
+        return std::string{
+            (std::ostringstream{} << std::ifstream(file).rdbuf()).view()
+        };
+    };
+    write_script(1);
+    std::filesystem::remove(err_file);
+    std::string cmd = test::ts_program.string() + " -t 1 -W 10 " +
+        script.string() + " </dev/null >" + out_file.string() + " 2>" +
+        err_file.string();
+    std::atomic<bool> done = false;
+    int status = 0;
+    std::jthread ts_thread([&cmd, &done, &status]() {
+        status = std::system(cmd.c_str());
+        done = true;
+    });
+    while (!done && read(err_file).find("started") == std::string::npos)
+        std::this_thread::sleep_for(10ms);
+    // Modified repeatedly, because the modification time may have a coarse
+    // resolution
+    while (!done) {
+        write_script(2);
+        std::this_thread::sleep_for(50ms);
+    }
+    ts_thread.join();
+    BOOST_CHECK_EQUAL(status % 256, 0);
+    BOOST_CHECK_EQUAL(status / 256, 69);
+    BOOST_CHECK_EQUAL(read(out_file), "version 2\n");
+    BOOST_CHECK(read(err_file).starts_with(
+                        "Thread 0 terminated by exception: "));
+}
+//! \endcond
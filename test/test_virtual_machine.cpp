@@ -57,9 +57,43 @@ BOOST_AUTO_TEST_CASE(vm_sh_vars)
     BOOST_CHECK_EQUAL(vars2.use_count(), 2);
     BOOST_CHECK_NE(vm.sh_vars.load().get(), state.t_vars.parent_table());
     BOOST_TEST(!state.t_vars.contains("var"));
-    state.update_sh_vars();
+    BOOST_TEST(state.update_sh_vars());
     BOOST_CHECK_EQUAL(vars2.use_count(), 3);
     BOOST_CHECK_EQUAL(vm.sh_vars.load().get(), state.t_vars.parent_table());
     BOOST_TEST(state.t_vars.contains("var"));
+    BOOST_TEST(!state.update_sh_vars());
+    BOOST_CHECK_EQUAL(vars2.use_count(), 3);
+}
+//! \endcond
+
+/*! \file
+ * \test \c vm_sh_vars_generation -- Generations of the shared global symbol
+ * table of a VM */
+//! \cond
+BOOST_AUTO_TEST_CASE(vm_sh_vars_generation)
+{
+    threadscript::allocator_any alloc;
+    threadscript::virtual_machine vm(alloc);
+    BOOST_TEST(vm.sh_vars.generation() == 0U);
+    auto vars1 = std::make_shared<threadscript::symbol_table>(alloc, nullptr);
+    vm.sh_vars = vars1;
+    BOOST_TEST(vm.sh_vars.generation() == 1U);
+    std::shared_ptr<const threadscript::symbol_table> p;
+    decltype(vm.sh_vars)::generation_t gen = 0;
+    BOOST_TEST(vm.sh_vars.load_if_changed(p, gen));
+    BOOST_CHECK_EQUAL(p, vars1);
+    BOOST_TEST(gen == 1U);
+    BOOST_TEST(!vm.sh_vars.load_if_changed(p, gen));
+    // Storing the same pointer again is a new generation
+    vm.sh_vars.store(vars1);
+    BOOST_TEST(vm.sh_vars.generation() == 2U);
+    BOOST_TEST(vm.sh_vars.load_if_changed(p, gen));
+    BOOST_TEST(gen == 2U);
+    threadscript::state state(vm);
+    BOOST_TEST(!state.update_sh_vars());
+    vm.sh_vars = nullptr;
+    BOOST_TEST(state.update_sh_vars());
+    BOOST_TEST(!state.t_vars.parent_table());
+    BOOST_CHECK_EQUAL(vars1.use_count(), 2);
 }
 //! \endcond
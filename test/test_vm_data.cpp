@@ -27,7 +27,9 @@ using value_types = std::tuple<
     ts::value_bool,
     ts::value_int,
     ts::value_unsigned,
-    ts::value_string
+    ts::value_string,
+    ts::value_int_vector,
+    ts::value_unsigned_vector
 >;
 
 template <class T> struct properties {};
@@ -51,6 +53,17 @@ template <> struct properties<ts::value_string> {
     inline static const ts::a_string default_value{};
     inline static const ts::a_string set_value{"abc"};
 };
+template <> struct properties<ts::value_int_vector> {
+    static constexpr std::string_view type_name{"int_vector"};
+    inline static const ts::value_int_vector::value_type default_value{};
+    inline static const ts::value_int_vector::value_type set_value{-1, 0, 2};
+};
+template <> struct properties<ts::value_unsigned_vector> {
+    static constexpr std::string_view type_name{"unsigned_vector"};
+    inline static const ts::value_unsigned_vector::value_type default_value{};
+    inline static const ts::value_unsigned_vector::value_type
+        set_value{1, 0, 2};
+};
 //! \endcond
 
 /*! \file
@@ -488,3 +501,42 @@ BOOST_AUTO_TEST_CASE(value_hash_capacity, *boost::unit_test::tolerance(0.05))
     BOOST_TEST(shrinked > 0);
 }
 //! \endcond
+
+//! \cond
+using packed_vector_types = std::tuple<
+    ts::value_int_vector,
+    ts::value_unsigned_vector
+>;
+//! \endcond
+
+/*! \file
+ * \test \c value_packed_vector_allocator -- The internal value of
+ * threadscript::basic_value_int_vector and
+ * threadscript::basic_value_unsigned_vector uses the provided allocator. */
+//! \cond
+BOOST_AUTO_TEST_CASE_TEMPLATE(value_packed_vector_allocator, T,
+                              packed_vector_types)
+{
+    ts::allocator_config cfg;
+    ts::allocator_any alloc{&cfg};
+    auto v = T::create(alloc);
+    BOOST_TEST(alloc.cfg() == v->value().get_allocator().cfg());
+}
+//! \endcond
+
+/*! \file
+ * \test \c value_packed_vector_capacity -- Automatic handling of
+ * threadscript::basic_value_int_vector and
+ * threadscript::basic_value_unsigned_vector capacity */
+//! \cond
+BOOST_AUTO_TEST_CASE_TEMPLATE(value_packed_vector_capacity, T,
+                              packed_vector_types)
+{
+    ts::allocator_any alloc;
+    auto v = T::create(alloc);
+    v->value().resize(300);
+    BOOST_TEST(v->value().capacity() >= v->value().size());
+    v->value().resize(20);
+    BOOST_TEST(v->value().capacity() < 60);
+}
+//! \endcond
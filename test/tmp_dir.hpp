@@ -0,0 +1,44 @@
+#pragma once
+
+/*! \file
+ * A temporary directory for files used by tests
+ *
+ * See, e.g., programs test_module.cpp and test_source_file.cpp for examples
+ * how to use this file.
+ */
+//! \cond
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+namespace test {
+
+// A temporary directory removed at the end of a test. Its name contains the
+// process id, so that concurrent runs of tests do not collide.
+struct tmp_dir {
+    explicit tmp_dir(const std::string& name):
+        path(std::filesystem::temp_directory_path() /
+             (name + "." + std::to_string(getpid())))
+    {
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+    }
+    tmp_dir(const tmp_dir&) = delete;
+    ~tmp_dir() {
+        std::filesystem::remove_all(path);
+    }
+    tmp_dir& operator=(const tmp_dir&) = delete;
+    // Writes a file, creating its parent directories, and returns its name
+    std::string write(const std::string& name, const std::string& data) {
+        auto file = path / name;
+        std::filesystem::create_directories(file.parent_path());
+        std::ofstream(file, std::ios::binary) << data;
+        return file.string();
+    }
+    std::filesystem::path path;
+};
+
+} // namespace test
+//! \endcond